@@ -27,6 +27,7 @@ import pooltool.constants as constants
 import pooltool.events as events
 import pooltool.evolution as evolution
 import pooltool.game as game
+import pooltool.instrumentation as instrumentation
 import pooltool.interact as interact
 import pooltool.layouts as layouts
 import pooltool.objects as objects
@@ -38,8 +39,21 @@ import pooltool.system as system
 import pooltool.terminal as terminal
 import pooltool.utils as utils
 from pooltool.events import EventType
-from pooltool.evolution import continuize, simulate
+from pooltool.evolution import (
+    SimulationCache,
+    continuize,
+    resimulate,
+    simulate,
+    simulate_batch,
+    simulate_compiled,
+    simulate_gpu,
+    simulate_iter,
+    simulate_many,
+)
+from pooltool.evolution.precompile import precompile
 from pooltool.game.datatypes import GameType
+from pooltool.game.selfplay import play_games
+from pooltool.instrumentation import instrument
 from pooltool.interact import Game, ShotViewer
 from pooltool.layouts import generate_layout, get_rack
 from pooltool.objects import (
@@ -62,6 +76,7 @@ __all__ = [
     "ptmath",
     "objects",
     "interact",
+    "instrumentation",
     "evolution",
     "ruleset",
     "layouts",
@@ -85,10 +100,20 @@ __all__ = [
     "Game",
     "ShotViewer",
     "EventType",
+    "SimulationCache",
     # functions
     "get_rack",
     "get_ruleset",
     "simulate",
+    "resimulate",
+    "simulate_batch",
+    "simulate_compiled",
+    "simulate_gpu",
+    "simulate_iter",
+    "simulate_many",
     "continuize",
     "generate_layout",
+    "precompile",
+    "instrument",
+    "play_games",
 ]
@@ -0,0 +1,144 @@
+"""Command line entry points
+
+Usage:
+
+.. code-block:: bash
+
+    python -m pooltool warmup [--cache-dir DIR] [--benchmark]
+    python -m pooltool bench run [-k PATTERN] [--exclude PATTERN] [-o FILE]
+    python -m pooltool bench compare BASE HEAD [--threshold FRACTION]
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+from pooltool.benchmark.runner import (
+    BenchmarkReport,
+    Change,
+    compare,
+    format_comparisons,
+    format_report,
+    run,
+    select,
+)
+from pooltool.benchmark.suite import default_suite, detect_crossover
+from pooltool.evolution.precompile import benchmark, precompile
+
+
+def warmup(args: argparse.Namespace) -> None:
+    if args.benchmark:
+        print(json.dumps(benchmark(args.cache_dir), indent=2))
+        return
+
+    report = precompile(args.cache_dir)
+    print(
+        f"Compiled {report.signatures} signatures of {report.kernels} kernels in "
+        f"{report.seconds:.1f}s"
+    )
+
+
+def bench_run(args: argparse.Namespace) -> None:
+    benchmarks = select(default_suite(), args.pattern, args.exclude)
+    report = run(
+        benchmarks,
+        repeat=args.repeat,
+        min_time=args.min_time,
+        progress=lambda result: print(f"{result.name}: {result.min:.6g}s"),
+    )
+
+    print(format_report(report))
+    if any(result.name.startswith("detect/") for result in report.results):
+        crossover = detect_crossover(report.results)
+        if crossover is None:
+            print("\nParallel detection was never faster than serial detection")
+        else:
+            print(f"\nParallel detection was faster from {crossover} candidates")
+
+    if args.output is not None:
+        report.save(args.output)
+
+
+def bench_compare(args: argparse.Namespace) -> None:
+    comparisons = compare(
+        BenchmarkReport.load(args.base),
+        BenchmarkReport.load(args.head),
+        threshold=args.threshold,
+    )
+    print(format_comparisons(comparisons))
+
+    if any(comparison.change == Change.SLOWER for comparison in comparisons):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    ap = argparse.ArgumentParser(prog="pooltool")
+    subparsers = ap.add_subparsers(dest="command", required=True)
+
+    warmup_parser = subparsers.add_parser(
+        "warmup", help="Precompile the numba kernels (see pooltool.precompile)"
+    )
+    warmup_parser.add_argument(
+        "--cache-dir",
+        type=Path,
+        default=None,
+        help="Cache compiled kernels here (default: numba's cache directory)",
+    )
+    warmup_parser.add_argument(
+        "--benchmark",
+        action="store_true",
+        help=(
+            "Instead, print the time-to-first-shot of a fresh process with a cold and "
+            "a precompiled cache, as JSON"
+        ),
+    )
+    warmup_parser.set_defaults(func=warmup)
+
+    bench_parser = subparsers.add_parser(
+        "bench", help="Benchmark the simulation pipeline (see pooltool.benchmark)"
+    )
+    bench_subparsers = bench_parser.add_subparsers(dest="bench_command", required=True)
+
+    run_parser = bench_subparsers.add_parser("run", help="Run the benchmarks")
+    run_parser.add_argument(
+        "-k",
+        dest="pattern",
+        default=None,
+        help="Only run benchmarks whose names match this regular expression",
+    )
+    run_parser.add_argument(
+        "--exclude",
+        default=None,
+        help="Skip benchmarks whose names match this regular expression",
+    )
+    run_parser.add_argument(
+        "--repeat", type=int, default=5, help="The number of timed rounds"
+    )
+    run_parser.add_argument(
+        "--min-time",
+        type=float,
+        default=0.2,
+        help="The minimum duration of each round, in seconds",
+    )
+    run_parser.add_argument(
+        "-o", "--output", type=Path, default=None, help="Save the results as JSON"
+    )
+    run_parser.set_defaults(func=bench_run)
+
+    compare_parser = bench_subparsers.add_parser(
+        "compare",
+        help="Compare two results files. Exits with 1 if any benchmark got slower",
+    )
+    compare_parser.add_argument("base", type=Path, help="The older results")
+    compare_parser.add_argument("head", type=Path, help="The newer results")
+    compare_parser.add_argument(
+        "--threshold",
+        type=float,
+        default=0.1,
+        help="Fractional changes smaller than this are considered noise",
+    )
+    compare_parser.set_defaults(func=bench_compare)
+
+    args = ap.parse_args()
+    args.func(args)
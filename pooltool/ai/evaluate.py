@@ -0,0 +1,273 @@
+"""Monte-Carlo evaluation of shot robustness
+
+Rather than judging a shot by its geometry (see :mod:`pooltool.ai.pot`), a shot is
+judged by simulating it many times, each time with the stroke perturbed by a model of
+the shooter's imprecision (:class:`NoiseModel`). The result (:class:`ShotEvaluation`)
+is the estimated probability that the target ball is potted, the probability that the
+cue ball is scratched, and statistics of where the cue ball comes to rest.
+
+Samples are drawn in rounds, and every candidate whose pot probability is known to the
+requested precision stops being sampled (see :func:`evaluate_actions`).
+"""
+
+from __future__ import annotations
+
+from statistics import NormalDist
+from typing import List, Optional, Sequence, Set
+
+import attrs
+import numpy as np
+from numpy.typing import NDArray
+
+from pooltool.ai.action import Action
+from pooltool.events import EventType
+from pooltool.evolution.event_based.batch import simulate_batch
+from pooltool.evolution.event_based.parallel import PoolType, simulate_many
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.system.datatypes import System
+
+
+@attrs.define(frozen=True)
+class NoiseModel:
+    """Gaussian imprecision of each stroke parameter
+
+    Each attribute is the standard deviation of the corresponding :class:`Action`
+    parameter. Perturbed values of ``theta`` are clipped to [0, 90), ``V0`` is clipped
+    to be non-negative, and ``a`` and ``b`` are clipped to [-1, 1].
+
+    Attributes:
+        V0: The standard deviation of the cue speed (m/s).
+        phi: The standard deviation of the cue's aiming angle (degrees).
+        theta: The standard deviation of the cue's elevation (degrees).
+        a: The standard deviation of the horizontal contact point (ball radii).
+        b: The standard deviation of the vertical contact point (ball radii).
+    """
+
+    V0: float = attrs.field(default=0.05)
+    phi: float = attrs.field(default=0.1)
+    theta: float = attrs.field(default=0.1)
+    a: float = attrs.field(default=0.01)
+    b: float = attrs.field(default=0.01)
+
+    def sample(
+        self, action: Action, size: int, rng: np.random.Generator
+    ) -> List[Action]:
+        """Draw perturbed copies of an action"""
+        V0 = rng.normal(action.V0, self.V0, size).clip(min=0)
+        phi = rng.normal(action.phi, self.phi, size) % 360
+        theta = rng.normal(action.theta, self.theta, size).clip(0, 89.999)
+        a = rng.normal(action.a, self.a, size).clip(-1, 1)
+        b = rng.normal(action.b, self.b, size).clip(-1, 1)
+
+        return [
+            Action(*(float(value) for value in values))
+            for values in zip(V0, phi, theta, a, b)
+        ]
+
+
+@attrs.define
+class ShotEvaluation:
+    """The simulated outcome statistics of a shot
+
+    Attributes:
+        action:
+            The unperturbed action.
+        samples:
+            The number of perturbed shots simulated.
+        pots:
+            The number of samples in which the target ball was pocketed.
+        scratches:
+            The number of samples in which the cue ball was pocketed.
+        leaves:
+            The final (x, y) coordinates of the cue ball, for each sample in which it
+            wasn't pocketed. Shape (M, 2).
+        converged:
+            Whether sampling stopped because the pot probability was known to the
+            requested precision, rather than because the sample budget was spent.
+    """
+
+    action: Action
+    samples: int = attrs.field(default=0)
+    pots: int = attrs.field(default=0)
+    scratches: int = attrs.field(default=0)
+    leaves: NDArray[np.float64] = attrs.field(factory=lambda: np.empty((0, 2)))
+    converged: bool = attrs.field(default=False)
+
+    @property
+    def pot_probability(self) -> float:
+        return self.pots / self.samples if self.samples else 0.0
+
+    @property
+    def scratch_probability(self) -> float:
+        return self.scratches / self.samples if self.samples else 0.0
+
+    @property
+    def leave_mean(self) -> NDArray[np.float64]:
+        """The mean resting position of the cue ball (NaN if it always scratched)"""
+        if not len(self.leaves):
+            return np.full(2, np.nan)
+        return self.leaves.mean(axis=0)
+
+    @property
+    def leave_std(self) -> NDArray[np.float64]:
+        """The standard deviation of the cue ball's resting position"""
+        if not len(self.leaves):
+            return np.full(2, np.nan)
+        return self.leaves.std(axis=0)
+
+    def interval(self, confidence: float = 0.95) -> float:
+        """The half-width of the Wilson score interval of the pot probability"""
+        if not self.samples:
+            return 0.5
+
+        z = NormalDist().inv_cdf(0.5 + confidence / 2)
+        n, p = self.samples, self.pot_probability
+        return z * np.sqrt(p * (1 - p) / n + z**2 / (4 * n**2)) / (1 + z**2 / n)
+
+
+def evaluate_action(
+    system: System, action: Action, ball_id: str, **kwargs
+) -> ShotEvaluation:
+    """Evaluate a single candidate action
+
+    See :func:`evaluate_actions` for the available keyword arguments.
+    """
+    return evaluate_actions(system, [action], ball_id, **kwargs)[0]
+
+
+def evaluate_actions(
+    system: System,
+    actions: Sequence[Action],
+    ball_id: str,
+    noise: NoiseModel = NoiseModel(),
+    max_samples: int = 64,
+    round_size: int = 16,
+    tolerance: float = 0.1,
+    confidence: float = 0.95,
+    engine: Optional[PhysicsEngine] = None,
+    pool: Optional[PoolType] = None,
+    seed: Optional[int] = None,
+) -> List[ShotEvaluation]:
+    """Estimate the outcome statistics of candidate actions by simulation
+
+    Samples are drawn in rounds of ``round_size`` per candidate. After each round, any
+    candidate whose pot probability is known to within ``tolerance`` (with the given
+    ``confidence``) is considered converged, and isn't sampled further. Each round,
+    every unconverged candidate's samples are simulated together, so shots that are
+    clearly makes or clearly misses cost only a round or two.
+
+    The pre-shot state is copied once. Each sample is a fork of it (see
+    :meth:`pooltool.system.datatypes.System.fork`), which shares the table geometry.
+
+    Args:
+        system:
+            The system, before the shot. Its cue's ``cue_ball_id`` determines the cue
+            ball.
+        actions:
+            The candidate actions.
+        ball_id:
+            The ID of the ball that is meant to be potted.
+        noise:
+            The model of the shooter's imprecision.
+        max_samples:
+            The maximum number of samples per candidate.
+        round_size:
+            The number of samples drawn per candidate per round.
+        tolerance:
+            The half-width of the confidence interval of the pot probability (see
+            :meth:`ShotEvaluation.interval`) below which sampling stops.
+        confidence:
+            The confidence level of the interval.
+        engine:
+            The physics engine. See
+            :func:`pooltool.evolution.event_based.simulate.simulate`.
+        pool:
+            By default, the samples of a round are simulated in lockstep, in-process
+            (see :func:`pooltool.evolution.event_based.batch.simulate_batch`). If a
+            :class:`pooltool.evolution.event_based.parallel.PoolType` is passed, they
+            are instead spread over a pool of workers (see
+            :func:`pooltool.evolution.event_based.parallel.simulate_many`).
+        seed:
+            The seed of the random number generator used to perturb the actions.
+
+    Returns:
+        evaluations:
+            One evaluation per candidate action, in the same order.
+
+    Example:
+
+        >>> import pooltool as pt
+        >>> from pooltool.ai.action import Action
+        >>> from pooltool.ai.evaluate import evaluate_actions
+        >>> system = pt.System.example()
+        >>> phi = pt.aim.at_ball(system, "1", cut=30)
+        >>> actions = [Action(V0, phi, 0, 0, 0) for V0 in (1, 2, 3)]
+        >>> for evaluation in evaluate_actions(system, actions, "1"):
+        >>>     print(evaluation.pot_probability, evaluation.leave_mean)
+    """
+    rng = np.random.default_rng(seed)
+
+    template = system.copy()
+    template.reset_history()
+    cue_ball_id = template.cue.cue_ball_id
+
+    evaluations = [ShotEvaluation(action=action) for action in actions]
+    leaves: List[List[NDArray[np.float64]]] = [[] for _ in actions]
+
+    while True:
+        pending = [
+            i
+            for i, evaluation in enumerate(evaluations)
+            if not evaluation.converged and evaluation.samples < max_samples
+        ]
+
+        if not pending:
+            break
+
+        owners: List[int] = []
+        shots: List[System] = []
+        for i in pending:
+            size = min(round_size, max_samples - evaluations[i].samples)
+            for action in noise.sample(evaluations[i].action, size, rng):
+                owners.append(i)
+                shots.append(_sample_system(template, action))
+
+        if pool is None:
+            simulated = simulate_batch(shots, engine=engine, inplace=True)
+        else:
+            simulated = list(simulate_many(shots, pool=pool, engine=engine))
+
+        for i, shot in zip(owners, simulated):
+            evaluation = evaluations[i]
+            evaluation.samples += 1
+
+            pocketed = _pocketed(shot)
+            if ball_id in pocketed:
+                evaluation.pots += 1
+            if cue_ball_id in pocketed:
+                evaluation.scratches += 1
+            else:
+                leaves[i].append(shot.balls[cue_ball_id].state.rvw[0, :2].copy())
+
+        for i in pending:
+            evaluation = evaluations[i]
+            evaluation.converged = evaluation.interval(confidence) <= tolerance
+
+    for evaluation, ball_leaves in zip(evaluations, leaves):
+        if len(ball_leaves):
+            evaluation.leaves = np.array(ball_leaves)
+
+    return evaluations
+
+
+def _sample_system(template: System, action: Action) -> System:
+    """Create a system from the pre-shot template, struck with an action"""
+    system = template.fork()
+    action.apply(system.cue)
+    return system
+
+
+def _pocketed(shot: System) -> Set[str]:
+    """The IDs of the balls pocketed during a simulated shot"""
+    pocket_events = shot.event_index.query(types=EventType.BALL_POCKET)
+    return {event.ids[0] for event in pocket_events}
@@ -3,13 +3,20 @@
 The concept of this aiming procedure is to determine the cueing angle phi such that the
 cue ball contacts the object ball on the aim line. Cut- and spin-induced throw is
 ignored. Bank shots are not supported. Interfering balls are not detected.
+
+The functions that take a single ball and pocket are mirrored by :class:`PotMatrix`,
+which evaluates every ball and pocket of a system in one just-in-time compiled pass.
 """
 
+from __future__ import annotations
+
 import math
-from typing import Dict, Iterable, List, Optional, Set, Tuple
+import weakref
+from typing import Any, Dict, Iterable, List, Optional, Set, Tuple
 
 import attrs
 import numpy as np
+from numba import jit
 from numpy.typing import NDArray
 
 import pooltool.constants as const
@@ -59,6 +66,10 @@ pocket_jaw_map: Dict[str, Jaw] = {
 
 
 def potting_point_side(_: Ball, table: Table, pocket: Pocket) -> Coordinate:
+    return _midpoint_between_jaws(table, pocket)
+
+
+def _midpoint_between_jaws(table: Table, pocket: Pocket) -> Coordinate:
     jaw = pocket_jaw_map[pocket.id]
     lrail = table.cushion_segments.linear[jaw.left_rail]
     rrail = table.cushion_segments.linear[jaw.right_rail]
@@ -474,14 +485,523 @@ def pick_easiest_pot(
     This function calculates the potting angle required, and the precision required, for
     each pocket. The "best" pocket is the one where the pot requires the smallest cut
     angle.
+
+    If the ball is one of the system's balls, every ball and pocket of the system is
+    evaluated at once (see :func:`pot_matrix`), so that picking pots for each ball of
+    an unchanged system is evaluated only once.
     """
 
-    cue_ball = system.balls[system.cue.cue_ball_id]
-    pocket_options = viable_pockets(
-        cue_ball, ball, system.table, list(system.balls.values())
-    )
+    if system.balls.get(ball.id) is ball:
+        pocket_options = pot_matrix(system).viable_pockets(ball.id)
+    else:
+        cue_ball = system.balls[system.cue.cue_ball_id]
+        pocket_options = viable_pockets(
+            cue_ball, ball, system.table, list(system.balls.values())
+        )
 
     if not len(pocket_options):
         return None
 
     return system.table.pockets[pocket_options[0][0]]
+
+
+@attrs.define(frozen=True, eq=False)
+class PocketGeometry:
+    """The geometry of a table's pockets that potting calculations need
+
+    Each attribute holds a row per pocket.
+
+    Attributes:
+        pocket_ids:
+            The pocket IDs.
+        corner:
+            Whether each pocket is a corner pocket.
+        center:
+            The pocket centers.
+        ltip:
+            The intersections of the left rail and left edge of each pocket's jaws.
+        rtip:
+            The intersections of the right rail and right edge of each pocket's jaws.
+        side_point:
+            The potting point of side pockets (see :func:`potting_point_side`).
+        aci:
+            The intersection of the adjacent rails of corner pockets.
+        lrail_unit:
+            The unit vector of the left rail of corner pockets.
+        rrail_unit:
+            The unit vector of the right rail of corner pockets.
+        ljaw_center:
+            The center of the left jaw tip of side pockets.
+        ljaw_radius:
+            The radius of the left jaw tip of side pockets.
+        rjaw_center:
+            The center of the right jaw tip of side pockets.
+        rjaw_radius:
+            The radius of the right jaw tip of side pockets.
+    """
+
+    pocket_ids: Tuple[str, ...]
+    corner: NDArray[np.bool_]
+    center: NDArray[np.float64]
+    ltip: NDArray[np.float64]
+    rtip: NDArray[np.float64]
+    side_point: NDArray[np.float64]
+    aci: NDArray[np.float64]
+    lrail_unit: NDArray[np.float64]
+    rrail_unit: NDArray[np.float64]
+    ljaw_center: NDArray[np.float64]
+    ljaw_radius: NDArray[np.float64]
+    rjaw_center: NDArray[np.float64]
+    rjaw_radius: NDArray[np.float64]
+
+    @classmethod
+    def from_table(cls, table: Table) -> PocketGeometry:
+        pockets = list(table.pockets.values())
+        num = len(pockets)
+
+        geometry = cls(
+            pocket_ids=tuple(pocket.id for pocket in pockets),
+            corner=np.zeros(num, dtype=np.bool_),
+            center=np.zeros((num, 3)),
+            ltip=np.zeros((num, 2)),
+            rtip=np.zeros((num, 2)),
+            side_point=np.zeros((num, 2)),
+            aci=np.zeros((num, 2)),
+            lrail_unit=np.zeros((num, 2)),
+            rrail_unit=np.zeros((num, 2)),
+            ljaw_center=np.zeros((num, 3)),
+            ljaw_radius=np.zeros(num),
+            rjaw_center=np.zeros((num, 3)),
+            rjaw_radius=np.zeros(num),
+        )
+
+        linear = table.cushion_segments.linear
+        circular = table.cushion_segments.circular
+        for i, pocket in enumerate(pockets):
+            jaw = pocket_jaw_map[pocket.id]
+            lrail, ledge = linear[jaw.left_rail], linear[jaw.left_edge]
+            rrail, redge = linear[jaw.right_rail], linear[jaw.right_edge]
+
+            geometry.corner[i] = jaw.corner
+            geometry.center[i] = pocket.center
+            geometry.ltip[i] = find_intersection_2D(
+                lrail.lx, lrail.ly, lrail.l0, ledge.lx, ledge.ly, ledge.l0
+            )
+            geometry.rtip[i] = find_intersection_2D(
+                rrail.lx, rrail.ly, rrail.l0, redge.lx, redge.ly, redge.l0
+            )
+
+            if jaw.corner:
+                geometry.aci[i] = find_intersection_2D(
+                    lrail.lx, lrail.ly, lrail.l0, rrail.lx, rrail.ly, rrail.l0
+                )
+                geometry.lrail_unit[i] = unit_vector(lrail.p2 - lrail.p1)[:2]
+                geometry.rrail_unit[i] = unit_vector(rrail.p2 - rrail.p1)[:2]
+            else:
+                geometry.side_point[i] = _midpoint_between_jaws(table, pocket)
+                ljaw, rjaw = circular[jaw.left_tip], circular[jaw.right_tip]
+                geometry.ljaw_center[i] = ljaw.center
+                geometry.ljaw_radius[i] = ljaw.radius
+                geometry.rjaw_center[i] = rjaw.center
+                geometry.rjaw_radius[i] = rjaw.radius
+
+        return geometry
+
+
+@attrs.define(frozen=True, eq=False)
+class PotMatrix:
+    """Potting calculations for every ball and pocket of a system
+
+    Each array has a row per ball and a column per pocket, and the entries for a ball
+    and pocket match the functions of this module that take that ball and pocket (with
+    all of the system's balls as the potentially interfering balls).
+
+    Attributes:
+        ball_ids:
+            The ball IDs, in row order.
+        pocket_ids:
+            The pocket IDs, in column order.
+        cue_ball_id:
+            The ID of the cue ball.
+        potting_point:
+            See :func:`get_potting_point`. Shape (balls, pockets, 2).
+        shadow_ball_center:
+            See :func:`calc_shadow_ball_center`. Shape (balls, pockets, 2).
+        cut_angle:
+            The absolute cut angle (see :func:`viable_pockets`).
+        precision:
+            See :func:`required_precision`.
+        pocket_occluded:
+            See :func:`is_pocket_occluded`.
+        room_for_cue_ball:
+            See :func:`is_room_for_cue_ball`.
+        jaw_in_way:
+            See :func:`is_jaw_in_way`.
+        object_ball_occluded:
+            See :func:`is_object_ball_occluded`.
+    """
+
+    ball_ids: Tuple[str, ...]
+    pocket_ids: Tuple[str, ...]
+    cue_ball_id: str
+    potting_point: NDArray[np.float64]
+    shadow_ball_center: NDArray[np.float64]
+    cut_angle: NDArray[np.float64]
+    precision: NDArray[np.float64]
+    pocket_occluded: NDArray[np.bool_]
+    room_for_cue_ball: NDArray[np.bool_]
+    jaw_in_way: NDArray[np.bool_]
+    object_ball_occluded: NDArray[np.bool_]
+
+    @classmethod
+    def from_system(
+        cls, system: System, geometry: Optional[PocketGeometry] = None
+    ) -> PotMatrix:
+        """Evaluate every ball and pocket of a system
+
+        Args:
+            system:
+                The system.
+            geometry:
+                The system table's pocket geometry. If not passed, it's computed from
+                the table.
+        """
+        if geometry is None:
+            geometry = PocketGeometry.from_table(system.table)
+        return cls._from_packed(system, geometry, *_pack_balls(system))
+
+    @classmethod
+    def _from_packed(
+        cls,
+        system: System,
+        geometry: PocketGeometry,
+        xyz: NDArray[np.float64],
+        R: NDArray[np.float64],
+        pocketed: NDArray[np.bool_],
+    ) -> PotMatrix:
+        ball_ids = tuple(system.balls)
+        cue_ball_id = system.cue.cue_ball_id
+
+        return cls(
+            ball_ids,
+            geometry.pocket_ids,
+            cue_ball_id,
+            *_pot_matrix(
+                xyz,
+                R,
+                pocketed,
+                ball_ids.index(cue_ball_id),
+                system.table.w,
+                system.table.l,
+                geometry.corner,
+                geometry.center,
+                geometry.ltip,
+                geometry.rtip,
+                geometry.side_point,
+                geometry.aci,
+                geometry.lrail_unit,
+                geometry.rrail_unit,
+                geometry.ljaw_center,
+                geometry.ljaw_radius,
+                geometry.rjaw_center,
+                geometry.rjaw_radius,
+            ),
+        )
+
+    def viable(self, max_cut: float = 80) -> NDArray[np.bool_]:
+        """Whether each ball can be potted into each pocket
+
+        See :func:`viable_pockets` for what makes a pot viable.
+        """
+        return (
+            ~self.pocket_occluded
+            & self.room_for_cue_ball
+            & ~self.jaw_in_way
+            & ~self.object_ball_occluded
+            & (self.cut_angle <= max_cut)
+        )
+
+    def viable_pockets(
+        self, ball_id: str, max_cut: float = 80
+    ) -> List[Tuple[str, float]]:
+        """Like :func:`viable_pockets`, for one of the system's balls"""
+        i = self.ball_ids.index(ball_id)
+        viable = self.viable(max_cut)[i]
+        options = [
+            (pocket_id, float(self.precision[i, j]))
+            for j, pocket_id in enumerate(self.pocket_ids)
+            if viable[j]
+        ]
+        return sorted(options, key=lambda x: x[1])
+
+
+def _pack_balls(
+    system: System,
+) -> Tuple[NDArray[np.float64], NDArray[np.float64], NDArray[np.bool_]]:
+    balls = system.balls.values()
+    xyz = np.array([ball.state.rvw[0] for ball in balls], dtype=np.float64)
+    R = np.array([ball.params.R for ball in balls], dtype=np.float64)
+    pocketed = np.array([ball.state.s == const.pocketed for ball in balls], dtype=bool)
+    return xyz.reshape(-1, 3), R, pocketed
+
+
+# Geometries of the most recently used tables, keyed by the table's id (the reference
+# guards against ids reused by new tables)
+_geometries: Dict[int, Tuple[weakref.ref, PocketGeometry]] = {}
+_MAX_GEOMETRIES = 256
+
+# The most recently computed matrix, and the state it was computed for (the geometry
+# is held by reference, since it's compared by identity)
+_last_matrix: Optional[Tuple[Tuple[Any, ...], PotMatrix]] = None
+
+
+def pocket_geometry(table: Table) -> PocketGeometry:
+    """The pocket geometry of a table, cached per table
+
+    The geometry is computed once per table object, so modifying a table's cushion
+    segments or pockets in place isn't picked up.
+    """
+    key = id(table)
+    if key in _geometries:
+        ref, geometry = _geometries[key]
+        if ref() is table:
+            return geometry
+
+    if len(_geometries) >= _MAX_GEOMETRIES:
+        for stale in [k for k, (ref, _) in _geometries.items() if ref() is None]:
+            del _geometries[stale]
+        if len(_geometries) >= _MAX_GEOMETRIES:
+            _geometries.clear()
+
+    geometry = PocketGeometry.from_table(table)
+    _geometries[key] = (weakref.ref(table), geometry)
+    return geometry
+
+
+def pot_matrix(system: System) -> PotMatrix:
+    """Evaluate every ball and pocket of a system, reusing the last result if possible
+
+    The most recent matrix is kept, and returned as long as the positions and states of
+    the balls, the cue ball, and the table are unchanged. The AI evaluates each
+    candidate ball of a decision against the same system, so the matrix is computed
+    once per decision.
+    """
+    global _last_matrix
+
+    geometry = pocket_geometry(system.table)
+    xyz, R, pocketed = _pack_balls(system)
+    key = (
+        geometry,
+        tuple(system.balls),
+        system.cue.cue_ball_id,
+        xyz.tobytes(),
+        R.tobytes(),
+        pocketed.tobytes(),
+    )
+
+    if _last_matrix is not None and _last_matrix[0] == key:
+        return _last_matrix[1]
+
+    matrix = PotMatrix._from_packed(system, geometry, xyz, R, pocketed)
+    _last_matrix = (key, matrix)
+    return matrix
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _angle_2d(v1x: float, v1y: float, v2x: float, v2y: float) -> float:
+    """See angle_between_vectors"""
+    return math.degrees(math.atan2(v1x * v2y - v1y * v2x, v1x * v2x + v1y * v2y))
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _is_path_occluded(
+    xyz: NDArray[np.float64],
+    R: NDArray[np.float64],
+    pocketed: NDArray[np.bool_],
+    traveler: int,
+    exclude: int,
+    p2x: float,
+    p2y: float,
+) -> bool:
+    """See ball_ids_occluding_ballpath"""
+    if pocketed[traveler]:
+        return False
+
+    p1x, p1y = xyz[traveler, 0], xyz[traveler, 1]
+    dx, dy = p2x - p1x, p2y - p1y
+    dd = dx * dx + dy * dy
+    if dd == 0.0:
+        return False
+
+    for k in range(len(R)):
+        if k == traveler or k == exclude:
+            continue
+
+        t = -((p1x - xyz[k, 0]) * dx + (p1y - xyz[k, 1]) * dy) / dd
+        if t < 0 or t > 1:
+            continue
+
+        cx, cy = p1x + dx * t - xyz[k, 0], p1y + dy * t - xyz[k, 1]
+        if math.sqrt(cx * cx + cy * cy) < 2 * R[k]:
+            return True
+
+    return False
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _pot_matrix(
+    xyz: NDArray[np.float64],
+    R: NDArray[np.float64],
+    pocketed: NDArray[np.bool_],
+    cue: int,
+    w: float,
+    l: float,
+    corner: NDArray[np.bool_],
+    center: NDArray[np.float64],
+    ltip: NDArray[np.float64],
+    rtip: NDArray[np.float64],
+    side_point: NDArray[np.float64],
+    aci: NDArray[np.float64],
+    lrail_unit: NDArray[np.float64],
+    rrail_unit: NDArray[np.float64],
+    ljaw_center: NDArray[np.float64],
+    ljaw_radius: NDArray[np.float64],
+    rjaw_center: NDArray[np.float64],
+    rjaw_radius: NDArray[np.float64],
+) -> Tuple[
+    NDArray[np.float64],
+    NDArray[np.float64],
+    NDArray[np.float64],
+    NDArray[np.float64],
+    NDArray[np.bool_],
+    NDArray[np.bool_],
+    NDArray[np.bool_],
+    NDArray[np.bool_],
+]:
+    """Evaluate every ball and pocket (just-in-time compiled)
+
+    See PotMatrix for the outputs, and the module's scalar functions for what's
+    calculated.
+    """
+    N = len(R)
+    P = len(corner)
+
+    potting_point = np.zeros((N, P, 2))
+    shadow = np.zeros((N, P, 2))
+    cut_angle = np.zeros((N, P))
+    precision = np.zeros((N, P))
+    pocket_occluded = np.zeros((N, P), dtype=np.bool_)
+    room = np.zeros((N, P), dtype=np.bool_)
+    jaw_in_way = np.zeros((N, P), dtype=np.bool_)
+    object_occluded = np.zeros((N, P), dtype=np.bool_)
+
+    cx, cy = xyz[cue, 0], xyz[cue, 1]
+
+    for i in range(N):
+        bx, by = xyz[i, 0], xyz[i, 1]
+
+        for j in range(P):
+            # Potting point (see get_potting_point)
+            if corner[j]:
+                lx, ly = ltip[j, 0], ltip[j, 1]
+                ex, ey = rtip[j, 0] - lx, rtip[j, 1] - ly
+                side_ball = ex * (by - ly) - (bx - lx) * ey
+                side_center = ex * (center[j, 1] - ly) - (center[j, 0] - lx) * ey
+
+                if side_ball * side_center >= 0:
+                    # The ball is in the jaws
+                    px, py = center[j, 0], center[j, 1]
+                else:
+                    ax, ay = aci[j, 0] - bx, aci[j, 1] - by
+                    lux, luy = lrail_unit[j, 0], lrail_unit[j, 1]
+                    rux, ruy = rrail_unit[j, 0], rrail_unit[j, 1]
+                    if ax * lux + ay * luy < 0:
+                        lux, luy = -lux, -luy
+                    if ax * rux + ay * ruy < 0:
+                        rux, ruy = -rux, -ruy
+
+                    theta_lrail = abs(_angle_2d(ax, ay, lux, luy))
+                    theta_rrail = abs(_angle_2d(ax, ay, rux, ruy))
+                    if theta_lrail < theta_rrail:
+                        theta = 45.0 - theta_lrail
+                        ox, oy = -rux, -ruy
+                    else:
+                        theta = 45.0 - theta_rrail
+                        ox, oy = -lux, -luy
+
+                    offset_mag = math.sin(math.pi / 90 * theta) * R[i]
+                    px, py = aci[j, 0] + ox * offset_mag, aci[j, 1] + oy * offset_mag
+            else:
+                px, py = side_point[j, 0], side_point[j, 1]
+
+            potting_point[i, j, 0] = px
+            potting_point[i, j, 1] = py
+
+            # Shadow ball (see calc_shadow_ball_center)
+            dx, dy = px - bx, py - by
+            norm = math.sqrt(dx * dx + dy * dy)
+            if norm == 0.0:
+                sx, sy = np.nan, np.nan
+            else:
+                sx = bx - dx / norm * 2 * R[i]
+                sy = by - dy / norm * 2 * R[i]
+
+            shadow[i, j, 0] = sx
+            shadow[i, j, 1] = sy
+
+            # Cut angle and precision (see viable_pockets and required_precision)
+            aim_x, aim_y = bx - cx, by - cy
+            cut_angle[i, j] = abs(_angle_2d(aim_x, aim_y, px - bx, py - by))
+            phi_left = abs(_angle_2d(aim_x, aim_y, ltip[j, 0] - bx, ltip[j, 1] - by))
+            phi_right = abs(_angle_2d(aim_x, aim_y, rtip[j, 0] - bx, rtip[j, 1] - by))
+            precision[i, j] = abs(phi_left - phi_right)
+
+            # See is_pocket_occluded and is_object_ball_occluded
+            pocket_occluded[i, j] = _is_path_occluded(xyz, R, pocketed, i, i, px, py)
+            object_occluded[i, j] = _is_path_occluded(xyz, R, pocketed, cue, i, sx, sy)
+
+            # See is_room_for_cue_ball
+            has_room = not (sx < R[i] or sx > w - R[i] or sy < R[i] or sy > l - R[i])
+            if has_room:
+                for k in range(N):
+                    if k == i:
+                        continue
+                    ux, uy = xyz[k, 0] - sx, xyz[k, 1] - sy
+                    if math.sqrt(ux * ux + uy * uy) < 2 * R[k]:
+                        has_room = False
+                        break
+            room[i, j] = has_room
+
+            # See is_jaw_in_way
+            if not corner[j]:
+                dl = (
+                    (ljaw_center[j, 0] - xyz[i, 0]) ** 2
+                    + (ljaw_center[j, 1] - xyz[i, 1]) ** 2
+                    + (ljaw_center[j, 2] - xyz[i, 2]) ** 2
+                )
+                dr = (
+                    (rjaw_center[j, 0] - xyz[i, 0]) ** 2
+                    + (rjaw_center[j, 1] - xyz[i, 1]) ** 2
+                    + (rjaw_center[j, 2] - xyz[i, 2]) ** 2
+                )
+                if dl < dr:
+                    tx, ty, tr = ljaw_center[j, 0], ljaw_center[j, 1], ljaw_radius[j]
+                else:
+                    tx, ty, tr = rjaw_center[j, 0], rjaw_center[j, 1], rjaw_radius[j]
+
+                dd = dx * dx + dy * dy
+                if dd > 0.0:
+                    t = -((bx - tx) * dx + (by - ty) * dy) / dd
+                    qx, qy = bx + dx * t - tx, by + dy * t - ty
+                    jaw_in_way[i, j] = math.sqrt(qx * qx + qy * qy) < tr + R[i]
+
+    return (
+        potting_point,
+        shadow,
+        cut_angle,
+        precision,
+        pocket_occluded,
+        room,
+        jaw_in_way,
+        object_occluded,
+    )
@@ -0,0 +1,98 @@
+import numpy as np
+import pytest
+
+from pooltool.ai.pot.core import (
+    PotMatrix,
+    calc_shadow_ball_center,
+    get_potting_point,
+    is_jaw_in_way,
+    is_object_ball_occluded,
+    is_pocket_occluded,
+    is_room_for_cue_ball,
+    pick_easiest_pot,
+    pot_matrix,
+    required_precision,
+    viable_pockets,
+)
+from pooltool.game.datatypes import GameType
+from pooltool.layouts import get_rack
+from pooltool.objects import Cue, Table
+from pooltool.system.datatypes import System
+
+
+def _system(seed: int) -> System:
+    np.random.seed(seed)
+    table = Table.from_game_type(GameType.NINEBALL)
+    system = System(
+        cue=Cue(cue_ball_id="cue"),
+        table=table,
+        balls=get_rack(GameType.NINEBALL, table=table),
+    )
+    assert system.randomize_positions()
+    return system
+
+
+@pytest.mark.parametrize("seed", range(10))
+def test_pot_matrix(seed: int):
+    system = _system(seed)
+    table = system.table
+    cue = system.balls["cue"]
+    balls = list(system.balls.values())
+
+    matrix = PotMatrix.from_system(system)
+
+    for i, ball_id in enumerate(matrix.ball_ids):
+        ball = system.balls[ball_id]
+        for j, pocket_id in enumerate(matrix.pocket_ids):
+            pocket = table.pockets[pocket_id]
+
+            assert np.allclose(
+                matrix.potting_point[i, j], get_potting_point(ball, table, pocket)
+            )
+            assert np.allclose(
+                matrix.shadow_ball_center[i, j],
+                calc_shadow_ball_center(ball, table, pocket),
+            )
+            assert np.isclose(
+                matrix.precision[i, j],
+                required_precision(cue.state, ball.state, table, pocket),
+            )
+            assert matrix.pocket_occluded[i, j] == is_pocket_occluded(
+                ball, table, pocket, balls
+            )
+            assert matrix.room_for_cue_ball[i, j] == is_room_for_cue_ball(
+                ball, table, pocket, balls
+            )
+            assert matrix.jaw_in_way[i, j] == is_jaw_in_way(ball, table, pocket)
+
+            if ball_id != "cue":
+                assert matrix.object_ball_occluded[i, j] == is_object_ball_occluded(
+                    cue, ball, table, pocket, balls
+                )
+
+        if ball_id != "cue":
+            expected = viable_pockets(cue, ball, table, balls)
+            assert [pocket_id for pocket_id, _ in matrix.viable_pockets(ball_id)] == [
+                pocket_id for pocket_id, _ in expected
+            ]
+
+
+def test_pot_matrix_reuse():
+    system = _system(0)
+
+    matrix = pot_matrix(system)
+    assert pot_matrix(system) is matrix
+
+    # Pots are picked from the cached matrix
+    for ball_id in matrix.ball_ids:
+        if ball_id == "cue":
+            continue
+        pocket = pick_easiest_pot(system, system.balls[ball_id])
+        options = matrix.viable_pockets(ball_id)
+        assert (pocket is None) == (not len(options))
+        if pocket is not None:
+            assert pocket.id == options[0][0]
+
+    # Moving a ball invalidates it
+    system.balls["1"].state.rvw[0, 0] += 0.1
+    assert pot_matrix(system) is not matrix
@@ -0,0 +1,62 @@
+import numpy as np
+
+from pooltool.ai.action import Action
+from pooltool.ai.evaluate import NoiseModel, evaluate_actions
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.system import System
+
+
+def test_evaluate_without_noise():
+    system = System.example()
+    make = Action.from_cue(system.cue)
+    miss = Action(make.V0, make.phi + 20, make.theta, make.a, make.b)
+
+    evaluations = evaluate_actions(
+        system,
+        [make, miss],
+        "1",
+        noise=NoiseModel(0, 0, 0, 0, 0),
+        round_size=8,
+        tolerance=0.2,
+    )
+
+    # Without noise, every sample has the same outcome, so one round is enough (the
+    # interval's half-width is about 0.16 after 8 samples)
+    for evaluation in evaluations:
+        assert evaluation.converged
+        assert evaluation.samples == 8
+
+    assert evaluations[0].pot_probability == 1
+    assert evaluations[1].pot_probability == 0
+
+    # The leave matches the unperturbed simulation
+    simulated = simulate(system)
+    assert np.allclose(
+        evaluations[0].leave_mean, simulated.balls["cue"].state.rvw[0, :2]
+    )
+    assert np.allclose(evaluations[0].leave_std, 0)
+
+    # The passed system is untouched
+    assert not system.simulated
+
+
+def test_evaluate_with_noise():
+    system = System.example()
+    action = Action.from_cue(system.cue)
+
+    evaluation = evaluate_actions(
+        system,
+        [action],
+        "1",
+        noise=NoiseModel(phi=2.0),
+        max_samples=32,
+        round_size=8,
+        tolerance=0.0,
+        seed=42,
+    )[0]
+
+    # A tolerance of 0 is never reached, so the whole budget is spent
+    assert not evaluation.converged
+    assert evaluation.samples == 32
+    assert 0 <= evaluation.pot_probability <= 1
+    assert len(evaluation.leaves) == evaluation.samples - evaluation.scratches
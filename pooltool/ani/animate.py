@@ -3,11 +3,13 @@
 import gc
 import sys
 from functools import partial
-from typing import Generator, Optional, Tuple, Union
+from typing import Dict, Generator, Optional, Tuple, Union
 
+import numpy as np
 import simplepbr
 from attrs import define
 from direct.showbase.ShowBase import ShowBase
+from numpy.typing import NDArray
 from panda3d.core import (
     ClockObject,
     FrameBufferProperties,
@@ -244,12 +246,37 @@ class FrameStepper(Interface):
         Global.clock.setMode(ClockObject.MLimited)
         Global.clock.setFrameRate(10000)
 
-    def _iterator(
+        # The positions of each ball at each frame of the loaded system
+        self._trajectories: Dict[str, NDArray[np.float64]] = {}
+
+    def load_system(
         self,
         system: System,
         size: Tuple[int, int] = (int(1.6 * 720), 720),
         fps: float = 30.0,
-    ) -> Generator:
+        reuse: bool = True,
+    ) -> int:
+        """Load a system into the scene, ready to be stepped through frame-by-frame
+
+        Args:
+            system:
+                The system to load. It should already be simulated. It is continuized
+                to match `fps`.
+            size:
+                The number of pixels in x and y.
+            fps:
+                The rate (in frames per second) that the system is stepped through.
+            reuse:
+                If True, and the system is compatible with the scene's current system
+                (see :meth:`pooltool.system.render.SystemController.can_rebind`), the
+                already rendered table and ball nodes are reused instead of rebuilt.
+                This is much faster when loading many systems that share a table and
+                ballset.
+
+        Returns:
+            frames:
+                The number of frames. Step through them with :meth:`render_frame`.
+        """
         continuize(system, dt=1 / fps, inplace=True)
 
         multisystem.reset()
@@ -257,30 +284,51 @@ class FrameStepper(Interface):
 
         _resize_offscreen_window(size)
 
-        self.create_scene()
+        if reuse and visual.can_rebind(system):
+            visual.rebind(system)
+        else:
+            self.create_scene()
 
-        # We don't want the cue in this
-        visual.cue.hide_nodes()
+            # We don't want the cue in this
+            visual.cue.hide_nodes()
 
-        # Or the camera fixation point object
-        if cam.fixation_object is not None:
-            cam.fixation_object.removeNode()
+            # Or the camera fixation point object
+            if cam.fixation_object is not None:
+                cam.fixation_object.removeNode()
 
-        # Set quaternions for each ball
-        for ball in visual.balls.values():
-            ball.set_quats(ball._ball.history_cts)
+        # Cache each ball's positions and quaternions, so frames can be set by index
+        self._trajectories = {}
+        for ball_id, ball in visual.balls.items():
+            rvws, _, ts = ball._ball.history_cts.vectorize()
+            ball.quats = autils.as_quaternion(rvws[:, 2, :], ts)
+            self._trajectories[ball_id] = rvws[:, 0, :]
 
-        frames = int(system.events[-1].time * fps) + 1
+        return int(system.events[-1].time * fps) + 1
 
-        yield frames
+    def render_frame(self, frame: int) -> None:
+        """Set each ball to its state at a frame, then render the frame
 
-        for frame in range(frames):
-            for ball in visual.balls.values():
-                ball.set_render_state_from_history(ball._ball.history_cts, frame)
-                ball._ball.state = ball._ball.history_cts[frame]
+        The system must first be loaded with :meth:`load_system`.
+        """
+        for ball_id, ball in visual.balls.items():
+            ball.set_render_state(self._trajectories[ball_id][frame], ball.quats[frame])
+            ball._ball.state = ball._ball.history_cts[frame]
 
-            Global.task_mgr.step()
+        Global.task_mgr.step()
 
+    def _iterator(
+        self,
+        system: System,
+        size: Tuple[int, int] = (int(1.6 * 720), 720),
+        fps: float = 30.0,
+        reuse: bool = False,
+    ) -> Generator:
+        frames = self.load_system(system, size, fps, reuse=reuse)
+
+        yield frames
+
+        for frame in range(frames):
+            self.render_frame(frame)
             yield frame
 
     def iterator(self, *args, **kwargs) -> Tuple[Generator, int]:
@@ -298,6 +346,9 @@ class FrameStepper(Interface):
             fps:
                 This is the rate (in frames per second) that the shot is iterated
                 through.
+            reuse:
+                If True, rendered nodes are reused from the previous shot when possible
+                (see :meth:`load_system`). False by default.
 
         Returns:
             iterator:
@@ -3,6 +3,8 @@ from pooltool.ani.image.interface import (
     image_array_from_texture,
     image_stack,
     save_images,
+    stream_batch,
+    stream_images,
 )
 from pooltool.ani.image.io import (
     GzipArrayImages,
@@ -15,6 +17,8 @@ from pooltool.ani.image.utils import ImageExt, gif, rgb2gray
 
 __all__ = [
     "save_images",
+    "stream_images",
+    "stream_batch",
     "image_stack",
     "ImageExt",
     "ImageZip",
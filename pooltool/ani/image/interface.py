@@ -1,4 +1,5 @@
-from typing import Any, List, Protocol, Tuple
+import time
+from typing import Any, Callable, Generator, Iterable, List, Protocol, Tuple
 
 import numpy as np
 from numpy.typing import NDArray
@@ -8,6 +9,7 @@ from pooltool.ani.animate import FrameStepper
 from pooltool.ani.camera import CameraState, cam, camera_states
 from pooltool.ani.globals import Global
 from pooltool.ani.hud import HUDElement, hud
+from pooltool.ani.image.io import ImageStorageMethod
 from pooltool.ani.image.utils import rgb2gray
 from pooltool.system.datatypes import System
 
@@ -28,6 +30,37 @@ def get_graphics_texture() -> Texture:
     return tex
 
 
+def _render_frames(
+    system: System,
+    interface: FrameStepper,
+    size: Tuple[int, int],
+    fps: float,
+    camera_state: CameraState,
+    gray: bool,
+    show_hud: bool,
+) -> Tuple[Generator[NDArray[np.uint8], None, None], int]:
+    """Return a generator of the shot's rendered frames, and the number of frames"""
+    iterator, frames = interface.iterator(system, size, fps)
+
+    tex = get_graphics_texture()
+
+    if show_hud:
+        hud.init()
+        hud.elements[HUDElement.help_text].help_hint.hide()
+        hud.update_cue(system.cue)
+    else:
+        hud.destroy()
+
+    cam.load_state(camera_state)
+
+    def generator() -> Generator[NDArray[np.uint8], None, None]:
+        for _ in range(frames):
+            next(iterator)
+            yield image_array_from_texture(tex, gray=gray)
+
+    return generator(), frames
+
+
 def image_stack(
     system: System,
     interface: FrameStepper,
@@ -50,28 +83,116 @@ def image_stack(
     Returns:
         A numpy array of size (N, x, y), where N is the number of frames, and x & y are
         the frame dimensions (in pixels).
+
+    See Also:
+        - :func:`stream_images`, which exports frames as they're rendered, rather than
+          holding every frame in memory.
     """
-    iterator, frames = interface.iterator(system, size, fps)
+    frames, _ = _render_frames(
+        system, interface, size, fps, camera_state, gray, show_hud
+    )
+    imgs: List[NDArray[np.uint8]] = list(frames)
 
-    tex = get_graphics_texture()
+    return np.array(imgs, dtype=np.uint8)
 
-    if show_hud:
-        hud.init()
-        hud.elements[HUDElement.help_text].help_hint.hide()
-        hud.update_cue(system.cue)
-    else:
-        hud.destroy()
 
-    cam.load_state(camera_state)
+def stream_images(
+    exporter: ImageStorageMethod,
+    system: System,
+    interface: FrameStepper,
+    size: Tuple[int, int] = (230, 144),
+    fps: float = 30.0,
+    camera_state: CameraState = DEFAULT_CAMERA,
+    gray: bool = False,
+    show_hud: bool = False,
+) -> None:
+    """Export the shot's rendered frames as they're rendered
 
-    # Initialize a numpy array image stack
-    imgs: List[NDArray[np.uint8]] = []
+    Each frame is handed to the exporter (see :meth:`ImageStorageMethod.write_frame`),
+    which encodes and writes it on a background thread while the next frame renders.
+    Since only a few frames are held in memory at once, peak memory doesn't grow with
+    the length of the shot.
 
-    for frame in range(frames):
-        next(iterator)
-        imgs.append(image_array_from_texture(tex, gray=gray))
+    Args:
+        See :func:`image_stack`.
+    """
+    frames, num_frames = _render_frames(
+        system, interface, size, fps, camera_state, gray, show_hud
+    )
 
-    return np.array(imgs, dtype=np.uint8)
+    exporter.open(frames=num_frames)
+    try:
+        for img in frames:
+            exporter.write_frame(img)
+    finally:
+        exporter.close()
+
+
+def stream_batch(
+    exporters: Callable[[int, System], ImageStorageMethod],
+    systems: Iterable[System],
+    interface: FrameStepper,
+    size: Tuple[int, int] = (230, 144),
+    fps: float = 30.0,
+    camera_state: CameraState = DEFAULT_CAMERA,
+    gray: bool = False,
+) -> float:
+    """Export the rendered frames of many systems in one session
+
+    This is :func:`stream_images` for datasets. Table and ball nodes are rendered once
+    and reused for each subsequent system that shares the table and ballset (see
+    :meth:`pooltool.ani.animate.FrameStepper.load_system`), and ball nodes are placed
+    directly from each system's continuized history.
+
+    Args:
+        exporters:
+            A function that accepts the index of a system and the system, and returns
+            the exporter its frames are streamed to, *e.g.* ``lambda i, system:
+            NpyImages(f"shot_{i}.npy")``.
+        systems:
+            The systems. They should already be simulated.
+
+    For the remaining arguments, see :func:`image_stack`. The HUD is never shown.
+
+    Returns:
+        frames_per_second:
+            The rendering throughput, measured over all systems.
+
+    Example:
+
+        >>> import pooltool as pt
+        >>> from pooltool.ani.animate import FrameStepper
+        >>> from pooltool.ani.image import NpyImages, stream_batch
+        >>> stepper = FrameStepper()
+        >>> systems = [pt.simulate(pt.System.example()) for _ in range(10)]
+        >>> stream_batch(lambda i, _: NpyImages(f"{i}.npy"), systems, stepper)
+    """
+    hud.destroy()
+
+    tex = None
+    total_frames = 0
+    start = time.perf_counter()
+
+    for index, system in enumerate(systems):
+        frames = interface.load_system(system, size, fps)
+        cam.load_state(camera_state)
+
+        if tex is None:
+            tex = get_graphics_texture()
+
+        exporter = exporters(index, system)
+        exporter.open(frames=frames)
+        try:
+            for frame in range(frames):
+                interface.render_frame(frame)
+                exporter.write_frame(image_array_from_texture(tex, gray=gray))
+        finally:
+            exporter.close()
+
+        total_frames += frames
+
+    elapsed = time.perf_counter() - start
+    return total_frames / elapsed if elapsed > 0 else 0.0
 
 
 def save_images(
@@ -84,18 +205,27 @@ def save_images(
     gray: bool = False,
     show_hud: bool = False,
 ) -> None:
-    exporter.save(
-        image_stack(
-            system=system,
-            interface=interface,
-            size=size,
-            fps=fps,
-            camera_state=camera_state,
-            gray=gray,
-            show_hud=show_hud,
-        )
+    """Render the shot's frames and save them with an exporter
+
+    Exporters that support streaming (subclasses of :class:`ImageStorageMethod`) are
+    streamed to with :func:`stream_images`. Otherwise, the frames are collected with
+    :func:`image_stack` and saved all at once.
+    """
+    kwargs = dict(
+        system=system,
+        interface=interface,
+        size=size,
+        fps=fps,
+        camera_state=camera_state,
+        gray=gray,
+        show_hud=show_hud,
     )
 
+    if isinstance(exporter, ImageStorageMethod):
+        stream_images(exporter, **kwargs)  # type: ignore
+    else:
+        exporter.save(image_stack(**kwargs))  # type: ignore
+
 
 def image_array_from_texture(tex: Texture, gray: bool = False) -> NDArray[np.uint8]:
     assert tex.hasRamImage()
@@ -1,10 +1,13 @@
+import contextlib
 import gzip
+import io
+import queue
 import re
-import shutil
+import threading
 import zipfile
 from abc import ABC, abstractmethod
 from pathlib import Path
-from typing import Any, List, Union
+from typing import IO, Any, List, Optional, Union
 
 import attrs
 import h5py
@@ -16,10 +19,84 @@ from pooltool.ani.image.utils import ImageExt, img2array, path2imgarray
 
 
 class ImageStorageMethod(ABC):
+    """Base class for image exporters
+
+    Images can be saved all at once with :meth:`save`, or streamed frame by frame with
+    :meth:`open`, :meth:`write_frame`, and :meth:`close`. When streaming, frames are
+    encoded and written on a background thread, and at most :attr:`max_pending` frames
+    are held in memory at once, regardless of how many frames are written.
+
+    Subclasses implement the streaming hooks :meth:`_open`, :meth:`_write_frame`, and
+    :meth:`_close`, which are always called from the same (background) thread. If
+    opening or writing fails, :meth:`_close` is still called to release any open
+    handles, and should release them before raising any errors of its own.
+    """
+
     path: Path
 
+    # The number of frames that can be queued for writing before write_frame blocks
+    max_pending: int = 4
+
+    def save(self, imgs: NDArray[np.uint8]) -> None:
+        """Save an image stack
+
+        Args:
+            imgs:
+                An image stack of shape (N, y, x) or (N, y, x, 3), where N is the number
+                of frames.
+        """
+        self.open(frames=len(imgs))
+        try:
+            for img in imgs:
+                self.write_frame(img)
+        finally:
+            self.close()
+
+    def open(self, frames: Optional[int] = None) -> None:
+        """Start streaming frames
+
+        Args:
+            frames:
+                The number of frames that will be written, if known. Some methods
+                (:class:`NpyImages`) require it.
+        """
+        assert not hasattr(self, "_writer"), "Exporter is already open"
+        self._writer = _FrameWriter(self, frames)
+
+    def write_frame(self, img: NDArray[np.uint8]) -> None:
+        """Queue a frame for writing
+
+        This blocks if :attr:`max_pending` frames are already waiting to be written.
+
+        Raises:
+            Exception:
+                Any exception raised while writing a previous frame.
+        """
+        assert hasattr(self, "_writer"), "Exporter must be opened first"
+        self._writer.put(img)
+
+    def close(self) -> None:
+        """Wait for all queued frames to be written, then finalize the output
+
+        Raises:
+            Exception:
+                Any exception raised while writing frames.
+        """
+        assert hasattr(self, "_writer"), "Exporter must be opened first"
+        writer = self._writer
+        del self._writer
+        writer.join()
+
+    @abstractmethod
+    def _open(self, frames: Optional[int]) -> None:
+        pass
+
+    @abstractmethod
+    def _write_frame(self, img: NDArray[np.uint8]) -> None:
+        pass
+
     @abstractmethod
-    def save(self, imgs: NDArray[np.uint8]) -> Any:
+    def _close(self) -> None:
         pass
 
     @staticmethod
@@ -28,6 +105,50 @@ class ImageStorageMethod(ABC):
         pass
 
 
+class _FrameWriter:
+    """Writes the frames of an exporter from a background thread"""
+
+    def __init__(self, exporter: ImageStorageMethod, frames: Optional[int]):
+        self.exporter = exporter
+        self.frames = frames
+        self.error: Optional[BaseException] = None
+        self.queue: queue.Queue = queue.Queue(maxsize=exporter.max_pending)
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+
+    def put(self, img: NDArray[np.uint8]) -> None:
+        self._raise()
+        self.queue.put(img)
+
+    def join(self) -> None:
+        self.queue.put(None)
+        self.thread.join()
+        self._raise()
+
+    def _raise(self) -> None:
+        if self.error is not None:
+            raise self.error
+
+    def _run(self) -> None:
+        try:
+            self.exporter._open(self.frames)
+            while (img := self.queue.get()) is not None:
+                self.exporter._write_frame(img)
+            self.exporter._close()
+        except BaseException as error:
+            self.error = error
+            with contextlib.suppress(Exception):
+                self.exporter._close()
+
+            # Drain the queue so that the producer never blocks
+            while self.queue.get() is not None:
+                pass
+
+
+def _pil_format(ext: ImageExt) -> str:
+    return Image.registered_extensions()[f".{ext}"]
+
+
 def _img_regex_pattern():
     return re.compile(r".*_[0-9]{6,6}\." + ImageExt.regex())
 
@@ -49,37 +170,37 @@ class ImageZip(ImageStorageMethod):
                 self.path.suffix == ".zip"
             ), f"{self.path} must end with .zip if compress is True"
 
-    def save(self, imgs: NDArray[np.uint8]) -> None:
+    _archive: Optional[zipfile.ZipFile] = attrs.field(init=False, default=None)
+
+    def _open(self, frames: Optional[int]) -> None:
         self.image_count = 0
+        self.paths = []
 
         if self.compress:
-            # Write contents to a temp directory that will be deleted after the contents
-            # have been zipped
-            save_dir = self.path.parent / "tmp"
+            # Images are encoded in memory and written straight to the archive
+            self._archive = zipfile.ZipFile(self.path, mode="w")
         else:
-            save_dir = self.path
+            self.path.mkdir(parents=True, exist_ok=True)
 
-        save_dir.mkdir(parents=True, exist_ok=True)
+    def _write_frame(self, img: NDArray[np.uint8]) -> None:
+        path = self._get_filepath(root=self.path if not self.compress else Path())
 
-        frames = np.shape(imgs)[0]
-        for frame in range(frames):
-            path = self._get_filepath(root=save_dir)
+        if self._archive is not None:
+            buffer = io.BytesIO()
+            Image.fromarray(img).save(buffer, format=_pil_format(self.ext))
+            self._archive.writestr(path.name, buffer.getvalue())
+        else:
             assert not path.exists(), f"{path} already exists!"
+            Image.fromarray(img).save(path)
 
-            Image.fromarray(imgs[frame, ...]).save(path)
+        # Increment
+        self.image_count += 1
+        self.paths.append(path)
 
-            # Increment
-            self.image_count += 1
-            self.paths.append(path)
-
-        if not self.compress:
-            return
-
-        # Compress the directory as a zip file and delete tmp dir
-        with zipfile.ZipFile(self.path, mode="w") as archive:
-            for path in save_dir.iterdir():
-                archive.write(path, arcname=path.name)
-        shutil.rmtree(save_dir)
+    def _close(self) -> None:
+        if self._archive is not None:
+            self._archive.close()
+            self._archive = None
 
     def _get_filepath(self, root: Path) -> Path:
         stem = f"{self.prefix}_{self.image_count:06d}"
@@ -130,9 +251,32 @@ class ImageZip(ImageStorageMethod):
 class HDF5Images(ImageStorageMethod):
     path: Path = attrs.field(converter=Path)
 
-    def save(self, imgs: NDArray[np.uint8]) -> None:
-        with h5py.File(self.path, "w") as fp:
-            fp.create_dataset("images", np.shape(imgs), h5py.h5t.STD_U8BE, data=imgs)
+    _file: Optional[h5py.File] = attrs.field(init=False, default=None)
+
+    def _open(self, frames: Optional[int]) -> None:
+        self._file = h5py.File(self.path, "w")
+
+    def _write_frame(self, img: NDArray[np.uint8]) -> None:
+        assert self._file is not None
+
+        if "images" not in self._file:
+            # Chunked by frame, so the dataset can grow as frames arrive
+            self._file.create_dataset(
+                "images",
+                (0, *img.shape),
+                h5py.h5t.STD_U8BE,
+                maxshape=(None, *img.shape),
+                chunks=(1, *img.shape),
+            )
+
+        images = self._file["images"]
+        images.resize(images.shape[0] + 1, axis=0)
+        images[-1] = img
+
+    def _close(self) -> None:
+        assert self._file is not None
+        self._file.close()
+        self._file = None
 
     @staticmethod
     def read(path: Union[str, Path]) -> NDArray[np.uint8]:
@@ -144,8 +288,38 @@ class HDF5Images(ImageStorageMethod):
 class NpyImages(ImageStorageMethod):
     path: Path = attrs.field(converter=Path)
 
-    def save(self, imgs: NDArray[np.uint8]) -> None:
-        np.save(self.path, imgs)
+    _frames: Optional[int] = attrs.field(init=False, default=None)
+    _array: Optional[np.memmap] = attrs.field(init=False, default=None)
+    _count: int = attrs.field(init=False, default=0)
+
+    def _open(self, frames: Optional[int]) -> None:
+        assert frames is not None, "NpyImages requires the number of frames"
+        self._frames = frames
+        self._array = None
+        self._count = 0
+
+    def _write_frame(self, img: NDArray[np.uint8]) -> None:
+        assert self._frames is not None
+
+        if self._array is None:
+            # The file is memory-mapped, so frames are paged out as they're written
+            self._array = np.lib.format.open_memmap(
+                self.path, mode="w+", dtype=np.uint8, shape=(self._frames, *img.shape)
+            )
+
+        assert self._count < self._frames, f"More than {self._frames} frames written"
+        self._array[self._count] = img
+        self._count += 1
+
+    def _close(self) -> None:
+        if self._array is not None:
+            self._array.flush()
+            self._array = None
+        elif not self._count:
+            # No frames were written
+            np.save(self.path, np.empty((0,), dtype=np.uint8))
+
+        assert self._count == self._frames, f"Expected {self._frames} frames"
 
     @staticmethod
     def read(path: Union[str, Path]) -> NDArray[np.uint8]:
@@ -156,9 +330,19 @@ class NpyImages(ImageStorageMethod):
 class GzipArrayImages(ImageStorageMethod):
     path: Path = attrs.field(converter=Path)
 
-    def save(self, imgs: NDArray[np.uint8]) -> None:
-        with open(self.path, "wb") as fp:
-            fp.write(gzip.compress(memoryview(imgs), compresslevel=1))  # type: ignore
+    _file: Optional[IO[bytes]] = attrs.field(init=False, default=None)
+
+    def _open(self, frames: Optional[int]) -> None:
+        self._file = gzip.open(self.path, "wb", compresslevel=1)
+
+    def _write_frame(self, img: NDArray[np.uint8]) -> None:
+        assert self._file is not None
+        self._file.write(np.ascontiguousarray(img, dtype=np.uint8).tobytes())
+
+    def _close(self) -> None:
+        assert self._file is not None
+        self._file.close()
+        self._file = None
 
     @staticmethod
     def read(path: Union[str, Path]) -> NDArray[np.uint8]:
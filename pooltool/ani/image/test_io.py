@@ -0,0 +1,73 @@
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+from pooltool.ani.image.io import (
+    GzipArrayImages,
+    HDF5Images,
+    ImageStorageMethod,
+    ImageZip,
+    NpyImages,
+)
+
+
+def _exporters(path: Path):
+    return [
+        ImageZip(path / "images.zip", ext="png"),
+        ImageZip(path / "images", ext="png", compress=False),
+        HDF5Images(path / "images.hdf5"),
+        NpyImages(path / "images.npy"),
+        GzipArrayImages(path / "images.array.gz"),
+    ]
+
+
+@pytest.mark.parametrize("index", range(5))
+def test_stream_round_trip(tmp_path: Path, index: int):
+    rng = np.random.default_rng(42)
+    imgs = rng.integers(0, 256, size=(10, 12, 16, 3), dtype=np.uint8)
+
+    (tmp_path / "streamed").mkdir()
+    streamed: ImageStorageMethod = _exporters(tmp_path / "streamed")[index]
+
+    streamed.open(frames=len(imgs))
+    for img in imgs:
+        # Frames rendered from textures are flipped views, so aren't contiguous
+        streamed.write_frame(img[::-1, :, ::-1])
+    streamed.close()
+
+    expected = imgs[:, ::-1, :, ::-1]
+    assert np.array_equal(streamed.read(streamed.path).reshape(imgs.shape), expected)
+
+    # Saving the stack all at once is equivalent
+    (tmp_path / "saved").mkdir()
+    saved: ImageStorageMethod = _exporters(tmp_path / "saved")[index]
+    saved.save(expected)
+    assert np.array_equal(saved.read(saved.path).reshape(imgs.shape), expected)
+
+
+def test_stream_error(tmp_path: Path):
+    exporter = NpyImages(tmp_path / "images.npy")
+
+    # Writing more frames than declared fails on the writer thread. The error is
+    # raised by a later write, or when the exporter is closed
+    exporter.open(frames=2)
+    with pytest.raises(AssertionError):
+        try:
+            for img in np.zeros((3, 4, 4), dtype=np.uint8):
+                exporter.write_frame(img)
+        finally:
+            exporter.close()
+
+
+def test_save_error(tmp_path: Path):
+    exporter = ImageZip(tmp_path / "images.zip", ext="png")
+
+    # PIL can't encode images with 5 channels
+    with pytest.raises(TypeError):
+        exporter.save(np.zeros((3, 4, 4, 5), dtype=np.uint8))
+
+    # The archive was closed, and the exporter can be used again
+    assert exporter._archive is None
+    exporter.save(np.zeros((3, 4, 4, 3), dtype=np.uint8))
+    assert exporter.read(exporter.path).shape[0] == 3
@@ -0,0 +1,39 @@
+"""Benchmarks of the simulation pipeline
+
+Run the suite, and compare the results of two commits, from the command line:
+
+.. code-block:: bash
+
+    git checkout main && python -m pooltool bench run -o base.json
+    git checkout my-branch && python -m pooltool bench run -o head.json
+    python -m pooltool bench compare base.json head.json
+
+``compare`` exits with a nonzero status if any benchmark got slower than the threshold.
+Select benchmarks by name with ``-k`` and ``--exclude`` (*e.g.* ``--exclude render``,
+where there's no GPU).
+"""
+
+from pooltool.benchmark.runner import (
+    Benchmark,
+    BenchmarkReport,
+    BenchmarkResult,
+    Change,
+    Comparison,
+    compare,
+    run,
+    select,
+)
+from pooltool.benchmark.suite import default_suite, detect_crossover
+
+__all__ = [
+    "Benchmark",
+    "BenchmarkReport",
+    "BenchmarkResult",
+    "Change",
+    "Comparison",
+    "compare",
+    "default_suite",
+    "detect_crossover",
+    "run",
+    "select",
+]
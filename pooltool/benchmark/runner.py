@@ -0,0 +1,414 @@
+"""Timing benchmarks, and recording and comparing their results
+
+A :class:`Benchmark` has a setup function that prepares its inputs (outside of the
+timing) and returns the function to time. :func:`run` times each benchmark like
+:mod:`timeit` does: the function is called once to compile its kernels, then it's called
+in rounds of as many calls as fit in ``min_time``, and the per-call time of each round
+is recorded. Reports record the environment they were run in, and are saved as JSON so
+that the results of two commits can be compared with :func:`compare`.
+"""
+
+from __future__ import annotations
+
+import gc
+import math
+import os
+import platform
+import re
+import statistics
+import subprocess
+import time
+from datetime import datetime, timezone
+from pathlib import Path
+from typing import Any, Callable, Dict, Iterable, List, Optional, Tuple
+
+import attrs
+import numba
+import numpy as np
+from cattrs.converters import Converter
+
+from pooltool.serialize.serializers import Pathish, from_json, to_json
+from pooltool.utils.strenum import StrEnum, auto
+
+
+@attrs.define(frozen=True)
+class Benchmark:
+    """A timed function
+
+    Attributes:
+        name:
+            A unique name, by convention ``<group>/<case>``.
+        setup:
+            Prepares the inputs, and returns the function to time. It's called once,
+            and isn't timed.
+        params:
+            The parameters the benchmark was set up with, recorded in its result.
+    """
+
+    name: str
+    setup: Callable[[], Callable[[], Any]]
+    params: Dict[str, Any] = attrs.field(factory=dict)
+
+    @property
+    def group(self) -> str:
+        return self.name.split("/")[0]
+
+
+@attrs.define(frozen=True)
+class BenchmarkResult:
+    """The timings of a benchmark
+
+    Attributes:
+        name:
+            The benchmark's name.
+        params:
+            The benchmark's parameters.
+        number:
+            The number of calls in each round.
+        times:
+            The mean time per call of each round, in seconds.
+    """
+
+    name: str
+    params: Dict[str, Any]
+    number: int
+    times: List[float]
+
+    @property
+    def min(self) -> float:
+        """The fastest round, which is the least affected by noise"""
+        return min(self.times)
+
+    @property
+    def median(self) -> float:
+        return statistics.median(self.times)
+
+    @property
+    def stdev(self) -> float:
+        return statistics.stdev(self.times) if len(self.times) > 1 else 0.0
+
+
+@attrs.define(frozen=True)
+class Environment:
+    """Where benchmarks were run
+
+    Attributes:
+        commit:
+            The git commit of the working tree, if it's a git repository.
+        dirty:
+            Whether the working tree had uncommitted changes.
+        timestamp:
+            When the benchmarks were run (ISO 8601, UTC).
+        python:
+            The Python version.
+        numpy:
+            The numpy version.
+        numba:
+            The numba version.
+        machine:
+            The platform and processor.
+        cpus:
+            The number of CPUs.
+    """
+
+    commit: Optional[str]
+    dirty: bool
+    timestamp: str
+    python: str
+    numpy: str
+    numba: str
+    machine: str
+    cpus: int
+
+    @classmethod
+    def current(cls) -> Environment:
+        commit, dirty = _git_state()
+        return cls(
+            commit=commit,
+            dirty=dirty,
+            timestamp=datetime.now(timezone.utc).isoformat(timespec="seconds"),
+            python=platform.python_version(),
+            numpy=np.__version__,
+            numba=numba.__version__,
+            machine=f"{platform.platform()} {platform.processor()}".strip(),
+            cpus=os.cpu_count() or 1,
+        )
+
+
+@attrs.define(frozen=True)
+class BenchmarkReport:
+    """The results of a benchmark run, and the environment they were produced in"""
+
+    environment: Environment
+    results: List[BenchmarkResult]
+
+    def save(self, path: Pathish) -> None:
+        """Save the report as JSON"""
+        to_json(_converter.unstructure(self), path)
+
+    @classmethod
+    def load(cls, path: Pathish) -> BenchmarkReport:
+        return _converter.structure(from_json(path), cls)
+
+
+_converter = Converter()
+
+
+def _git_state() -> Tuple[Optional[str], bool]:
+    """The commit of the repository pooltool lives in, and whether it's dirty"""
+    cwd = Path(__file__).parent
+    try:
+        commit = subprocess.run(
+            ["git", "rev-parse", "HEAD"],
+            cwd=cwd,
+            check=True,
+            capture_output=True,
+            text=True,
+        ).stdout.strip()
+        status = subprocess.run(
+            ["git", "status", "--porcelain", "--untracked-files=no"],
+            cwd=cwd,
+            check=True,
+            capture_output=True,
+            text=True,
+        ).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None, False
+
+    return commit, bool(status)
+
+
+def time_benchmark(
+    benchmark: Benchmark, repeat: int = 5, min_time: float = 0.2
+) -> BenchmarkResult:
+    """Time a benchmark
+
+    Args:
+        benchmark:
+            The benchmark.
+        repeat:
+            The number of rounds.
+        min_time:
+            The minimum duration of each round, in seconds. Fast functions are called
+            several times per round, so that the timer's resolution doesn't matter.
+
+    Returns:
+        BenchmarkResult: The timings.
+    """
+    func = benchmark.setup()
+
+    # The first call compiles (or loads from cache) any kernels the function calls
+    start = time.perf_counter()
+    func()
+    elapsed = time.perf_counter() - start
+
+    # The first call is an overestimate, so this is conservative
+    number = max(1, math.ceil(min_time / max(elapsed, 1e-9)))
+
+    times = []
+    gc_was_enabled = gc.isenabled()
+    gc.disable()
+    try:
+        for _ in range(repeat):
+            start = time.perf_counter()
+            for _ in range(number):
+                func()
+            times.append((time.perf_counter() - start) / number)
+    finally:
+        if gc_was_enabled:
+            gc.enable()
+
+    return BenchmarkResult(
+        name=benchmark.name,
+        params=dict(benchmark.params),
+        number=number,
+        times=times,
+    )
+
+
+def select(
+    benchmarks: Iterable[Benchmark],
+    pattern: Optional[str] = None,
+    exclude: Optional[str] = None,
+) -> List[Benchmark]:
+    """Filter benchmarks by name
+
+    Args:
+        pattern:
+            If passed, only benchmarks whose names match this regular expression are
+            kept.
+        exclude:
+            If passed, benchmarks whose names match this regular expression are dropped.
+    """
+    return [
+        benchmark
+        for benchmark in benchmarks
+        if (pattern is None or re.search(pattern, benchmark.name))
+        and (exclude is None or not re.search(exclude, benchmark.name))
+    ]
+
+
+def run(
+    benchmarks: Iterable[Benchmark],
+    repeat: int = 5,
+    min_time: float = 0.2,
+    progress: Optional[Callable[[BenchmarkResult], None]] = None,
+) -> BenchmarkReport:
+    """Time benchmarks
+
+    Args:
+        benchmarks:
+            The benchmarks (see :func:`pooltool.benchmark.suite.default_suite`).
+        repeat:
+            See :func:`time_benchmark`.
+        min_time:
+            See :func:`time_benchmark`.
+        progress:
+            If passed, this is called with each result as it's produced.
+
+    Returns:
+        BenchmarkReport: The results, and the environment they were produced in.
+    """
+    names = set()
+    results = []
+    for benchmark in benchmarks:
+        if benchmark.name in names:
+            raise ValueError(f"Duplicate benchmark name '{benchmark.name}'")
+        names.add(benchmark.name)
+
+        result = time_benchmark(benchmark, repeat=repeat, min_time=min_time)
+        if progress is not None:
+            progress(result)
+        results.append(result)
+
+    return BenchmarkReport(environment=Environment.current(), results=results)
+
+
+class Change(StrEnum):
+    """How a benchmark's timing changed between two reports
+
+    Attributes:
+        FASTER:
+            Faster by more than the threshold.
+        SLOWER:
+            Slower by more than the threshold.
+        UNCHANGED:
+            Within the threshold.
+        ADDED:
+            Only in the newer report.
+        REMOVED:
+            Only in the older report.
+    """
+
+    FASTER = auto()
+    SLOWER = auto()
+    UNCHANGED = auto()
+    ADDED = auto()
+    REMOVED = auto()
+
+
+@attrs.define(frozen=True)
+class Comparison:
+    """A benchmark's timing in two reports
+
+    Attributes:
+        name:
+            The benchmark's name.
+        base:
+            The fastest round in the older report, if it has the benchmark.
+        head:
+            The fastest round in the newer report, if it has the benchmark.
+        change:
+            How the timing changed.
+    """
+
+    name: str
+    base: Optional[float]
+    head: Optional[float]
+    change: Change
+
+    @property
+    def speedup(self) -> Optional[float]:
+        """How many times faster the newer report is"""
+        if self.base is None or self.head is None:
+            return None
+        return self.base / self.head
+
+
+def compare(
+    base: BenchmarkReport, head: BenchmarkReport, threshold: float = 0.1
+) -> List[Comparison]:
+    """Compare the results of two reports
+
+    Args:
+        base:
+            The older report.
+        head:
+            The newer report.
+        threshold:
+            Fractional changes in time smaller than this are considered noise.
+
+    Returns:
+        List[Comparison]: A comparison of each benchmark, in the newer report's order,
+        followed by those only in the older report.
+    """
+    base_times = {result.name: result.min for result in base.results}
+    head_times = {result.name: result.min for result in head.results}
+
+    comparisons = []
+    for name, head_time in head_times.items():
+        base_time = base_times.get(name)
+        if base_time is None:
+            change = Change.ADDED
+        elif head_time > base_time * (1 + threshold):
+            change = Change.SLOWER
+        elif head_time < base_time / (1 + threshold):
+            change = Change.FASTER
+        else:
+            change = Change.UNCHANGED
+        comparisons.append(Comparison(name, base_time, head_time, change))
+
+    for name, base_time in base_times.items():
+        if name not in head_times:
+            comparisons.append(Comparison(name, base_time, None, Change.REMOVED))
+
+    return comparisons
+
+
+def format_report(report: BenchmarkReport) -> str:
+    """A human-readable table of a report's results"""
+    env = report.environment
+    commit = "unknown" if env.commit is None else env.commit[:10]
+    lines = [
+        f"commit {commit}{' (dirty)' if env.dirty else ''}, python {env.python}, "
+        f"numpy {env.numpy}, numba {env.numba}, {env.cpus} cpus",
+        f"{'benchmark':<50} {'min':>12} {'median':>12} {'stdev':>12}",
+    ]
+    for result in report.results:
+        lines.append(
+            f"{result.name:<50} {_seconds(result.min):>12} "
+            f"{_seconds(result.median):>12} {_seconds(result.stdev):>12}"
+        )
+    return "\n".join(lines)
+
+
+def format_comparisons(comparisons: List[Comparison]) -> str:
+    """A human-readable table of comparisons"""
+    lines = [f"{'benchmark':<50} {'base':>12} {'head':>12} {'speedup':>9}  change"]
+    for comparison in comparisons:
+        base = "-" if comparison.base is None else _seconds(comparison.base)
+        head = "-" if comparison.head is None else _seconds(comparison.head)
+        speedup = comparison.speedup
+        ratio = "-" if speedup is None else f"{speedup:.2f}x"
+        lines.append(
+            f"{comparison.name:<50} {base:>12} {head:>12} {ratio:>9}  "
+            f"{comparison.change}"
+        )
+    return "\n".join(lines)
+
+
+def _seconds(seconds: float) -> str:
+    for unit, scale in (("s", 1), ("ms", 1e-3), ("us", 1e-6)):
+        if seconds >= scale:
+            return f"{seconds / scale:.3f} {unit}"
+    return f"{seconds / 1e-9:.1f} ns"
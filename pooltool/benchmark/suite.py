@@ -0,0 +1,325 @@
+"""The benchmarks of the simulation pipeline
+
+Each group covers one stage of the pipeline:
+
+- ``simulate``: simulating the regression test shots (saved in
+  :mod:`pooltool.evolution.event_based.test_data`), and breaks with 10 to 22 balls.
+- ``batch``: simulating sweeps of cue angles, one shot at a time and in lockstep (with
+  :func:`pooltool.evolution.event_based.batch.simulate_batch`).
+- ``quartic``: solving batches of quartic polynomials, with each solver.
+- ``detect``: detecting the next collisions of tables with 4 to 192 moving balls, with
+  the serial and the parallel fused kernels. Where parallel detection starts paying off
+  is reported by :func:`detect_crossover`.
+- ``continuize``: continuizing a simulated break at several time steps.
+- ``copy``: copying a simulated break.
+- ``serialize``: saving and loading a simulated break, in each format.
+- ``render``: rendering a shot's frames offscreen, and exporting them.
+
+Inputs are seeded, so every run of a benchmark does the same work.
+"""
+
+from __future__ import annotations
+
+import tempfile
+from itertools import product
+from pathlib import Path
+from typing import Any, Callable, Iterable, List, Optional
+
+import numpy as np
+
+import pooltool.ai.aim as aim
+import pooltool.constants as const
+from pooltool.ani.animate import FrameStepper
+from pooltool.ani.image.interface import stream_images
+from pooltool.ani.image.io import NpyImages
+from pooltool.benchmark.runner import Benchmark, BenchmarkResult
+from pooltool.evolution.continuize import continuize
+from pooltool.evolution.event_based.batch import simulate_batch
+from pooltool.evolution.event_based.fused import FusedDetector
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.evolution.event_based.test_data import TEST_DIR
+from pooltool.game.datatypes import GameType
+from pooltool.layouts import get_rack
+from pooltool.objects import Ball, Cue, Table
+from pooltool.ptmath.roots.quartic import QuarticSolver, minimum_quartic_roots
+from pooltool.serialize.serializers import SerializeFormat
+from pooltool.system.datatypes import System
+
+SEED = 42
+
+# Caps the event loop, since case4 loops almost forever
+MAX_EVENTS = 2000
+
+BREAKS = {
+    GameType.NINEBALL: "cue",
+    GameType.EIGHTBALL: "cue",
+    GameType.SNOOKER: "white",
+}
+
+BATCH_SIZES = (10, 100)
+
+QUARTIC_BATCH_SIZES = (1, 10, 100, 1000, 10000)
+
+CONTINUIZE_DTS = (0.01, 0.001, 0.0001)
+
+DETECT_BALL_COUNTS = (4, 16, 64, 192)
+
+
+def break_shot(game_type: GameType, cue_ball_id: str) -> System:
+    """A break shot (seeded, so it's the same every time)
+
+    The cue ball is struck at the object ball nearest to it.
+    """
+    np.random.seed(SEED)
+
+    table = Table.from_game_type(game_type)
+    system = System(
+        cue=Cue(cue_ball_id=cue_ball_id),
+        table=table,
+        balls=get_rack(game_type, table=table),
+    )
+
+    cue_ball = system.balls[cue_ball_id]
+    target = min(
+        (ball for ball_id, ball in system.balls.items() if ball_id != cue_ball_id),
+        key=lambda ball: np.linalg.norm(ball.xyz - cue_ball.xyz),
+    )
+    system.strike(V0=8, phi=aim.at_ball(system, target.id))
+
+    return system
+
+
+def moving_balls(num_balls: int) -> System:
+    """Balls sliding in random directions on the default table (seeded)
+
+    Balls are placed on distinct cells of a grid, so none of them overlap.
+    """
+    rng = np.random.default_rng(SEED)
+    table = Table.default()
+
+    R = Ball.dummy().params.R
+    xs = np.arange(2 * R, table.w - 2 * R, 3 * R)
+    ys = np.arange(2 * R, table.l - 2 * R, 3 * R)
+    cells = list(product(xs, ys))
+    assert num_balls <= len(cells)
+
+    balls = {}
+    for n, cell in enumerate(rng.choice(len(cells), num_balls, replace=False)):
+        ball = Ball.create(str(n), xy=cells[cell])
+        speed, angle = rng.uniform(0.5, 2), rng.uniform(0, 2 * np.pi)
+        ball.state.rvw[1] = [speed * np.cos(angle), speed * np.sin(angle), 0]
+        ball.state.rvw[2] = rng.uniform(-50, 50, 3)
+        ball.state.s = const.sliding
+        balls[ball.id] = ball
+
+    return System(cue=Cue(cue_ball_id="0"), table=table, balls=balls)
+
+
+def detect_crossover(results: Iterable[BenchmarkResult]) -> Optional[int]:
+    """The number of candidates from which parallel detection beats serial detection
+
+    Args:
+        results:
+            Benchmark results, which should include the ``detect`` benchmarks.
+
+    Returns:
+        Optional[int]:
+            The fewest candidates of a ``detect`` benchmark for which the parallel
+            kernel was faster, at that size and every larger one (compare with
+            :data:`pooltool.evolution.event_based.fused.parallel_threshold`). None if
+            it never was, or if there are no ``detect`` results.
+    """
+    times = {}
+    for result in results:
+        if result.name.startswith("detect/"):
+            times[result.params["candidates"], result.params["parallel"]] = result.min
+
+    crossover = None
+    for num in sorted({num for num, _ in times}, reverse=True):
+        if (num, False) not in times or (num, True) not in times:
+            continue
+        if times[num, True] >= times[num, False]:
+            break
+        crossover = num
+
+    return crossover
+
+
+def _test_case(num: int) -> System:
+    """A regression test shot, reset to before it was simulated"""
+    system = System.load(TEST_DIR / f"case{num}.msgpack")
+    for ball in system.balls.values():
+        ball.state = ball.history[0]
+    system.reset_history()
+    return system
+
+
+def _simulate(get_system: Callable[[], System]) -> Callable[[], Callable[[], Any]]:
+    def setup() -> Callable[[], Any]:
+        system = get_system()
+        return lambda: simulate(system, max_events=MAX_EVENTS)
+
+    return setup
+
+
+def _batch(num: int, lockstep: bool) -> Callable[[], Callable[[], Any]]:
+    def setup() -> Callable[[], Any]:
+        template = System.example()
+        shots = []
+        for phi in np.linspace(0, 360, num, endpoint=False):
+            shot = template.copy()
+            shot.strike(phi=phi)
+            shots.append(shot)
+
+        if lockstep:
+            return lambda: simulate_batch(shots, max_events=MAX_EVENTS)
+        return lambda: [simulate(shot, max_events=MAX_EVENTS) for shot in shots]
+
+    return setup
+
+
+def _quartic(num: int, solver: QuarticSolver) -> Callable[[], Callable[[], Any]]:
+    def setup() -> Callable[[], Any]:
+        # Random coefficients have a mix of real and complex roots, like collisions do
+        ps = np.random.default_rng(SEED).uniform(-1, 1, (num, 5))
+        return lambda: minimum_quartic_roots(ps, solver)
+
+    return setup
+
+
+def _detect(num_balls: int, parallel: bool) -> Callable[[], Callable[[], Any]]:
+    def setup() -> Callable[[], Any]:
+        system = moving_balls(num_balls)
+        detector = FusedDetector.from_table(system.table, parallel=parallel)
+        return lambda: detector.next_collisions(system)
+
+    return setup
+
+
+def _simulated_break() -> System:
+    return simulate(break_shot(GameType.NINEBALL, "cue"))
+
+
+def _continuize(dt: float) -> Callable[[], Callable[[], Any]]:
+    def setup() -> Callable[[], Any]:
+        system = _simulated_break()
+        return lambda: continuize(system, dt=dt, inplace=True)
+
+    return setup
+
+
+def _copy() -> Callable[[], Any]:
+    system = continuize(_simulated_break())
+    return system.copy
+
+
+def _serialize(fmt: SerializeFormat, load: bool) -> Callable[[], Callable[[], Any]]:
+    def setup() -> Callable[[], Any]:
+        system = continuize(_simulated_break())
+        path = Path(tempfile.mkdtemp()) / f"shot.{fmt.ext}"
+        system.save(path)
+
+        if load:
+            return lambda: System.load(path)
+        return lambda: system.save(path)
+
+    return setup
+
+
+_stepper: Optional[FrameStepper] = None
+
+
+def _render(size: int) -> Callable[[], Callable[[], Any]]:
+    def setup() -> Callable[[], Any]:
+        global _stepper
+        if _stepper is None:
+            # There can only be one offscreen window per process
+            _stepper = FrameStepper()
+
+        stepper = _stepper
+        system = _simulated_break()
+        exporter = NpyImages(Path(tempfile.mkdtemp()) / "frames.npy")
+        return lambda: stream_images(
+            exporter, system, stepper, size=(int(1.6 * size), size), fps=10
+        )
+
+    return setup
+
+
+def default_suite() -> List[Benchmark]:
+    """All the benchmarks"""
+    benchmarks: List[Benchmark] = []
+
+    for num in range(1, 5):
+        benchmarks.append(
+            Benchmark(
+                f"simulate/case{num}",
+                _simulate(lambda num=num: _test_case(num)),
+                {"max_events": MAX_EVENTS},
+            )
+        )
+
+    for game_type, cue_ball_id in BREAKS.items():
+        balls = len(break_shot(game_type, cue_ball_id).balls)
+        benchmarks.append(
+            Benchmark(
+                f"simulate/break_{game_type}",
+                _simulate(lambda g=game_type, c=cue_ball_id: break_shot(g, c)),
+                {"balls": balls, "max_events": MAX_EVENTS},
+            )
+        )
+
+    for num in BATCH_SIZES:
+        for lockstep in (False, True):
+            benchmarks.append(
+                Benchmark(
+                    f"batch/{'simulate_batch' if lockstep else 'simulate'}_{num}",
+                    _batch(num, lockstep),
+                    {"shots": num, "max_events": MAX_EVENTS},
+                )
+            )
+
+    for solver in QuarticSolver:
+        for num in QUARTIC_BATCH_SIZES:
+            benchmarks.append(
+                Benchmark(
+                    f"quartic/{solver}_{num}",
+                    _quartic(num, solver),
+                    {"solver": str(solver), "batch": num},
+                )
+            )
+
+    for num in DETECT_BALL_COUNTS:
+        candidates = FusedDetector.from_table(Table.default()).num_candidates(num)
+        for parallel in (False, True):
+            benchmarks.append(
+                Benchmark(
+                    f"detect/{'parallel' if parallel else 'serial'}_{num}",
+                    _detect(num, parallel),
+                    {"balls": num, "candidates": candidates, "parallel": parallel},
+                )
+            )
+
+    for dt in CONTINUIZE_DTS:
+        benchmarks.append(
+            Benchmark(f"continuize/dt_{dt:g}", _continuize(dt), {"dt": dt})
+        )
+
+    benchmarks.append(Benchmark("copy/break", _copy))
+
+    for fmt in SerializeFormat:
+        for load in (False, True):
+            benchmarks.append(
+                Benchmark(
+                    f"serialize/{'load' if load else 'save'}_{fmt}",
+                    _serialize(fmt, load),
+                    {"format": str(fmt)},
+                )
+            )
+
+    for size in (144, 480):
+        benchmarks.append(
+            Benchmark(f"render/frames_{size}p", _render(size), {"height": size})
+        )
+
+    return benchmarks
@@ -0,0 +1,112 @@
+from pathlib import Path
+
+import pytest
+
+from pooltool.benchmark.runner import (
+    Benchmark,
+    BenchmarkReport,
+    BenchmarkResult,
+    Change,
+    Environment,
+    compare,
+    run,
+    select,
+)
+from pooltool.benchmark.suite import default_suite, detect_crossover
+
+
+def _counter():
+    calls = []
+    return Benchmark("test/count", lambda: lambda: calls.append(None)), calls
+
+
+def _report(**times: float) -> BenchmarkReport:
+    return BenchmarkReport(
+        environment=Environment.current(),
+        results=[BenchmarkResult(name, {}, 1, [time]) for name, time in times.items()],
+    )
+
+
+def test_run(tmp_path: Path):
+    benchmark, calls = _counter()
+    report = run([benchmark], repeat=3, min_time=0.001)
+
+    (result,) = report.results
+    assert len(result.times) == 3
+    assert result.min <= result.median
+
+    # One warmup call, then the timed rounds
+    assert len(calls) == 1 + 3 * result.number
+
+    path = tmp_path / "results.json"
+    report.save(path)
+    assert BenchmarkReport.load(path) == report
+
+
+def test_run_duplicate_names():
+    benchmark, _ = _counter()
+    with pytest.raises(ValueError):
+        run([benchmark, benchmark], repeat=1, min_time=0)
+
+
+def test_compare():
+    base = _report(same=1.0, slower=1.0, faster=1.0, removed=1.0)
+    head = _report(same=1.05, slower=1.5, faster=0.5, added=1.0)
+
+    changes = {
+        comparison.name: comparison.change
+        for comparison in compare(base, head, threshold=0.1)
+    }
+    assert changes == {
+        "same": Change.UNCHANGED,
+        "slower": Change.SLOWER,
+        "faster": Change.FASTER,
+        "added": Change.ADDED,
+        "removed": Change.REMOVED,
+    }
+
+
+def test_default_suite():
+    benchmarks = default_suite()
+
+    names = [benchmark.name for benchmark in benchmarks]
+    assert len(names) == len(set(names))
+
+    groups = {benchmark.group for benchmark in benchmarks}
+    assert groups == {
+        "simulate",
+        "batch",
+        "quartic",
+        "continuize",
+        "copy",
+        "serialize",
+        "render",
+        "detect",
+    }
+
+    # Rendering needs a graphics pipe, so it's not run here
+    selected = select(benchmarks, pattern="quartic/.*_10$|copy")
+    report = run(selected, repeat=1, min_time=0)
+    assert len(report.results) == len(selected) > 1
+
+
+def test_detect_crossover():
+    def result(candidates: int, parallel: bool, time: float) -> BenchmarkResult:
+        params = {"candidates": candidates, "parallel": parallel}
+        return BenchmarkResult(f"detect/{parallel}_{candidates}", params, 1, [time])
+
+    results = [
+        result(10, False, 1.0),
+        result(10, True, 2.0),
+        result(100, False, 1.0),
+        result(100, True, 0.9),
+        result(1000, False, 1.0),
+        result(1000, True, 0.5),
+    ]
+    assert detect_crossover(results) == 100
+
+    # Parallel has to stay faster for larger sizes
+    results[-1] = result(1000, True, 1.5)
+    assert detect_crossover(results) is None
+
+    assert detect_crossover([]) is None
@@ -26,6 +26,7 @@ from pooltool.events.filter import (
     filter_time,
     filter_type,
 )
+from pooltool.events.index import EventIndex
 
 __all__ = [
     "filter_ball",
@@ -35,6 +36,7 @@ __all__ = [
     "by_type",
     "by_ball",
     "by_time",
+    "EventIndex",
     "null_event",
     "ball_ball_collision",
     "ball_linear_cushion_collision",
@@ -0,0 +1,169 @@
+"""Indexed queries over chronological events
+
+The functions in :mod:`pooltool.events.filter` scan the whole event list each time
+they're called. An :class:`EventIndex` instead keeps the position of each event in
+per-ball and per-type lists, and the time of each event in chronological order. A
+query then costs a bisection for its time window, plus time proportional to the
+matching candidates, however many events there are.
+
+Every :class:`pooltool.system.datatypes.System` keeps an index over its events, which
+is built the first time it's queried (see
+:attr:`pooltool.system.datatypes.System.event_index`).
+"""
+
+from __future__ import annotations
+
+from bisect import bisect_left, bisect_right
+from collections import defaultdict
+from heapq import merge
+from typing import DefaultDict, Iterable, List, Optional, Sequence, Set, Union
+
+from pooltool.events.datatypes import AgentType, Event, EventType
+
+
+class EventIndex:
+    """Per-ball, per-type, and chronological indices over a list of events
+
+    The index holds a reference to the list it's built over, and can be extended as
+    events are appended to it (see :meth:`sync`).
+
+    Args:
+        events:
+            A list of chronological events.
+
+    Raises:
+        ValueError:
+            If the events aren't chronological.
+    """
+
+    def __init__(self, events: List[Event]) -> None:
+        self.events = events
+        self.times: List[float] = []
+        self.by_ball: DefaultDict[str, List[int]] = defaultdict(list)
+        self.by_type: DefaultDict[EventType, List[int]] = defaultdict(list)
+        self._index(0)
+
+    def _index(self, start: int) -> None:
+        for i in range(start, len(self.events)):
+            event = self.events[i]
+            if len(self.times) and event.time < self.times[-1]:
+                raise ValueError("Event lists must be chronological")
+
+            self.times.append(event.time)
+            self.by_type[event.event_type].append(i)
+            for agent in event.agents:
+                if agent.agent_type == AgentType.BALL:
+                    self.by_ball[agent.id].append(i)
+
+    def sync(self, events: List[Event]) -> EventIndex:
+        """Return an index that covers the events
+
+        If ``events`` is the list this index was built over, and events have only been
+        appended to it since, the new events are indexed in place. Otherwise, a new
+        index is built.
+        """
+        if events is not self.events or len(events) < len(self.times):
+            return EventIndex(events)
+
+        self._index(len(self.times))
+        return self
+
+    def query(
+        self,
+        ball_ids: Optional[Union[str, Iterable[str]]] = None,
+        types: Optional[Union[EventType, Iterable[EventType]]] = None,
+        after: Optional[float] = None,
+        before: Optional[float] = None,
+        keep_nonevent: bool = False,
+    ) -> List[Event]:
+        """Query the events
+
+        Each criterion matches like its counterpart in :mod:`pooltool.events.filter`,
+        and an event must match every criterion that's passed.
+
+        Args:
+            ball_ids:
+                Match events that involve any of these balls (see
+                :func:`pooltool.events.filter.by_ball`).
+            types:
+                Match events of these types (see
+                :func:`pooltool.events.filter.by_type`).
+            after:
+                Match events after this time, non-inclusive (see
+                :func:`pooltool.events.filter.by_time`).
+            before:
+                Match events before this time, non-inclusive.
+            keep_nonevent:
+                If ``ball_ids`` is passed, also match non-events
+                (:attr:`EventType.NONE`).
+
+        Returns:
+            List[Event]: The matching events, in chronological order.
+        """
+        positions = self.positions(ball_ids, types, after, before, keep_nonevent)
+        return [self.events[i] for i in positions]
+
+    def first(
+        self,
+        ball_ids: Optional[Union[str, Iterable[str]]] = None,
+        types: Optional[Union[EventType, Iterable[EventType]]] = None,
+        after: Optional[float] = None,
+        before: Optional[float] = None,
+    ) -> Optional[Event]:
+        """The first event matching a query (see :meth:`query`), if there is one"""
+        positions = self.positions(ball_ids, types, after, before)
+        return self.events[positions[0]] if len(positions) else None
+
+    def positions(
+        self,
+        ball_ids: Optional[Union[str, Iterable[str]]] = None,
+        types: Optional[Union[EventType, Iterable[EventType]]] = None,
+        after: Optional[float] = None,
+        before: Optional[float] = None,
+        keep_nonevent: bool = False,
+    ) -> List[int]:
+        """The positions of the events matching a query (see :meth:`query`)"""
+        lo = 0 if after is None else bisect_right(self.times, after)
+        hi = len(self.times) if before is None else bisect_left(self.times, before)
+        if lo >= hi:
+            return []
+
+        type_set = None if types is None else _as_set(types)
+
+        if ball_ids is not None:
+            lists = [self.by_ball.get(ball_id, []) for ball_id in _as_set(ball_ids)]
+            if keep_nonevent:
+                lists.append(self.by_type.get(EventType.NONE, []))
+        elif type_set is not None:
+            lists = [self.by_type.get(event_type, []) for event_type in type_set]
+            type_set = None
+        else:
+            return list(range(lo, hi))
+
+        candidates = _merge([_window(positions, lo, hi) for positions in lists])
+        if type_set is None:
+            return candidates
+
+        return [i for i in candidates if self.events[i].event_type in type_set]
+
+
+def _as_set(values: Union[str, Iterable[str]]) -> Set[str]:
+    # Ball IDs and event types are both strings
+    return {values} if isinstance(values, str) else set(values)
+
+
+def _window(positions: List[int], lo: int, hi: int) -> Sequence[int]:
+    """The positions within [lo, hi)"""
+    return positions[bisect_left(positions, lo) : bisect_left(positions, hi)]
+
+
+def _merge(lists: List[Sequence[int]]) -> List[int]:
+    """Merge sorted lists of positions, dropping duplicates"""
+    if len(lists) == 1:
+        return list(lists[0])
+
+    merged: List[int] = []
+    for i in merge(*lists):
+        if not len(merged) or merged[-1] != i:
+            merged.append(i)
+    return merged
@@ -0,0 +1,108 @@
+import pytest
+from numpy import inf
+
+from pooltool.events import (
+    ball_ball_collision,
+    ball_linear_cushion_collision,
+    null_event,
+    rolling_stationary_transition,
+    sliding_rolling_transition,
+    stick_ball_collision,
+)
+from pooltool.events.datatypes import EventType
+from pooltool.events.filter import by_ball, by_time, by_type, filter_events
+from pooltool.events.index import EventIndex
+from pooltool.objects.ball.datatypes import Ball
+from pooltool.objects.cue.datatypes import Cue
+from pooltool.objects.table.components import LinearCushionSegment
+
+
+@pytest.fixture
+def events():
+    ball1, ball2, ball3 = Ball.dummy("1"), Ball.dummy("2"), Ball.dummy("3")
+
+    # Cue ID is "1", but cues aren't balls
+    cue = Cue("1")
+    cushion = LinearCushionSegment.dummy()
+
+    return [
+        null_event(0),
+        stick_ball_collision(cue, ball2, 1),
+        sliding_rolling_transition(ball1, 2),
+        ball_ball_collision(ball1, ball2, 3),
+        sliding_rolling_transition(ball1, 4),
+        sliding_rolling_transition(ball2, 5),
+        rolling_stationary_transition(ball2, 6),
+        ball_ball_collision(ball1, ball3, 7),
+        sliding_rolling_transition(ball1, 7),
+        sliding_rolling_transition(ball3, 9),
+        rolling_stationary_transition(ball1, 10),
+        ball_linear_cushion_collision(ball3, cushion, 12),
+        null_event(inf),
+    ]
+
+
+@pytest.mark.parametrize(
+    "query, filters",
+    [
+        (dict(), []),
+        (dict(ball_ids="1"), [by_ball("1")]),
+        (dict(ball_ids=["2", "3"]), [by_ball(["2", "3"])]),
+        (dict(ball_ids="1", keep_nonevent=True), [by_ball("1", keep_nonevent=True)]),
+        (dict(ball_ids="4"), [by_ball("4")]),
+        (dict(types=EventType.BALL_BALL), [by_type(EventType.BALL_BALL)]),
+        (
+            dict(types=[EventType.STICK_BALL, EventType.BALL_LINEAR_CUSHION]),
+            [by_type([EventType.STICK_BALL, EventType.BALL_LINEAR_CUSHION])],
+        ),
+        (dict(after=7), [by_time(7)]),
+        (dict(before=7), [by_time(7, after=False)]),
+        (
+            dict(ball_ids="1", types=EventType.SLIDING_ROLLING, after=2, before=10),
+            [
+                by_ball("1"),
+                by_type(EventType.SLIDING_ROLLING),
+                by_time(2),
+                by_time(10, after=False),
+            ],
+        ),
+    ],
+)
+def test_query(events, query, filters):
+    index = EventIndex(events)
+    expected = filter_events(events, *filters) if len(filters) else events
+    assert index.query(**query) == expected
+
+
+def test_first(events):
+    index = EventIndex(events)
+    assert index.first("1", EventType.BALL_BALL) == events[3]
+    assert index.first(types=EventType.BALL_BALL, after=3) == events[7]
+    assert index.first("4") is None
+
+    # An empty time window
+    assert index.first(after=3, before=3) is None
+
+
+def test_sync(events):
+    index = EventIndex(events[:5])
+    assert index.sync(events) is not index
+
+    appended = events[:5]
+    index = EventIndex(appended)
+    appended.extend(events[5:])
+    assert index.sync(appended) is index
+    assert index.query(types=EventType.BALL_BALL) == filter_events(
+        events, by_type(EventType.BALL_BALL)
+    )
+
+    # Events were removed, so the index is rebuilt
+    del appended[3:]
+    synced = index.sync(appended)
+    assert synced is not index
+    assert synced.query() == events[:3]
+
+
+def test_chronological(events):
+    with pytest.raises(ValueError):
+        EventIndex(events[::-1])
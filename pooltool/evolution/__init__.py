@@ -1,9 +1,30 @@
 """Shot evolution algorithm routines"""
 
 from pooltool.evolution.continuize import continuize
-from pooltool.evolution.event_based.simulate import simulate
+from pooltool.evolution.event_based.batch import simulate_batch
+from pooltool.evolution.event_based.compiled import simulate_compiled
+from pooltool.evolution.event_based.gpu import simulate_gpu
+from pooltool.evolution.event_based.memo import SimulationCache
+from pooltool.evolution.event_based.parallel import PoolType, simulate_many
+from pooltool.evolution.event_based.simulate import (
+    SimulationStep,
+    resimulate,
+    simulate,
+    simulate_iter,
+)
+from pooltool.evolution.event_based.stop import StopCondition
 
 __all__ = [
+    "PoolType",
+    "SimulationCache",
+    "SimulationStep",
+    "StopCondition",
     "continuize",
+    "resimulate",
     "simulate",
+    "simulate_batch",
+    "simulate_compiled",
+    "simulate_gpu",
+    "simulate_iter",
+    "simulate_many",
 ]
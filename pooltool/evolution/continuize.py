@@ -1,11 +1,30 @@
 """Module for building a time-dense system trajectory
 
 For an explanation, see :func:`continuize`
+
+Between the events it's involved in, a ball follows a closed-form trajectory (see
+:func:`pooltool.physics.evolve.trajectory_coeffs`). Each ball's event-based history is
+therefore broken into trajectory segments, one per event, and every timepoint is
+evaluated from the segment it falls within. All balls and timepoints are evaluated in a
+single just-in-time compiled pass that writes into preallocated arrays.
+
+A system can also be continuized while it's being simulated, with a
+:class:`Continuizer`. Once an event is resolved, the trajectories up to the event's time
+are final, so timepoints are evaluated in windows, one per event.
 """
 
+from typing import Dict, List, Tuple
+
+import numpy as np
+from numba import jit
+from numpy.typing import NDArray
+
+import pooltool.constants as const
+import pooltool.evolution.event_based.packed as packed
 import pooltool.physics.evolve as evolve
-from pooltool.events import filter_ball
-from pooltool.objects.ball.datatypes import BallHistory, BallState
+from pooltool.events import AgentType, Event, EventType
+from pooltool.evolution.event_based import solve
+from pooltool.objects.ball.datatypes import Ball, BallHistory, BallState
 from pooltool.system.datatypes import System
 
 
@@ -104,89 +123,328 @@ def continuize(system: System, dt: float = 0.01, inplace: bool = False) -> Syste
     # This is the exact number of timepoints that the ball histories will contain
     num_timestamps = int(system.events[-1].time // dt) + 1
 
-    for ball in system.balls.values():
-        # Create a new history and add the zeroth event
-        history = BallHistory()
-        history.add(ball.history[0])
+    balls = list(system.balls.values())
+    offsets, segment_t, segment_rvw, segment_s = _trajectory_segments(system, balls)
+
+    rvws, ss, ts = _evaluate_segments(
+        offsets,
+        segment_t,
+        segment_rvw,
+        segment_s,
+        packed.pack_ball_params(balls),
+        dt,
+        num_timestamps + 1,
+    )
+
+    for i, ball in enumerate(balls):
+        # The first state is the ball's initial state. There is also a finale: the
+        # final state is within dt of the second last timepoint, yet it's added even
+        # though this breaks the promise of uniformly spaced timestamps
+        for idx, state in ((0, ball.history[0]), (-1, ball.history[-1])):
+            rvws[i, idx] = state.rvw
+            ss[i, idx] = state.s
+            ts[i, idx] = state.t
 
-        rvw, s = ball.history[0].rvw, ball.history[0].s
+        # Attach the newly created history to the ball
+        ball.history_cts = BallHistory.from_vectorization((rvws[i], ss[i], ts[i]))
 
-        # Get all events that the ball is involved in, even the null_event events
-        # that mark the start and end times
-        events = filter_ball(system.events, ball.id, keep_nonevent=True)
+    return system
 
-        # Tracks which event is currently being handled
-        count = 0
 
-        # The elapsed simulation time (as of the last timepoint)
-        elapsed = 0.0
+class Continuizer:
+    """Continuize a system incrementally, as its events are simulated
+
+    The system's events are passed to :meth:`update` in order, as they're recorded.
+    Each call returns the states at the timepoints that have become final: those from
+    the previous call's event time, up to (but not including) the event's time. The
+    timepoints are the same as those of :func:`continuize`, and so are their states,
+    save for round-off. Once the last event's been passed, :meth:`histories` returns
+    the concatenated samples, which are the histories that :func:`continuize` creates.
+
+    Args:
+        system:
+            The system, with its initial states recorded (see
+            :meth:`pooltool.system.datatypes.System.reset_history`).
+        dt:
+            See :func:`continuize`.
+    """
+
+    def __init__(self, system: System, dt: float = 0.01) -> None:
+        self.dt = dt
+        self.balls = list(system.balls.values())
+        self.index = {ball.id: i for i, ball in enumerate(self.balls)}
+        self.params = packed.pack_ball_params(self.balls)
+
+        # The trajectory segment each ball is on
+        initial = [ball.history[0] for ball in self.balls]
+        self.segment_t = np.zeros(len(self.balls), dtype=np.float64)
+        self.segment_rvw = np.array(
+            [state.rvw for state in initial], dtype=np.float64
+        ).reshape(-1, 3, 3)
+        self.segment_s = np.array([state.s for state in initial], dtype=np.int64)
+
+        # The index of the next timepoint. The first is the ball's initial state
+        self.next_timepoint = 0
+        self.samples: List[Tuple[NDArray, NDArray, NDArray]] = []
+
+    def update(self, event: Event, final: bool = False) -> Dict[str, BallHistory]:
+        """Continuize up to an event
+
+        Args:
+            event:
+                The system's next event.
+            final:
+                Whether it's the system's last event. If it is, each ball's final
+                state is added (like :func:`continuize`, even though it breaks the
+                uniform spacing).
+
+        Returns:
+            Dict[str, BallHistory]: The new samples of each ball.
+        """
+        stop = max(int(np.ceil(event.time / self.dt)), self.next_timepoint)
+        ts = np.arange(self.next_timepoint, stop, dtype=np.float64) * self.dt
+
+        rvws, ss = _evaluate_window(
+            self.segment_t, self.segment_rvw, self.segment_s, self.params, ts
+        )
+
+        if self.next_timepoint == 0 and len(ts):
+            for i, ball in enumerate(self.balls):
+                _set_sample(rvws, ss, i, 0, ball.history[0])
+
+        self.next_timepoint = stop
+
+        if event.event_type != EventType.NONE:
+            for agent in event.agents:
+                if agent.agent_type != AgentType.BALL or agent.final is None:
+                    continue
+                if agent.id not in self.index:
+                    continue
+
+                i = self.index[agent.id]
+                state = agent.final.state  # type: ignore
+                self.segment_t[i] = event.time
+                self.segment_rvw[i] = state.rvw
+                self.segment_s[i] = state.s
+
+        if final:
+            finale_rvws = np.empty((len(self.balls), 1, 3, 3), dtype=np.float64)
+            finale_ss = np.empty((len(self.balls), 1), dtype=np.float64)
+            for i, ball in enumerate(self.balls):
+                _set_sample(finale_rvws, finale_ss, i, 0, ball.history[-1])
+
+            rvws = np.concatenate((rvws, finale_rvws), axis=1)
+            ss = np.concatenate((ss, finale_ss), axis=1)
+            ts = np.append(ts, event.time)
+
+        self.samples.append((rvws, ss, ts))
+
+        return {
+            ball.id: BallHistory.from_vectorization((rvws[i], ss[i], ts))
+            for i, ball in enumerate(self.balls)
+        }
+
+    def histories(self) -> Dict[str, BallHistory]:
+        """The concatenated samples of each ball"""
+        rvws = np.concatenate([sample[0] for sample in self.samples], axis=1)
+        ss = np.concatenate([sample[1] for sample in self.samples], axis=1)
+        ts = np.concatenate([sample[2] for sample in self.samples])
+
+        return {
+            ball.id: BallHistory.from_vectorization((rvws[i], ss[i], ts))
+            for i, ball in enumerate(self.balls)
+        }
+
+
+def _set_sample(
+    rvws: NDArray[np.float64],
+    ss: NDArray[np.float64],
+    i: int,
+    n: int,
+    state: BallState,
+) -> None:
+    rvws[i, n] = state.rvw
+    ss[i, n] = state.s
+
+
+def _trajectory_segments(
+    system: System, balls: List[Ball]
+) -> Tuple[
+    NDArray[np.int64], NDArray[np.float64], NDArray[np.float64], NDArray[np.int64]
+]:
+    """Break the event-based history of each ball into trajectory segments
+
+    A ball's first segment starts from its initial state, and a new segment starts from
+    the outgoing state of each event the ball is involved in.
+
+    Returns:
+        (offsets, t, rvw, s):
+            The segments of ``balls[i]`` are ``offsets[i]:offsets[i + 1]``. ``t``,
+            ``rvw``, and ``s`` are the start times, kinematic states, and motion
+            states of the segments.
+    """
+    index = {ball.id: i for i, ball in enumerate(balls)}
+    segments = [[(0.0, ball.history[0])] for ball in balls]
+
+    for event in system.events:
+        if event.event_type == EventType.NONE:
+            continue
+
+        for agent in event.agents:
+            if agent.agent_type == AgentType.BALL and agent.id in index:
+                state = agent.final.state  # type: ignore
+                segments[index[agent.id]].append((event.time, state))
+
+    offsets = np.zeros(len(balls) + 1, dtype=np.int64)
+    offsets[1:] = np.cumsum([len(ball_segments) for ball_segments in segments])
+
+    num_segments = offsets[-1]
+    t = np.empty(num_segments, dtype=np.float64)
+    rvw = np.empty((num_segments, 3, 3), dtype=np.float64)
+    s = np.empty(num_segments, dtype=np.int64)
+
+    for i, ball_segments in enumerate(segments):
+        for k, (time, state) in enumerate(ball_segments, start=offsets[i]):
+            t[k] = time
+            rvw[k] = state.rvw
+            s[k] = state.s
+
+    return offsets, t, rvw, s
+
 
-        for n in range(num_timestamps):
-            if n == (num_timestamps - 1):
-                # We made it to the end. the difference between the final time and
-                # the elapsed time should be < dt
-                assert events[-1].time - elapsed < dt
-                break
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _evaluate_segments(offsets, segment_t, segment_rvw, segment_s, params, dt, num):
+    """Evaluate the ball states at uniformly spaced timepoints
 
-            if events[count + 1].time - elapsed > dt:
-                # This is the easy case. There is no upcoming event so we simply
-                # evolve the state an amount dt
-                evolve_time = dt
+    The timepoints between the first and the last are filled. The first and last are
+    left for the caller, since they are the ball's first and final event-based states.
 
+    Each timepoint is evaluated from the last segment that starts at or before it.
+    Should a timepoint exceed the segment's motion transition (which happens only if
+    the transition wasn't recorded as an event), the ball is evolved through the
+    transition instead.
+
+    (just-in-time compiled)
+
+    Args:
+        offsets:
+            See :func:`_trajectory_segments`.
+        segment_t:
+            See :func:`_trajectory_segments`.
+        segment_rvw:
+            See :func:`_trajectory_segments`.
+        segment_s:
+            See :func:`_trajectory_segments`.
+        params:
+            Ball parameters (see
+            :func:`pooltool.evolution.event_based.packed.pack_ball_params`).
+        dt:
+            The spacing between timepoints.
+        num:
+            The number of timepoints.
+
+    Returns:
+        (rvws, ss, ts):
+            (N, num, 3, 3), (N, num), and (N, num) arrays of kinematic states, motion
+            states, and timestamps.
+    """
+    num_balls = len(offsets) - 1
+    rvws = np.empty((num_balls, num, 3, 3), dtype=np.float64)
+    ss = np.empty((num_balls, num), dtype=np.float64)
+    ts = np.empty((num_balls, num), dtype=np.float64)
+
+    for i in range(num_balls):
+        R = params[i, packed.R]
+        m = params[i, packed.M]
+        u_s = params[i, packed.U_S]
+        u_sp = params[i, packed.U_SP]
+        u_r = params[i, packed.U_R]
+        g = params[i, packed.G]
+
+        k = offsets[i]
+        end = offsets[i + 1]
+        rvw, s = segment_rvw[k], segment_s[k]
+        coeffs, spin_time, duration = _segment(rvw, s, R, u_s, u_sp, u_r, g)
+
+        # The elapsed simulation time (as of the last timepoint)
+        elapsed = 0.0
+
+        for n in range(1, num - 1):
+            # Find the last segment that starts before the next timepoint
+            advanced = False
+            while k + 1 < end and segment_t[k + 1] - elapsed <= dt:
+                k += 1
+                advanced = True
+
+            if advanced:
+                rvw, s = segment_rvw[k], segment_s[k]
+                coeffs, spin_time, duration = _segment(rvw, s, R, u_s, u_sp, u_r, g)
+
+            tau = elapsed + dt - segment_t[k]
+            if tau <= duration:
+                rvws[i, n] = evolve.evaluate_trajectory(rvw, coeffs, spin_time, tau)
+                ss[i, n] = s
             else:
-                # The next event (and perhaps an arbitrary number of subsequent
-                # events) occurs before the next timestamp. Find the last event
-                # between the current timestamp and the next timestamp. This will be
-                # used as a launching point to simulate the ball state to the next
-                # timestamp
-
-                while True:
-                    count += 1
-
-                    if events[count + 1].time - elapsed > dt:
-                        # OK, we found the last event between the current timestamp
-                        # and the next timestamp. It is events[count].
-                        break
-
-                # We need to get the ball's outgoing state from the event. We'll
-                # evolve the system from this state.
-                for agent in events[count].agents:
-                    if agent.matches(ball):
-                        state = agent.final.state.copy()  # type: ignore
-                        break
-                else:
-                    raise ValueError("No agents in event match ball")
-
-                rvw, s = state.rvw, state.s
-
-                # Since this event occurs between two timestamps, we won't be
-                # evolving a full dt. Instead, we evolve this much:
-                evolve_time = elapsed + dt - events[count].time
-
-            # Whether it was the hard path or the easy path, the ball state is
-            # properly defined and we know how much we need to simulate.
-            rvw, s = evolve.evolve_ball_motion(
-                state=s,
-                rvw=rvw,
-                R=ball.params.R,
-                m=ball.params.m,
-                u_s=ball.params.u_s,
-                u_sp=ball.params.u_sp,
-                u_r=ball.params.u_r,
-                g=ball.params.g,
-                t=evolve_time,
-            )
-
-            history.add(BallState(rvw, s, elapsed + dt))
+                rvw_tau, s_tau = evolve.evolve_ball_motion(
+                    s, rvw, R, m, u_s, u_sp, u_r, g, tau
+                )
+                rvws[i, n] = rvw_tau
+                ss[i, n] = s_tau
+
+            ts[i, n] = elapsed + dt
             elapsed += dt
 
-        # There is a finale. The final state is missing from the continuous history,
-        # whose final state is within dt of the true final state. We add the final
-        # state to the continous history even though this breaks the promise of
-        # uniformly spaced timestamps
-        history.add(ball.history[-1])
+    return rvws, ss, ts
 
-        # Attach the newly created history to the ball
-        ball.history_cts = history
 
-    return system
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _segment(rvw, s, R, u_s, u_sp, u_r, g):
+    """Get the trajectory coefficients and duration of a segment
+
+    (just-in-time compiled)
+    """
+    coeffs, spin_time = evolve.trajectory_coeffs(rvw, s, R, u_s, u_sp, u_r, g)
+    duration, _ = solve.ball_transition_time(rvw, s, R, u_s, u_sp, u_r, g)
+    return coeffs, spin_time, duration
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _evaluate_window(segment_t, segment_rvw, segment_s, params, ts):
+    """Evaluate the ball states at timepoints, each ball from a single segment
+
+    See :func:`_evaluate_segments`, and :class:`Continuizer` for the windows.
+
+    (just-in-time compiled)
+
+    Returns:
+        (rvws, ss):
+            (N, len(ts), 3, 3) and (N, len(ts)) arrays of kinematic and motion states.
+    """
+    num_balls = len(segment_t)
+    rvws = np.empty((num_balls, len(ts), 3, 3), dtype=np.float64)
+    ss = np.empty((num_balls, len(ts)), dtype=np.float64)
+
+    for i in range(num_balls):
+        R = params[i, packed.R]
+        m = params[i, packed.M]
+        u_s = params[i, packed.U_S]
+        u_sp = params[i, packed.U_SP]
+        u_r = params[i, packed.U_R]
+        g = params[i, packed.G]
+
+        rvw, s = segment_rvw[i], segment_s[i]
+        coeffs, spin_time, duration = _segment(rvw, s, R, u_s, u_sp, u_r, g)
+
+        for n in range(len(ts)):
+            tau = ts[n] - segment_t[i]
+            if tau <= duration:
+                rvws[i, n] = evolve.evaluate_trajectory(rvw, coeffs, spin_time, tau)
+                ss[i, n] = s
+            else:
+                rvw_tau, s_tau = evolve.evolve_ball_motion(
+                    s, rvw, R, m, u_s, u_sp, u_r, g, tau
+                )
+                rvws[i, n] = rvw_tau
+                ss[i, n] = s_tau
+
+    return rvws, ss
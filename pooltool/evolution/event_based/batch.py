@@ -0,0 +1,943 @@
+"""Simulate many systems in lockstep
+
+:func:`simulate_batch` runs the same event-based algorithm as
+:func:`pooltool.evolution.event_based.simulate.simulate`, but on many systems at once.
+Rather than detecting each system's next event with a Python loop over ball pairs (and
+ball-cushion pairs, etc.), the kinematic states of all systems are packed into
+struct-of-arrays form (see :mod:`pooltool.evolution.event_based.packed`), and each
+event class is detected for every system with a single compiled kernel call and a
+single quartic solver call.
+
+Events are resolved with the engine's resolver, so any
+:class:`pooltool.physics.engine.PhysicsEngine` can be used. At each step, the events
+of the same type are resolved together on the packed states, with a single call to the
+model's array entrypoint (see, e.g.,
+:class:`pooltool.physics.resolve.ball_ball.core.BallBallArrayStrategy`). Only events
+whose model doesn't have one, like ball-pocket collisions and custom models, are
+resolved on the balls of each system. The balls themselves are only updated once a
+system's simulation ends.
+"""
+
+from __future__ import annotations
+
+import time
+from collections import defaultdict
+from typing import Callable, DefaultDict, Dict, List, Optional, Sequence, Set, Tuple
+
+import attrs
+import numpy as np
+from numba import jit
+from numpy.typing import NDArray
+
+import pooltool.constants as const
+import pooltool.evolution.event_based.packed as packed
+import pooltool.instrumentation as instrumentation
+import pooltool.physics.evolve as evolve
+import pooltool.ptmath as ptmath
+from pooltool.events import (
+    AgentType,
+    Event,
+    EventType,
+    null_event,
+    stick_ball_collision,
+)
+from pooltool.evolution.continuize import continuize
+from pooltool.evolution.event_based import solve
+from pooltool.evolution.event_based.config import INCLUDED_EVENTS
+from pooltool.evolution.event_based.simulate import DEFAULT_ENGINE
+from pooltool.evolution.event_based.stop import Predicate, StopCondition
+from pooltool.objects.ball.datatypes import Ball, BallHistory, BallState
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.physics.resolve.resolver import Resolver
+from pooltool.ptmath.roots.quartic import QuarticSolver, minimum_quartic_roots
+from pooltool.system.datatypes import System
+
+
+def simulate_batch(
+    shots: Sequence[System],
+    engine: Optional[PhysicsEngine] = None,
+    inplace: bool = False,
+    continuous: bool = False,
+    dt: Optional[float] = None,
+    t_final: Optional[float] = None,
+    quartic_solver: QuarticSolver = QuarticSolver.HYBRID,
+    include: Set[EventType] = INCLUDED_EVENTS,
+    max_events: int = 0,
+    stop: Optional[StopCondition] = None,
+) -> List[System]:
+    """Run a simulation on many systems and return them
+
+    The systems are advanced in lockstep: at each step, the next event of every
+    unfinished system is detected in one call per event class (transition, ball-ball,
+    ball-linear cushion, ball-circular cushion, ball-pocket), all systems are evolved
+    to their next event in one call, and then each event is resolved. The result for
+    each system is identical to what
+    :func:`pooltool.evolution.event_based.simulate.simulate` produces.
+
+    While a system is simulated, its packed state is authoritative. Its balls (their
+    states and histories) are only brought up to date once its simulation ends, or
+    after every event if ``stop`` holds a
+    :class:`pooltool.evolution.event_based.stop.Predicate`, which may read them.
+
+    All systems must share the same table geometry and the same ball IDs (in the same
+    order). Ball parameters, ball states, and cue parameters may differ from system to
+    system. This makes ``simulate_batch`` well-suited for parameter sweeps, like
+    simulating the same layout with many different cue strikes.
+
+    Args:
+        shots:
+            The systems you would like simulated.
+        engine:
+            The engine holds all of the physics. See
+            :func:`pooltool.evolution.event_based.simulate.simulate`.
+        inplace:
+            By default, copies of the passed systems are simulated and returned. If
+            inplace is set to True, the passed systems are modified in place.
+        continuous:
+            If True, each system is also continuized (see
+            :func:`pooltool.evolution.continuize.continuize`).
+        dt:
+            The small fixed timestep used when continuous is True.
+        t_final:
+            If set, a system's simulation ends prematurely after the calculation of an
+            event with ``event.time > t_final``.
+        quartic_solver:
+            Which QuarticSolver do you want to use for solving quartic polynomials?
+        include:
+            Which EventType are you interested in resolving? By default, all detected
+            events are resolved.
+        max_events:
+            If this is greater than 0, and a shot has more than this many events, its
+            simulation is stopped and its balls are set to stationary.
+        stop:
+            If set, a shot's simulation ends as soon as this condition is met. It's
+            checked after each event. See :mod:`pooltool.evolution.event_based.stop`.
+
+    Returns:
+        List[System]: The simulated systems, in the same order they were passed.
+
+    Raises:
+        ValueError:
+            If the systems don't share the same table geometry and ball IDs.
+
+    Examples:
+        Simulate the same layout with a sweep of cue angles:
+
+        >>> import pooltool as pt
+        >>> template = pt.System.example()
+        >>> shots = []
+        >>> for phi in range(0, 360, 10):
+        >>>     shot = template.copy()
+        >>>     shot.cue.set_state(phi=phi)
+        >>>     shots.append(shot)
+        >>> simulated = pt.simulate_batch(shots)
+
+    See Also:
+        - :func:`pooltool.evolution.event_based.simulate.simulate`
+    """
+    if not inplace:
+        shots = [shot.copy() for shot in shots]
+    else:
+        shots = list(shots)
+
+    if not len(shots):
+        return shots
+
+    if not engine:
+        engine = DEFAULT_ENGINE
+
+    ball_ids, table = _validate_batch(shots)
+    num_shots, num_balls = len(shots), len(ball_ids)
+    index_of_ball = {ball_id: i for i, ball_id in enumerate(ball_ids)}
+
+    for shot in shots:
+        shot.reset_history()
+        shot._update_history(null_event(time=0))
+
+        if shot.get_system_energy() == 0 and shot.cue.V0 > 0:
+            # System has no energy, but the cue stick has an impact velocity. So create
+            # and resolve a stick-ball collision to start things off
+            event = stick_ball_collision(
+                stick=shot.cue,
+                ball=shot.balls[shot.cue.cue_ball_id],
+                time=0,
+                set_initial=True,
+            )
+            engine.resolver.resolve(shot, event)
+            shot._update_history(event)
+
+    rvw = np.empty((num_shots, num_balls, 3, 3), dtype=np.float64)
+    s = np.empty((num_shots, num_balls), dtype=np.int64)
+    params = np.empty((num_shots, num_balls, packed.NUM_BALL_PARAMS), dtype=np.float64)
+    transition_time = np.empty((num_shots, num_balls), dtype=np.float64)
+    transition_code = np.empty((num_shots, num_balls), dtype=np.int64)
+
+    for n, shot in enumerate(shots):
+        balls = list(shot.balls.values())
+        rvw[n], s[n] = packed.pack_ball_states(balls)
+        params[n] = packed.pack_ball_params(balls)
+        for i, ball in enumerate(balls):
+            transition_time[n, i], transition_code[n, i] = _transition(
+                ball.state.t, rvw[n, i], s[n, i], params[n, i]
+            )
+
+    active = np.ones(num_shots, dtype=np.bool_)
+    event_counts = np.zeros(num_shots, dtype=np.int64)
+    dts = np.zeros(num_shots, dtype=np.float64)
+    t = np.array([shot.t for shot in shots], dtype=np.float64)
+    watchers = [stop.watcher() for _ in shots] if stop is not None else None
+    pending: List[List[_PendingState]] = [[] for _ in shots]
+
+    # Predicates may read the balls, which must then be kept up to date at every event
+    reads_balls = stop is not None and any(
+        isinstance(primitive, Predicate)
+        for group in stop.groups()
+        for primitive in group
+    )
+
+    while active.any():
+        times, codes, first, second = _get_next_events(
+            rvw,
+            s,
+            params,
+            t,
+            active,
+            transition_time,
+            transition_code,
+            table,
+            quartic_solver,
+        )
+
+        stepping = active & (times < np.inf)
+        for n in np.flatnonzero(active & ~stepping):
+            _flush(shots[n], pending[n], rvw[n], s[n])
+            shots[n]._update_history(null_event(time=shots[n].t))
+            active[n] = False
+
+        dts[:] = 0.0
+        dts[stepping] = times[stepping] - t[stepping]
+        _evolve_balls(rvw, s, params, dts, stepping)
+
+        t_evolved = t + dts
+        events: Dict[int, Event] = {}
+        groups: DefaultDict[EventType, List[int]] = defaultdict(list)
+        for n in np.flatnonzero(stepping):
+            event = events[n] = packed.unpack_event(
+                shots[n],
+                int(codes[n]),
+                int(first[n]),
+                int(second[n]),
+                float(times[n]),
+                ball_ids,
+                table,
+            )
+
+            if event.event_type in include:
+                groups[event.event_type].append(n)
+
+        # Events of the same type are resolved together, on the packed states. Events
+        # whose model doesn't have an array entrypoint are resolved on the balls
+        for event_type, group in groups.items():
+            resolve_many = engine.resolver.array_entrypoint(event_type)
+            if resolve_many is not None:
+                _resolve_packed(
+                    resolve_many,
+                    [shots[n] for n in group],
+                    [events[n] for n in group],
+                    np.array(group, dtype=np.int64),
+                    first,
+                    second,
+                    rvw,
+                    s,
+                    params,
+                    t_evolved,
+                    transition_time,
+                    transition_code,
+                    table,
+                )
+                continue
+
+            for n in group:
+                _resolve_balls(
+                    engine.resolver,
+                    shots[n],
+                    events[n],
+                    index_of_ball,
+                    rvw[n],
+                    s[n],
+                    params[n],
+                    float(t_evolved[n]),
+                    transition_time[n],
+                    transition_code[n],
+                )
+
+        # The packed states are authoritative while the systems are stepped. So rather
+        # than updating the balls, their states are recorded, and added to the ball
+        # histories once the system is finished
+        states_rvw, states_s = rvw[stepping], s[stepping]
+        for k, (n, event) in enumerate(events.items()):
+            shot = shots[n]
+            shot.t = t[n] = event.time
+            shot.events.append(event)
+            pending[n].append((states_rvw, states_s, k, event.time))
+
+            if reads_balls:
+                _flush(shot, pending[n], rvw[n], s[n])
+
+            if watchers is not None and watchers[n].update(shot, event):
+                _flush(shot, pending[n], rvw[n], s[n])
+                shot._update_history(null_event(time=shot.t))
+                active[n] = False
+                continue
+
+            if t_final is not None and shot.t >= t_final:
+                _flush(shot, pending[n], rvw[n], s[n])
+                shot._update_history(null_event(time=shot.t))
+                active[n] = False
+                continue
+
+            if max_events > 0 and event_counts[n] > max_events:
+                _flush(shot, pending[n], rvw[n], s[n])
+                shot.stop_balls()
+
+                # The balls are stopped after their final states were recorded
+                for ball in shot.balls.values():
+                    ball.history[-1] = ball.state
+
+                active[n] = False
+                continue
+
+            event_counts[n] += 1
+
+    if continuous:
+        for shot in shots:
+            continuize(shot, dt=0.01 if dt is None else dt, inplace=True)
+
+    return shots
+
+
+_PendingState = Tuple[NDArray[np.float64], NDArray[np.int64], int, float]
+"""A recorded state of a system's balls
+
+The packed states of the stepped systems (rvw and s), the system's row in them, and the
+time.
+"""
+
+
+def _flush(
+    shot: System,
+    pending: List[_PendingState],
+    rvw: NDArray[np.float64],
+    s: NDArray[np.int64],
+) -> None:
+    """Bring the balls of a system up to date with its packed states
+
+    The recorded states are added to the ball histories (and cleared), and each ball is
+    given its packed state.
+    """
+    balls = shot.balls.values()
+
+    if pending:
+        rvws = np.stack([states_rvw[k] for states_rvw, _, k, _ in pending])
+        ss = np.array([states_s[k] for _, states_s, k, _ in pending], np.float64)
+        ts = np.array([t for _, _, _, t in pending], dtype=np.float64)
+        for i, ball in enumerate(balls):
+            ball.history.add_vectorization((rvws[:, i], ss[:, i], ts))
+        pending.clear()
+
+    for i, ball in enumerate(balls):
+        ball.state = BallState(rvw[i].copy(), int(s[i]), shot.t)
+
+
+def _validate_batch(
+    shots: Sequence[System],
+) -> Tuple[Tuple[str, ...], packed.PackedTable]:
+    ball_ids = tuple(shots[0].balls.keys())
+    table = packed.PackedTable.from_table(shots[0].table)
+
+    for shot in shots[1:]:
+        if tuple(shot.balls.keys()) != ball_ids:
+            raise ValueError(
+                "All systems in a batch must have the same ball IDs, in the same order"
+            )
+
+        if shot.table is not shots[0].table and not table.matches(
+            packed.PackedTable.from_table(shot.table)
+        ):
+            raise ValueError("All systems in a batch must have the same table geometry")
+
+    return ball_ids, table
+
+
+def _set_agent_states(
+    shot: System,
+    event: Event,
+    indices: Tuple[int, int],
+    initial_rvw: NDArray[np.float64],
+    initial_s: NDArray[np.int64],
+    final_rvw: NDArray[np.float64],
+    final_s: NDArray[np.int64],
+    time_evolved: float,
+) -> None:
+    """Set the initial and final agent states of a resolved event
+
+    This mirrors the snapshots taken by
+    :meth:`pooltool.physics.resolve.resolver.Resolver.resolve`.
+
+    Args:
+        indices:
+            The packed indices of the event's agents (see
+            :func:`pooltool.evolution.event_based.packed.unpack_event`).
+        initial_rvw:
+            (2, 3, 3) array holding the pre-resolution states of the first (and for
+            ball-ball collisions, second) agent.
+        initial_s:
+            (2,) array holding the corresponding motion states.
+        final_rvw:
+            (B, 3, 3) array holding the post-resolution states of all balls.
+        final_s:
+            (B,) array holding the corresponding motion states.
+        time_evolved:
+            The time the balls were evolved to before resolution.
+    """
+    # The resolver timestamps colliding balls with the event time, whereas
+    # transitioning balls keep the time they were evolved to
+    time_final = time_evolved if event.event_type.is_transition() else event.time
+
+    for a, agent in enumerate(event.agents):
+        if agent.agent_type == AgentType.BALL:
+            ball = shot.balls[agent.id]
+            i = indices[a]
+            agent.initial = _snapshot(
+                ball, initial_rvw[a].copy(), initial_s[a], time_evolved
+            )
+            agent.final = _snapshot(ball, final_rvw[i].copy(), final_s[i], time_final)
+        elif agent.agent_type == AgentType.POCKET:
+            pocket = shot.table.pockets[agent.id]
+            agent.set_initial(pocket)
+            pocket.add(event.ids[0])
+            agent.set_final(pocket)
+        elif agent.agent_type == AgentType.LINEAR_CUSHION_SEGMENT:
+            agent.set_initial(shot.table.cushion_segments.linear[agent.id])
+        elif agent.agent_type == AgentType.CIRCULAR_CUSHION_SEGMENT:
+            agent.set_initial(shot.table.cushion_segments.circular[agent.id])
+
+
+def _snapshot(ball: Ball, rvw: NDArray[np.float64], s: int, t: float) -> Ball:
+    """Copy a ball (without its history) and give it a new state"""
+    return attrs.evolve(
+        ball,
+        state=BallState(rvw, s, t),
+        history=BallHistory(),
+        history_cts=BallHistory(),
+    )
+
+
+def _resolve_packed(
+    resolve_many: Callable,
+    shots: Sequence[System],
+    events: Sequence[Event],
+    shot_idx: NDArray[np.int64],
+    first: NDArray[np.int64],
+    second: NDArray[np.int64],
+    rvw: NDArray[np.float64],
+    s: NDArray[np.int64],
+    params: NDArray[np.float64],
+    t_evolved: NDArray[np.float64],
+    transition_time: NDArray[np.float64],
+    transition_code: NDArray[np.int64],
+    table: packed.PackedTable,
+) -> None:
+    """Resolve events of the same type with one call to the model's array entrypoint
+
+    The packed states of the involved balls are resolved in place, and their next
+    transitions are updated. See, e.g.,
+    :class:`pooltool.physics.resolve.ball_ball.core.BallBallArrayStrategy` for the
+    signature of ``resolve_many``.
+
+    Args:
+        shots:
+            The systems of ``shot_idx``.
+        events:
+            The event of each system.
+        shot_idx:
+            The packed index of each system.
+    """
+    stats = instrumentation.active
+    start = time.perf_counter()
+
+    event_type = events[0].event_type
+    ball_ball = event_type == EventType.BALL_BALL
+    i = first[shot_idx]
+    j = second[shot_idx]
+
+    # For events other than ball-ball collisions, the second agent isn't a ball
+    initial_rvw = np.stack([rvw[shot_idx, i], rvw[shot_idx, j if ball_ball else i]], 1)
+    initial_s = np.stack([s[shot_idx, i], s[shot_idx, j if ball_ball else i]], 1)
+
+    rvw1 = initial_rvw[:, 0].copy()
+    if event_type.is_transition():
+        s[shot_idx, i] = resolve_many(rvw1, initial_s[:, 0].copy(), event_type)
+    elif ball_ball:
+        rvw2 = initial_rvw[:, 1].copy()
+        s[shot_idx, i], s[shot_idx, j] = resolve_many(
+            rvw1, rvw2, params[shot_idx, i, packed.R]
+        )
+        rvw[shot_idx, j] = rvw2
+    else:
+        R, m, e_c, f_c = np.ascontiguousarray(
+            params[shot_idx, i][:, [packed.R, packed.M, packed.E_C, packed.F_C]].T
+        )
+        if event_type == EventType.BALL_LINEAR_CUSHION:
+            cushions: Tuple[NDArray[np.float64], ...] = (
+                table.linear_p1[j],
+                table.linear_p2[j],
+                table.linear_normals[j],
+                table.linear_heights[j],
+            )
+        else:
+            cushions = (
+                table.circular_centers[j],
+                table.circular_radii[j],
+                table.circular_heights[j],
+            )
+        s[shot_idx, i] = resolve_many(rvw1, R, m, e_c, f_c, *cushions)
+    rvw[shot_idx, i] = rvw1
+
+    for k, (shot, event) in enumerate(zip(shots, events)):
+        n = shot_idx[k]
+        _set_agent_states(
+            shot,
+            event,
+            (int(i[k]), int(j[k])),
+            initial_rvw[k],
+            initial_s[k],
+            rvw[n],
+            s[n],
+            float(t_evolved[n]),
+        )
+
+        t_final = float(t_evolved[n]) if event_type.is_transition() else event.time
+        for ball in (i[k], j[k]) if ball_ball else (i[k],):
+            transition_time[n, ball], transition_code[n, ball] = _transition(
+                t_final, rvw[n, ball], s[n, ball], params[n, ball]
+            )
+
+    if stats is not None:
+        seconds = (time.perf_counter() - start) / len(events)
+        for _ in events:
+            stats.record_event(event_type, seconds)
+
+
+def _resolve_balls(
+    resolver: Resolver,
+    shot: System,
+    event: Event,
+    index_of_ball: Dict[str, int],
+    rvw: NDArray[np.float64],
+    s: NDArray[np.int64],
+    params: NDArray[np.float64],
+    t_evolved: float,
+    transition_time: NDArray[np.float64],
+    transition_code: NDArray[np.int64],
+) -> None:
+    """Resolve an event on the balls of its system
+
+    This is for events that can't be resolved on the packed states, like ball-pocket
+    collisions. The event's balls are given their packed states before the event is
+    resolved, and their resolved states are packed again afterwards.
+
+    Args:
+        rvw, s, params, transition_time, transition_code:
+            The packed arrays of the system, which are modified in place.
+    """
+    balls = [
+        (index_of_ball[agent.id], shot.balls[agent.id])
+        for agent in event.agents
+        if agent.agent_type == AgentType.BALL
+    ]
+
+    for i, ball in balls:
+        ball.state = BallState(rvw[i].copy(), s[i], t_evolved)
+
+    resolver.resolve(shot, event)
+
+    for i, ball in balls:
+        rvw[i], s[i] = ball.state.rvw, ball.state.s
+        transition_time[i], transition_code[i] = _transition(
+            ball.state.t, rvw[i], s[i], params[i]
+        )
+
+
+def _transition(
+    t: float, rvw: NDArray[np.float64], s: int, params: NDArray[np.float64]
+) -> Tuple[float, int]:
+    """Get the absolute time and event code of a ball's next transition"""
+    dtau_E, code = solve.ball_transition_time(
+        rvw,
+        s,
+        params[packed.R],
+        params[packed.U_S],
+        params[packed.U_SP],
+        params[packed.U_R],
+        params[packed.G],
+    )
+    return t + dtau_E, code
+
+
+def _get_next_events(
+    rvw: NDArray[np.float64],
+    s: NDArray[np.int64],
+    params: NDArray[np.float64],
+    t: NDArray[np.float64],
+    active: NDArray[np.bool_],
+    transition_time: NDArray[np.float64],
+    transition_code: NDArray[np.int64],
+    table: packed.PackedTable,
+    solver: QuarticSolver,
+) -> Tuple[
+    NDArray[np.float64], NDArray[np.int64], NDArray[np.int64], NDArray[np.int64]
+]:
+    """Get the next event of each active system
+
+    The event classes are compared in the same order, and with the same tie-breaking,
+    as :func:`pooltool.evolution.event_based.simulate.get_next_event`.
+
+    Returns:
+        (times, codes, first, second):
+            The absolute event times, the event type codes, and the indices of the
+            involved agents. ``first`` indexes the ball, and ``second`` indexes the
+            other ball (ball-ball), the cushion segment, or the pocket. Inactive
+            systems, and systems without a next event, have a time of ``np.inf``.
+    """
+    num_shots = len(t)
+
+    times = np.full(num_shots, np.inf, dtype=np.float64)
+    codes = np.full(num_shots, packed.EVENT_NONE, dtype=np.int64)
+    first = np.full(num_shots, -1, dtype=np.int64)
+    second = np.full(num_shots, -1, dtype=np.int64)
+
+    def _take(candidate_times, code, candidate_first, candidate_second):
+        better = active & (candidate_times < times)
+        times[better] = candidate_times[better]
+        codes[better] = code if np.isscalar(code) else code[better]
+        first[better] = candidate_first[better]
+        second[better] = candidate_second[better]
+
+    # Transitions
+    ball = np.argmin(transition_time, axis=1)
+    rows = np.arange(num_shots)
+    _take(transition_time[rows, ball], transition_code[rows, ball], ball, second)
+
+    # Ball-ball
+    dtau_E, ball1, ball2 = _next_quartic_collisions(
+        *_ball_ball_collision_coeffs(rvw, s, params, active), num_shots, solver
+    )
+    _take(t + dtau_E, packed.EVENT_BALL_BALL, ball1, ball2)
+
+    # Ball-linear cushion
+    dtau_E, ball, cushion = _ball_linear_cushion_collision_times(
+        rvw,
+        s,
+        params,
+        active,
+        table.linear_lines,
+        table.linear_p1,
+        table.linear_p2,
+        table.linear_directions,
+    )
+    _take(t + dtau_E, packed.EVENT_BALL_LINEAR_CUSHION, ball, cushion)
+
+    # Ball-circular cushion
+    dtau_E, ball, cushion = _next_quartic_collisions(
+        *_ball_circle_collision_coeffs(
+            rvw, s, params, active, table.circular_centers, table.circular_radii, False
+        ),
+        num_shots,
+        solver,
+    )
+    _take(t + dtau_E, packed.EVENT_BALL_CIRCULAR_CUSHION, ball, cushion)
+
+    # Ball-pocket
+    dtau_E, ball, pocket = _next_quartic_collisions(
+        *_ball_circle_collision_coeffs(
+            rvw, s, params, active, table.pocket_centers, table.pocket_radii, True
+        ),
+        num_shots,
+        solver,
+    )
+    _take(t + dtau_E, packed.EVENT_BALL_POCKET, ball, pocket)
+
+    return times, codes, first, second
+
+
+def _next_quartic_collisions(
+    coeffs: NDArray[np.float64],
+    shot_idx: NDArray[np.int64],
+    first: NDArray[np.int64],
+    second: NDArray[np.int64],
+    num_shots: int,
+    solver: QuarticSolver,
+) -> Tuple[NDArray[np.float64], NDArray[np.int64], NDArray[np.int64]]:
+    """Solve the collision polynomials of all systems, return each system's earliest
+
+    All polynomials are solved with a single call to the quartic solver.
+    """
+    if not len(coeffs):
+        # There are no collisions to test for
+        missing = np.full(num_shots, -1, dtype=np.int64)
+        return np.full(num_shots, np.inf, dtype=np.float64), missing, missing
+
+    dtau_E, row = _group_min(minimum_quartic_roots(coeffs, solver), shot_idx, num_shots)
+    return dtau_E, first[row], second[row]
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _nontranslating(s):
+    return s == const.stationary or s == const.spinning or s == const.pocketed
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _mu(s, params):
+    return params[packed.U_S] if s == const.sliding else params[packed.U_R]
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _group_min(values, groups, num_groups):
+    """Find the minimum value (and its index) of each group
+
+    (just-in-time compiled)
+
+    Ties are broken in favor of the first occurrence. Groups without values are
+    assigned a minimum of ``np.inf`` and an index of ``0``.
+    """
+    minimums = np.full(num_groups, np.inf, dtype=np.float64)
+    indices = np.zeros(num_groups, dtype=np.int64)
+
+    for k in range(len(values)):
+        group = groups[k]
+        if values[k] < minimums[group]:
+            minimums[group] = values[k]
+            indices[group] = k
+
+    return minimums, indices
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _ball_ball_collision_coeffs(rvw, s, params, active):
+    """Get the ball-ball collision coefficients of all active systems
+
+    (just-in-time compiled)
+
+    Ball pairs are skipped according to the same criteria as
+    :func:`pooltool.evolution.event_based.simulate.get_next_ball_ball_collision`.
+
+    Returns:
+        (coeffs, shot_idx, ball1, ball2):
+            ``coeffs`` is a mx5 array of quartic coefficients, and the remaining arrays
+            specify which system and which balls each row belongs to.
+    """
+    num_shots, num_balls = s.shape
+    max_rows = num_shots * (num_balls * (num_balls - 1)) // 2
+
+    coeffs = np.empty((max_rows, 5), dtype=np.float64)
+    shot_idx = np.empty(max_rows, dtype=np.int64)
+    ball1 = np.empty(max_rows, dtype=np.int64)
+    ball2 = np.empty(max_rows, dtype=np.int64)
+
+    k = 0
+    for n in range(num_shots):
+        if not active[n]:
+            continue
+
+        for i in range(num_balls):
+            s1 = s[n, i]
+            for j in range(i + 1, num_balls):
+                s2 = s[n, j]
+
+                if s1 == const.pocketed or s2 == const.pocketed:
+                    continue
+
+                if _nontranslating(s1) and _nontranslating(s2):
+                    continue
+
+                if (
+                    ptmath.norm3d(rvw[n, i, 0] - rvw[n, j, 0])
+                    < params[n, i, packed.R] + params[n, j, packed.R]
+                ):
+                    # If balls are intersecting, avoid internal collisions
+                    continue
+
+                a, b, c, d, e = solve.ball_ball_collision_coeffs(
+                    rvw[n, i],
+                    rvw[n, j],
+                    s1,
+                    s2,
+                    _mu(s1, params[n, i]),
+                    _mu(s2, params[n, j]),
+                    params[n, i, packed.M],
+                    params[n, j, packed.M],
+                    params[n, i, packed.G],
+                    params[n, j, packed.G],
+                    params[n, i, packed.R],
+                )
+
+                coeffs[k, 0] = a
+                coeffs[k, 1] = b
+                coeffs[k, 2] = c
+                coeffs[k, 3] = d
+                coeffs[k, 4] = e
+                shot_idx[k] = n
+                ball1[k] = i
+                ball2[k] = j
+                k += 1
+
+    return coeffs[:k], shot_idx[:k], ball1[:k], ball2[:k]
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _ball_circle_collision_coeffs(rvw, s, params, active, centers, radii, pockets):
+    """Get the ball-circular cushion (or ball-pocket) coefficients of active systems
+
+    (just-in-time compiled)
+
+    Returns:
+        (coeffs, shot_idx, ball, other):
+            ``coeffs`` is a mx5 array of quartic coefficients, and the remaining arrays
+            specify which system, ball, and circular cushion segment (or pocket, if
+            ``pockets`` is True) each row belongs to.
+    """
+    num_shots, num_balls = s.shape
+    num_circles = len(radii)
+    max_rows = num_shots * num_balls * num_circles
+
+    coeffs = np.empty((max_rows, 5), dtype=np.float64)
+    shot_idx = np.empty(max_rows, dtype=np.int64)
+    ball = np.empty(max_rows, dtype=np.int64)
+    other = np.empty(max_rows, dtype=np.int64)
+
+    k = 0
+    for n in range(num_shots):
+        if not active[n]:
+            continue
+
+        for i in range(num_balls):
+            if _nontranslating(s[n, i]):
+                continue
+
+            for j in range(num_circles):
+                if pockets:
+                    a, b, c, d, e = solve.ball_pocket_collision_coeffs(
+                        rvw[n, i],
+                        s[n, i],
+                        centers[j, 0],
+                        centers[j, 1],
+                        radii[j],
+                        _mu(s[n, i], params[n, i]),
+                        params[n, i, packed.M],
+                        params[n, i, packed.G],
+                        params[n, i, packed.R],
+                    )
+                else:
+                    a, b, c, d, e = solve.ball_circular_cushion_collision_coeffs(
+                        rvw[n, i],
+                        s[n, i],
+                        centers[j, 0],
+                        centers[j, 1],
+                        radii[j],
+                        _mu(s[n, i], params[n, i]),
+                        params[n, i, packed.M],
+                        params[n, i, packed.G],
+                        params[n, i, packed.R],
+                    )
+
+                coeffs[k, 0] = a
+                coeffs[k, 1] = b
+                coeffs[k, 2] = c
+                coeffs[k, 3] = d
+                coeffs[k, 4] = e
+                shot_idx[k] = n
+                ball[k] = i
+                other[k] = j
+                k += 1
+
+    return coeffs[:k], shot_idx[:k], ball[:k], other[:k]
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _ball_linear_cushion_collision_times(
+    rvw, s, params, active, lines, p1, p2, directions
+):
+    """Get the next ball-linear cushion collision of each active system
+
+    (just-in-time compiled)
+
+    Returns:
+        (dtau_E, ball, cushion):
+            The time until collision, and the indices of the ball and linear cushion
+            segment, for each system. Systems without a collision have ``np.inf``.
+    """
+    num_shots, num_balls = s.shape
+    num_cushions = len(directions)
+
+    dtau_E_min = np.full(num_shots, np.inf, dtype=np.float64)
+    ball = np.zeros(num_shots, dtype=np.int64)
+    cushion = np.zeros(num_shots, dtype=np.int64)
+
+    for n in range(num_shots):
+        if not active[n]:
+            continue
+
+        for i in range(num_balls):
+            if _nontranslating(s[n, i]):
+                continue
+
+            for j in range(num_cushions):
+                dtau_E = solve.ball_linear_cushion_collision_time(
+                    rvw[n, i],
+                    s[n, i],
+                    lines[j, 0],
+                    lines[j, 1],
+                    lines[j, 2],
+                    p1[j],
+                    p2[j],
+                    directions[j],
+                    _mu(s[n, i], params[n, i]),
+                    params[n, i, packed.M],
+                    params[n, i, packed.G],
+                    params[n, i, packed.R],
+                )
+
+                if dtau_E < dtau_E_min[n]:
+                    dtau_E_min[n] = dtau_E
+                    ball[n] = i
+                    cushion[n] = j
+
+    return dtau_E_min, ball, cushion
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _evolve_balls(rvw, s, params, dts, mask):
+    """Evolve all balls of the masked systems by their system's timestep (in place)
+
+    (just-in-time compiled)
+    """
+    num_shots, num_balls = s.shape
+
+    for n in range(num_shots):
+        if not mask[n]:
+            continue
+
+        for i in range(num_balls):
+            rvw_i, _ = evolve.evolve_ball_motion(
+                s[n, i],
+                rvw[n, i],
+                params[n, i, packed.R],
+                params[n, i, packed.M],
+                params[n, i, packed.U_S],
+                params[n, i, packed.U_SP],
+                params[n, i, packed.U_R],
+                params[n, i, packed.G],
+                dts[n],
+            )
+            rvw[n, i] = rvw_i
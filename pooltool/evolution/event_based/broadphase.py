@@ -0,0 +1,351 @@
+"""Broad-phase culling of collision candidates
+
+Before each event, the exhaustive search in
+:func:`pooltool.evolution.event_based.simulate.get_next_event` solves a polynomial for
+every ball pair, and for every ball paired with every cushion segment and pocket. Most
+of these candidates can't possibly collide before the next event.
+
+This module bounds where each ball can be within a time horizon. The horizon is the
+time until the earliest event found so far (initially, the next motion transition).
+Until then, a ball travels at most
+
+.. math::
+
+    |v| T + \\frac{1}{2} \\mu g T^2
+
+where :math:`T` is the horizon, :math:`v` is the ball's velocity, and :math:`\\mu g` is
+the magnitude of its deceleration. Candidates whose bounding boxes don't overlap are
+culled, and the remaining ball pairs are found with sweep-and-prune.
+"""
+
+from __future__ import annotations
+
+from typing import List, Tuple
+
+import attrs
+import numpy as np
+from numba import jit
+from numpy.typing import NDArray
+
+import pooltool.constants as const
+import pooltool.ptmath as ptmath
+from pooltool.evolution.event_based import solve
+from pooltool.objects.ball.datatypes import Ball
+from pooltool.objects.table.components import (
+    CircularCushionSegment,
+    LinearCushionSegment,
+    Pocket,
+)
+from pooltool.objects.table.datatypes import Table
+from pooltool.system.datatypes import System
+from pooltool.utils.strenum import StrEnum, auto
+
+# Bounding boxes are padded by this distance (in meters) to absorb round-off in the
+# collision time calculations
+PADDING = 1e-6
+
+
+class BroadPhase(StrEnum):
+    """Broad-phase strategies for culling collision candidates
+
+    Attributes:
+        EXHAUSTIVE:
+            Every candidate is solved.
+        SWEEP_AND_PRUNE:
+            Candidates are culled with bounding boxes (see
+            :class:`SweepAndPrune`) and the trajectory checks
+            :func:`pooltool.evolution.event_based.solve.skip_ball_ball_collision` and
+            :func:`pooltool.evolution.event_based.solve.skip_ball_linear_cushion_collision`.
+    """
+
+    EXHAUSTIVE = auto()
+    SWEEP_AND_PRUNE = auto()
+
+
+@attrs.define
+class BallBounds:
+    """The ingredients for bounding each ball's motion
+
+    Attributes:
+        balls:
+            The balls, in the order of the system's ball dictionary.
+        xy:
+            (N, 2) array of ball positions.
+        speed:
+            (N,) array of ball speeds. Nontranslating balls have a speed of 0.
+        decel:
+            (N,) array of ball deceleration magnitudes. Nontranslating balls have a
+            deceleration of 0.
+        R:
+            (N,) array of ball radii.
+    """
+
+    balls: List[Ball]
+    xy: NDArray[np.float64]
+    speed: NDArray[np.float64]
+    decel: NDArray[np.float64]
+    R: NDArray[np.float64]
+
+    def boxes(self, horizon: float) -> NDArray[np.float64]:
+        """Get the bounding box of each ball's swept area within a time horizon
+
+        Returns:
+            boxes:
+                (N, 4) array, where the columns are (x_min, y_min, x_max, y_max).
+        """
+        if horizon == np.inf:
+            reach = np.where(self.speed > 0, np.inf, 0.0)
+        else:
+            reach = self.speed * horizon + 0.5 * self.decel * horizon**2
+
+        extent = (reach + self.R + PADDING)[:, None]
+        return np.hstack((self.xy - extent, self.xy + extent))
+
+    @classmethod
+    def from_system(cls, shot: System) -> BallBounds:
+        balls = list(shot.balls.values())
+        num_balls = len(balls)
+
+        xy = np.empty((num_balls, 2), dtype=np.float64)
+        speed = np.zeros(num_balls, dtype=np.float64)
+        decel = np.zeros(num_balls, dtype=np.float64)
+        R = np.empty(num_balls, dtype=np.float64)
+
+        for i, ball in enumerate(balls):
+            xy[i] = ball.state.rvw[0, :2]
+            R[i] = ball.params.R
+
+            if ball.state.s in const.nontranslating:
+                continue
+
+            mu = ball.params.u_s if ball.state.s == const.sliding else ball.params.u_r
+            speed[i] = ptmath.norm3d(ball.state.rvw[1])
+            decel[i] = mu * ball.params.g
+
+        return cls(balls, xy, speed, decel, R)
+
+
+@attrs.define
+class SweepAndPrune:
+    """Culls collision candidates using each ball's swept bounding box
+
+    The bounding boxes of the table's cushion segments and pockets are calculated once,
+    upon creation (see :meth:`from_table`).
+
+    Attributes:
+        linear:
+            The linear cushion segments of the table.
+        linear_boxes:
+            (L, 4) array of linear cushion segment bounding boxes.
+        circular:
+            The circular cushion segments of the table.
+        circular_boxes:
+            (C, 4) array of circular cushion segment bounding boxes.
+        pockets:
+            The pockets of the table.
+        pocket_boxes:
+            (P, 4) array of pocket bounding boxes.
+    """
+
+    linear: List[LinearCushionSegment]
+    linear_boxes: NDArray[np.float64]
+    circular: List[CircularCushionSegment]
+    circular_boxes: NDArray[np.float64]
+    pockets: List[Pocket]
+    pocket_boxes: NDArray[np.float64]
+
+    def candidates(self, shot: System) -> Candidates:
+        """Get the collision candidates of a system at its current state"""
+        return Candidates(self, BallBounds.from_system(shot))
+
+    @classmethod
+    def from_table(cls, table: Table) -> SweepAndPrune:
+        linear = list(table.cushion_segments.linear.values())
+        circular = list(table.cushion_segments.circular.values())
+        pockets = list(table.pockets.values())
+
+        return cls(
+            linear=linear,
+            linear_boxes=np.array(
+                [
+                    [
+                        min(cushion.p1[0], cushion.p2[0]),
+                        min(cushion.p1[1], cushion.p2[1]),
+                        max(cushion.p1[0], cushion.p2[0]),
+                        max(cushion.p1[1], cushion.p2[1]),
+                    ]
+                    for cushion in linear
+                ],
+                dtype=np.float64,
+            ).reshape(-1, 4),
+            circular=circular,
+            circular_boxes=_circle_boxes(
+                [cushion.center for cushion in circular],
+                [cushion.radius for cushion in circular],
+            ),
+            pockets=pockets,
+            pocket_boxes=_circle_boxes(
+                [pocket.center for pocket in pockets],
+                [pocket.radius for pocket in pockets],
+            ),
+        )
+
+
+@attrs.define
+class Candidates:
+    """The collision candidates of a system, culled with a time horizon
+
+    Each method returns the candidates that may collide within ``horizon`` seconds, in
+    the same order as the exhaustive searches in
+    :mod:`pooltool.evolution.event_based.simulate`.
+
+    Attributes:
+        culler:
+            The culler, which holds the table's bounding boxes.
+        bounds:
+            The bounds of the system's balls.
+    """
+
+    culler: SweepAndPrune
+    bounds: BallBounds
+
+    def ball_ball(self, horizon: float) -> List[Tuple[Ball, Ball]]:
+        """Ball pairs that may collide within the horizon
+
+        Pairs are returned in the same order as ``itertools.combinations``.
+        """
+        candidates = sweep_and_prune(self.bounds.boxes(horizon))
+
+        return [
+            (self.bounds.balls[i], self.bounds.balls[j])
+            for i, j in zip(*np.nonzero(candidates))
+            if not skip_ball_ball(self.bounds.balls[i], self.bounds.balls[j])
+        ]
+
+    def ball_linear_cushion(
+        self, horizon: float
+    ) -> List[Tuple[Ball, LinearCushionSegment]]:
+        """Ball-linear cushion pairs that may collide within the horizon"""
+        overlaps = _overlaps(self.bounds.boxes(horizon), self.culler.linear_boxes)
+        pairs = [
+            (self.bounds.balls[i], self.culler.linear[j])
+            for i, j in zip(*np.nonzero(overlaps))
+        ]
+        return [pair for pair in pairs if not skip_ball_linear_cushion(*pair)]
+
+    def ball_circular_cushion(
+        self, horizon: float
+    ) -> List[Tuple[Ball, CircularCushionSegment]]:
+        """Ball-circular cushion pairs that may collide within the horizon"""
+        overlaps = _overlaps(self.bounds.boxes(horizon), self.culler.circular_boxes)
+        return [
+            (self.bounds.balls[i], self.culler.circular[j])
+            for i, j in zip(*np.nonzero(overlaps))
+        ]
+
+    def ball_pocket(self, horizon: float) -> List[Tuple[Ball, Pocket]]:
+        """Ball-pocket pairs that may collide within the horizon"""
+        overlaps = _overlaps(self.bounds.boxes(horizon), self.culler.pocket_boxes)
+        return [
+            (self.bounds.balls[i], self.culler.pockets[j])
+            for i, j in zip(*np.nonzero(overlaps))
+        ]
+
+
+def skip_ball_ball(ball1: Ball, ball2: Ball) -> bool:
+    """Whether the trajectories of two balls guarantee they won't collide
+
+    See :func:`pooltool.evolution.event_based.solve.skip_ball_ball_collision`.
+    Intersecting balls are never skipped here, since the exhaustive search handles them.
+    """
+    if (
+        ptmath.norm3d(ball1.state.rvw[0] - ball2.state.rvw[0])
+        < ball1.params.R + ball2.params.R
+    ):
+        return False
+
+    return solve.skip_ball_ball_collision(
+        ball1.state.rvw,
+        ball2.state.rvw,
+        ball1.state.s,
+        ball2.state.s,
+        ball1.params.R,
+        ball2.params.R,
+    )
+
+
+def skip_ball_linear_cushion(ball: Ball, cushion: LinearCushionSegment) -> bool:
+    """Whether a ball's trajectory guarantees it won't hit a linear cushion segment
+
+    See :func:`pooltool.evolution.event_based.solve.skip_ball_linear_cushion_collision`.
+    """
+    return solve.skip_ball_linear_cushion_collision(
+        ball.state.rvw,
+        ball.state.s,
+        ball.params.u_r,
+        ball.params.g,
+        ball.params.R,
+        cushion.p1,
+        cushion.p2,
+        cushion.normal,
+    )
+
+
+def _circle_boxes(centers, radii) -> NDArray[np.float64]:
+    centers = np.array(centers, dtype=np.float64).reshape(-1, 3)[:, :2]
+    radii = np.array(radii, dtype=np.float64)[:, None]
+    return np.hstack((centers - radii, centers + radii))
+
+
+def _overlaps(
+    boxes: NDArray[np.float64], other: NDArray[np.float64]
+) -> NDArray[np.bool_]:
+    """Which boxes overlap which other boxes
+
+    Returns:
+        overlaps:
+            A (len(boxes), len(other)) boolean array.
+    """
+    return (
+        (boxes[:, None, 0] <= other[None, :, 2])
+        & (other[None, :, 0] <= boxes[:, None, 2])
+        & (boxes[:, None, 1] <= other[None, :, 3])
+        & (other[None, :, 1] <= boxes[:, None, 3])
+    )
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def sweep_and_prune(boxes):
+    """Find all overlapping pairs of bounding boxes
+
+    Boxes are sorted by their minimum x-coordinate, and each box is only tested against
+    the boxes that start before it ends.
+
+    (just-in-time compiled)
+
+    Args:
+        boxes:
+            (N, 4) array, where the columns are (x_min, y_min, x_max, y_max).
+
+    Returns:
+        overlaps:
+            A (N, N) boolean array. ``overlaps[i, j]`` is True if boxes i and j overlap
+            and i < j.
+    """
+    num_boxes = len(boxes)
+    overlaps = np.zeros((num_boxes, num_boxes), dtype=np.bool_)
+    order = np.argsort(boxes[:, 0].copy())
+
+    for k in range(num_boxes):
+        i = order[k]
+        for m in range(k + 1, num_boxes):
+            j = order[m]
+
+            if boxes[j, 0] > boxes[i, 2]:
+                # No remaining box starts before box i ends
+                break
+
+            if boxes[j, 1] <= boxes[i, 3] and boxes[i, 1] <= boxes[j, 3]:
+                overlaps[min(i, j), max(i, j)] = True
+
+    return overlaps
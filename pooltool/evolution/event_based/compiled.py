@@ -0,0 +1,819 @@
+"""Simulate a system with a compiled event loop
+
+:func:`pooltool.evolution.event_based.simulate.simulate` keeps the system in Python
+objects for the entire simulation. Each event allocates new ball states, looks up balls
+and cushion segments by ID, and copies the event agents before and after resolution.
+
+:func:`simulate_compiled` packs the system into struct-of-arrays form (see
+:mod:`pooltool.evolution.event_based.packed`) and runs the entire detect, evolve, and
+resolve loop as just-in-time compiled code. Events are detected with the same kernels
+as :func:`pooltool.evolution.event_based.batch.simulate_batch`, and resolved with the
+compiled cores of the default resolver models. The events and ball histories are only
+rebuilt as Python objects once the loop has finished.
+"""
+
+from __future__ import annotations
+
+from typing import Optional, Set, Tuple
+
+import numpy as np
+from numba import jit
+from numpy.typing import NDArray
+
+import pooltool.constants as const
+import pooltool.evolution.event_based.packed as packed
+from pooltool.events import (
+    EventType,
+    null_event,
+    stick_ball_collision,
+)
+from pooltool.evolution.continuize import continuize
+from pooltool.evolution.event_based import batch, solve
+from pooltool.evolution.event_based.config import INCLUDED_EVENTS
+from pooltool.evolution.event_based.simulate import DEFAULT_ENGINE
+from pooltool.evolution.event_based.stop import StopCondition
+from pooltool.objects.ball.datatypes import BallState
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.physics.resolve.ball_ball.core import ball_ball_kiss
+from pooltool.physics.resolve.ball_ball.frictionless_elastic import (
+    FrictionlessElastic,
+    _resolve_ball_ball,
+)
+from pooltool.physics.resolve.ball_cushion.core import (
+    ball_circular_cushion_kiss,
+    ball_linear_cushion_kiss,
+    circular_cushion_normal,
+)
+from pooltool.physics.resolve.ball_cushion.han_2005 import (
+    Han2005Circular,
+    Han2005Linear,
+    han2005,
+)
+from pooltool.physics.resolve.ball_pocket import CanonicalBallPocket
+from pooltool.physics.resolve.resolver import Resolver
+from pooltool.physics.resolve.transition import CanonicalTransition
+from pooltool.ptmath.roots import quartic
+from pooltool.ptmath.roots.core import min_real_root_rows
+from pooltool.ptmath.roots.quartic import QuarticSolver
+from pooltool.system.datatypes import System
+
+# Why the compiled event loop stopped
+STOP_NO_EVENTS = 0
+STOP_T_FINAL = 1
+STOP_MAX_EVENTS = 2
+STOP_CONDITION = 3
+
+# The initial capacity of the event log. It's doubled whenever it fills up
+_INITIAL_CAPACITY = 64
+
+
+def simulate_compiled(
+    shot: System,
+    engine: Optional[PhysicsEngine] = None,
+    inplace: bool = False,
+    continuous: bool = False,
+    dt: Optional[float] = None,
+    t_final: Optional[float] = None,
+    quartic_solver: QuarticSolver = QuarticSolver.HYBRID,
+    include: Set[EventType] = INCLUDED_EVENTS,
+    max_events: int = 0,
+    stop: Optional[StopCondition] = None,
+) -> System:
+    """Run a simulation on a system with a compiled event loop and return it
+
+    The result is identical to what
+    :func:`pooltool.evolution.event_based.simulate.simulate` produces, but rather than
+    detecting, evolving, and resolving each event with Python objects, the whole event
+    loop runs as just-in-time compiled code over packed arrays. The events (with their
+    agents' initial and final states) and the ball histories are rebuilt once, after
+    the loop has finished.
+
+    Args:
+        shot:
+            The system you would like simulated. The system should already have energy,
+            otherwise there will be nothing to simulate.
+        engine:
+            The engine holds all of the physics. Only engines whose resolver uses the
+            default collision and transition models are supported (see Raises). The
+            stick-ball model can be anything, since the initial stick-ball collision is
+            resolved before the compiled loop starts.
+        inplace:
+            By default, a copy of the passed system is simulated and returned. If
+            inplace is set to True, the passed system is modified in place.
+        continuous:
+            If True, the system is also continuized (see
+            :func:`pooltool.evolution.continuize.continuize`).
+        dt:
+            The small fixed timestep used when continuous is True.
+        t_final:
+            If set, the simulation ends prematurely after the calculation of an event
+            with ``event.time > t_final``.
+        quartic_solver:
+            Which QuarticSolver do you want to use for solving quartic polynomials?
+        include:
+            Which EventType are you interested in resolving? By default, all detected
+            events are resolved.
+        max_events:
+            If this is greater than 0, and the shot has more than this many events, the
+            simulation is stopped and the balls are set to stationary.
+        stop:
+            If set, the simulation ends as soon as this condition is met. It's checked
+            after each event, within the compiled loop, so it must not contain a
+            :class:`pooltool.evolution.event_based.stop.Predicate`.
+
+    Returns:
+        System: The simulated system.
+
+    Raises:
+        ValueError:
+            If ``stop`` can't be compiled (see
+            :meth:`pooltool.evolution.event_based.stop.StopCondition.compile`).
+        ValueError:
+            If the engine's resolver uses a ball-ball, ball-cushion, ball-pocket, or
+            transition model without a compiled counterpart. Only
+            :class:`pooltool.physics.resolve.ball_ball.frictionless_elastic.FrictionlessElastic`,
+            :class:`pooltool.physics.resolve.ball_cushion.han_2005.model.Han2005Linear`,
+            :class:`pooltool.physics.resolve.ball_cushion.han_2005.model.Han2005Circular`,
+            :class:`pooltool.physics.resolve.ball_pocket.CanonicalBallPocket`, and
+            :class:`pooltool.physics.resolve.transition.CanonicalTransition` are
+            supported.
+
+    Examples:
+        >>> import pooltool as pt
+        >>> system = pt.System.example()
+        >>> simulated = pt.simulate_compiled(system)
+
+    Notes:
+        - The first call compiles the event loop, which takes several seconds (unless
+          :data:`pooltool.constants.use_numba_cache` is True and the loop has been
+          compiled before).
+        - With ``quartic_solver=QuarticSolver.NUMERIC``, roots are found with
+          compiled companion matrix eigenvalues, rather than the vectorized numpy
+          routine used by
+          :func:`pooltool.evolution.event_based.simulate.simulate`. Collision times
+          may therefore differ in the last few digits.
+
+    See Also:
+        - :func:`pooltool.evolution.event_based.simulate.simulate`
+    """
+    if not inplace:
+        shot = shot.copy()
+
+    if not engine:
+        engine = DEFAULT_ENGINE
+
+    _validate_resolver(engine.resolver)
+    assert QuarticSolver(quartic_solver)
+
+    condition = _compile_stop(stop, tuple(shot.balls.keys()))
+
+    shot.reset_history()
+    shot._update_history(null_event(time=0))
+
+    if shot.get_system_energy() == 0 and shot.cue.V0 > 0:
+        # System has no energy, but the cue stick has an impact velocity. So create and
+        # resolve a stick-ball collision to start things off
+        event = stick_ball_collision(
+            stick=shot.cue,
+            ball=shot.balls[shot.cue.cue_ball_id],
+            time=0,
+            set_initial=True,
+        )
+        engine.resolver.resolve(shot, event)
+        shot._update_history(event)
+
+    balls = list(shot.balls.values())
+    ball_ids = tuple(shot.balls.keys())
+    table = packed.PackedTable.from_table(shot.table)
+
+    rvw, s = packed.pack_ball_states(balls)
+    params = packed.pack_ball_params(balls)
+
+    resolve = np.array(
+        [event_type in include for event_type in packed.CODE_TO_EVENT_TYPE],
+        dtype=np.bool_,
+    )
+
+    log = _event_loop(
+        rvw,
+        s,
+        params,
+        shot.t,
+        resolve,
+        _SOLVER_CODES[quartic_solver],
+        np.inf if t_final is None else t_final,
+        max_events,
+        table.linear_lines,
+        table.linear_p1,
+        table.linear_p2,
+        table.linear_normals,
+        table.linear_directions,
+        table.linear_heights,
+        table.circular_centers,
+        table.circular_radii,
+        table.circular_heights,
+        table.pocket_centers,
+        table.pocket_radii,
+        table.pocket_depths,
+        *condition,
+    )
+
+    _finish(shot, _unpack_log(shot, log, ball_ids, table))
+
+    if continuous:
+        continuize(shot, dt=0.01 if dt is None else dt, inplace=True)
+
+    return shot
+
+
+def _compile_stop(
+    stop: Optional[StopCondition], ball_ids: Tuple[str, ...]
+) -> Tuple[NDArray, ...]:
+    """The array representation of a stop condition, which is empty if there is none"""
+    if stop is not None:
+        return stop.compile(ball_ids)
+
+    return (
+        np.zeros((0, len(packed.CODE_TO_EVENT_TYPE)), dtype=np.bool_),
+        np.zeros(0, dtype=np.int64),
+        np.zeros(0, dtype=np.int64),
+        np.zeros(0, dtype=np.int64),
+    )
+
+
+def _validate_resolver(resolver: Resolver) -> None:
+    for strategy, model in (
+        (resolver.ball_ball, FrictionlessElastic),
+        (resolver.ball_linear_cushion, Han2005Linear),
+        (resolver.ball_circular_cushion, Han2005Circular),
+        (resolver.ball_pocket, CanonicalBallPocket),
+        (resolver.transition, CanonicalTransition),
+    ):
+        if type(strategy) is not model:
+            raise ValueError(
+                f"'{type(strategy).__name__}' has no compiled counterpart. The "
+                f"compiled event loop requires '{model.__name__}'"
+            )
+
+
+def _unpack_log(
+    shot: System,
+    log: Tuple,
+    ball_ids: Tuple[str, ...],
+    table: packed.PackedTable,
+) -> int:
+    """Rebuild the events and ball histories of a system from the event log
+
+    Returns:
+        stop: Why the event loop stopped.
+    """
+    (
+        num_events,
+        stop,
+        codes,
+        times,
+        times_evolved,
+        first,
+        second,
+        resolved,
+        states_rvw,
+        states_s,
+        agents_rvw,
+        agents_s,
+    ) = log
+
+    balls = list(shot.balls.values())
+
+    for k in range(num_events):
+        time = float(times[k])
+        event = packed.unpack_event(
+            shot, int(codes[k]), int(first[k]), int(second[k]), time, ball_ids, table
+        )
+
+        if resolved[k]:
+            batch._set_agent_states(
+                shot,
+                event,
+                (int(first[k]), int(second[k])),
+                agents_rvw[k],
+                agents_s[k],
+                states_rvw[k],
+                states_s[k],
+                float(times_evolved[k]),
+            )
+
+        for i, ball in enumerate(balls):
+            ball.state = BallState(states_rvw[k, i], states_s[k, i], time)
+
+        shot._update_history(event)
+
+    return int(stop)
+
+
+def _finish(shot: System, stop: int) -> None:
+    """Close a system's history, given why its event loop stopped"""
+    if stop == STOP_MAX_EVENTS:
+        shot.stop_balls()
+
+        # The balls are stopped after their final states were recorded
+        for ball in shot.balls.values():
+            ball.history[-1] = ball.state
+    else:
+        shot._update_history(null_event(time=shot.t))
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _stop_condition_met(code, ball, other, types, balls, counts, groups, seen):
+    """Account for an event, and return whether the stop condition is met
+
+    This mirrors :meth:`pooltool.evolution.event_based.stop.StopWatcher.update`.
+
+    (just-in-time compiled)
+    """
+    num_primitives = len(counts)
+    if num_primitives == 0:
+        return False
+
+    for p in range(num_primitives):
+        if seen[p] >= counts[p] or not types[p, code]:
+            continue
+        if (
+            balls[p] < 0
+            or balls[p] == ball
+            or (code == packed.EVENT_BALL_BALL and balls[p] == other)
+        ):
+            seen[p] += 1
+
+    met = np.ones(groups.max() + 1, dtype=np.bool_)
+    for p in range(num_primitives):
+        if seen[p] < counts[p]:
+            met[groups[p]] = False
+
+    return met.any()
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _grow(arr):
+    """Double the length of an array's first axis
+
+    (just-in-time compiled)
+    """
+    return np.concatenate((arr, np.empty_like(arr)))
+
+
+# QuarticSolver members, as integer codes that can be passed to the event loop
+_HYBRID, _NUMERIC, _BRACKETED = 0, 1, 2
+
+_SOLVER_CODES = {
+    QuarticSolver.HYBRID: _HYBRID,
+    QuarticSolver.NUMERIC: _NUMERIC,
+    QuarticSolver.BRACKETED: _BRACKETED,
+}
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _min_quartic_root(coeffs, solver):
+    """Get the smallest real, positive root of many quartics, and its row index
+
+    (just-in-time compiled)
+
+    Returns:
+        (root, index):
+            The index is ``-1`` if no quartic has a real, positive root.
+    """
+    num_rows = len(coeffs)
+
+    if num_rows == 0:
+        return np.inf, -1
+
+    if solver == _BRACKETED:
+        return quartic.min_root_bracketed(coeffs)
+
+    ps = coeffs.astype(np.complex128)
+
+    if solver == _NUMERIC:
+        # Roots are the eigenvalues of the companion matrix (see
+        # pooltool.ptmath.roots.quartic.solve_many_numerical)
+        roots = np.empty((num_rows, 4), dtype=np.complex128)
+        companion = np.zeros((4, 4), dtype=np.complex128)
+        for i in range(num_rows):
+            companion[:, :] = 0.0
+            for j in range(3):
+                companion[j + 1, j] = 1.0
+            for j in range(4):
+                companion[0, j] = -ps[i, j + 1] / ps[i, 0]
+            roots[i, :] = np.linalg.eigvals(companion)
+    else:
+        roots, _ = quartic._solve_many(ps)
+
+    minimums = min_real_root_rows(roots)
+    index = np.argmin(minimums)
+
+    if minimums[index] == np.inf:
+        return np.inf, -1
+
+    return minimums[index], index
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _transition(rvw, s, code):
+    """Resolve a ball transition (in place), returning the new motion state
+
+    See :class:`pooltool.physics.resolve.transition.CanonicalTransition`.
+
+    (just-in-time compiled)
+    """
+    if code == packed.EVENT_SPINNING_STATIONARY:
+        start, end = const.spinning, const.stationary
+    elif code == packed.EVENT_ROLLING_STATIONARY:
+        start, end = const.rolling, const.stationary
+    elif code == packed.EVENT_ROLLING_SPINNING:
+        start, end = const.rolling, const.spinning
+    else:
+        start, end = const.sliding, const.rolling
+
+    assert s == start
+
+    if end == const.spinning:
+        assert (np.abs(rvw[1]) < const.EPS_SPACE).all()
+        assert (np.abs(rvw[2, :2]) < const.EPS_SPACE).all()
+        rvw[1, :] = 0.0
+        rvw[2, :2] = 0.0
+
+    if end == const.stationary:
+        assert (np.abs(rvw[1]) < const.EPS_SPACE).all()
+        assert (np.abs(rvw[2]) < const.EPS_SPACE).all()
+        rvw[1, :] = 0.0
+        rvw[2, :] = 0.0
+
+    return end
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _resolve_event(
+    code,
+    ball,
+    other,
+    rvw,
+    s,
+    params,
+    linear_p1,
+    linear_p2,
+    linear_normals,
+    linear_heights,
+    circular_centers,
+    circular_radii,
+    circular_heights,
+    pocket_centers,
+    pocket_depths,
+):
+    """Resolve an event with the default resolver models (in place)
+
+    The agents are indexed as in :func:`_event_loop`, and the packed ball states
+    ``rvw`` and ``s`` are modified in place.
+
+    (just-in-time compiled)
+    """
+    R = params[ball, packed.R]
+
+    if code == packed.EVENT_BALL_BALL:
+        ball_ball_kiss(rvw[ball], rvw[other], R)
+        rvw1, rvw2 = _resolve_ball_ball(rvw[ball].copy(), rvw[other].copy(), R)
+        rvw[ball] = rvw1
+        rvw[other] = rvw2
+        s[ball] = const.sliding
+        s[other] = const.sliding
+    elif code == packed.EVENT_BALL_LINEAR_CUSHION:
+        normal = linear_normals[other]
+        ball_linear_cushion_kiss(
+            rvw[ball], linear_p1[other], linear_p2[other], normal, R
+        )
+        rvw[ball] = han2005(
+            rvw[ball],
+            normal,
+            R,
+            params[ball, packed.M],
+            linear_heights[other],
+            params[ball, packed.E_C],
+            params[ball, packed.F_C],
+        )
+        s[ball] = const.sliding
+    elif code == packed.EVENT_BALL_CIRCULAR_CUSHION:
+        center = circular_centers[other]
+        ball_circular_cushion_kiss(
+            rvw[ball],
+            center,
+            circular_radii[other],
+            circular_cushion_normal(rvw[ball], center),
+            R,
+        )
+        rvw[ball] = han2005(
+            rvw[ball],
+            circular_cushion_normal(rvw[ball], center),
+            R,
+            params[ball, packed.M],
+            circular_heights[other],
+            params[ball, packed.E_C],
+            params[ball, packed.F_C],
+        )
+        s[ball] = const.sliding
+    elif code == packed.EVENT_BALL_POCKET:
+        # Ball is placed at the pocket center
+        rvw[ball] = 0.0
+        rvw[ball, 0, 0] = pocket_centers[other, 0]
+        rvw[ball, 0, 1] = pocket_centers[other, 1]
+        rvw[ball, 0, 2] = -pocket_depths[other]
+        s[ball] = const.pocketed
+    else:
+        s[ball] = _transition(rvw[ball], s[ball], code)
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _event_loop(
+    rvw,
+    s,
+    params,
+    t,
+    resolve,
+    solver,
+    t_final,
+    max_events,
+    linear_lines,
+    linear_p1,
+    linear_p2,
+    linear_normals,
+    linear_directions,
+    linear_heights,
+    circular_centers,
+    circular_radii,
+    circular_heights,
+    pocket_centers,
+    pocket_radii,
+    pocket_depths,
+    stop_types,
+    stop_balls,
+    stop_counts,
+    stop_groups,
+):
+    """Detect, evolve, and resolve events until the system comes to rest
+
+    The packed ball states ``rvw`` (a (B, 3, 3) array) and ``s`` (a (B,) array) are
+    modified in place. Events are detected in the same order, and with the same
+    tie-breaking, as :func:`pooltool.evolution.event_based.simulate.get_next_event`.
+
+    (just-in-time compiled)
+
+    Args:
+        resolve:
+            A boolean array indexed by event type code. Events with a code that's False
+            are detected, but not resolved.
+        solver:
+            The code of the QuarticSolver used to solve quartics (see
+            ``_SOLVER_CODES``).
+        t_final:
+            The loop stops after the first event at or beyond this time.
+        max_events:
+            If greater than 0, the loop stops after this many events.
+        stop_types, stop_balls, stop_counts, stop_groups:
+            The stop condition (see
+            :meth:`pooltool.evolution.event_based.stop.StopCondition.compile`). With
+            no primitives, there is no stop condition.
+
+    Returns:
+        log:
+            A tuple of ``(num_events, stop, codes, times, times_evolved, first, second,
+            resolved, states_rvw, states_s, agents_rvw, agents_s)``. ``stop`` is one of
+            :data:`STOP_NO_EVENTS`, :data:`STOP_T_FINAL`, :data:`STOP_MAX_EVENTS`, or
+            :data:`STOP_CONDITION`.
+            For each event, ``times_evolved`` is the time the balls were evolved to,
+            ``first`` and ``second`` index the agents (see
+            :func:`pooltool.evolution.event_based.packed.unpack_event`), ``resolved``
+            says whether it was resolved, ``states_*`` holds the states of every ball
+            after resolution, and ``agents_*`` holds the states of the (up to two)
+            agent balls before resolution. The event arrays have at least
+            ``num_events`` rows.
+    """
+    num_balls = len(s)
+
+    # The batch kernels operate on many systems, so treat this as a batch of one
+    rvw_batch = rvw.reshape((1, num_balls, 3, 3))
+    s_batch = s.reshape((1, num_balls))
+    params_batch = params.reshape((1, num_balls, packed.NUM_BALL_PARAMS))
+    active = np.ones(1, dtype=np.bool_)
+    dts = np.zeros(1, dtype=np.float64)
+
+    transition_time = np.empty(num_balls, dtype=np.float64)
+    transition_code = np.empty(num_balls, dtype=np.int64)
+    for i in range(num_balls):
+        dtau_E, code = solve.ball_transition_time(
+            rvw[i],
+            s[i],
+            params[i, packed.R],
+            params[i, packed.U_S],
+            params[i, packed.U_SP],
+            params[i, packed.U_R],
+            params[i, packed.G],
+        )
+        transition_time[i] = t + dtau_E
+        transition_code[i] = code
+
+    capacity = _INITIAL_CAPACITY
+    codes = np.empty(capacity, dtype=np.int64)
+    times = np.empty(capacity, dtype=np.float64)
+    times_evolved = np.empty(capacity, dtype=np.float64)
+    first = np.empty(capacity, dtype=np.int64)
+    second = np.empty(capacity, dtype=np.int64)
+    resolved = np.empty(capacity, dtype=np.bool_)
+    states_rvw = np.empty((capacity, num_balls, 3, 3), dtype=np.float64)
+    states_s = np.empty((capacity, num_balls), dtype=np.int64)
+    agents_rvw = np.empty((capacity, 2, 3, 3), dtype=np.float64)
+    agents_s = np.empty((capacity, 2), dtype=np.int64)
+
+    # The number of matching events seen by each primitive of the stop condition
+    stop_seen = np.zeros(len(stop_counts), dtype=np.int64)
+
+    k = 0
+    stop = STOP_NO_EVENTS
+
+    while True:
+        # Transitions
+        i = np.argmin(transition_time)
+        time = transition_time[i]
+        code = transition_code[i]
+        ball = i
+        other = -1
+
+        # Ball-ball
+        coeffs, _, ball1, ball2 = batch._ball_ball_collision_coeffs(
+            rvw_batch, s_batch, params_batch, active
+        )
+        dtau_E, row = _min_quartic_root(coeffs, solver)
+        if row >= 0 and t + dtau_E < time:
+            time = t + dtau_E
+            code = packed.EVENT_BALL_BALL
+            ball = ball1[row]
+            other = ball2[row]
+
+        # Ball-linear cushion
+        dtau_E_min, ball_min, cushion_min = batch._ball_linear_cushion_collision_times(
+            rvw_batch,
+            s_batch,
+            params_batch,
+            active,
+            linear_lines,
+            linear_p1,
+            linear_p2,
+            linear_directions,
+        )
+        if t + dtau_E_min[0] < time:
+            time = t + dtau_E_min[0]
+            code = packed.EVENT_BALL_LINEAR_CUSHION
+            ball = ball_min[0]
+            other = cushion_min[0]
+
+        # Ball-circular cushion
+        coeffs, _, ball_circular, cushion = batch._ball_circle_collision_coeffs(
+            rvw_batch,
+            s_batch,
+            params_batch,
+            active,
+            circular_centers,
+            circular_radii,
+            False,
+        )
+        dtau_E, row = _min_quartic_root(coeffs, solver)
+        if row >= 0 and t + dtau_E < time:
+            time = t + dtau_E
+            code = packed.EVENT_BALL_CIRCULAR_CUSHION
+            ball = ball_circular[row]
+            other = cushion[row]
+
+        # Ball-pocket
+        coeffs, _, ball_pocket, pocket = batch._ball_circle_collision_coeffs(
+            rvw_batch,
+            s_batch,
+            params_batch,
+            active,
+            pocket_centers,
+            pocket_radii,
+            True,
+        )
+        dtau_E, row = _min_quartic_root(coeffs, solver)
+        if row >= 0 and t + dtau_E < time:
+            time = t + dtau_E
+            code = packed.EVENT_BALL_POCKET
+            ball = ball_pocket[row]
+            other = pocket[row]
+
+        if time == np.inf:
+            stop = STOP_NO_EVENTS
+            break
+
+        if k == capacity:
+            codes = _grow(codes)
+            times = _grow(times)
+            times_evolved = _grow(times_evolved)
+            first = _grow(first)
+            second = _grow(second)
+            resolved = _grow(resolved)
+            states_rvw = _grow(states_rvw)
+            states_s = _grow(states_s)
+            agents_rvw = _grow(agents_rvw)
+            agents_s = _grow(agents_s)
+            capacity *= 2
+
+        # Evolve all balls to the event
+        dts[0] = time - t
+        batch._evolve_balls(rvw_batch, s_batch, params_batch, dts, active)
+        t_evolved = t + dts[0]
+
+        agents_rvw[k, 0] = rvw[ball]
+        agents_s[k, 0] = s[ball]
+        if code == packed.EVENT_BALL_BALL:
+            agents_rvw[k, 1] = rvw[other]
+            agents_s[k, 1] = s[other]
+
+        if resolve[code]:
+            _resolve_event(
+                code,
+                ball,
+                other,
+                rvw,
+                s,
+                params,
+                linear_p1,
+                linear_p2,
+                linear_normals,
+                linear_heights,
+                circular_centers,
+                circular_radii,
+                circular_heights,
+                pocket_centers,
+                pocket_depths,
+            )
+
+            # Colliding balls are timestamped with the event time, whereas
+            # transitioning balls keep the time they were evolved to
+            t_ball = t_evolved if code >= packed.EVENT_SPINNING_STATIONARY else time
+
+            for j in (ball, other if code == packed.EVENT_BALL_BALL else -1):
+                if j < 0:
+                    continue
+                dtau_E, transition = solve.ball_transition_time(
+                    rvw[j],
+                    s[j],
+                    params[j, packed.R],
+                    params[j, packed.U_S],
+                    params[j, packed.U_SP],
+                    params[j, packed.U_R],
+                    params[j, packed.G],
+                )
+                transition_time[j] = t_ball + dtau_E
+                transition_code[j] = transition
+
+        codes[k] = code
+        times[k] = time
+        times_evolved[k] = t_evolved
+        first[k] = ball
+        second[k] = other
+        resolved[k] = resolve[code]
+        states_rvw[k] = rvw
+        states_s[k] = s
+        t = time
+        k += 1
+
+        if _stop_condition_met(
+            code,
+            ball,
+            other,
+            stop_types,
+            stop_balls,
+            stop_counts,
+            stop_groups,
+            stop_seen,
+        ):
+            stop = STOP_CONDITION
+            break
+
+        if t >= t_final:
+            stop = STOP_T_FINAL
+            break
+
+        if max_events > 0 and k - 1 > max_events:
+            stop = STOP_MAX_EVENTS
+            break
+
+    return (
+        k,
+        stop,
+        codes,
+        times,
+        times_evolved,
+        first,
+        second,
+        resolved,
+        states_rvw,
+        states_s,
+        agents_rvw,
+        agents_s,
+    )
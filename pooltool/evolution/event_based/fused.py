@@ -0,0 +1,544 @@
+"""Fused detection of a system's next collisions
+
+Without culling, ``get_next_event`` (see :mod:`pooltool.evolution.event_based.simulate`)
+considers every ball pair, and every pairing of a ball with a cushion segment or
+pocket. Calling a compiled coefficient function once per candidate from Python, and
+gathering the results into lists, costs more than solving the candidates does.
+
+A :class:`FusedDetector` packs the system (see
+:mod:`pooltool.evolution.event_based.packed`) and hands it to a single compiled kernel,
+which builds every candidate's coefficients, solves them, and reduces them to the
+earliest collision of each class. The kernel comes in two flavors: a serial one, and one
+compiled with ``parallel=True`` that spreads the candidates of all classes across
+threads with ``prange``. Threads have a fixed cost per call, so the parallel kernel is
+only used for systems with at least :data:`parallel_threshold` candidates. Run the
+``detect`` benchmarks (see :mod:`pooltool.benchmark`) to find the crossover on a given
+machine.
+
+Note:
+    Kernels compiled with ``parallel=True`` can't be run from several threads at once
+    with numba's ``workqueue`` threading layer (doing so aborts the process). So off the
+    main thread, *e.g.* when simulating on a thread pool (see
+    :func:`pooltool.evolution.event_based.parallel.simulate_many`), the parallel kernel
+    is only picked once a thread-safe layer (``tbb`` or ``omp``) is known to be active.
+"""
+
+from __future__ import annotations
+
+import threading
+from typing import List, Optional, Tuple
+
+import numpy as np
+from numba import jit, prange, threading_layer
+
+import pooltool.constants as const
+import pooltool.evolution.event_based.packed as packed
+import pooltool.ptmath as ptmath
+from pooltool.events import Event
+from pooltool.evolution.event_based import solve
+from pooltool.objects.table.datatypes import Table
+from pooltool.ptmath.roots import quartic
+from pooltool.ptmath.roots.core import min_real_root_rows
+from pooltool.ptmath.roots.quartic import QuarticSolver
+from pooltool.system.datatypes import System
+
+parallel_threshold: int = 4096
+"""The number of candidates from which the parallel kernel is used
+
+Candidates are counted across all collision classes, *e.g.* a 9-ball rack on the default
+table has 45 ball pairs and 10 balls times 36 cushion segments and pockets.
+"""
+
+
+def _parallel_safe() -> bool:
+    """Whether the parallel kernel can be run from the calling thread
+
+    Other threads can run it once a parallel kernel has run with a threading layer that
+    allows concurrent launches (until then, the layer isn't known). The main thread can
+    always run it, since no other thread runs it by default unless that's the case.
+    """
+    if threading.current_thread() is threading.main_thread():
+        return True
+
+    try:
+        return threading_layer() != "workqueue"
+    except ValueError:
+        return False
+
+
+# The collision classes, in the order get_next_event compares them
+_CODES = (
+    packed.EVENT_BALL_BALL,
+    packed.EVENT_BALL_LINEAR_CUSHION,
+    packed.EVENT_BALL_CIRCULAR_CUSHION,
+    packed.EVENT_BALL_POCKET,
+)
+
+# QuarticSolver members, as integer codes that can be passed to the kernels
+_HYBRID, _NUMERIC, _BRACKETED = 0, 1, 2
+
+_SOLVER_CODES = {
+    QuarticSolver.HYBRID: _HYBRID,
+    QuarticSolver.NUMERIC: _NUMERIC,
+    QuarticSolver.BRACKETED: _BRACKETED,
+}
+
+# How a candidate was handled: skipped (or not a quartic), solved, or solved with the
+# solver's fallback
+_SKIPPED, _SOLVED, _FALLBACK = 0, 1, 2
+
+
+class FusedDetector:
+    """Detects the next collision of each class with one compiled kernel call
+
+    Args:
+        table:
+            The table geometry of the systems it's used on.
+        parallel:
+            Whether candidates are solved across threads. By default, they are if there
+            are at least :data:`parallel_threshold` of them, and the parallel kernel can
+            be safely run from the calling thread (see :meth:`use_parallel`).
+    """
+
+    def __init__(self, table: packed.PackedTable, parallel: Optional[bool] = None):
+        self.table = table
+        self.parallel = parallel
+
+    @classmethod
+    def from_table(cls, table: Table, parallel: Optional[bool] = None) -> FusedDetector:
+        return cls(packed.PackedTable.from_table(table), parallel=parallel)
+
+    def num_candidates(self, num_balls: int) -> int:
+        """The number of candidates of a system with this many balls"""
+        table = self.table
+        num_others = len(table.linear_ids) + len(table.circular_ids)
+        num_others += len(table.pocket_ids)
+        return num_balls * (num_balls - 1) // 2 + num_balls * num_others
+
+    def use_parallel(self, num_balls: int) -> bool:
+        """Whether the parallel kernel is used for a system with this many balls"""
+        if self.parallel is not None:
+            return self.parallel
+
+        if self.num_candidates(num_balls) < parallel_threshold:
+            return False
+
+        return _parallel_safe()
+
+    def next_collisions(
+        self, shot: System, solver: QuarticSolver = QuarticSolver.HYBRID
+    ) -> Tuple[List[Event], int, int]:
+        """Get the next ball-ball, ball-cushion, and ball-pocket collisions
+
+        Candidates are skipped by the same criteria, and ties are broken the same way,
+        as when calling the ``get_next_ball_ball_collision``,
+        ``get_next_ball_linear_cushion_collision``,
+        ``get_next_ball_circular_cushion_event``, and ``get_next_ball_pocket_collision``
+        functions of :mod:`pooltool.evolution.event_based.simulate` without pairs.
+
+        Returns:
+            (events, quartics, fallbacks):
+                ``events`` holds the next collision of each class, in the order above,
+                skipping classes without one. ``quartics`` is the number of quartics
+                solved, and ``fallbacks`` the number that fell back to the solver's
+                slower method (see :meth:`pooltool.instrumentation.SimulationStats`).
+        """
+        balls = list(shot.balls.values())
+        rvw, s = packed.pack_ball_states(balls)
+        params = packed.pack_ball_params(balls)
+
+        table = self.table
+        if self.use_parallel(len(balls)):
+            kernel = _next_collisions_parallel
+        else:
+            kernel = _next_collisions
+        dtau_E, first, second, quartics, fallbacks = kernel(
+            rvw,
+            s,
+            params,
+            _SOLVER_CODES[QuarticSolver(solver)],
+            table.linear_lines,
+            table.linear_p1,
+            table.linear_p2,
+            table.linear_directions,
+            table.circular_centers,
+            table.circular_radii,
+            table.pocket_centers,
+            table.pocket_radii,
+        )
+
+        ball_ids = tuple(shot.balls)
+        events = [
+            packed.unpack_event(
+                shot,
+                code,
+                int(first[c]),
+                int(second[c]),
+                shot.t + float(dtau_E[c]),
+                ball_ids,
+                table,
+            )
+            for c, code in enumerate(_CODES)
+            if dtau_E[c] < np.inf
+        ]
+
+        return events, int(quartics), int(fallbacks)
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _nontranslating(s):
+    return s == const.stationary or s == const.spinning or s == const.pocketed
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _mu(s, params):
+    return params[packed.U_S] if s == const.sliding else params[packed.U_R]
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _min_root(a, b, c, d, e, solver):
+    """The smallest real, positive root of a quartic, and how it was solved
+
+    Roots are calculated like
+    :func:`pooltool.ptmath.roots.quartic.minimum_quartic_root` calculates them.
+
+    (just-in-time compiled)
+    """
+    p = np.empty(5, dtype=np.float64)
+    p[0], p[1], p[2], p[3], p[4] = a, b, c, d, e
+
+    if solver == _BRACKETED:
+        root, flagged = quartic.smallest_positive_root(p)
+        if flagged:
+            return quartic._fallback_root(p), _FALLBACK
+        return root, _SOLVED
+
+    ps = p.astype(np.complex128)
+
+    if solver == _NUMERIC:
+        # Roots are the eigenvalues of the companion matrix (see
+        # pooltool.ptmath.roots.quartic.solve_many_numerical)
+        companion = np.zeros((4, 4), dtype=np.complex128)
+        for j in range(3):
+            companion[j + 1, j] = 1.0
+        for j in range(4):
+            companion[0, j] = -ps[j + 1] / ps[0]
+        roots = np.linalg.eigvals(companion)
+        flag = _SOLVED
+    else:
+        roots, indicator = quartic._solve(ps)
+        flag = _FALLBACK if indicator == quartic._NUMERIC_FALLBACK else _SOLVED
+
+    return min_real_root_rows(roots.reshape((1, -1)))[0], flag
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _ball_pairs(num_balls):
+    """The ball pairs, ordered like itertools.combinations
+
+    (just-in-time compiled)
+    """
+    num_pairs = num_balls * (num_balls - 1) // 2
+    ball1 = np.empty(num_pairs, dtype=np.int64)
+    ball2 = np.empty(num_pairs, dtype=np.int64)
+
+    k = 0
+    for i in range(num_balls):
+        for j in range(i + 1, num_balls):
+            ball1[k] = i
+            ball2[k] = j
+            k += 1
+
+    return ball1, ball2
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _candidate(
+    k,
+    rvw,
+    s,
+    params,
+    solver,
+    ball1,
+    ball2,
+    linear_lines,
+    linear_p1,
+    linear_p2,
+    linear_directions,
+    circular_centers,
+    circular_radii,
+    pocket_centers,
+    pocket_radii,
+):
+    """The collision time of candidate k, and how it was solved
+
+    Candidates are numbered class by class (see ``_CODES``). Ball-cushion and
+    ball-pocket candidates are ordered like itertools.product of the balls and the
+    cushion segments (or pockets).
+
+    (just-in-time compiled)
+    """
+    num_pairs = len(ball1)
+    num_balls = len(s)
+
+    if k < num_pairs:
+        i, j = ball1[k], ball2[k]
+        s1, s2 = s[i], s[j]
+
+        if s1 == const.pocketed or s2 == const.pocketed:
+            return np.inf, _SKIPPED
+
+        if _nontranslating(s1) and _nontranslating(s2):
+            return np.inf, _SKIPPED
+
+        if (
+            ptmath.norm3d(rvw[i, 0] - rvw[j, 0])
+            < params[i, packed.R] + params[j, packed.R]
+        ):
+            # If balls are intersecting, avoid internal collisions
+            return np.inf, _SKIPPED
+
+        a, b, c, d, e = solve.ball_ball_collision_coeffs(
+            rvw[i],
+            rvw[j],
+            s1,
+            s2,
+            _mu(s1, params[i]),
+            _mu(s2, params[j]),
+            params[i, packed.M],
+            params[j, packed.M],
+            params[i, packed.G],
+            params[j, packed.G],
+            params[i, packed.R],
+        )
+        return _min_root(a, b, c, d, e, solver)
+
+    k -= num_pairs
+    num_linear = len(linear_directions)
+
+    if k < num_balls * num_linear:
+        i, j = k // num_linear, k % num_linear
+
+        if _nontranslating(s[i]):
+            return np.inf, _SKIPPED
+
+        dtau_E = solve.ball_linear_cushion_collision_time(
+            rvw[i],
+            s[i],
+            linear_lines[j, 0],
+            linear_lines[j, 1],
+            linear_lines[j, 2],
+            linear_p1[j],
+            linear_p2[j],
+            linear_directions[j],
+            _mu(s[i], params[i]),
+            params[i, packed.M],
+            params[i, packed.G],
+            params[i, packed.R],
+        )
+        return dtau_E, _SKIPPED
+
+    k -= num_balls * num_linear
+    num_circular = len(circular_radii)
+
+    if k < num_balls * num_circular:
+        i, j = k // num_circular, k % num_circular
+
+        if _nontranslating(s[i]):
+            return np.inf, _SKIPPED
+
+        a, b, c, d, e = solve.ball_circular_cushion_collision_coeffs(
+            rvw[i],
+            s[i],
+            circular_centers[j, 0],
+            circular_centers[j, 1],
+            circular_radii[j],
+            _mu(s[i], params[i]),
+            params[i, packed.M],
+            params[i, packed.G],
+            params[i, packed.R],
+        )
+        return _min_root(a, b, c, d, e, solver)
+
+    k -= num_balls * num_circular
+    num_pockets = len(pocket_radii)
+    i, j = k // num_pockets, k % num_pockets
+
+    if _nontranslating(s[i]):
+        return np.inf, _SKIPPED
+
+    a, b, c, d, e = solve.ball_pocket_collision_coeffs(
+        rvw[i],
+        s[i],
+        pocket_centers[j, 0],
+        pocket_centers[j, 1],
+        pocket_radii[j],
+        _mu(s[i], params[i]),
+        params[i, packed.M],
+        params[i, packed.G],
+        params[i, packed.R],
+    )
+    return _min_root(a, b, c, d, e, solver)
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _earliest(times, flags, ball1, ball2, num_balls, num_linear, num_circular):
+    """Reduce the candidates to the earliest collision of each class
+
+    Ties are broken in favor of the first candidate.
+
+    (just-in-time compiled)
+
+    Returns:
+        (dtau_E, first, second, quartics, fallbacks):
+            The time until each class's next collision (``np.inf`` if there is none),
+            the agent indices of the collision (see
+            :func:`pooltool.evolution.event_based.packed.unpack_event`), and the
+            number of quartics solved, and of fallbacks.
+    """
+    dtau_E = np.full(4, np.inf, dtype=np.float64)
+    first = np.full(4, -1, dtype=np.int64)
+    second = np.full(4, -1, dtype=np.int64)
+
+    num_pairs = len(ball1)
+    starts = np.empty(5, dtype=np.int64)
+    starts[0] = 0
+    starts[1] = num_pairs
+    starts[2] = starts[1] + num_balls * num_linear
+    starts[3] = starts[2] + num_balls * num_circular
+    starts[4] = len(times)
+
+    for c in range(4):
+        for k in range(starts[c], starts[c + 1]):
+            if times[k] < dtau_E[c]:
+                dtau_E[c] = times[k]
+                first[c] = k - starts[c]
+
+        if first[c] < 0:
+            continue
+
+        if c == 0:
+            first[c], second[c] = ball1[first[c]], ball2[first[c]]
+        else:
+            num_others = (starts[c + 1] - starts[c]) // num_balls
+            first[c], second[c] = first[c] // num_others, first[c] % num_others
+
+    quartics = 0
+    fallbacks = 0
+    for k in range(len(flags)):
+        quartics += flags[k] != _SKIPPED
+        fallbacks += flags[k] == _FALLBACK
+
+    return dtau_E, first, second, quartics, fallbacks
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _next_collisions(
+    rvw,
+    s,
+    params,
+    solver,
+    linear_lines,
+    linear_p1,
+    linear_p2,
+    linear_directions,
+    circular_centers,
+    circular_radii,
+    pocket_centers,
+    pocket_radii,
+):
+    """Build, solve, and reduce every candidate of a packed system, serially
+
+    (just-in-time compiled)
+
+    Returns:
+        See ``_earliest``.
+    """
+    num_balls = len(s)
+    num_linear = len(linear_directions)
+    num_circular = len(circular_radii)
+    num_pockets = len(pocket_radii)
+
+    ball1, ball2 = _ball_pairs(num_balls)
+    num = len(ball1) + num_balls * (num_linear + num_circular + num_pockets)
+    times = np.empty(num, dtype=np.float64)
+    flags = np.empty(num, dtype=np.int64)
+
+    for k in range(num):
+        dtau_E, flag = _candidate(
+            k,
+            rvw,
+            s,
+            params,
+            solver,
+            ball1,
+            ball2,
+            linear_lines,
+            linear_p1,
+            linear_p2,
+            linear_directions,
+            circular_centers,
+            circular_radii,
+            pocket_centers,
+            pocket_radii,
+        )
+        times[k] = dtau_E
+        flags[k] = flag
+
+    return _earliest(times, flags, ball1, ball2, num_balls, num_linear, num_circular)
+
+
+@jit(nopython=True, nogil=True, parallel=True, cache=const.use_numba_cache)
+def _next_collisions_parallel(
+    rvw,
+    s,
+    params,
+    solver,
+    linear_lines,
+    linear_p1,
+    linear_p2,
+    linear_directions,
+    circular_centers,
+    circular_radii,
+    pocket_centers,
+    pocket_radii,
+):
+    """Build, solve, and reduce every candidate of a packed system, across threads
+
+    Candidates are solved in parallel, and reduced serially, so the result is the
+    same as that of ``_next_collisions``.
+
+    (just-in-time compiled)
+    """
+    num_balls = len(s)
+    num_linear = len(linear_directions)
+    num_circular = len(circular_radii)
+    num_pockets = len(pocket_radii)
+
+    ball1, ball2 = _ball_pairs(num_balls)
+    num = len(ball1) + num_balls * (num_linear + num_circular + num_pockets)
+    times = np.empty(num, dtype=np.float64)
+    flags = np.empty(num, dtype=np.int64)
+
+    for k in prange(num):
+        dtau_E, flag = _candidate(
+            k,
+            rvw,
+            s,
+            params,
+            solver,
+            ball1,
+            ball2,
+            linear_lines,
+            linear_p1,
+            linear_p2,
+            linear_directions,
+            circular_centers,
+            circular_radii,
+            pocket_centers,
+            pocket_radii,
+        )
+        times[k] = dtau_E
+        flags[k] = flag
+
+    return _earliest(times, flags, ball1, ball2, num_balls, num_linear, num_circular)
@@ -0,0 +1,1542 @@
+"""Simulate many systems on a CUDA GPU
+
+:func:`simulate_gpu` runs the event-based algorithm of
+:func:`pooltool.evolution.event_based.compiled.simulate_compiled` on a CUDA device,
+with one system per thread. The systems are packed into struct-of-arrays form (see
+:mod:`pooltool.evolution.event_based.packed`) and copied to the device once, and each
+thread then detects, evolves, and resolves its system's events until the system comes
+to rest, without returning to the host.
+
+The device kernels are scalar ports of the CPU kernels: the transition times and
+collision coefficients of :mod:`pooltool.evolution.event_based.solve`, the ball motion
+equations of :mod:`pooltool.physics.evolve`, the real arithmetic quartic solver
+:func:`pooltool.ptmath.roots.quartic.smallest_positive_root`, and the default resolver
+models (frictionless elastic ball-ball collisions and Han 2005 ball-cushion
+collisions). They don't allocate, so that nothing but the packed system and its event
+log lives in device memory.
+
+Each thread writes a compact log of its events (type, agents, and time) to the device.
+The host copies the logs back, and decodes a system only when it's asked for (see
+:class:`GPUEventLog`), by replaying the logged events with the CPU kernels.
+"""
+
+from __future__ import annotations
+
+import math
+from typing import List, Optional, Sequence, Set, Tuple
+
+import attrs
+import numpy as np
+from numba import cuda, jit
+from numpy.typing import NDArray
+
+import pooltool.constants as const
+import pooltool.evolution.event_based.packed as packed
+from pooltool.events import EventType, null_event, stick_ball_collision
+from pooltool.evolution.event_based import batch, compiled
+from pooltool.evolution.event_based.config import INCLUDED_EVENTS
+from pooltool.evolution.event_based.simulate import DEFAULT_ENGINE
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.ptmath.roots import quartic
+from pooltool.system.datatypes import System
+
+# The device solver found a quartic whose root it can't trust (see
+# pooltool.ptmath.roots.quartic.smallest_positive_root), so the system is simulated on
+# the host instead. The other stop codes are shared with the compiled event loop
+STOP_FALLBACK = 4
+
+_TWO_PI = 2 * math.pi
+_MAX_ITERATIONS = quartic.MAX_ITERATIONS
+_XTOL = quartic.XTOL
+_GRAZE_TOL = quartic.GRAZE_TOL
+
+
+@attrs.define(frozen=True)
+class GPUEventLog:
+    """The event logs of systems simulated on the device
+
+    Systems are decoded from their logs as they're asked for, so that only the systems
+    that are needed are ever built as Python objects.
+
+    Attributes:
+        shots:
+            The systems, as they were just before their event loops started (after the
+            initial stick-ball collision).
+        ball_ids:
+            The ball IDs, in packed order.
+        table:
+            The packed table geometry shared by the systems.
+        resolve:
+            Which event types are resolved (indexed by event type code).
+        t_final:
+            See :func:`simulate_gpu`.
+        max_events:
+            See :func:`simulate_gpu`.
+        num_events:
+            The number of events of each system.
+        stops:
+            Why each system's event loop stopped (see
+            :data:`pooltool.evolution.event_based.compiled.STOP_NO_EVENTS`, etc.).
+            Systems with :data:`STOP_FALLBACK` are simulated on the host when they're
+            decoded.
+        codes:
+            (N, max_events + 2) array of event type codes.
+        times:
+            (N, max_events + 2) array of event times.
+        first:
+            (N, max_events + 2) array of the (first) ball of each event.
+        second:
+            (N, max_events + 2) array of the other agent of each event (see
+            :func:`pooltool.evolution.event_based.packed.unpack_event`).
+    """
+
+    shots: List[System]
+    ball_ids: Tuple[str, ...]
+    table: packed.PackedTable
+    resolve: NDArray[np.bool_]
+    t_final: float
+    max_events: int
+    num_events: NDArray[np.int64]
+    stops: NDArray[np.int64]
+    codes: NDArray[np.int8]
+    times: NDArray[np.float64]
+    first: NDArray[np.int32]
+    second: NDArray[np.int32]
+
+    def __len__(self) -> int:
+        return len(self.shots)
+
+    def __getitem__(self, index: int) -> System:
+        return self.decode(index)
+
+    def decode(self, index: int) -> System:
+        """Build a simulated system from its event log
+
+        The logged events are replayed on the host: the balls are evolved to each
+        event, and the event is resolved with the compiled cores of the default
+        resolver models. The event times and agents come from the device.
+
+        Returns:
+            System: A new system each time it's called.
+        """
+        shot = self.shots[index].copy()
+        balls = list(shot.balls.values())
+        rvw, s = packed.pack_ball_states(balls)
+        params = packed.pack_ball_params(balls)
+
+        if self.stops[index] == STOP_FALLBACK:
+            log = _simulate_on_host(
+                shot,
+                rvw,
+                s,
+                params,
+                self.table,
+                self.resolve,
+                self.t_final,
+                self.max_events,
+            )
+        else:
+            num_events = int(self.num_events[index])
+            log = _replay(
+                rvw,
+                s,
+                params,
+                shot.t,
+                self.resolve,
+                num_events,
+                self.codes[index, :num_events].astype(np.int64),
+                self.times[index, :num_events],
+                self.first[index, :num_events].astype(np.int64),
+                self.second[index, :num_events].astype(np.int64),
+                self.table.linear_p1,
+                self.table.linear_p2,
+                self.table.linear_normals,
+                self.table.linear_heights,
+                self.table.circular_centers,
+                self.table.circular_radii,
+                self.table.circular_heights,
+                self.table.pocket_centers,
+                self.table.pocket_depths,
+            )
+            log = (log[0], int(self.stops[index])) + log[1:]
+
+        stop = compiled._unpack_log(shot, log, self.ball_ids, self.table)
+        compiled._finish(shot, stop)
+        return shot
+
+    def systems(self) -> List[System]:
+        """Decode every system"""
+        return [self.decode(index) for index in range(len(self))]
+
+
+def simulate_gpu(
+    shots: Sequence[System],
+    engine: Optional[PhysicsEngine] = None,
+    t_final: Optional[float] = None,
+    include: Set[EventType] = INCLUDED_EVENTS,
+    max_events: int = 1000,
+    threads_per_block: int = 64,
+) -> GPUEventLog:
+    """Simulate many systems on a CUDA GPU, one system per thread
+
+    The detection, evolution, and resolution of every event runs on the device, and
+    each system's events are logged (see :class:`GPUEventLog`). Decoding a system
+    gives the same result as
+    :func:`pooltool.evolution.event_based.compiled.simulate_compiled` with
+    ``quartic_solver=QuarticSolver.BRACKETED``, to within the floating point
+    differences of device arithmetic.
+
+    All systems must share the same table geometry and the same ball IDs (in the same
+    order), like in :func:`pooltool.evolution.event_based.batch.simulate_batch`. The
+    passed systems are left untouched.
+
+    Args:
+        shots:
+            The systems you would like simulated.
+        engine:
+            Only the default engine configuration is supported (see
+            :func:`pooltool.evolution.event_based.compiled.simulate_compiled`). The
+            initial stick-ball collision is resolved on the host, so the stick-ball
+            model can be anything.
+        t_final:
+            See :func:`pooltool.evolution.event_based.compiled.simulate_compiled`.
+        include:
+            See :func:`pooltool.evolution.event_based.compiled.simulate_compiled`.
+        max_events:
+            If a shot has more than this many events, its simulation is stopped and its
+            balls are set to stationary. Each system's event log is allocated up front,
+            so this must be greater than 0. Each event takes 17 bytes of device memory.
+        threads_per_block:
+            The number of threads (systems) per CUDA block.
+
+    Returns:
+        GPUEventLog: The event logs, which are decoded into systems as needed.
+
+    Raises:
+        ValueError:
+            If the systems don't share the same table geometry and ball IDs, or if the
+            engine isn't supported.
+        RuntimeError:
+            If no CUDA device is available (see :func:`numba.cuda.is_available`).
+
+    Examples:
+        Simulate a sweep of cue angles, and decode the first shot:
+
+        >>> import pooltool as pt
+        >>> template = pt.System.example()
+        >>> shots = []
+        >>> for phi in range(0, 360, 10):
+        >>>     shot = template.copy()
+        >>>     shot.cue.set_state(phi=phi)
+        >>>     shots.append(shot)
+        >>> log = pt.simulate_gpu(shots)
+        >>> simulated = log[0]
+
+    Notes:
+        - The first call compiles the kernel for the device, which takes several
+          seconds.
+        - Shots that come across a quartic whose root the real arithmetic solver can't
+          trust (see :func:`pooltool.ptmath.roots.quartic.smallest_positive_root`) are
+          given up on by the device, and simulated on the host as they're decoded.
+          This is rare.
+        - Stop conditions aren't supported.
+    """
+    if max_events <= 0:
+        raise ValueError("max_events must be greater than 0")
+
+    if not engine:
+        engine = DEFAULT_ENGINE
+
+    compiled._validate_resolver(engine.resolver)
+
+    if not len(shots):
+        raise ValueError("There are no shots to simulate")
+
+    if not cuda.is_available():
+        raise RuntimeError("simulate_gpu requires a CUDA device")
+
+    shots, ball_ids, table, rvw, s, params, t = _prepare(shots, engine)
+    num_shots = len(shots)
+
+    resolve = np.array(
+        [event_type in include for event_type in packed.CODE_TO_EVENT_TYPE],
+        dtype=np.bool_,
+    )
+    t_final = np.inf if t_final is None else t_final
+
+    # The event loop stops once it has logged more than max_events + 1 events
+    capacity = max_events + 2
+    num_events = np.zeros(num_shots, dtype=np.int64)
+    stops = np.zeros(num_shots, dtype=np.int64)
+    codes = np.zeros((num_shots, capacity), dtype=np.int8)
+    times = np.zeros((num_shots, capacity), dtype=np.float64)
+    first = np.zeros((num_shots, capacity), dtype=np.int32)
+    second = np.zeros((num_shots, capacity), dtype=np.int32)
+
+    d_num_events = cuda.to_device(num_events)
+    d_stops = cuda.to_device(stops)
+    d_codes = cuda.device_array_like(codes)
+    d_times = cuda.device_array_like(times)
+    d_first = cuda.device_array_like(first)
+    d_second = cuda.device_array_like(second)
+
+    blocks = (num_shots + threads_per_block - 1) // threads_per_block
+    _kernel[blocks, threads_per_block](
+        cuda.to_device(rvw),
+        cuda.to_device(s),
+        cuda.to_device(params),
+        cuda.to_device(t),
+        cuda.to_device(resolve),
+        t_final,
+        max_events,
+        cuda.to_device(table.linear_lines),
+        cuda.to_device(table.linear_p1),
+        cuda.to_device(table.linear_p2),
+        cuda.to_device(table.linear_normals),
+        cuda.to_device(table.linear_directions),
+        cuda.to_device(table.linear_heights),
+        cuda.to_device(table.circular_centers),
+        cuda.to_device(table.circular_radii),
+        cuda.to_device(table.circular_heights),
+        cuda.to_device(table.pocket_centers),
+        cuda.to_device(table.pocket_radii),
+        cuda.to_device(table.pocket_depths),
+        cuda.device_array(s.shape, dtype=np.float64),
+        cuda.device_array(s.shape, dtype=np.int64),
+        d_num_events,
+        d_stops,
+        d_codes,
+        d_times,
+        d_first,
+        d_second,
+    )
+
+    num_events = d_num_events.copy_to_host()
+    stops = d_stops.copy_to_host()
+    codes = d_codes.copy_to_host()
+    times = d_times.copy_to_host()
+    first = d_first.copy_to_host()
+    second = d_second.copy_to_host()
+
+    return GPUEventLog(
+        shots=shots,
+        ball_ids=ball_ids,
+        table=table,
+        resolve=resolve,
+        t_final=t_final,
+        max_events=max_events,
+        num_events=num_events,
+        stops=stops,
+        codes=codes,
+        times=times,
+        first=first,
+        second=second,
+    )
+
+
+def _prepare(shots: Sequence[System], engine: PhysicsEngine) -> Tuple:
+    """Copy the systems, start their shots, and pack them
+
+    Returns:
+        (shots, ball_ids, table, rvw, s, params, t):
+            The copied systems, their ball IDs and packed table, and the packed ball
+            states, ball parameters, and times of each system.
+    """
+    shots = [shot.copy() for shot in shots]
+    ball_ids, table = batch._validate_batch(shots)
+    num_shots = len(shots)
+
+    rvw = np.empty((num_shots, len(ball_ids), 3, 3), dtype=np.float64)
+    s = np.empty((num_shots, len(ball_ids)), dtype=np.int64)
+    params = np.empty((num_shots, len(ball_ids), packed.NUM_BALL_PARAMS))
+    t = np.empty(num_shots, dtype=np.float64)
+
+    for n, shot in enumerate(shots):
+        shot.reset_history()
+        shot._update_history(null_event(time=0))
+
+        if shot.get_system_energy() == 0 and shot.cue.V0 > 0:
+            # System has no energy, but the cue stick has an impact velocity. So create
+            # and resolve a stick-ball collision to start things off
+            event = stick_ball_collision(
+                stick=shot.cue,
+                ball=shot.balls[shot.cue.cue_ball_id],
+                time=0,
+                set_initial=True,
+            )
+            engine.resolver.resolve(shot, event)
+            shot._update_history(event)
+
+        balls = list(shot.balls.values())
+        rvw[n], s[n] = packed.pack_ball_states(balls)
+        params[n] = packed.pack_ball_params(balls)
+        t[n] = shot.t
+
+    return shots, ball_ids, table, rvw, s, params, t
+
+
+def _simulate_on_host(
+    shot: System,
+    rvw: NDArray[np.float64],
+    s: NDArray[np.int64],
+    params: NDArray[np.float64],
+    table: packed.PackedTable,
+    resolve: NDArray[np.bool_],
+    t_final: float,
+    max_events: int,
+) -> Tuple:
+    """Run the compiled event loop of a system the device gave up on"""
+    return compiled._event_loop(
+        rvw,
+        s,
+        params,
+        shot.t,
+        resolve,
+        compiled._BRACKETED,
+        t_final,
+        max_events,
+        table.linear_lines,
+        table.linear_p1,
+        table.linear_p2,
+        table.linear_normals,
+        table.linear_directions,
+        table.linear_heights,
+        table.circular_centers,
+        table.circular_radii,
+        table.circular_heights,
+        table.pocket_centers,
+        table.pocket_radii,
+        table.pocket_depths,
+        *compiled._compile_stop(None, tuple(shot.balls.keys())),
+    )
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _replay(
+    rvw,
+    s,
+    params,
+    t,
+    resolve,
+    num_events,
+    codes,
+    times,
+    first,
+    second,
+    linear_p1,
+    linear_p2,
+    linear_normals,
+    linear_heights,
+    circular_centers,
+    circular_radii,
+    circular_heights,
+    pocket_centers,
+    pocket_depths,
+):
+    """Replay logged events, building the event log of the compiled event loop
+
+    The packed ball states ``rvw`` and ``s`` are modified in place.
+
+    (just-in-time compiled)
+
+    Returns:
+        log:
+            The log returned by
+            :func:`pooltool.evolution.event_based.compiled._event_loop`, without its
+            ``stop`` entry.
+    """
+    num_balls = len(s)
+
+    # The batch kernels operate on many systems, so treat this as a batch of one
+    rvw_batch = rvw.reshape((1, num_balls, 3, 3))
+    s_batch = s.reshape((1, num_balls))
+    params_batch = params.reshape((1, num_balls, packed.NUM_BALL_PARAMS))
+    active = np.ones(1, dtype=np.bool_)
+    dts = np.zeros(1, dtype=np.float64)
+
+    times_evolved = np.empty(num_events, dtype=np.float64)
+    resolved = np.empty(num_events, dtype=np.bool_)
+    states_rvw = np.empty((num_events, num_balls, 3, 3), dtype=np.float64)
+    states_s = np.empty((num_events, num_balls), dtype=np.int64)
+    agents_rvw = np.empty((num_events, 2, 3, 3), dtype=np.float64)
+    agents_s = np.empty((num_events, 2), dtype=np.int64)
+
+    for k in range(num_events):
+        code, ball, other = codes[k], first[k], second[k]
+
+        dts[0] = times[k] - t
+        batch._evolve_balls(rvw_batch, s_batch, params_batch, dts, active)
+        times_evolved[k] = t + dts[0]
+
+        agents_rvw[k, 0] = rvw[ball]
+        agents_s[k, 0] = s[ball]
+        if code == packed.EVENT_BALL_BALL:
+            agents_rvw[k, 1] = rvw[other]
+            agents_s[k, 1] = s[other]
+
+        if resolve[code]:
+            compiled._resolve_event(
+                code,
+                ball,
+                other,
+                rvw,
+                s,
+                params,
+                linear_p1,
+                linear_p2,
+                linear_normals,
+                linear_heights,
+                circular_centers,
+                circular_radii,
+                circular_heights,
+                pocket_centers,
+                pocket_depths,
+            )
+
+        resolved[k] = resolve[code]
+        states_rvw[k] = rvw
+        states_s[k] = s
+        t = times[k]
+
+    return (
+        num_events,
+        codes,
+        times,
+        times_evolved,
+        first,
+        second,
+        resolved,
+        states_rvw,
+        states_s,
+        agents_rvw,
+        agents_s,
+    )
+
+
+@cuda.jit(device=True)
+def _angle_between(x, y, x1, y1):
+    """See :func:`pooltool.ptmath.utils.angle`"""
+    ang = math.atan2(y, x) - math.atan2(y1, x1)
+
+    if ang < 0:
+        return _TWO_PI + ang
+
+    return ang
+
+
+@cuda.jit(device=True)
+def _norm3d(x, y, z):
+    return math.sqrt(x * x + y * y + z * z)
+
+
+@cuda.jit(device=True)
+def _nontranslating(s):
+    return s == const.stationary or s == const.spinning or s == const.pocketed
+
+
+@cuda.jit(device=True)
+def _mu(s, params):
+    return params[packed.U_S] if s == const.sliding else params[packed.U_R]
+
+
+@cuda.jit(device=True)
+def _slide_time(rvw, R, u_s, g):
+    """See :func:`pooltool.ptmath.utils.get_slide_time`"""
+    if u_s == 0.0:
+        return math.inf
+
+    rel = _norm3d(rvw[1, 0] - R * rvw[2, 1], rvw[1, 1] + R * rvw[2, 0], rvw[1, 2])
+    return 2 * rel / (7 * u_s * g)
+
+
+@cuda.jit(device=True)
+def _roll_time(rvw, u_r, g):
+    """See :func:`pooltool.ptmath.utils.get_roll_time`"""
+    if u_r == 0.0:
+        return math.inf
+
+    return _norm3d(rvw[1, 0], rvw[1, 1], rvw[1, 2]) / (u_r * g)
+
+
+@cuda.jit(device=True)
+def _spin_time(rvw, R, u_sp, g):
+    """See :func:`pooltool.ptmath.utils.get_spin_time`"""
+    if u_sp == 0.0:
+        return math.inf
+
+    return abs(rvw[2, 2]) * 2 / 5 * R / u_sp / g
+
+
+@cuda.jit(device=True)
+def _transition_time(rvw, s, R, u_s, u_sp, u_r, g):
+    """See :func:`pooltool.evolution.event_based.solve.ball_transition_time`"""
+    if s == const.spinning:
+        return _spin_time(rvw, R, u_sp, g), packed.EVENT_SPINNING_STATIONARY
+
+    if s == const.rolling:
+        dtau_E_spin = _spin_time(rvw, R, u_sp, g)
+        dtau_E_roll = _roll_time(rvw, u_r, g)
+
+        if dtau_E_spin > dtau_E_roll:
+            return dtau_E_roll, packed.EVENT_ROLLING_SPINNING
+        else:
+            return dtau_E_roll, packed.EVENT_ROLLING_STATIONARY
+
+    if s == const.sliding:
+        return _slide_time(rvw, R, u_s, g), packed.EVENT_SLIDING_ROLLING
+
+    return math.inf, packed.EVENT_NONE
+
+
+@cuda.jit(device=True)
+def _perpendicular_spin(wz, R, u_sp, g, t):
+    """See :func:`pooltool.physics.evolve.evolve_perpendicular_spin_component`"""
+    if t == 0:
+        return wz
+
+    if abs(wz) < const.EPS:
+        return wz
+
+    alpha = 5 * u_sp * g / (2 * R)
+
+    if t > abs(wz) / alpha:
+        # You can't decay past 0 angular velocity
+        t = abs(wz) / alpha
+
+    # Always decay towards 0, whether spin is +ve or -ve
+    if wz > 0:
+        return wz - alpha * t
+
+    return wz + alpha * t
+
+
+@cuda.jit(device=True)
+def _evolve_slide(rvw, R, u_s, u_sp, g, t):
+    """See :func:`pooltool.physics.evolve.evolve_slide_state` (in place)"""
+    if t == 0:
+        return
+
+    # Angle of initial velocity in table frame
+    phi = _angle_between(rvw[1, 0], rvw[1, 1], 1.0, 0.0)
+    cos_phi = math.cos(phi)
+    sin_phi = math.sin(phi)
+
+    # Relative velocity unit vector in ball frame
+    rel_x = rvw[1, 0] - R * rvw[2, 1]
+    rel_y = rvw[1, 1] + R * rvw[2, 0]
+    rel_z = rvw[1, 2]
+    rel = _norm3d(rel_x, rel_y, rel_z)
+    rel_x, rel_y, rel_z = rel_x / rel, rel_y / rel, rel_z / rel
+    u_x = cos_phi * rel_x + sin_phi * rel_y
+    u_y = -sin_phi * rel_x + cos_phi * rel_y
+    u_z = rel_z
+
+    # Velocities in the ball frame
+    v_x = cos_phi * rvw[1, 0] + sin_phi * rvw[1, 1]
+    v_y = -sin_phi * rvw[1, 0] + cos_phi * rvw[1, 1]
+    v_z = rvw[1, 2]
+    w_x = cos_phi * rvw[2, 0] + sin_phi * rvw[2, 1]
+    w_y = -sin_phi * rvw[2, 0] + cos_phi * rvw[2, 1]
+
+    a = u_s * g
+    r_x = v_x * t - 0.5 * a * t**2 * u_x
+    r_y = -0.5 * a * t**2 * u_y
+    v_x -= a * t * u_x
+    v_y -= a * t * u_y
+    v_z -= a * t * u_z
+    w_x -= 5 / 2 / R * a * t * u_y
+    w_y += 5 / 2 / R * a * t * u_x
+
+    # Rotate to table reference
+    rvw[0, 0] += cos_phi * r_x - sin_phi * r_y
+    rvw[0, 1] += sin_phi * r_x + cos_phi * r_y
+    rvw[1, 0] = cos_phi * v_x - sin_phi * v_y
+    rvw[1, 1] = sin_phi * v_x + cos_phi * v_y
+    rvw[1, 2] = v_z
+    rvw[2, 0] = cos_phi * w_x - sin_phi * w_y
+    rvw[2, 1] = sin_phi * w_x + cos_phi * w_y
+    rvw[2, 2] = _perpendicular_spin(rvw[2, 2], R, u_sp, g, t)
+
+
+@cuda.jit(device=True)
+def _evolve_roll(rvw, R, u_r, u_sp, g, t):
+    """See :func:`pooltool.physics.evolve.evolve_roll_state` (in place)"""
+    if t == 0:
+        return
+
+    v = _norm3d(rvw[1, 0], rvw[1, 1], rvw[1, 2])
+    a = u_r * g
+
+    for k in range(3):
+        v_hat = rvw[1, k] / v
+        rvw[0, k] += rvw[1, k] * t - 0.5 * a * t**2 * v_hat
+        rvw[1, k] -= a * t * v_hat
+
+    # Angular velocity is locked to velocity, except for the independent z spin
+    cos_phi = math.cos(math.pi / 2)
+    sin_phi = math.sin(math.pi / 2)
+    rvw[2, 0] = cos_phi * rvw[1, 0] / R - sin_phi * rvw[1, 1] / R
+    rvw[2, 1] = sin_phi * rvw[1, 0] / R + cos_phi * rvw[1, 1] / R
+    rvw[2, 2] = _perpendicular_spin(rvw[2, 2], R, u_sp, g, t)
+
+
+@cuda.jit(device=True)
+def _evolve(rvw, s, R, u_s, u_sp, u_r, g, t):
+    """See :func:`pooltool.physics.evolve.evolve_ball_motion` (in place)
+
+    The motion state isn't returned, since only transition events change it.
+    """
+    if s == const.sliding:
+        dtau_E_slide = _slide_time(rvw, R, u_s, g)
+
+        if t < dtau_E_slide:
+            _evolve_slide(rvw, R, u_s, u_sp, g, t)
+            return
+
+        _evolve_slide(rvw, R, u_s, u_sp, g, dtau_E_slide)
+        s = const.rolling
+        t -= dtau_E_slide
+
+    if s == const.rolling:
+        dtau_E_roll = _roll_time(rvw, u_r, g)
+
+        if t < dtau_E_roll:
+            _evolve_roll(rvw, R, u_r, u_sp, g, t)
+            return
+
+        _evolve_roll(rvw, R, u_r, u_sp, g, dtau_E_roll)
+        s = const.spinning
+        t -= dtau_E_roll
+
+    if s == const.spinning:
+        dtau_E_spin = _spin_time(rvw, R, u_sp, g)
+        rvw[2, 2] = _perpendicular_spin(rvw[2, 2], R, u_sp, g, min(t, dtau_E_spin))
+
+
+@cuda.jit(device=True)
+def _trajectory(rvw, s, R, mu, g):
+    """The planar acceleration and initial velocity of a translating ball
+
+    See :func:`pooltool.evolution.event_based.solve.ball_ball_collision_coeffs`.
+
+    Returns:
+        (ax, ay, bx, by)
+    """
+    phi = _angle_between(rvw[1, 0], rvw[1, 1], 1.0, 0.0)
+    v = _norm3d(rvw[1, 0], rvw[1, 1], rvw[1, 2])
+    cos_phi = math.cos(phi)
+    sin_phi = math.sin(phi)
+
+    # See pooltool.evolution.event_based.solve.get_u
+    u_x, u_y = 1.0, 0.0
+    if s != const.rolling:
+        rel_x = rvw[1, 0] - R * rvw[2, 1]
+        rel_y = rvw[1, 1] + R * rvw[2, 0]
+        rel_z = rvw[1, 2]
+        if rel_x != 0.0 or rel_y != 0.0 or rel_z != 0.0:
+            rel = _norm3d(rel_x, rel_y, rel_z)
+            u_x = cos_phi * (rel_x / rel) + sin_phi * (rel_y / rel)
+            u_y = -sin_phi * (rel_x / rel) + cos_phi * (rel_y / rel)
+
+    K = -0.5 * mu * g
+    return (
+        K * (u_x * cos_phi - u_y * sin_phi),
+        K * (u_x * sin_phi + u_y * cos_phi),
+        v * cos_phi,
+        v * sin_phi,
+    )
+
+
+@cuda.jit(device=True)
+def _horner(q0, q1, q2, q3, q4, x):
+    """See :func:`pooltool.ptmath.roots.quartic._horner`
+
+    Cubics are evaluated with a leading coefficient of 0.
+    """
+    f = q0
+    df = 0.0
+    df = df * x + f
+    f = f * x + q1
+    df = df * x + f
+    f = f * x + q2
+    df = df * x + f
+    f = f * x + q3
+    df = df * x + f
+    f = f * x + q4
+    return f, df
+
+
+@cuda.jit(device=True)
+def _monotone_root(q0, q1, q2, q3, q4, lo, hi, f_lo):
+    """See :func:`pooltool.ptmath.roots.quartic._monotone_root`"""
+    x = 0.5 * (lo + hi)
+
+    for _ in range(_MAX_ITERATIONS):
+        f, df = _horner(q0, q1, q2, q3, q4, x)
+        if f == 0.0:
+            return x
+
+        if (f < 0.0) == (f_lo < 0.0):
+            lo = x
+        else:
+            hi = x
+
+        if df != 0.0 and lo < x - f / df < hi:
+            x_new = x - f / df
+        else:
+            x_new = 0.5 * (lo + hi)
+
+        if abs(x_new - x) <= _XTOL * abs(x_new) or hi - lo <= _XTOL * hi:
+            return x_new
+
+        x = x_new
+
+    return x
+
+
+@cuda.jit(device=True)
+def _smallest_positive_root(a, b, c, d, e):
+    """See :func:`pooltool.ptmath.roots.quartic.smallest_positive_root`
+
+    Returns:
+        (root, flagged)
+    """
+    # This means t=0 is a root
+    if e == 0.0:
+        return 0.0, False
+
+    if a == 0.0 or not (
+        math.isfinite(a)
+        and math.isfinite(b)
+        and math.isfinite(c)
+        and math.isfinite(d)
+        and math.isfinite(e)
+    ):
+        return math.inf, True
+
+    upper = 1.0 + max(abs(b / a), abs(c / a), abs(d / a), abs(e / a))
+
+    # The cubic derivative is monotone between the roots of the second derivative
+    knots = cuda.local.array(4, dtype=np.float64)
+    knots[0] = 0.0
+    num_knots = 1
+
+    A, B, C = 12.0 * a, 6.0 * b, 2.0 * c
+    discriminant = B * B - 4.0 * A * C
+    if discriminant >= 0.0:
+        # Numerically stable form of the quadratic formula
+        q = -0.5 * (B + math.copysign(math.sqrt(discriminant), B))
+        r1 = q / A
+        r2 = C / q if q != 0.0 else r1
+        for r in (min(r1, r2), max(r1, r2)):
+            if 0.0 < r < upper and r > knots[num_knots - 1]:
+                knots[num_knots] = r
+                num_knots += 1
+
+    knots[num_knots] = upper
+    num_knots += 1
+
+    # The quartic is monotone between the roots of the cubic derivative (see
+    # pooltool.ptmath.roots.quartic._interval_roots)
+    critical = cuda.local.array(5, dtype=np.float64)
+    critical[0] = 0.0
+    num_critical = 1
+
+    for k in range(num_knots - 1):
+        lo, hi = knots[k], knots[k + 1]
+        f_lo, _ = _horner(0.0, 4.0 * a, 3.0 * b, 2.0 * c, d, lo)
+        f_hi, _ = _horner(0.0, 4.0 * a, 3.0 * b, 2.0 * c, d, hi)
+
+        if f_hi == 0.0:
+            critical[num_critical] = hi
+            num_critical += 1
+        elif f_lo != 0.0 and (f_lo < 0.0) != (f_hi < 0.0):
+            critical[num_critical] = _monotone_root(
+                0.0, 4.0 * a, 3.0 * b, 2.0 * c, d, lo, hi, f_lo
+            )
+            num_critical += 1
+
+    critical[num_critical] = upper
+    num_critical += 1
+
+    for k in range(num_critical - 1):
+        lo, hi = critical[k], critical[k + 1]
+        f_lo, _ = _horner(a, b, c, d, e, lo)
+        f_hi, _ = _horner(a, b, c, d, e, hi)
+
+        if f_hi == 0.0:
+            return hi, False
+
+        if (f_lo < 0.0) != (f_hi < 0.0):
+            return _monotone_root(a, b, c, d, e, lo, hi, f_lo), False
+
+        if k < num_critical - 2:
+            # The quartic doesn't cross zero, but it may have a (near) double root at
+            # the critical point
+            magnitude = abs(a) * hi**4 + abs(b) * hi**3 + abs(c) * hi**2
+            magnitude += abs(d) * hi + abs(e)
+            if abs(f_hi) <= _GRAZE_TOL * magnitude:
+                return math.inf, True
+
+    return math.inf, False
+
+
+@cuda.jit(device=True)
+def _next_ball_ball(rvw, s, params):
+    """The next ball-ball collision
+
+    Ball pairs are skipped like in
+    :func:`pooltool.evolution.event_based.batch._ball_ball_collision_coeffs`.
+
+    Returns:
+        (dtau_E, ball1, ball2, flagged)
+    """
+    num_balls = len(s)
+    best = math.inf
+    ball1, ball2 = -1, -1
+
+    for i in range(num_balls):
+        s1 = s[i]
+        R = params[i, packed.R]
+
+        for j in range(i + 1, num_balls):
+            s2 = s[j]
+
+            if s1 == const.pocketed or s2 == const.pocketed:
+                continue
+
+            if _nontranslating(s1) and _nontranslating(s2):
+                continue
+
+            distance = _norm3d(
+                rvw[i, 0, 0] - rvw[j, 0, 0],
+                rvw[i, 0, 1] - rvw[j, 0, 1],
+                rvw[i, 0, 2] - rvw[j, 0, 2],
+            )
+            if distance < R + params[j, packed.R]:
+                # If balls are intersecting, avoid internal collisions
+                continue
+
+            a1x, a1y, b1x, b1y = 0.0, 0.0, 0.0, 0.0
+            if not _nontranslating(s1):
+                a1x, a1y, b1x, b1y = _trajectory(
+                    rvw[i], s1, R, _mu(s1, params[i]), params[i, packed.G]
+                )
+
+            a2x, a2y, b2x, b2y = 0.0, 0.0, 0.0, 0.0
+            if not _nontranslating(s2):
+                a2x, a2y, b2x, b2y = _trajectory(
+                    rvw[j], s2, R, _mu(s2, params[j]), params[j, packed.G]
+                )
+
+            Ax, Ay = a2x - a1x, a2y - a1y
+            Bx, By = b2x - b1x, b2y - b1y
+            Cx, Cy = rvw[j, 0, 0] - rvw[i, 0, 0], rvw[j, 0, 1] - rvw[i, 0, 1]
+
+            root, flagged = _smallest_positive_root(
+                Ax**2 + Ay**2,
+                2 * Ax * Bx + 2 * Ay * By,
+                Bx**2 + 2 * Ax * Cx + 2 * Ay * Cy + By**2,
+                2 * Bx * Cx + 2 * By * Cy,
+                Cx**2 + Cy**2 - 4 * R**2,
+            )
+            if flagged:
+                return math.inf, -1, -1, True
+
+            if root < best:
+                best = root
+                ball1, ball2 = i, j
+
+    return best, ball1, ball2, False
+
+
+@cuda.jit(device=True)
+def _next_circle(rvw, s, params, centers, radii, pockets):
+    """The next ball-circular cushion (or ball-pocket, if ``pockets``) collision
+
+    See
+    :func:`pooltool.evolution.event_based.solve.ball_circular_cushion_collision_coeffs`
+    and :func:`pooltool.evolution.event_based.solve.ball_pocket_collision_coeffs`.
+
+    Returns:
+        (dtau_E, ball, other, flagged)
+    """
+    best = math.inf
+    ball, other = -1, -1
+
+    for i in range(len(s)):
+        if _nontranslating(s[i]):
+            continue
+
+        R = params[i, packed.R]
+        ax, ay, bx, by = _trajectory(
+            rvw[i], s[i], R, _mu(s[i], params[i]), params[i, packed.G]
+        )
+        cx, cy = rvw[i, 0, 0], rvw[i, 0, 1]
+
+        for j in range(len(radii)):
+            a, b = centers[j, 0], centers[j, 1]
+            r = radii[j] if pockets else radii[j] + R
+
+            root, flagged = _smallest_positive_root(
+                0.5 * (ax**2 + ay**2),
+                ax * bx + ay * by,
+                ax * (cx - a) + ay * (cy - b) + 0.5 * (bx**2 + by**2),
+                bx * (cx - a) + by * (cy - b),
+                0.5 * (a**2 + b**2 + cx**2 + cy**2 - r**2) - (cx * a + cy * b),
+            )
+            if flagged:
+                return math.inf, -1, -1, True
+
+            if root < best:
+                best = root
+                ball, other = i, j
+
+    return best, ball, other, False
+
+
+@cuda.jit(device=True)
+def _cushion_contact(rvw, s, root, p1, p2, mu, g, R, work):
+    """Whether a ball contacts a linear cushion segment (not its extension) at a root
+
+    See :func:`pooltool.evolution.event_based.solve.ball_linear_cushion_collision_time`.
+    """
+    if not (const.EPS < root < math.inf):
+        return False
+
+    for a in range(3):
+        for b in range(3):
+            work[a, b] = rvw[a, b]
+    _evolve(work, s, R, mu, 1, mu, g, root)
+
+    dot = 0.0
+    length_sq = 0.0
+    for a in range(3):
+        dot += (p1[a] - work[0, a]) * (p2[a] - p1[a])
+        length_sq += (p2[a] - p1[a]) ** 2
+
+    return 0 <= -dot / length_sq <= 1
+
+
+@cuda.jit(device=True)
+def _linear_cushion_time(rvw, s, A, B, C, p1, p2, mu, g, R, work):
+    """The earliest valid root of the quadratic At^2 + Bt + C = 0
+
+    See :func:`pooltool.ptmath.roots.quadratic.solve`.
+    """
+    if A == 0:
+        root1 = root2 = -C / B
+    else:
+        bp = B / 2
+        delta = bp * bp - A * C
+        if delta < 0:
+            return math.inf
+        root1 = (-bp - math.sqrt(delta)) / A
+        root2 = -root1 - B / A
+
+    min_time = math.inf
+    if _cushion_contact(rvw, s, root1, p1, p2, mu, g, R, work):
+        min_time = root1
+    if root2 < min_time and _cushion_contact(rvw, s, root2, p1, p2, mu, g, R, work):
+        min_time = root2
+
+    return min_time
+
+
+@cuda.jit(device=True)
+def _next_linear_cushion(rvw, s, params, lines, p1, p2, directions, work):
+    """The next ball-linear cushion collision
+
+    See
+    :func:`pooltool.evolution.event_based.batch._ball_linear_cushion_collision_times`.
+
+    Returns:
+        (dtau_E, ball, cushion)
+    """
+    best = math.inf
+    ball, cushion = 0, 0
+
+    for i in range(len(s)):
+        if _nontranslating(s[i]):
+            continue
+
+        R = params[i, packed.R]
+        mu = _mu(s[i], params[i])
+        g = params[i, packed.G]
+        ax, ay, bx, by = _trajectory(rvw[i], s[i], R, mu, g)
+        cx, cy = rvw[i, 0, 0], rvw[i, 0, 1]
+
+        for j in range(len(directions)):
+            lx, ly, l0 = lines[j, 0], lines[j, 1], lines[j, 2]
+            A = lx * ax + ly * ay
+            B = lx * bx + ly * by
+            offset = R * math.sqrt(lx**2 + ly**2)
+
+            # Direction 0 is the + side, 1 is the - side, and 2 is both
+            dtau_E = math.inf
+            for side in (1.0, -1.0):
+                if directions[j] == (1 if side > 0 else 0):
+                    continue
+                C = l0 + lx * cx + ly * cy + side * offset
+                root = _linear_cushion_time(
+                    rvw[i], s[i], A, B, C, p1[j], p2[j], mu, g, R, work
+                )
+                dtau_E = min(dtau_E, root)
+
+            if dtau_E < best:
+                best = dtau_E
+                ball, cushion = i, j
+
+    return best, ball, cushion
+
+
+@cuda.jit(device=True)
+def _resolve_ball_ball(rvw1, rvw2, R):
+    """Kiss and resolve a ball-ball collision (in place)
+
+    See :func:`pooltool.physics.resolve.ball_ball.core.ball_ball_kiss` and
+    :func:`pooltool.physics.resolve.ball_ball.frictionless_elastic._resolve_ball_ball`.
+    """
+    distance = _norm3d(
+        rvw2[0, 0] - rvw1[0, 0], rvw2[0, 1] - rvw1[0, 1], rvw2[0, 2] - rvw1[0, 2]
+    )
+    correction = 2 * R - distance + const.EPS_SPACE
+    for k in range(3):
+        n = (rvw2[0, k] - rvw1[0, k]) / distance
+        rvw2[0, k] += correction / 2 * n
+        rvw1[0, k] -= correction / 2 * n
+
+    distance = _norm3d(
+        rvw2[0, 0] - rvw1[0, 0], rvw2[0, 1] - rvw1[0, 1], rvw2[0, 2] - rvw1[0, 2]
+    )
+    n_x = (rvw2[0, 0] - rvw1[0, 0]) / distance
+    n_y = (rvw2[0, 1] - rvw1[0, 1]) / distance
+    n_z = (rvw2[0, 2] - rvw1[0, 2]) / distance
+
+    cos_phi = math.cos(math.pi / 2)
+    sin_phi = math.sin(math.pi / 2)
+    t_x = cos_phi * n_x - sin_phi * n_y
+    t_y = sin_phi * n_x + cos_phi * n_y
+    t_z = n_z
+
+    rel_x = rvw1[1, 0] - rvw2[1, 0]
+    rel_y = rvw1[1, 1] - rvw2[1, 1]
+    rel_z = rvw1[1, 2] - rvw2[1, 2]
+    v_mag = _norm3d(rel_x, rel_y, rel_z)
+    beta = _angle_between(rel_x, rel_y, n_x, n_y)
+    v_t = v_mag * math.sin(beta)
+    v_n = v_mag * math.cos(beta)
+
+    v2_x, v2_y, v2_z = rvw2[1, 0], rvw2[1, 1], rvw2[1, 2]
+    rvw1[1, 0] = t_x * v_t + v2_x
+    rvw1[1, 1] = t_y * v_t + v2_y
+    rvw1[1, 2] = t_z * v_t + v2_z
+    rvw2[1, 0] = n_x * v_n + v2_x
+    rvw2[1, 1] = n_y * v_n + v2_y
+    rvw2[1, 2] = n_z * v_n + v2_z
+
+
+@cuda.jit(device=True)
+def _han2005(rvw, n_x, n_y, R, m, h, e_c, f_c):
+    """See :func:`pooltool.physics.resolve.ball_cushion.han_2005.model.han2005`
+
+    Cushion normals have no z-component, so only the planar components are passed.
+    """
+    # orient the normal so it points away from playing surface
+    if n_x * rvw[1, 0] + n_y * rvw[1, 1] <= 0:
+        n_x, n_y = -n_x, -n_y
+
+    # Change from the table frame to the cushion frame. The cushion frame is defined by
+    # the normal vector is parallel with <1,0,0>.
+    psi = _angle_between(n_x, n_y, 1.0, 0.0)
+    cos_psi = math.cos(psi)
+    sin_psi = math.sin(psi)
+    for k in range(3):
+        x, y = rvw[k, 0], rvw[k, 1]
+        rvw[k, 0] = cos_psi * x + sin_psi * y
+        rvw[k, 1] = -sin_psi * x + cos_psi * y
+
+    # The incidence angle--called theta_0 in paper. The restitution and friction
+    # coefficients are constant (see han_2005.properties)
+    phi = _angle_between(rvw[1, 0], rvw[1, 1], 1.0, 0.0) % _TWO_PI
+    e = e_c
+    mu = f_c
+
+    # Depends on height of cushion relative to ball
+    theta_a = math.asin(h / R - 1)
+    sin_a = math.sin(theta_a)
+    cos_a = math.cos(theta_a)
+
+    # Eqs 14
+    sx = rvw[1, 0] * sin_a - rvw[1, 2] * cos_a + R * rvw[2, 1]
+    sy = -rvw[1, 1] - R * rvw[2, 2] * cos_a + R * rvw[2, 0] * sin_a
+    c = rvw[1, 0] * cos_a  # 2D assumption
+
+    # Eqs 16
+    II = 2 / 5 * m * R**2
+    A = 7 / 2 / m
+    B = 1 / m
+
+    # Eqs 17 & 20
+    PzE = (1 + e) * c / B
+    PzS = math.sqrt(sx**2 + sy**2) / A
+
+    if PzS <= PzE:
+        # Sliding and sticking case
+        PX = -sx / A * sin_a - (1 + e) * c / B * cos_a
+        PY = sy / A
+        PZ = sx / A * cos_a - (1 + e) * c / B * sin_a
+    else:
+        # Forward sliding case
+        PX = -mu * (1 + e) * c / B * math.cos(phi) * sin_a - (1 + e) * c / B * cos_a
+        PY = mu * (1 + e) * c / B * math.sin(phi)
+        PZ = mu * (1 + e) * c / B * math.cos(phi) * cos_a - (1 + e) * c / B * sin_a
+
+    # Update velocity
+    rvw[1, 0] += PX / m
+    rvw[1, 1] += PY / m
+
+    # Update angular velocity
+    rvw[2, 0] += -R / II * PY * sin_a
+    rvw[2, 1] += R / II * (PX * sin_a - PZ * cos_a)
+    rvw[2, 2] += R / II * PY * cos_a
+
+    # Change back to table reference frame
+    for k in range(3):
+        x, y = rvw[k, 0], rvw[k, 1]
+        rvw[k, 0] = cos_psi * x - sin_psi * y
+        rvw[k, 1] = sin_psi * x + cos_psi * y
+
+
+@cuda.jit(device=True)
+def _resolve_linear_cushion(rvw, p1, p2, normal, h, R, m, e_c, f_c):
+    """Kiss and resolve a ball-linear cushion collision (in place)
+
+    See :func:`pooltool.physics.resolve.ball_cushion.core.ball_linear_cushion_kiss`.
+    """
+    n_x, n_y = normal[0], normal[1]
+    sign = 1.0 if n_x * rvw[1, 0] + n_y * rvw[1, 1] > 0 else -1.0
+
+    # The point on the cushion line where contact should be made, at the ball's height
+    dot = 0.0
+    length_sq = 0.0
+    for k in range(3):
+        dot += (p1[k] - rvw[0, k]) * (p2[k] - p1[k])
+        length_sq += (p2[k] - p1[k]) ** 2
+    t = -dot / length_sq
+    c_x = p1[0] + (p2[0] - p1[0]) * t
+    c_y = p1[1] + (p2[1] - p1[1]) * t
+
+    # Move the ball to exactly meet the cushion
+    correction = R - _norm3d(rvw[0, 0] - c_x, rvw[0, 1] - c_y, 0.0) + const.EPS_SPACE
+    rvw[0, 0] -= correction * sign * n_x
+    rvw[0, 1] -= correction * sign * n_y
+
+    _han2005(rvw, n_x, n_y, R, m, h, e_c, f_c)
+
+
+@cuda.jit(device=True)
+def _resolve_circular_cushion(rvw, center, radius, h, R, m, e_c, f_c):
+    """Kiss and resolve a ball-circular cushion collision (in place)
+
+    See :func:`pooltool.physics.resolve.ball_cushion.core.ball_circular_cushion_kiss`.
+    """
+    d_x, d_y = rvw[0, 0] - center[0], rvw[0, 1] - center[1]
+    distance = _norm3d(d_x, d_y, 0.0)
+    n_x, n_y = d_x / distance, d_y / distance
+    sign = 1.0 if n_x * rvw[1, 0] + n_y * rvw[1, 1] > 0 else -1.0
+
+    correction = R + radius - distance - const.EPS_SPACE
+    rvw[0, 0] += correction * sign * n_x
+    rvw[0, 1] += correction * sign * n_y
+
+    d_x, d_y = rvw[0, 0] - center[0], rvw[0, 1] - center[1]
+    distance = _norm3d(d_x, d_y, 0.0)
+    _han2005(rvw, d_x / distance, d_y / distance, R, m, h, e_c, f_c)
+
+
+@cuda.jit(device=True)
+def _transition(rvw, code):
+    """Resolve a ball transition (in place), returning the new motion state
+
+    See :func:`pooltool.evolution.event_based.compiled._transition`.
+    """
+    if code == packed.EVENT_SLIDING_ROLLING:
+        return const.rolling
+
+    for k in range(3):
+        rvw[1, k] = 0.0
+    rvw[2, 0] = 0.0
+    rvw[2, 1] = 0.0
+
+    if code == packed.EVENT_ROLLING_SPINNING:
+        return const.spinning
+
+    rvw[2, 2] = 0.0
+    return const.stationary
+
+
+@cuda.jit(device=True)
+def _event_loop(
+    rvw,
+    s,
+    params,
+    t,
+    resolve,
+    t_final,
+    max_events,
+    linear_lines,
+    linear_p1,
+    linear_p2,
+    linear_normals,
+    linear_directions,
+    linear_heights,
+    circular_centers,
+    circular_radii,
+    circular_heights,
+    pocket_centers,
+    pocket_radii,
+    pocket_depths,
+    transition_time,
+    transition_code,
+    codes,
+    times,
+    first,
+    second,
+):
+    """Detect, evolve, and resolve the events of a system until it comes to rest
+
+    This mirrors :func:`pooltool.evolution.event_based.compiled._event_loop`, with
+    events detected in the same order and with the same tie-breaking.
+
+    Returns:
+        (num_events, stop)
+    """
+    num_balls = len(s)
+    work = cuda.local.array((3, 3), dtype=np.float64)
+
+    for i in range(num_balls):
+        dtau_E, code = _transition_time(
+            rvw[i],
+            s[i],
+            params[i, packed.R],
+            params[i, packed.U_S],
+            params[i, packed.U_SP],
+            params[i, packed.U_R],
+            params[i, packed.G],
+        )
+        transition_time[i] = t + dtau_E
+        transition_code[i] = code
+
+    k = 0
+
+    while True:
+        # Transitions
+        ball = 0
+        for i in range(1, num_balls):
+            if transition_time[i] < transition_time[ball]:
+                ball = i
+        time = transition_time[ball]
+        code = transition_code[ball]
+        other = -1
+
+        # Ball-ball
+        dtau_E, i, j, flagged = _next_ball_ball(rvw, s, params)
+        if flagged:
+            return k, STOP_FALLBACK
+        if i >= 0 and t + dtau_E < time:
+            time = t + dtau_E
+            code = packed.EVENT_BALL_BALL
+            ball, other = i, j
+
+        # Ball-linear cushion
+        dtau_E, i, j = _next_linear_cushion(
+            rvw, s, params, linear_lines, linear_p1, linear_p2, linear_directions, work
+        )
+        if t + dtau_E < time:
+            time = t + dtau_E
+            code = packed.EVENT_BALL_LINEAR_CUSHION
+            ball, other = i, j
+
+        # Ball-circular cushion
+        dtau_E, i, j, flagged = _next_circle(
+            rvw, s, params, circular_centers, circular_radii, False
+        )
+        if flagged:
+            return k, STOP_FALLBACK
+        if i >= 0 and t + dtau_E < time:
+            time = t + dtau_E
+            code = packed.EVENT_BALL_CIRCULAR_CUSHION
+            ball, other = i, j
+
+        # Ball-pocket
+        dtau_E, i, j, flagged = _next_circle(
+            rvw, s, params, pocket_centers, pocket_radii, True
+        )
+        if flagged:
+            return k, STOP_FALLBACK
+        if i >= 0 and t + dtau_E < time:
+            time = t + dtau_E
+            code = packed.EVENT_BALL_POCKET
+            ball, other = i, j
+
+        if time == math.inf:
+            return k, compiled.STOP_NO_EVENTS
+
+        # Evolve all balls to the event
+        dt = time - t
+        for i in range(num_balls):
+            _evolve(
+                rvw[i],
+                s[i],
+                params[i, packed.R],
+                params[i, packed.U_S],
+                params[i, packed.U_SP],
+                params[i, packed.U_R],
+                params[i, packed.G],
+                dt,
+            )
+        t_evolved = t + dt
+
+        if resolve[code]:
+            R = params[ball, packed.R]
+            m = params[ball, packed.M]
+            e_c = params[ball, packed.E_C]
+            f_c = params[ball, packed.F_C]
+
+            if code == packed.EVENT_BALL_BALL:
+                _resolve_ball_ball(rvw[ball], rvw[other], R)
+                s[ball] = const.sliding
+                s[other] = const.sliding
+            elif code == packed.EVENT_BALL_LINEAR_CUSHION:
+                _resolve_linear_cushion(
+                    rvw[ball],
+                    linear_p1[other],
+                    linear_p2[other],
+                    linear_normals[other],
+                    linear_heights[other],
+                    R,
+                    m,
+                    e_c,
+                    f_c,
+                )
+                s[ball] = const.sliding
+            elif code == packed.EVENT_BALL_CIRCULAR_CUSHION:
+                _resolve_circular_cushion(
+                    rvw[ball],
+                    circular_centers[other],
+                    circular_radii[other],
+                    circular_heights[other],
+                    R,
+                    m,
+                    e_c,
+                    f_c,
+                )
+                s[ball] = const.sliding
+            elif code == packed.EVENT_BALL_POCKET:
+                # Ball is placed at the pocket center
+                for a in range(3):
+                    for b in range(3):
+                        rvw[ball, a, b] = 0.0
+                rvw[ball, 0, 0] = pocket_centers[other, 0]
+                rvw[ball, 0, 1] = pocket_centers[other, 1]
+                rvw[ball, 0, 2] = -pocket_depths[other]
+                s[ball] = const.pocketed
+            else:
+                s[ball] = _transition(rvw[ball], code)
+
+            # Colliding balls are timestamped with the event time, whereas
+            # transitioning balls keep the time they were evolved to
+            t_ball = t_evolved if code >= packed.EVENT_SPINNING_STATIONARY else time
+
+            for j in (ball, other if code == packed.EVENT_BALL_BALL else -1):
+                if j < 0:
+                    continue
+                dtau_E, transition = _transition_time(
+                    rvw[j],
+                    s[j],
+                    params[j, packed.R],
+                    params[j, packed.U_S],
+                    params[j, packed.U_SP],
+                    params[j, packed.U_R],
+                    params[j, packed.G],
+                )
+                transition_time[j] = t_ball + dtau_E
+                transition_code[j] = transition
+
+        codes[k] = code
+        times[k] = time
+        first[k] = ball
+        second[k] = other
+        t = time
+        k += 1
+
+        if t >= t_final:
+            return k, compiled.STOP_T_FINAL
+
+        if k - 1 > max_events:
+            return k, compiled.STOP_MAX_EVENTS
+
+
+@cuda.jit
+def _kernel(
+    rvw,
+    s,
+    params,
+    t,
+    resolve,
+    t_final,
+    max_events,
+    linear_lines,
+    linear_p1,
+    linear_p2,
+    linear_normals,
+    linear_directions,
+    linear_heights,
+    circular_centers,
+    circular_radii,
+    circular_heights,
+    pocket_centers,
+    pocket_radii,
+    pocket_depths,
+    transition_time,
+    transition_code,
+    num_events,
+    stops,
+    codes,
+    times,
+    first,
+    second,
+):
+    """Run the event loop of each system, one system per thread"""
+    n = cuda.grid(1)
+    if n >= len(t):
+        return
+
+    num_events[n], stops[n] = _event_loop(
+        rvw[n],
+        s[n],
+        params[n],
+        t[n],
+        resolve,
+        t_final,
+        max_events,
+        linear_lines,
+        linear_p1,
+        linear_p2,
+        linear_normals,
+        linear_directions,
+        linear_heights,
+        circular_centers,
+        circular_radii,
+        circular_heights,
+        pocket_centers,
+        pocket_radii,
+        pocket_depths,
+        transition_time[n],
+        transition_code[n],
+        codes[n],
+        times[n],
+        first[n],
+        second[n],
+    )
@@ -0,0 +1,301 @@
+"""Memoized simulation of nearly identical shots
+
+AI search and shot previews tend to simulate the same shot over and over: the same cue
+parameters retried from the same table state, or an aim that barely moved. A
+:class:`SimulationCache` sits in front of
+:func:`pooltool.evolution.event_based.simulate.simulate`, and returns the stored result
+when a shot matches one it has already simulated.
+
+Shots are matched by a hash of their quantized pre-shot state: the ball states and cue
+parameters (``V0``, ``phi``, ``theta``, ``a``, and ``b``) are rounded to multiples of
+configurable tolerances (see :class:`Tolerances`), while the ball parameters, cue
+specs, table geometry, resolver config, and simulation options must match exactly. A
+hit therefore returns the simulation of a shot that may differ from the requested one
+by up to the tolerances.
+
+Results are kept in memory (least recently used first out), and optionally on disk, so
+that they outlive the process. Hits and misses are counted, both by the cache and by the
+instrumentation layer (see :class:`pooltool.instrumentation.SimulationStats`).
+"""
+
+from __future__ import annotations
+
+import hashlib
+from collections import OrderedDict
+from pathlib import Path
+from typing import Dict, Optional, Set
+
+import attrs
+import numpy as np
+from numpy.typing import NDArray
+
+import pooltool.evolution.event_based.packed as packed
+import pooltool.instrumentation as instrumentation
+from pooltool.events import EventType
+from pooltool.evolution.event_based.broadphase import BroadPhase
+from pooltool.evolution.event_based.config import INCLUDED_EVENTS
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.physics.resolve.resolver import Resolver, ResolverConfig
+from pooltool.ptmath.roots.quartic import QuarticSolver
+from pooltool.serialize import Pathish
+from pooltool.system.datatypes import System
+
+
+@attrs.define(frozen=True)
+class Tolerances:
+    """The quantization tolerances of shot matching
+
+    Each quantity is rounded to the nearest multiple of its tolerance, so shots whose
+    quantities differ by less than a tolerance usually (but not always, since they may
+    round to either side of a boundary) match. A tolerance of 0 requires an exact match.
+
+    Attributes:
+        position:
+            Ball positions, in *m*.
+        velocity:
+            Ball velocities, in *m/s*.
+        angular_velocity:
+            Ball angular velocities, in *rad/s*.
+        V0:
+            The cue's impact speed, in *m/s*.
+        angle:
+            The cue angles ``phi`` and ``theta``, in degrees.
+        offset:
+            The cue's spin offsets ``a`` and ``b``.
+    """
+
+    position: float = attrs.field(default=1e-6)
+    velocity: float = attrs.field(default=1e-6)
+    angular_velocity: float = attrs.field(default=1e-4)
+    V0: float = attrs.field(default=1e-6)
+    angle: float = attrs.field(default=1e-6)
+    offset: float = attrs.field(default=1e-6)
+
+
+def _quantize(values: NDArray[np.float64], tolerance: float) -> bytes:
+    """Round values to multiples of a tolerance, as bytes"""
+    values = np.ascontiguousarray(values, dtype=np.float64)
+    if tolerance == 0:
+        return values.tobytes()
+
+    return np.round(values / tolerance).astype(np.int64).tobytes()
+
+
+class SimulationCache:
+    """A memoization cache of simulated shots
+
+    Each result is returned as a copy (see
+    :meth:`pooltool.system.datatypes.System.copy`), so modifying it doesn't modify the
+    stored result. The copy is cheap, since ball histories are copy-on-write and the
+    events are shared. To skip even that, see the
+    ``copy`` argument of :meth:`simulate`.
+
+    Args:
+        maxsize:
+            The number of results kept in memory. Once it's exceeded, the least
+            recently used result is dropped. Pass None to keep every result.
+        directory:
+            If passed, results are also saved to (and looked up in) this directory, so
+            they persist between processes.
+        tolerances:
+            The quantization tolerances used to match shots.
+
+    Example:
+
+        Preview a shot as the aim barely moves:
+
+        >>> import pooltool as pt
+        >>> cache = pt.SimulationCache()
+        >>> system = pt.System.example()
+        >>> for dphi in (0, 1e-8, 2e-8):
+        >>>     system.cue.set_state(phi=90 + dphi)
+        >>>     preview = cache.simulate(system)
+        >>> cache.hits, cache.misses
+        (2, 1)
+    """
+
+    def __init__(
+        self,
+        maxsize: Optional[int] = 1024,
+        directory: Optional[Pathish] = None,
+        tolerances: Tolerances = Tolerances(),
+    ) -> None:
+        self.maxsize = maxsize
+        self.directory = None if directory is None else Path(directory)
+        self.tolerances = tolerances
+        self.hits = 0
+        self.misses = 0
+
+        if self.directory is not None:
+            self.directory.mkdir(parents=True, exist_ok=True)
+
+        self._results: OrderedDict[str, System] = OrderedDict()
+        self._engines: Dict[str, PhysicsEngine] = {}
+        self._default_config: Optional[ResolverConfig] = None
+
+    def __len__(self) -> int:
+        return len(self._results)
+
+    def clear(self) -> None:
+        """Drop the results kept in memory (saved results are kept)"""
+        self._results.clear()
+
+    def simulate(
+        self,
+        shot: System,
+        config: Optional[ResolverConfig] = None,
+        copy: bool = True,
+        continuous: bool = False,
+        dt: Optional[float] = None,
+        t_final: Optional[float] = None,
+        quartic_solver: QuarticSolver = QuarticSolver.HYBRID,
+        include: Set[EventType] = INCLUDED_EVENTS,
+        max_events: int = 0,
+        cache_collisions: bool = False,
+        broadphase: BroadPhase = BroadPhase.EXHAUSTIVE,
+    ) -> System:
+        """Simulate a shot, or return the result of a matching shot
+
+        Args:
+            shot:
+                The system to simulate. It's left unmodified.
+            config:
+                The resolver config of the physics engine (see
+                :class:`pooltool.physics.resolve.resolver.ResolverConfig`). By default,
+                the default engine's config is used.
+            copy:
+                By default, a copy of the stored result is returned. If False, the
+                stored result itself is returned, which is shared with every shot that
+                matches it and must not be modified (nor its events, which copies
+                share).
+
+        The remaining arguments are the same as those of
+        :func:`pooltool.evolution.event_based.simulate.simulate`.
+
+        Returns:
+            System: The simulated system.
+        """
+        if config is None:
+            if self._default_config is None:
+                self._default_config = ResolverConfig.default()
+            config = self._default_config
+
+        options = (
+            continuous,
+            dt,
+            t_final,
+            str(quartic_solver),
+            sorted(str(event_type) for event_type in include),
+            max_events,
+            cache_collisions,
+            str(broadphase),
+        )
+        key = self.key(shot, config, repr(options))
+
+        result = self._get(key)
+        stats = instrumentation.active
+        if stats is not None:
+            stats.record_cache(result is not None)
+
+        if result is not None:
+            self.hits += 1
+            return result.copy() if copy else result
+
+        self.misses += 1
+
+        config_key = repr(config)
+        if config_key not in self._engines:
+            self._engines[config_key] = PhysicsEngine(
+                resolver=Resolver.from_config(config)
+            )
+
+        result = simulate(
+            shot,
+            engine=self._engines[config_key],
+            continuous=continuous,
+            dt=dt,
+            t_final=t_final,
+            quartic_solver=quartic_solver,
+            include=include,
+            max_events=max_events,
+            cache_collisions=cache_collisions,
+            broadphase=broadphase,
+        )
+        self._put(key, result)
+
+        return result.copy() if copy else result
+
+    def key(self, shot: System, config: ResolverConfig, options: str = "") -> str:
+        """The hash that matches shots
+
+        Args:
+            shot:
+                The shot.
+            config:
+                The resolver config of the physics engine.
+            options:
+                A representation of the simulation options.
+
+        Returns:
+            str: A hex digest.
+        """
+        tol = self.tolerances
+        digest = hashlib.blake2b(digest_size=16)
+
+        def _update(part: object) -> None:
+            digest.update(part if isinstance(part, bytes) else repr(part).encode())
+
+        balls = list(shot.balls.values())
+        rvw, s = packed.pack_ball_states(balls)
+        _update(tuple(shot.balls))
+        _update(_quantize(rvw[:, 0], tol.position))
+        _update(_quantize(rvw[:, 1], tol.velocity))
+        _update(_quantize(rvw[:, 2], tol.angular_velocity))
+        _update(s.tobytes())
+        _update([attrs.astuple(ball.params) for ball in balls])
+
+        cue = shot.cue
+        _update((cue.cue_ball_id, attrs.astuple(cue.specs)))
+        _update(_quantize(np.array([cue.V0]), tol.V0))
+        _update(_quantize(np.array([cue.phi % 360, cue.theta]), tol.angle))
+        _update(_quantize(np.array([cue.a, cue.b]), tol.offset))
+
+        pockets = shot.table.pockets.items()
+        table = packed.PackedTable.from_table(shot.table)
+        for value in attrs.astuple(table, recurse=False):
+            _update(value.tobytes() if isinstance(value, np.ndarray) else value)
+        _update([(pocket_id, sorted(pocket.contains)) for pocket_id, pocket in pockets])
+
+        _update(config)
+        _update(options)
+
+        return digest.hexdigest()
+
+    def _get(self, key: str) -> Optional[System]:
+        if key in self._results:
+            self._results.move_to_end(key)
+            return self._results[key]
+
+        path = self._path(key)
+        if path is None or not path.exists():
+            return None
+
+        result = System.load(path)
+        self._remember(key, result)
+        return result
+
+    def _put(self, key: str, result: System) -> None:
+        self._remember(key, result)
+
+        path = self._path(key)
+        if path is not None:
+            result.save(path)
+
+    def _remember(self, key: str, result: System) -> None:
+        self._results[key] = result
+        if self.maxsize is not None and len(self._results) > self.maxsize:
+            self._results.popitem(last=False)
+
+    def _path(self, key: str) -> Optional[Path]:
+        return None if self.directory is None else self.directory / f"{key}.msgpack"
@@ -0,0 +1,294 @@
+"""Struct-of-arrays representations of the system
+
+The event-based algorithm in :mod:`pooltool.evolution.event_based.simulate` operates on
+``attrs`` objects (:class:`pooltool.objects.ball.datatypes.Ball`,
+:class:`pooltool.objects.table.components.Pocket`, etc). That's convenient, but it
+means data lives in Python objects that can't be handed to just-in-time compiled code.
+
+This module packs balls and table geometry into flat ``float64`` arrays so that many
+candidate collisions (across many balls, and possibly across many systems) can be
+processed by compiled kernels in a single call.
+"""
+
+from __future__ import annotations
+
+from typing import Dict, Sequence, Tuple
+
+import attrs
+import numpy as np
+from numpy.typing import NDArray
+
+from pooltool.events import (
+    Event,
+    EventType,
+    ball_ball_collision,
+    ball_circular_cushion_collision,
+    ball_linear_cushion_collision,
+    ball_pocket_collision,
+    rolling_spinning_transition,
+    rolling_stationary_transition,
+    sliding_rolling_transition,
+    spinning_stationary_transition,
+)
+from pooltool.objects.ball.datatypes import Ball
+from pooltool.objects.table.datatypes import Table
+from pooltool.system.datatypes import System
+
+# Column indices of packed ball parameter arrays (see pack_ball_params)
+R = 0
+M = 1
+U_S = 2
+U_SP = 3
+U_R = 4
+G = 5
+E_C = 6
+F_C = 7
+NUM_BALL_PARAMS = 8
+
+# Integer codes for event types, for use in compiled code. The order follows the
+# declaration order of EventType
+EVENT_NONE = 0
+EVENT_BALL_BALL = 1
+EVENT_BALL_LINEAR_CUSHION = 2
+EVENT_BALL_CIRCULAR_CUSHION = 3
+EVENT_BALL_POCKET = 4
+EVENT_STICK_BALL = 5
+EVENT_SPINNING_STATIONARY = 6
+EVENT_ROLLING_STATIONARY = 7
+EVENT_ROLLING_SPINNING = 8
+EVENT_SLIDING_ROLLING = 9
+
+CODE_TO_EVENT_TYPE: Tuple[EventType, ...] = tuple(EventType)
+EVENT_TYPE_TO_CODE: Dict[EventType, int] = {
+    event_type: code for code, event_type in enumerate(CODE_TO_EVENT_TYPE)
+}
+
+
+def pack_ball_params(balls: Sequence[Ball]) -> NDArray[np.float64]:
+    """Pack the parameters of balls into a (len(balls), NUM_BALL_PARAMS) array
+
+    Columns are indexed with the module constants :data:`R`, :data:`M`, :data:`U_S`,
+    :data:`U_SP`, :data:`U_R`, :data:`G`, :data:`E_C`, and :data:`F_C`.
+    """
+    params = np.empty((len(balls), NUM_BALL_PARAMS), dtype=np.float64)
+
+    for i, ball in enumerate(balls):
+        params[i, R] = ball.params.R
+        params[i, M] = ball.params.m
+        params[i, U_S] = ball.params.u_s
+        params[i, U_SP] = ball.params.u_sp
+        params[i, U_R] = ball.params.u_r
+        params[i, G] = ball.params.g
+        params[i, E_C] = ball.params.e_c
+        params[i, F_C] = ball.params.f_c
+
+    return params
+
+
+def pack_ball_states(
+    balls: Sequence[Ball],
+) -> Tuple[NDArray[np.float64], NDArray[np.int64]]:
+    """Pack the kinematic states and motion states of balls into arrays
+
+    Returns:
+        (rvw, s):
+            ``rvw`` has shape (len(balls), 3, 3) and ``s`` has shape (len(balls),). The
+            arrays are copies, so modifying them leaves the balls untouched.
+    """
+    rvw = np.empty((len(balls), 3, 3), dtype=np.float64)
+    s = np.empty(len(balls), dtype=np.int64)
+
+    for i, ball in enumerate(balls):
+        rvw[i] = ball.state.rvw
+        s[i] = ball.state.s
+
+    return rvw, s
+
+
+@attrs.define(frozen=True)
+class PackedTable:
+    """The collision geometry of a table, packed into arrays
+
+    Each cushion segment (or pocket) collection is ordered identically to its
+    dictionary in the source :class:`pooltool.objects.table.datatypes.Table`, and the
+    corresponding IDs are stored alongside, so that index ``i`` of any array refers to
+    the object with ID ``*_ids[i]``.
+
+    Attributes:
+        linear_ids:
+            IDs of the linear cushion segments.
+        linear_lines:
+            (L, 3) array of the 2D general form line coefficients ``lx``, ``ly``, and
+            ``l0`` (see :meth:`pooltool.objects.table.components.LinearCushionSegment.lx`).
+        linear_p1:
+            (L, 3) array of segment start points.
+        linear_p2:
+            (L, 3) array of segment end points.
+        linear_normals:
+            (L, 3) array of (arbitrarily directed) segment normals.
+        linear_directions:
+            (L,) array of :class:`pooltool.objects.table.components.CushionDirection`
+            values.
+        linear_heights:
+            (L,) array of segment heights.
+        circular_ids:
+            IDs of the circular cushion segments.
+        circular_centers:
+            (C, 3) array of circular cushion segment centers.
+        circular_radii:
+            (C,) array of circular cushion segment radii.
+        circular_heights:
+            (C,) array of circular cushion segment heights.
+        pocket_ids:
+            IDs of the pockets.
+        pocket_centers:
+            (P, 3) array of pocket centers.
+        pocket_radii:
+            (P,) array of pocket radii.
+        pocket_depths:
+            (P,) array of pocket depths.
+    """
+
+    linear_ids: Tuple[str, ...]
+    linear_lines: NDArray[np.float64]
+    linear_p1: NDArray[np.float64]
+    linear_p2: NDArray[np.float64]
+    linear_normals: NDArray[np.float64]
+    linear_directions: NDArray[np.int64]
+    linear_heights: NDArray[np.float64]
+    circular_ids: Tuple[str, ...]
+    circular_centers: NDArray[np.float64]
+    circular_radii: NDArray[np.float64]
+    circular_heights: NDArray[np.float64]
+    pocket_ids: Tuple[str, ...]
+    pocket_centers: NDArray[np.float64]
+    pocket_radii: NDArray[np.float64]
+    pocket_depths: NDArray[np.float64]
+
+    def matches(self, other: PackedTable) -> bool:
+        """Whether two packed tables have identical collision geometry"""
+        if (
+            self.linear_ids != other.linear_ids
+            or self.circular_ids != other.circular_ids
+            or self.pocket_ids != other.pocket_ids
+        ):
+            return False
+
+        return all(
+            np.array_equal(getattr(self, name), getattr(other, name))
+            for name in (
+                "linear_lines",
+                "linear_p1",
+                "linear_p2",
+                "linear_directions",
+                "linear_heights",
+                "circular_centers",
+                "circular_radii",
+                "circular_heights",
+                "pocket_centers",
+                "pocket_radii",
+                "pocket_depths",
+            )
+        )
+
+    @classmethod
+    def from_table(cls, table: Table) -> PackedTable:
+        linear = list(table.cushion_segments.linear.values())
+        circular = list(table.cushion_segments.circular.values())
+        pockets = list(table.pockets.values())
+
+        return cls(
+            linear_ids=tuple(cushion.id for cushion in linear),
+            linear_lines=np.array(
+                [[cushion.lx, cushion.ly, cushion.l0] for cushion in linear],
+                dtype=np.float64,
+            ).reshape(-1, 3),
+            linear_p1=np.array(
+                [cushion.p1 for cushion in linear], dtype=np.float64
+            ).reshape(-1, 3),
+            linear_p2=np.array(
+                [cushion.p2 for cushion in linear], dtype=np.float64
+            ).reshape(-1, 3),
+            linear_normals=np.array(
+                [cushion.normal for cushion in linear], dtype=np.float64
+            ).reshape(-1, 3),
+            linear_directions=np.array(
+                [cushion.direction for cushion in linear], dtype=np.int64
+            ),
+            linear_heights=np.array(
+                [cushion.height for cushion in linear], dtype=np.float64
+            ),
+            circular_ids=tuple(cushion.id for cushion in circular),
+            circular_centers=np.array(
+                [cushion.center for cushion in circular], dtype=np.float64
+            ).reshape(-1, 3),
+            circular_radii=np.array(
+                [cushion.radius for cushion in circular], dtype=np.float64
+            ),
+            circular_heights=np.array(
+                [cushion.height for cushion in circular], dtype=np.float64
+            ),
+            pocket_ids=tuple(pocket.id for pocket in pockets),
+            pocket_centers=np.array(
+                [pocket.center for pocket in pockets], dtype=np.float64
+            ).reshape(-1, 3),
+            pocket_radii=np.array(
+                [pocket.radius for pocket in pockets], dtype=np.float64
+            ),
+            pocket_depths=np.array(
+                [pocket.depth for pocket in pockets], dtype=np.float64
+            ),
+        )
+
+
+def unpack_event(
+    shot: System,
+    code: int,
+    first: int,
+    second: int,
+    time: float,
+    ball_ids: Tuple[str, ...],
+    table: PackedTable,
+) -> Event:
+    """Create the Event corresponding to a packed event
+
+    Args:
+        shot:
+            The system the event belongs to.
+        code:
+            The event type code (see :data:`EVENT_TYPE_TO_CODE`).
+        first:
+            The index of the (first) ball.
+        second:
+            The index of the other ball (ball-ball), the cushion segment, or the
+            pocket. Ignored for transitions.
+        time:
+            The event time.
+        ball_ids:
+            The ball IDs, in packed order.
+        table:
+            The packed table geometry of the system.
+    """
+    ball = shot.balls[ball_ids[first]]
+
+    if code == EVENT_BALL_BALL:
+        return ball_ball_collision(ball, shot.balls[ball_ids[second]], time)
+    elif code == EVENT_BALL_LINEAR_CUSHION:
+        cushion = shot.table.cushion_segments.linear[table.linear_ids[second]]
+        return ball_linear_cushion_collision(ball, cushion, time)
+    elif code == EVENT_BALL_CIRCULAR_CUSHION:
+        cushion = shot.table.cushion_segments.circular[table.circular_ids[second]]
+        return ball_circular_cushion_collision(ball, cushion, time)
+    elif code == EVENT_BALL_POCKET:
+        pocket = shot.table.pockets[table.pocket_ids[second]]
+        return ball_pocket_collision(ball, pocket, time)
+    elif code == EVENT_SPINNING_STATIONARY:
+        return spinning_stationary_transition(ball, time)
+    elif code == EVENT_ROLLING_STATIONARY:
+        return rolling_stationary_transition(ball, time)
+    elif code == EVENT_ROLLING_SPINNING:
+        return rolling_spinning_transition(ball, time)
+    elif code == EVENT_SLIDING_ROLLING:
+        return sliding_rolling_transition(ball, time)
+
+    raise NotImplementedError(f"Unknown event code '{code}'")
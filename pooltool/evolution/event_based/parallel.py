@@ -0,0 +1,304 @@
+"""Simulate many systems across multiple cores
+
+:func:`simulate_many` farms systems out to a pool of workers, each of which runs
+:func:`pooltool.evolution.event_based.simulate.simulate`.
+
+For process pools, the table and physics engine are sent to each worker once, when the
+worker starts, rather than being pickled alongside every system. Each system is then
+sent as a small payload (cue, balls, and which balls each pocket contains), and the
+simulated balls and events are sent back and reassembled into a system in the parent
+process.
+"""
+
+from __future__ import annotations
+
+import os
+from collections import deque
+from concurrent.futures import ProcessPoolExecutor, ThreadPoolExecutor
+from itertools import chain
+from typing import Any, Deque, Dict, Iterable, Iterator, List, Optional, Set
+
+import attrs
+import numpy as np
+
+from pooltool.events import Event, EventType
+from pooltool.evolution.event_based.config import INCLUDED_EVENTS
+from pooltool.evolution.event_based.simulate import DEFAULT_ENGINE, simulate
+from pooltool.evolution.event_based.stop import StopCondition
+from pooltool.objects.ball.datatypes import Ball
+from pooltool.objects.cue.datatypes import Cue
+from pooltool.objects.table.datatypes import Table
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.ptmath.roots.quartic import QuarticSolver
+from pooltool.system.datatypes import System
+from pooltool.utils.strenum import StrEnum, auto
+
+
+class PoolType(StrEnum):
+    """The type of worker pool used by :func:`simulate_many`
+
+    Attributes:
+        PROCESS:
+            A pool of processes. Systems are pickled to and from the workers, but the
+            simulations run fully in parallel.
+        THREAD:
+            A pool of threads. Nothing is pickled, but only the just-in-time compiled
+            kernels (which release the GIL) run in parallel.
+    """
+
+    PROCESS = auto()
+    THREAD = auto()
+
+
+def simulate_many(
+    shots: Iterable[System],
+    workers: Optional[int] = None,
+    pool: PoolType = PoolType.PROCESS,
+    engine: Optional[PhysicsEngine] = None,
+    chunksize: int = 1,
+    continuous: bool = False,
+    dt: Optional[float] = None,
+    t_final: Optional[float] = None,
+    quartic_solver: QuarticSolver = QuarticSolver.HYBRID,
+    include: Set[EventType] = INCLUDED_EVENTS,
+    max_events: int = 0,
+    stop: Optional[StopCondition] = None,
+) -> Iterator[System]:
+    """Simulate many systems in parallel
+
+    Simulated systems are yielded in submission order, each as soon as it (and all
+    systems submitted before it) has finished. The passed systems are never modified.
+
+    Args:
+        shots:
+            The systems you would like simulated.
+        workers:
+            The number of workers. By default, this is the number of CPUs.
+        pool:
+            Whether to use a pool of processes or threads. See :class:`PoolType`.
+        engine:
+            The engine holds all of the physics. See
+            :func:`pooltool.evolution.event_based.simulate.simulate`.
+        chunksize:
+            For process pools, the number of systems sent to a worker at a time. Larger
+            values reduce communication overhead when there are many short shots.
+        continuous:
+            See :func:`pooltool.evolution.event_based.simulate.simulate`.
+        dt:
+            See :func:`pooltool.evolution.event_based.simulate.simulate`.
+        t_final:
+            See :func:`pooltool.evolution.event_based.simulate.simulate`.
+        quartic_solver:
+            See :func:`pooltool.evolution.event_based.simulate.simulate`.
+        include:
+            See :func:`pooltool.evolution.event_based.simulate.simulate`.
+        max_events:
+            See :func:`pooltool.evolution.event_based.simulate.simulate`.
+        stop:
+            See :func:`pooltool.evolution.event_based.simulate.simulate`. With process
+            pools, the condition must be picklable.
+
+    Yields:
+        System: The simulated systems, in the same order they were passed.
+
+    Examples:
+        Simulate a sweep of cue angles on all cores:
+
+        >>> import pooltool as pt
+        >>> template = pt.System.example()
+        >>> shots = []
+        >>> for phi in range(0, 360, 10):
+        >>>     shot = template.copy()
+        >>>     shot.cue.set_state(phi=phi)
+        >>>     shots.append(shot)
+        >>> simulated = list(pt.simulate_many(shots, workers=4))
+
+    Notes:
+        - With process pools, worker processes import pooltool afresh. Compiled
+          kernels are loaded from the numba cache when
+          :data:`pooltool.constants.use_numba_cache` is True, otherwise each worker
+          compiles them upon its first shot.
+
+    See Also:
+        - :func:`pooltool.evolution.event_based.batch.simulate_batch`
+    """
+    assert PoolType(pool)
+
+    if not engine:
+        engine = DEFAULT_ENGINE
+
+    if workers is None:
+        workers = os.cpu_count() or 1
+
+    options: Dict[str, Any] = dict(
+        continuous=continuous,
+        dt=dt,
+        t_final=t_final,
+        quartic_solver=quartic_solver,
+        include=include,
+        max_events=max_events,
+        stop=stop,
+    )
+
+    if pool == PoolType.THREAD:
+        with ThreadPoolExecutor(max_workers=workers) as executor:
+            yield from executor.map(
+                lambda shot: simulate(shot, engine=engine, **options), shots
+            )
+        return
+
+    shots = iter(shots)
+    first = next(shots, None)
+    if first is None:
+        return
+
+    table = first.table
+
+    # The systems are needed again in the parent to reassemble the results, so hold on
+    # to them until their results arrive
+    submitted: Deque[System] = deque()
+
+    def _payloads() -> Iterator[_ShotPayload]:
+        for shot in chain([first], shots):
+            submitted.append(shot)
+            yield _ShotPayload.from_system(shot, table)
+
+    with ProcessPoolExecutor(
+        max_workers=workers,
+        initializer=_init_worker,
+        initargs=(table, engine, options),
+    ) as executor:
+        results = executor.map(_simulate_payload, _payloads(), chunksize=chunksize)
+        for result in results:
+            yield result.to_system(submitted.popleft())
+
+
+@attrs.define
+class _ShotPayload:
+    """What is sent to a worker process for each system"""
+
+    cue: Cue
+    balls: Dict[str, Ball]
+    contains: Dict[str, Set[str]]
+    table: Optional[Table] = None
+
+    @classmethod
+    def from_system(cls, shot: System, table: Table) -> _ShotPayload:
+        # Histories are reset by the simulation, so there is no point sending them
+        balls = {
+            ball_id: (
+                ball
+                if ball.history.empty and ball.history_cts.empty
+                else ball.copy(drop_history=True)
+            )
+            for ball_id, ball in shot.balls.items()
+        }
+
+        # Only send the table if its geometry differs from the worker's table
+        same_geometry = _same_geometry(shot.table, table)
+
+        return cls(
+            cue=shot.cue,
+            balls=balls,
+            contains={
+                pocket_id: pocket.contains
+                for pocket_id, pocket in shot.table.pockets.items()
+            },
+            table=None if same_geometry else shot.table,
+        )
+
+
+@attrs.define
+class _ShotResult:
+    """What is sent back from a worker process for each system"""
+
+    cue: Cue
+    balls: Dict[str, Ball]
+    t: float
+    events: List[Event]
+    contains: Dict[str, Set[str]]
+
+    def to_system(self, shot: System) -> System:
+        table = shot.table.copy()
+        for pocket_id, contains in self.contains.items():
+            table.pockets[pocket_id].contains.clear()
+            table.pockets[pocket_id].contains.update(contains)
+
+        return System(
+            cue=self.cue,
+            table=table,
+            balls=self.balls,
+            t=self.t,
+            events=self.events,
+        )
+
+
+def _same_geometry(table: Table, other: Table) -> bool:
+    """Whether two tables have the same cushion segments and pockets
+
+    Cushion segments are frozen, so copied tables share them (see
+    :meth:`pooltool.objects.table.datatypes.Table.copy`). Pockets are compared by
+    value, since :attr:`pooltool.objects.table.components.Pocket.contains` is mutable
+    and pockets are therefore copied.
+    """
+    if table is other:
+        return True
+
+    for segments, other_segments in (
+        (table.cushion_segments.linear, other.cushion_segments.linear),
+        (table.cushion_segments.circular, other.cushion_segments.circular),
+    ):
+        if segments.keys() != other_segments.keys():
+            return False
+        if any(segments[key] is not other_segments[key] for key in segments):
+            return False
+
+    if table.pockets.keys() != other.pockets.keys():
+        return False
+
+    for pocket_id, pocket in table.pockets.items():
+        other_pocket = other.pockets[pocket_id]
+        if (
+            not np.array_equal(pocket.center, other_pocket.center)
+            or pocket.radius != other_pocket.radius
+            or pocket.depth != other_pocket.depth
+        ):
+            return False
+
+    return True
+
+
+# State of a worker process, set once by _init_worker
+_worker_table: Optional[Table] = None
+_worker_engine: Optional[PhysicsEngine] = None
+_worker_options: Dict[str, Any] = {}
+
+
+def _init_worker(table: Table, engine: PhysicsEngine, options: Dict[str, Any]) -> None:
+    global _worker_table, _worker_engine, _worker_options
+    _worker_table = table
+    _worker_engine = engine
+    _worker_options = options
+
+
+def _simulate_payload(payload: _ShotPayload) -> _ShotResult:
+    assert _worker_table is not None
+
+    table = (_worker_table if payload.table is None else payload.table).copy()
+    for pocket_id, contains in payload.contains.items():
+        table.pockets[pocket_id].contains.clear()
+        table.pockets[pocket_id].contains.update(contains)
+
+    shot = System(cue=payload.cue, table=table, balls=payload.balls)
+    simulate(shot, engine=_worker_engine, inplace=True, **_worker_options)
+
+    return _ShotResult(
+        cue=shot.cue,
+        balls=shot.balls,
+        t=shot.t,
+        events=shot.events,
+        contains={
+            pocket_id: pocket.contains
+            for pocket_id, pocket in shot.table.pockets.items()
+        },
+    )
@@ -2,13 +2,16 @@
 
 from __future__ import annotations
 
-from itertools import combinations
-from typing import Dict, Optional, Set
+import heapq
+from itertools import combinations, product
+from typing import Dict, Hashable, Iterable, Iterator, List, Optional, Set, Tuple
 
 import attrs
 import numpy as np
+from numpy.typing import NDArray
 
 import pooltool.constants as const
+import pooltool.instrumentation as instrumentation
 import pooltool.physics.evolve as evolve
 import pooltool.ptmath as ptmath
 from pooltool.events import (
@@ -26,17 +29,25 @@ from pooltool.events import (
     spinning_stationary_transition,
     stick_ball_collision,
 )
-from pooltool.evolution.continuize import continuize
+from pooltool.evolution.continuize import Continuizer, continuize
 from pooltool.evolution.event_based import solve
+from pooltool.evolution.event_based.broadphase import (
+    BroadPhase,
+    SweepAndPrune,
+    skip_ball_ball,
+    skip_ball_linear_cushion,
+)
 from pooltool.evolution.event_based.config import INCLUDED_EVENTS
-from pooltool.objects.ball.datatypes import Ball, BallState
+from pooltool.evolution.event_based.fused import FusedDetector
+from pooltool.evolution.event_based.stop import StopCondition
+from pooltool.objects.ball.datatypes import Ball, BallHistory, BallState
 from pooltool.objects.table.components import (
     CircularCushionSegment,
     LinearCushionSegment,
     Pocket,
 )
 from pooltool.physics.engine import PhysicsEngine
-from pooltool.ptmath.roots.quartic import QuarticSolver
+from pooltool.ptmath.roots.quartic import QuarticSolver, minimum_quartic_roots
 from pooltool.system.datatypes import System
 
 DEFAULT_ENGINE = PhysicsEngine()
@@ -52,6 +63,9 @@ def simulate(
     quartic_solver: QuarticSolver = QuarticSolver.HYBRID,
     include: Set[EventType] = INCLUDED_EVENTS,
     max_events: int = 0,
+    cache_collisions: bool = False,
+    broadphase: BroadPhase = BroadPhase.EXHAUSTIVE,
+    stop: Optional[StopCondition] = None,
 ) -> System:
     """Run a simulation on a system and return it
 
@@ -85,6 +99,22 @@ def simulate(
         max_events:
             If this is greater than 0, and the shot has more than this many events, the
             simulation is stopped and the balls are set to stationary.
+        cache_collisions:
+            If True, collision predictions are cached between events (see
+            :class:`CollisionCache`), and after each event only the predictions
+            involving the event's balls are recalculated. This reduces the cost of each
+            event from quadratic to linear in the number of balls, which pays off for
+            systems with many balls (`e.g.` snooker breaks). Predictions are made from
+            the state at the time they are cached, so event times may differ from the
+            default (exhaustive) search in the last few digits.
+        broadphase:
+            How collision candidates are culled before their collision times are
+            solved for. See :class:`pooltool.evolution.event_based.broadphase.BroadPhase`.
+            When ``cache_collisions`` is True, predictions must remain valid beyond the
+            next event, so only the trajectory-based checks are used.
+        stop:
+            If set, the simulation ends as soon as this condition is met. It's checked
+            after each event. See :mod:`pooltool.evolution.event_based.stop`.
 
     Returns:
         System: The simulated system.
@@ -139,7 +169,320 @@ def simulate(
 
     shot.reset_history()
     shot._update_history(null_event(time=0))
+    _strike(shot, engine)
+
+    _evolve_until_done(
+        shot,
+        engine,
+        t_final=t_final,
+        quartic_solver=quartic_solver,
+        include=include,
+        max_events=max_events,
+        cache_collisions=cache_collisions,
+        broadphase=broadphase,
+        stop=stop,
+    )
+
+    if continuous:
+        continuize(shot, dt=0.01 if dt is None else dt, inplace=True)
+
+    return shot
+
+
+@attrs.define(frozen=True)
+class SimulationStep:
+    """An event of a shot, yielded by :func:`simulate_iter` as soon as it's resolved
+
+    Attributes:
+        system:
+            The system being simulated. Its history runs up to (and including) the
+            event.
+        event:
+            The resolved event.
+        states:
+            The state of each ball just after the event.
+        samples:
+            If continuized samples were asked for, the continuized states of each ball
+            that became final with this event (see
+            :class:`pooltool.evolution.continuize.Continuizer`). Otherwise, None.
+        final:
+            Whether this is the shot's last event.
+    """
+
+    system: System
+    event: Event
+    states: Dict[str, BallState]
+    samples: Optional[Dict[str, BallHistory]] = None
+    final: bool = False
+
+
+def simulate_iter(
+    shot: System,
+    engine: Optional[PhysicsEngine] = None,
+    inplace: bool = False,
+    continuous: bool = False,
+    dt: Optional[float] = None,
+    t_final: Optional[float] = None,
+    quartic_solver: QuarticSolver = QuarticSolver.HYBRID,
+    include: Set[EventType] = INCLUDED_EVENTS,
+    max_events: int = 0,
+    cache_collisions: bool = False,
+    broadphase: BroadPhase = BroadPhase.EXHAUSTIVE,
+    stop: Optional[StopCondition] = None,
+) -> Iterator[SimulationStep]:
+    """Simulate a system, yielding each event as soon as it's resolved
+
+    This runs the same simulation as :func:`simulate`, but rather than returning once
+    the shot's over, it yields a :class:`SimulationStep` for each event the system
+    records, in order (starting with the null event at time 0). Playback can therefore
+    start while later events are still being computed, and the simulation advances only
+    as fast as the steps are consumed.
+
+    With ``continuous``, each step also carries the continuized samples (see
+    :func:`pooltool.evolution.continuize.continuize`) that became final with its event:
+    those up to the event's time. The trajectories up to the time of the latest event
+    can't be changed by later events, so once the samples are yielded, they're final.
+    Once the last step is yielded, the system is what :func:`simulate` returns (its
+    continuized histories match those of ``continuize``, save for round-off).
+
+    Args:
+        shot:
+            See :func:`simulate`. Simulation starts at the first step, not when this is
+            called.
+
+    The remaining arguments are the same as those of :func:`simulate`.
+
+    Yields:
+        SimulationStep: The resolved events, in order.
+
+    Example:
+
+        Print the events of a shot as they're computed:
 
+        >>> import pooltool as pt
+        >>> for step in pt.simulate_iter(pt.System.example(), continuous=True):
+        >>>     print(f"{step.event.time:.3f}", step.event.event_type)
+
+    See Also:
+        - :func:`simulate`
+    """
+    if not inplace:
+        shot = shot.copy()
+
+    if not engine:
+        engine = DEFAULT_ENGINE
+
+    shot.reset_history()
+    shot._update_history(null_event(time=0))
+
+    continuizer = Continuizer(shot, 0.01 if dt is None else dt) if continuous else None
+
+    def _step(event: Event, final: bool) -> SimulationStep:
+        samples = None
+        if continuizer is not None:
+            samples = continuizer.update(event, final)
+            if final:
+                for ball_id, history in continuizer.histories().items():
+                    shot.balls[ball_id].history_cts = history
+
+        return SimulationStep(
+            system=shot,
+            event=event,
+            states={
+                ball_id: ball.history[-1].copy() for ball_id, ball in shot.balls.items()
+            },
+            samples=samples,
+            final=final,
+        )
+
+    yield _step(shot.events[0], False)
+
+    _strike(shot, engine)
+    if len(shot.events) > 1:
+        yield _step(shot.events[1], False)
+
+    for event, final in _evolve_iter(
+        shot,
+        engine,
+        t_final=t_final,
+        quartic_solver=quartic_solver,
+        include=include,
+        max_events=max_events,
+        cache_collisions=cache_collisions,
+        broadphase=broadphase,
+        stop=stop,
+    ):
+        yield _step(event, final)
+
+
+def resimulate(
+    shot: System,
+    event_index: int,
+    engine: Optional[PhysicsEngine] = None,
+    inplace: bool = False,
+    continuous: bool = False,
+    dt: Optional[float] = None,
+    t_final: Optional[float] = None,
+    quartic_solver: QuarticSolver = QuarticSolver.HYBRID,
+    include: Set[EventType] = INCLUDED_EVENTS,
+    max_events: int = 0,
+    cache_collisions: bool = False,
+    broadphase: BroadPhase = BroadPhase.EXHAUSTIVE,
+    stop: Optional[StopCondition] = None,
+) -> System:
+    """Re-simulate a simulated system from one of its events onward
+
+    The events up to and including ``shot.events[event_index]`` are kept, and the
+    simulation resumes from the ball states just after that event, which are the final
+    states of the event's agents (see :attr:`pooltool.events.datatypes.Agent.final`).
+    Only the events that follow are re-simulated, so sweeping a parameter that only
+    matters after some event costs only the part of the shot that diverges.
+
+    Unless ``inplace`` is True, the returned system shares the kept events and the kept
+    part of each ball's history with ``shot``. Histories are shared copy-on-write (see
+    :meth:`pooltool.objects.ball.datatypes.BallHistory.truncated`), so re-simulating
+    never modifies ``shot``.
+
+    Args:
+        shot:
+            A simulated system.
+        event_index:
+            The index of the last event to keep. Negative indices count from the end.
+            If this is 0, the whole shot is re-simulated.
+        engine:
+            The engine used for the re-simulated events. To vary a resolver model
+            parameter, pass an engine built from a modified config, e.g.
+            ``PhysicsEngine(resolver=Resolver.from_config(config))``.
+        inplace:
+            By default, ``shot`` is left unchanged. If True, its re-simulated events
+            replace its original ones.
+        max_events:
+            If this is greater than 0, and more than this many events are
+            re-simulated, the simulation is stopped and the balls are set to
+            stationary.
+        stop:
+            If set, the re-simulation ends as soon as this condition is met. Only the
+            re-simulated events are checked.
+
+    The remaining arguments are the same as those of :func:`simulate`.
+
+    Returns:
+        System: The re-simulated system.
+
+    Raises:
+        ValueError: If ``shot`` hasn't been simulated.
+        IndexError: If ``event_index`` is out of range.
+
+    Example:
+
+        Compare cushion models, re-simulating only what follows the first cushion
+        contact:
+
+        >>> import attrs
+        >>> import pooltool as pt
+        >>> from pooltool.physics.resolve.ball_cushion import BallLCushionModel
+        >>> from pooltool.physics.resolve.resolver import Resolver, ResolverConfig
+        >>> system = pt.simulate(pt.System.example())
+        >>> first = next(
+        >>>     i
+        >>>     for i, event in enumerate(system.events)
+        >>>     if event.event_type == pt.EventType.BALL_LINEAR_CUSHION
+        >>> )
+        >>> config = ResolverConfig.default()
+        >>> for restitution in (True, False):
+        >>>     resolver = Resolver.from_config(
+        >>>         attrs.evolve(
+        >>>             config,
+        >>>             ball_linear_cushion=BallLCushionModel.UNREALISTIC,
+        >>>             ball_linear_cushion_params={"restitution": restitution},
+        >>>         )
+        >>>     )
+        >>>     engine = pt.physics.PhysicsEngine(resolver=resolver)
+        >>>     pt.resimulate(system, first - 1, engine=engine)
+    """
+    if not shot.simulated:
+        raise ValueError("Only a simulated system can be re-simulated")
+
+    num_events = len(shot.events)
+    if not -num_events <= event_index < num_events:
+        raise IndexError(f"Event index {event_index} out of range")
+    event_index %= num_events
+
+    if not engine:
+        engine = DEFAULT_ENGINE
+
+    # The kept events and history are shared with the original, never copied
+    length = event_index + 1
+    resumed = shot if inplace else _copy_without_history(shot)
+    _restore_pockets(resumed, shot.events, event_index)
+
+    for ball_id, ball in resumed.balls.items():
+        ball.history = shot.balls[ball_id].history.truncated(length)
+        ball.history_cts = BallHistory()
+        ball.state = ball.history[-1].copy()
+
+    resumed.events = shot.events[:length]
+    resumed.t = resumed.events[-1].time
+    shot = resumed
+
+    if event_index == 0:
+        _strike(shot, engine)
+
+    _evolve_until_done(
+        shot,
+        engine,
+        t_final=t_final,
+        quartic_solver=quartic_solver,
+        include=include,
+        max_events=max_events,
+        cache_collisions=cache_collisions,
+        broadphase=broadphase,
+        stop=stop,
+    )
+
+    if continuous:
+        continuize(shot, dt=0.01 if dt is None else dt, inplace=True)
+
+    return shot
+
+
+def _copy_without_history(shot: System) -> System:
+    """Copy a system, except for its events and the histories of its balls"""
+    return System(
+        cue=shot.cue.copy(),
+        table=shot.table.copy(),
+        balls={
+            ball_id: ball.copy(drop_history=True)
+            for ball_id, ball in shot.balls.items()
+        },
+    )
+
+
+def _restore_pockets(shot: System, events: List[Event], event_index: int) -> None:
+    """Set the pocket contents to what they were just after an event
+
+    The contents of a pocket just after the event are those it had just before the next
+    resolved ball-pocket event into it. Pockets that weren't entered after the event are
+    left as they are.
+    """
+    restored: Set[str] = set()
+    for event in events[event_index + 1 :]:
+        if event.event_type != EventType.BALL_POCKET:
+            continue
+
+        pocket = event.agents[1]
+        if pocket.initial is None or pocket.id in restored:
+            continue
+
+        assert isinstance(pocket.initial, Pocket)
+        contains = shot.table.pockets[pocket.id].contains
+        contains.clear()
+        contains.update(pocket.initial.contains)
+        restored.add(pocket.id)
+
+
+def _strike(shot: System, engine: PhysicsEngine) -> None:
+    """Resolve the stick-ball collision that starts a shot, if there is one"""
     if shot.get_system_energy() == 0 and shot.cue.V0 > 0:
         # System has no energy, but the cue stick has an impact velocity. So create and
         # resolve a stick-ball collision to start things off
@@ -152,73 +495,185 @@ def simulate(
         engine.resolver.resolve(shot, event)
         shot._update_history(event)
 
+
+def _evolve_until_done(
+    shot: System,
+    engine: PhysicsEngine,
+    t_final: Optional[float],
+    quartic_solver: QuarticSolver,
+    include: Set[EventType],
+    max_events: int,
+    cache_collisions: bool,
+    broadphase: BroadPhase,
+    stop: Optional[StopCondition],
+) -> None:
+    """Detect, evolve, and resolve events until the shot ends
+
+    See :func:`simulate` for the arguments.
+    """
+    for _ in _evolve_iter(
+        shot,
+        engine,
+        t_final=t_final,
+        quartic_solver=quartic_solver,
+        include=include,
+        max_events=max_events,
+        cache_collisions=cache_collisions,
+        broadphase=broadphase,
+        stop=stop,
+    ):
+        pass
+
+
+def _evolve_iter(
+    shot: System,
+    engine: PhysicsEngine,
+    t_final: Optional[float],
+    quartic_solver: QuarticSolver,
+    include: Set[EventType],
+    max_events: int,
+    cache_collisions: bool,
+    broadphase: BroadPhase,
+    stop: Optional[StopCondition],
+) -> Iterator[Tuple[Event, bool]]:
+    """Detect, evolve, and resolve events until the shot ends, yielding each event
+
+    Each event is yielded once it's recorded, along with whether it's the shot's last.
+    See :func:`simulate` for the arguments.
+    """
+    assert BroadPhase(broadphase)
+    cull = broadphase == BroadPhase.SWEEP_AND_PRUNE
+
     transition_cache = TransitionCache.create(shot)
+    trajectory_cache = TrajectoryCache.create(shot)
+    collision_cache = (
+        CollisionCache.create(shot, solver=quartic_solver, cull=cull)
+        if cache_collisions
+        else None
+    )
+    culler = SweepAndPrune.from_table(shot.table) if cull else None
+    detector = (
+        FusedDetector.from_table(shot.table)
+        if collision_cache is None and not cull
+        else None
+    )
+    watcher = stop.watcher() if stop is not None else None
+
+    stats = instrumentation.active
+    if stats is not None:
+        stats.shots += 1
+        stats.lap()
 
     events = 0
     while True:
         event = get_next_event(
             shot,
             transition_cache=transition_cache,
+            collision_cache=collision_cache,
+            culler=culler,
+            detector=detector,
             quartic_solver=quartic_solver,
         )
 
+        if stats is not None:
+            stats.lap(instrumentation.Phase.DETECT)
+
         if event.time == np.inf:
             shot._update_history(null_event(time=shot.t))
-            break
+            yield shot.events[-1], True
+            return
+
+        trajectory_cache.evolve(shot, event.time - shot.t)
+
+        if event.event_type in include:
+            # Resolving the event only reads its balls
+            ball_ids = [
+                agent.id for agent in event.agents if agent.agent_type == AgentType.BALL
+            ]
+            trajectory_cache.sync(shot, ball_ids)
 
-        _evolve(shot, event.time - shot.t)
+        if stats is not None:
+            stats.lap(instrumentation.Phase.EVOLVE)
 
         if event.event_type in include:
             engine.resolver.resolve(shot, event)
             transition_cache.update(event)
+            trajectory_cache.update(event)
+
+        if stats is not None:
+            stats.lap(instrumentation.Phase.RESOLVE)
+
+        # Every ball is recorded in the history, and read to detect the next event
+        trajectory_cache.sync(shot)
+
+        if stats is not None:
+            stats.lap(instrumentation.Phase.EVOLVE)
 
         shot._update_history(event)
 
-        if t_final is not None and shot.t >= t_final:
-            shot._update_history(null_event(time=shot.t))
-            break
+        if collision_cache is not None:
+            collision_cache.update(shot, event)
+
+        done = (watcher is not None and watcher.update(shot, event)) or (
+            t_final is not None and shot.t >= t_final
+        )
 
-        if max_events > 0 and events > max_events:
+        if not done and max_events > 0 and events > max_events:
             shot.stop_balls()
-            break
 
-        events += 1
+            # The balls are stopped after their final states were recorded
+            for ball in shot.balls.values():
+                ball.history[-1] = ball.state
 
-    if continuous:
-        continuize(shot, dt=0.01 if dt is None else dt, inplace=True)
+            yield event, True
+            return
 
-    return shot
+        if stats is not None:
+            stats.lap(instrumentation.Phase.RECORD)
 
+        yield event, False
 
-def _evolve(shot: System, dt: float):
-    """Evolves current ball an amount of time dt
+        if stats is not None:
+            # Time spent by the consumer of the events isn't attributed to any phase
+            stats.lap()
 
-    FIXME This is very inefficent. each ball should store its natural trajectory
-    thereby avoid a call to the clunky evolve_ball_motion. It could even be a
-    partial function so parameters don't continuously need to be passed
-    """
+        if done:
+            shot._update_history(null_event(time=shot.t))
+            yield shot.events[-1], True
+            return
 
-    for ball in shot.balls.values():
-        rvw, _ = evolve.evolve_ball_motion(
-            state=ball.state.s,
-            rvw=ball.state.rvw,
-            R=ball.params.R,
-            m=ball.params.m,
-            u_s=ball.params.u_s,
-            u_sp=ball.params.u_sp,
-            u_r=ball.params.u_r,
-            g=ball.params.g,
-            t=dt,
-        )
-        ball.state = BallState(rvw, ball.state.s, shot.t + dt)
+        events += 1
+
+    if stats is not None:
+        stats.lap(instrumentation.Phase.RECORD)
 
 
 def get_next_event(
     shot: System,
     *,
     transition_cache: Optional[TransitionCache] = None,
+    collision_cache: Optional[CollisionCache] = None,
+    culler: Optional[SweepAndPrune] = None,
+    detector: Optional[FusedDetector] = None,
     quartic_solver: QuarticSolver = QuarticSolver.HYBRID,
 ) -> Event:
+    """Get the next event of a system
+
+    Args:
+        transition_cache:
+            The next transition of each ball. If not passed, it's created.
+        collision_cache:
+            If passed, collisions are taken from the cache rather than searched for
+            exhaustively (see :class:`CollisionCache`).
+        culler:
+            If passed (and ``collision_cache`` isn't), collision candidates that can't
+            occur before the earliest event found so far are culled (see
+            :class:`pooltool.evolution.event_based.broadphase.SweepAndPrune`).
+        detector:
+            Searches for collisions exhaustively when there's neither a cache nor a
+            culler (see :class:`pooltool.evolution.event_based.fused.FusedDetector`).
+            If not passed, it's created.
+    """
     # Start by assuming next event doesn't happen
     event = null_event(time=np.inf)
 
@@ -229,21 +684,124 @@ def get_next_event(
     if transition_event.time < event.time:
         event = transition_event
 
-    ball_ball_event = get_next_ball_ball_collision(shot, solver=quartic_solver)
+    if collision_cache is not None:
+        return _get_next_cached_collision(event, collision_cache, shot)
+
+    if culler is None:
+        return _get_next_fused_collision(event, detector, shot, quartic_solver)
+
+    candidates = culler.candidates(shot)
+    stats = instrumentation.active
+
+    ball_ball_pairs = candidates.ball_ball(event.time - shot.t)
+    if stats is not None:
+        num = len(shot.balls)
+        stats.record_candidates(
+            EventType.BALL_BALL, num * (num - 1) // 2, ball_ball_pairs
+        )
+
+    ball_ball_event = get_next_ball_ball_collision(
+        shot, solver=quartic_solver, pairs=ball_ball_pairs
+    )
     if ball_ball_event.time < event.time:
         event = ball_ball_event
 
-    ball_linear_cushion_event = get_next_ball_linear_cushion_collision(shot)
+    ball_linear_cushion_pairs = candidates.ball_linear_cushion(event.time - shot.t)
+    if stats is not None:
+        stats.record_candidates(
+            EventType.BALL_LINEAR_CUSHION,
+            len(shot.balls) * len(shot.table.cushion_segments.linear),
+            ball_linear_cushion_pairs,
+        )
+
+    ball_linear_cushion_event = get_next_ball_linear_cushion_collision(
+        shot, pairs=ball_linear_cushion_pairs
+    )
     if ball_linear_cushion_event.time < event.time:
         event = ball_linear_cushion_event
 
+    ball_circular_cushion_pairs = candidates.ball_circular_cushion(event.time - shot.t)
+    if stats is not None:
+        stats.record_candidates(
+            EventType.BALL_CIRCULAR_CUSHION,
+            len(shot.balls) * len(shot.table.cushion_segments.circular),
+            ball_circular_cushion_pairs,
+        )
+
     ball_circular_cushion_event = get_next_ball_circular_cushion_event(
-        shot, solver=quartic_solver
+        shot, solver=quartic_solver, pairs=ball_circular_cushion_pairs
     )
     if ball_circular_cushion_event.time < event.time:
         event = ball_circular_cushion_event
 
-    ball_pocket_event = get_next_ball_pocket_collision(shot, solver=quartic_solver)
+    ball_pocket_pairs = candidates.ball_pocket(event.time - shot.t)
+    if stats is not None:
+        stats.record_candidates(
+            EventType.BALL_POCKET,
+            len(shot.balls) * len(shot.table.pockets),
+            ball_pocket_pairs,
+        )
+
+    ball_pocket_event = get_next_ball_pocket_collision(
+        shot, solver=quartic_solver, pairs=ball_pocket_pairs
+    )
+    if ball_pocket_event.time < event.time:
+        event = ball_pocket_event
+
+    return event
+
+
+def _get_next_fused_collision(
+    event: Event,
+    detector: Optional[FusedDetector],
+    shot: System,
+    quartic_solver: QuarticSolver,
+) -> Event:
+    """Get the next event given the next transition, searching every candidate"""
+    if detector is None:
+        detector = FusedDetector.from_table(shot.table)
+
+    collisions, quartics, fallbacks = detector.next_collisions(shot, quartic_solver)
+    for collision in collisions:
+        if collision.time < event.time:
+            event = collision
+
+    stats = instrumentation.active
+    if stats is not None:
+        num_balls = len(shot.balls)
+        cushion_segments = shot.table.cushion_segments
+        for event_type, num in (
+            (EventType.BALL_BALL, num_balls * (num_balls - 1) // 2),
+            (EventType.BALL_LINEAR_CUSHION, num_balls * len(cushion_segments.linear)),
+            (
+                EventType.BALL_CIRCULAR_CUSHION,
+                num_balls * len(cushion_segments.circular),
+            ),
+            (EventType.BALL_POCKET, num_balls * len(shot.table.pockets)),
+        ):
+            stats.record_candidates(event_type, num, None)
+        stats.record_quartics(quartics, fallbacks)
+
+    return event
+
+
+def _get_next_cached_collision(
+    event: Event, collision_cache: CollisionCache, shot: System
+) -> Event:
+    """Get the next event given the next transition and a collision cache"""
+    ball_ball_event = collision_cache.get_next_ball_ball_collision(shot)
+    if ball_ball_event.time < event.time:
+        event = ball_ball_event
+
+    ball_linear_cushion_event = collision_cache.ball_linear_cushion.get_next()
+    if ball_linear_cushion_event.time < event.time:
+        event = ball_linear_cushion_event
+
+    ball_circular_cushion_event = collision_cache.ball_circular_cushion.get_next()
+    if ball_circular_cushion_event.time < event.time:
+        event = ball_circular_cushion_event
+
+    ball_pocket_event = collision_cache.ball_pocket.get_next()
     if ball_pocket_event.time < event.time:
         event = ball_pocket_event
 
@@ -310,62 +868,388 @@ def _next_transition(ball: Ball) -> Event:
         raise NotImplementedError(f"Unknown '{ball.state.s=}'")
 
 
+@attrs.define
+class _EventQueue:
+    """A priority queue of predicted events, keyed by the agents involved
+
+    Events are ordered by time, and ties are broken by rank. Replacing (or removing)
+    an event leaves its old heap entry behind, which is discarded lazily once it
+    surfaces.
+    """
+
+    events: Dict[Hashable, Event] = attrs.field(factory=dict)
+    heap: List[Tuple[float, Tuple[int, ...], Hashable]] = attrs.field(factory=list)
+
+    def get_next(self) -> Event:
+        while self.heap:
+            time, _, key = self.heap[0]
+            event = self.events.get(key)
+            if event is not None and event.time == time:
+                return event
+            heapq.heappop(self.heap)
+
+        return null_event(time=np.inf)
+
+    def push(self, key: Hashable, rank: Tuple[int, ...], event: Event) -> None:
+        if event.time == np.inf:
+            self.remove(key)
+            return
+
+        self.events[key] = event
+        heapq.heappush(self.heap, (event.time, rank, key))
+
+    def remove(self, key: Hashable) -> None:
+        self.events.pop(key, None)
+
+
+@attrs.define
+class TrajectoryCache:
+    """The current trajectory segment of each ball
+
+    A ball's trajectory segment begins whenever its state is resolved, and lasts until
+    its next motion transition. Each segment holds the ball's state at the start of the
+    segment, along with the closed-form coefficients of its motion (see
+    :func:`pooltool.physics.evolve.trajectory_coeffs`). Evolving the system is then a
+    single compiled evaluation of the segments, rather than one call to
+    :func:`pooltool.physics.evolve.evolve_ball_motion` per ball. Segments are only
+    evaluated for the balls that are read (see :meth:`sync`), and never for stationary
+    and pocketed balls, whose segments are constant.
+
+    Attributes:
+        index:
+            The row of each ball, keyed by ball ID. Rows follow the order of the
+            system's ball dictionary.
+        rvw:
+            (N, 3, 3) array of the kinematic state at the start of each segment.
+        s:
+            (N,) array of the motion state of each segment.
+        t:
+            (N,) array of the start time of each segment.
+        coeffs:
+            (N, 3, 3, 3) array of trajectory coefficients.
+        spin_time:
+            (N,) array of perpendicular spin decay times.
+        duration:
+            (N,) array of the time between the start of each segment and the ball's
+            next motion transition.
+        synced:
+            (N,) array of the time of each ball's state.
+        time:
+            The time the system was last evolved to.
+    """
+
+    index: Dict[str, int]
+    rvw: NDArray[np.float64]
+    s: NDArray[np.int64]
+    t: NDArray[np.float64]
+    coeffs: NDArray[np.float64]
+    spin_time: NDArray[np.float64]
+    duration: NDArray[np.float64]
+    synced: NDArray[np.float64]
+    time: float
+
+    def evolve(self, shot: System, dt: float) -> None:
+        """Evolve every ball of a system an amount of time dt
+
+        This is lazy: nothing is evaluated until the balls are read, so the evolved
+        states are only given to balls by :meth:`sync`.
+        """
+        self.time = shot.t + dt
+
+    def sync(self, shot: System, ball_ids: Optional[Iterable[str]] = None) -> None:
+        """Give balls their states at the time the system was evolved to
+
+        Only the segments of the given balls (by default, every ball) are evaluated,
+        and only if they haven't been since the system was last evolved. Stationary and
+        pocketed balls keep their state, with its time updated.
+        """
+        if ball_ids is None:
+            rows = np.arange(len(self.index))
+        else:
+            rows = np.array([self.index[ball_id] for ball_id in ball_ids], np.int64)
+        rows = rows[self.synced[rows] != self.time]
+
+        if not len(rows):
+            return
+
+        balls = list(shot.balls.values())
+        self.synced[rows] = self.time
+
+        constant = (self.s[rows] == const.stationary) | (self.s[rows] == const.pocketed)
+        for i in rows[constant]:
+            balls[i].state.t = self.time
+
+        rows = rows[~constant]
+        if not len(rows):
+            return
+
+        tau = self.time - self.t[rows]
+        rvw = evolve.evaluate_trajectories(
+            self.rvw[rows], self.coeffs[rows], self.spin_time[rows], tau
+        )
+
+        for k in np.flatnonzero(tau > self.duration[rows]):
+            # The segment has outlived its transition, which happens when transitions
+            # aren't resolved (see ``include`` in simulate)
+            params = balls[rows[k]].params
+            rvw[k], _ = evolve.evolve_ball_motion(
+                state=self.s[rows[k]],
+                rvw=self.rvw[rows[k]],
+                R=params.R,
+                m=params.m,
+                u_s=params.u_s,
+                u_sp=params.u_sp,
+                u_r=params.u_r,
+                g=params.g,
+                t=tau[k],
+            )
+
+        for k, i in enumerate(rows):
+            balls[i].state = BallState(rvw[k], self.s[i], self.time)
+
+    def update(self, event: Event) -> None:
+        """Start new trajectory segments for all balls in Event"""
+        for agent in event.agents:
+            if agent.agent_type == AgentType.BALL:
+                assert isinstance(ball := agent.final, Ball)
+                self._set_segment(self.index[agent.id], ball)
+
+    def _set_segment(self, i: int, ball: Ball) -> None:
+        self.rvw[i] = ball.state.rvw
+        self.s[i] = ball.state.s
+        self.t[i] = self.synced[i] = ball.state.t
+        self.coeffs[i], self.spin_time[i] = evolve.trajectory_coeffs(
+            ball.state.rvw,
+            ball.state.s,
+            ball.params.R,
+            ball.params.u_s,
+            ball.params.u_sp,
+            ball.params.u_r,
+            ball.params.g,
+        )
+        self.duration[i], _ = solve.ball_transition_time(
+            ball.state.rvw,
+            ball.state.s,
+            ball.params.R,
+            ball.params.u_s,
+            ball.params.u_sp,
+            ball.params.u_r,
+            ball.params.g,
+        )
+
+    @classmethod
+    def create(cls, shot: System) -> TrajectoryCache:
+        num_balls = len(shot.balls)
+        cache = cls(
+            index={ball_id: i for i, ball_id in enumerate(shot.balls)},
+            rvw=np.empty((num_balls, 3, 3), dtype=np.float64),
+            s=np.empty(num_balls, dtype=np.int64),
+            t=np.empty(num_balls, dtype=np.float64),
+            coeffs=np.empty((num_balls, 3, 3, 3), dtype=np.float64),
+            spin_time=np.empty(num_balls, dtype=np.float64),
+            duration=np.empty(num_balls, dtype=np.float64),
+            synced=np.empty(num_balls, dtype=np.float64),
+            time=shot.t,
+        )
+
+        for i, ball in enumerate(shot.balls.values()):
+            cache._set_segment(i, ball)
+
+        return cache
+
+
+@attrs.define
+class CollisionCache:
+    """Cached collision predictions
+
+    Balls follow deterministic trajectories between the events they're involved in, so
+    a predicted collision time stays valid until one of its balls is involved in an
+    event. This cache stores a prediction for every ball pair, and the earliest
+    ball-cushion and ball-pocket prediction for every ball. After each event, only the
+    predictions of the event's balls are recalculated (see :meth:`update`).
+
+    Ties are broken in the same order as the exhaustive searches (`e.g.`
+    :func:`get_next_ball_ball_collision`).
+
+    Attributes:
+        solver:
+            The quartic solver used for predictions.
+        ranks:
+            The index of each ball ID in the system's ball dictionary.
+        ball_ball:
+            Ball-ball collision predictions, keyed by ball ID pair.
+        ball_linear_cushion:
+            The earliest linear cushion collision of each ball, keyed by ball ID.
+        ball_circular_cushion:
+            The earliest circular cushion collision of each ball, keyed by ball ID.
+        ball_pocket:
+            The earliest pocket collision of each ball, keyed by ball ID.
+        intersecting:
+            Ball pairs that are currently intersecting. These are skipped by the
+            exhaustive search only while intersecting, so they're rechecked before
+            every event.
+        cull:
+            If True, ball pairs and ball-linear cushion pairs are skipped when their
+            trajectories guarantee they won't collide (see
+            :func:`pooltool.evolution.event_based.broadphase.skip_ball_ball` and
+            :func:`pooltool.evolution.event_based.broadphase.skip_ball_linear_cushion`).
+    """
+
+    solver: QuarticSolver = attrs.field(default=QuarticSolver.HYBRID)
+    ranks: Dict[str, int] = attrs.field(factory=dict)
+    ball_ball: _EventQueue = attrs.field(factory=_EventQueue)
+    ball_linear_cushion: _EventQueue = attrs.field(factory=_EventQueue)
+    ball_circular_cushion: _EventQueue = attrs.field(factory=_EventQueue)
+    ball_pocket: _EventQueue = attrs.field(factory=_EventQueue)
+    intersecting: Set[Tuple[str, str]] = attrs.field(factory=set)
+    cull: bool = attrs.field(default=False)
+
+    def get_next_ball_ball_collision(self, shot: System) -> Event:
+        if self.intersecting:
+            self._update_pairs(shot, sorted(self.intersecting, key=self._pair_rank))
+
+        return self.ball_ball.get_next()
+
+    def update(self, shot: System, event: Event) -> None:
+        """Recalculate the predictions of all balls in Event
+
+        This should be called once the event has been resolved and the system has been
+        updated to the time of the event.
+        """
+        ball_ids = [
+            agent.id for agent in event.agents if agent.agent_type == AgentType.BALL
+        ]
+        self._update_balls(shot, ball_ids)
+
+    def _pair_rank(self, pair: Tuple[str, str]) -> Tuple[int, int]:
+        return self.ranks[pair[0]], self.ranks[pair[1]]
+
+    def _update_balls(self, shot: System, ball_ids: List[str]) -> None:
+        pairs: Set[Tuple[str, str]] = set()
+
+        for ball_id in ball_ids:
+            ball = shot.balls[ball_id]
+            rank = (self.ranks[ball_id],)
+
+            linear_pairs = [
+                (ball, cushion)
+                for cushion in shot.table.cushion_segments.linear.values()
+                if not (self.cull and skip_ball_linear_cushion(ball, cushion))
+            ]
+            circular_pairs = [
+                (ball, cushion)
+                for cushion in shot.table.cushion_segments.circular.values()
+            ]
+            pocket_pairs = [(ball, pocket) for pocket in shot.table.pockets.values()]
+
+            self.ball_linear_cushion.push(
+                ball_id,
+                rank,
+                get_next_ball_linear_cushion_collision(shot, linear_pairs),
+            )
+            self.ball_circular_cushion.push(
+                ball_id,
+                rank,
+                get_next_ball_circular_cushion_event(shot, self.solver, circular_pairs),
+            )
+            self.ball_pocket.push(
+                ball_id,
+                rank,
+                get_next_ball_pocket_collision(shot, self.solver, pocket_pairs),
+            )
+
+            for other_id in shot.balls:
+                if other_id == ball_id:
+                    continue
+                if self.ranks[ball_id] < self.ranks[other_id]:
+                    pairs.add((ball_id, other_id))
+                else:
+                    pairs.add((other_id, ball_id))
+
+        self._update_pairs(shot, sorted(pairs, key=self._pair_rank))
+
+    def _update_pairs(self, shot: System, pairs: List[Tuple[str, str]]) -> None:
+        solvable = []
+        collision_coeffs = []
+
+        for pair in pairs:
+            ball1, ball2 = shot.balls[pair[0]], shot.balls[pair[1]]
+            self.intersecting.discard(pair)
+
+            if _skip_ball_ball_collision(ball1, ball2):
+                self.ball_ball.remove(pair)
+                continue
+
+            if _balls_intersecting(ball1, ball2):
+                self.ball_ball.remove(pair)
+                self.intersecting.add(pair)
+                continue
+
+            if self.cull and skip_ball_ball(ball1, ball2):
+                self.ball_ball.remove(pair)
+                continue
+
+            collision_coeffs.append(_ball_ball_collision_coeffs(ball1, ball2))
+            solvable.append(pair)
+
+        if not len(solvable):
+            return
+
+        # All pairs are solved with a single call to the quartic solver
+        dtau_Es = minimum_quartic_roots(np.array(collision_coeffs), solver=self.solver)
+
+        for pair, dtau_E in zip(solvable, dtau_Es):
+            self.ball_ball.push(
+                pair,
+                self._pair_rank(pair),
+                ball_ball_collision(
+                    shot.balls[pair[0]], shot.balls[pair[1]], shot.t + float(dtau_E)
+                ),
+            )
+
+    @classmethod
+    def create(
+        cls,
+        shot: System,
+        solver: QuarticSolver = QuarticSolver.HYBRID,
+        cull: bool = False,
+    ) -> CollisionCache:
+        cache = cls(
+            solver=solver,
+            ranks={ball_id: i for i, ball_id in enumerate(shot.balls)},
+            cull=cull,
+        )
+        cache._update_balls(shot, list(shot.balls))
+        return cache
+
+
 def get_next_ball_ball_collision(
-    shot: System, solver: QuarticSolver = QuarticSolver.HYBRID
+    shot: System,
+    solver: QuarticSolver = QuarticSolver.HYBRID,
+    pairs: Optional[Iterable[Tuple[Ball, Ball]]] = None,
 ) -> Event:
-    """Returns next ball-ball collision"""
+    """Returns next ball-ball collision
+
+    If ``pairs`` is passed, only these ball pairs are considered. Otherwise, every
+    combination of two balls is considered.
+    """
 
     dtau_E = np.inf
     ball_ids = []
     collision_coeffs = []
 
-    for ball1, ball2 in combinations(shot.balls.values(), 2):
-        ball1_state = ball1.state
-        ball1_params = ball1.params
-
-        ball2_state = ball2.state
-        ball2_params = ball2.params
+    if pairs is None:
+        pairs = combinations(shot.balls.values(), 2)
 
-        if ball1_state.s == const.pocketed or ball2_state.s == const.pocketed:
+    for ball1, ball2 in pairs:
+        if _skip_ball_ball_collision(ball1, ball2):
             continue
 
-        if (
-            ball1_state.s in const.nontranslating
-            and ball2_state.s in const.nontranslating
-        ):
-            continue
-
-        if (
-            ptmath.norm3d(ball1_state.rvw[0] - ball2_state.rvw[0])
-            < ball1_params.R + ball2_params.R
-        ):
+        if _balls_intersecting(ball1, ball2):
             # If balls are intersecting, avoid internal collisions
             continue
 
-        collision_coeffs.append(
-            solve.ball_ball_collision_coeffs(
-                rvw1=ball1_state.rvw,
-                rvw2=ball2_state.rvw,
-                s1=ball1_state.s,
-                s2=ball2_state.s,
-                mu1=(
-                    ball1_params.u_s
-                    if ball1_state.s == const.sliding
-                    else ball1_params.u_r
-                ),
-                mu2=(
-                    ball2_params.u_s
-                    if ball2_state.s == const.sliding
-                    else ball2_params.u_r
-                ),
-                m1=ball1_params.m,
-                m2=ball2_params.m,
-                g1=ball1_params.g,
-                g2=ball2_params.g,
-                R=ball1_params.R,
-            )
-        )
-
+        collision_coeffs.append(_ball_ball_collision_coeffs(ball1, ball2))
         ball_ids.append((ball1.id, ball2.id))
 
     if not len(collision_coeffs):
@@ -382,38 +1266,84 @@ def get_next_ball_ball_collision(
     return ball_ball_collision(ball1, ball2, shot.t + dtau_E)
 
 
+def _skip_ball_ball_collision(ball1: Ball, ball2: Ball) -> bool:
+    if ball1.state.s == const.pocketed or ball2.state.s == const.pocketed:
+        return True
+
+    return (
+        ball1.state.s in const.nontranslating and ball2.state.s in const.nontranslating
+    )
+
+
+def _balls_intersecting(ball1: Ball, ball2: Ball) -> bool:
+    return (
+        ptmath.norm3d(ball1.state.rvw[0] - ball2.state.rvw[0])
+        < ball1.params.R + ball2.params.R
+    )
+
+
+def _ball_ball_collision_coeffs(ball1: Ball, ball2: Ball) -> Tuple[float, ...]:
+    return solve.ball_ball_collision_coeffs(
+        rvw1=ball1.state.rvw,
+        rvw2=ball2.state.rvw,
+        s1=ball1.state.s,
+        s2=ball2.state.s,
+        mu1=(
+            ball1.params.u_s if ball1.state.s == const.sliding else ball1.params.u_r
+        ),
+        mu2=(
+            ball2.params.u_s if ball2.state.s == const.sliding else ball2.params.u_r
+        ),
+        m1=ball1.params.m,
+        m2=ball2.params.m,
+        g1=ball1.params.g,
+        g2=ball2.params.g,
+        R=ball1.params.R,
+    )
+
+
 def get_next_ball_circular_cushion_event(
-    shot: System, solver: QuarticSolver = QuarticSolver.HYBRID
+    shot: System,
+    solver: QuarticSolver = QuarticSolver.HYBRID,
+    pairs: Optional[Iterable[Tuple[Ball, CircularCushionSegment]]] = None,
 ) -> Event:
-    """Returns next ball-cushion collision (circular cushion segment)"""
+    """Returns next ball-cushion collision (circular cushion segment)
+
+    If ``pairs`` is passed, only these ball-cushion pairs are considered. Otherwise,
+    every ball is paired with every circular cushion segment.
+    """
 
     dtau_E = np.inf
     agent_ids = []
     collision_coeffs = []
 
-    for ball in shot.balls.values():
+    if pairs is None:
+        pairs = product(
+            shot.balls.values(), shot.table.cushion_segments.circular.values()
+        )
+
+    for ball, cushion in pairs:
         if ball.state.s in const.nontranslating:
             continue
 
         state = ball.state
         params = ball.params
 
-        for cushion in shot.table.cushion_segments.circular.values():
-            collision_coeffs.append(
-                solve.ball_circular_cushion_collision_coeffs(
-                    rvw=state.rvw,
-                    s=state.s,
-                    a=cushion.a,
-                    b=cushion.b,
-                    r=cushion.radius,
-                    mu=(params.u_s if state.s == const.sliding else params.u_r),
-                    m=params.m,
-                    g=params.g,
-                    R=params.R,
-                )
+        collision_coeffs.append(
+            solve.ball_circular_cushion_collision_coeffs(
+                rvw=state.rvw,
+                s=state.s,
+                a=cushion.a,
+                b=cushion.b,
+                r=cushion.radius,
+                mu=(params.u_s if state.s == const.sliding else params.u_r),
+                m=params.m,
+                g=params.g,
+                R=params.R,
             )
+        )
 
-            agent_ids.append((ball.id, cushion.id))
+        agent_ids.append((ball.id, cushion.id))
 
     if not len(collision_coeffs):
         # There are no collisions to test for
@@ -434,38 +1364,49 @@ def get_next_ball_circular_cushion_event(
     return ball_circular_cushion_collision(ball, cushion, shot.t + dtau_E)
 
 
-def get_next_ball_linear_cushion_collision(shot: System) -> Event:
-    """Returns next ball-cushion collision (linear cushion segment)"""
+def get_next_ball_linear_cushion_collision(
+    shot: System,
+    pairs: Optional[Iterable[Tuple[Ball, LinearCushionSegment]]] = None,
+) -> Event:
+    """Returns next ball-cushion collision (linear cushion segment)
+
+    If ``pairs`` is passed, only these ball-cushion pairs are considered. Otherwise,
+    every ball is paired with every linear cushion segment.
+    """
 
     dtau_E_min = np.inf
     involved_agents = (Ball.dummy(), LinearCushionSegment.dummy())
 
-    for ball in shot.balls.values():
+    if pairs is None:
+        pairs = product(
+            shot.balls.values(), shot.table.cushion_segments.linear.values()
+        )
+
+    for ball, cushion in pairs:
         if ball.state.s in const.nontranslating:
             continue
 
         state = ball.state
         params = ball.params
 
-        for cushion in shot.table.cushion_segments.linear.values():
-            dtau_E = solve.ball_linear_cushion_collision_time(
-                rvw=state.rvw,
-                s=state.s,
-                lx=cushion.lx,
-                ly=cushion.ly,
-                l0=cushion.l0,
-                p1=cushion.p1,
-                p2=cushion.p2,
-                direction=cushion.direction,
-                mu=(params.u_s if state.s == const.sliding else params.u_r),
-                m=params.m,
-                g=params.g,
-                R=params.R,
-            )
+        dtau_E = solve.ball_linear_cushion_collision_time(
+            rvw=state.rvw,
+            s=state.s,
+            lx=cushion.lx,
+            ly=cushion.ly,
+            l0=cushion.l0,
+            p1=cushion.p1,
+            p2=cushion.p2,
+            direction=cushion.direction,
+            mu=(params.u_s if state.s == const.sliding else params.u_r),
+            m=params.m,
+            g=params.g,
+            R=params.R,
+        )
 
-            if dtau_E < dtau_E_min:
-                involved_agents = (ball, cushion)
-                dtau_E_min = dtau_E
+        if dtau_E < dtau_E_min:
+            involved_agents = (ball, cushion)
+            dtau_E_min = dtau_E
 
     dtau_E = dtau_E_min
 
@@ -473,37 +1414,45 @@ def get_next_ball_linear_cushion_collision(shot: System) -> Event:
 
 
 def get_next_ball_pocket_collision(
-    shot: System, solver: QuarticSolver = QuarticSolver.HYBRID
+    shot: System,
+    solver: QuarticSolver = QuarticSolver.HYBRID,
+    pairs: Optional[Iterable[Tuple[Ball, Pocket]]] = None,
 ) -> Event:
-    """Returns next ball-pocket collision"""
+    """Returns next ball-pocket collision
+
+    If ``pairs`` is passed, only these ball-pocket pairs are considered. Otherwise,
+    every ball is paired with every pocket.
+    """
 
     dtau_E = np.inf
     agent_ids = []
     collision_coeffs = []
 
-    for ball in shot.balls.values():
+    if pairs is None:
+        pairs = product(shot.balls.values(), shot.table.pockets.values())
+
+    for ball, pocket in pairs:
         if ball.state.s in const.nontranslating:
             continue
 
         state = ball.state
         params = ball.params
 
-        for pocket in shot.table.pockets.values():
-            collision_coeffs.append(
-                solve.ball_pocket_collision_coeffs(
-                    rvw=state.rvw,
-                    s=state.s,
-                    a=pocket.a,
-                    b=pocket.b,
-                    r=pocket.radius,
-                    mu=(params.u_s if state.s == const.sliding else params.u_r),
-                    m=params.m,
-                    g=params.g,
-                    R=params.R,
-                )
+        collision_coeffs.append(
+            solve.ball_pocket_collision_coeffs(
+                rvw=state.rvw,
+                s=state.s,
+                a=pocket.a,
+                b=pocket.b,
+                r=pocket.radius,
+                mu=(params.u_s if state.s == const.sliding else params.u_r),
+                m=params.m,
+                g=params.g,
+                R=params.R,
             )
+        )
 
-            agent_ids.append((ball.id, pocket.id))
+        agent_ids.append((ball.id, pocket.id))
 
     if not len(collision_coeffs):
         # There are no collisions to test for
@@ -4,11 +4,12 @@ import numpy as np
 from numba import jit
 
 import pooltool.constants as const
+import pooltool.evolution.event_based.packed as packed
 import pooltool.physics.evolve as evolve
 import pooltool.ptmath as ptmath
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def skip_ball_ball_collision(rvw1, rvw2, s1, s2, R1, R2):
     if (s1 == const.spinning or s1 == const.pocketed or s1 == const.stationary) and (
         s2 == const.spinning or s2 == const.pocketed or s2 == const.stationary
@@ -70,7 +71,41 @@ def skip_ball_ball_collision(rvw1, rvw2, s1, s2, R1, R2):
     return False
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def ball_transition_time(rvw, s, R, u_s, u_sp, u_r, g):
+    """Get the time until a ball's next motion state transition
+
+    (just-in-time compiled)
+
+    Returns:
+        (dtau, code):
+            ``dtau`` is the time until the transition, and ``code`` is the integer code
+            of the transition's event type (see
+            :mod:`pooltool.evolution.event_based.packed`). If the ball will not
+            transition, ``(np.inf, packed.EVENT_NONE)`` is returned.
+    """
+    if s == const.stationary or s == const.pocketed:
+        return np.inf, packed.EVENT_NONE
+
+    if s == const.spinning:
+        return ptmath.get_spin_time(rvw, R, u_sp, g), packed.EVENT_SPINNING_STATIONARY
+
+    if s == const.rolling:
+        dtau_E_spin = ptmath.get_spin_time(rvw, R, u_sp, g)
+        dtau_E_roll = ptmath.get_roll_time(rvw, u_r, g)
+
+        if dtau_E_spin > dtau_E_roll:
+            return dtau_E_roll, packed.EVENT_ROLLING_SPINNING
+        else:
+            return dtau_E_roll, packed.EVENT_ROLLING_STATIONARY
+
+    if s == const.sliding:
+        return ptmath.get_slide_time(rvw, R, u_s, g), packed.EVENT_SLIDING_ROLLING
+
+    raise ValueError("Unknown motion state")
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def get_u(rvw, R, phi, s):
     if s == const.rolling:
         return np.array([1, 0, 0], dtype=np.float64)
@@ -82,7 +117,7 @@ def get_u(rvw, R, phi, s):
     return ptmath.coordinate_rotation(ptmath.unit_vector(rel_vel), -phi)
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def ball_ball_collision_coeffs(rvw1, rvw2, s1, s2, mu1, mu2, m1, m2, g1, g2, R):
     """Get quartic coeffs required to determine the ball-ball collision time
 
@@ -156,7 +191,7 @@ def ball_ball_collision_time(rvw1, rvw2, s1, s2, mu1, mu2, m1, m2, g1, g2, R):
     return roots.min() if len(roots) else np.inf
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def skip_ball_linear_cushion_collision(rvw, s, u_r, g, R, p1, p2, normal):
     if s == const.spinning or s == const.pocketed or s == const.stationary:
         # Ball isn't moving. No collision.
@@ -200,7 +235,7 @@ def skip_ball_linear_cushion_collision(rvw, s, u_r, g, R, p1, p2, normal):
     return False
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def ball_linear_cushion_collision_time(
     rvw, s, lx, ly, l0, p1, p2, direction, mu, m, g, R
 ):
@@ -263,7 +298,7 @@ def ball_linear_cushion_collision_time(
     return min_time
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def ball_circular_cushion_collision_coeffs(rvw, s, a, b, r, mu, m, g, R):
     """Get quartic coeffs required to determine the ball-circular-cushion collision time
 
@@ -296,7 +331,7 @@ def ball_circular_cushion_collision_coeffs(rvw, s, a, b, r, mu, m, g, R):
     return A, B, C, D, E
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def ball_pocket_collision_coeffs(rvw, s, a, b, r, mu, m, g, R):
     """Get quartic coeffs required to determine the ball-pocket collision time
 
@@ -0,0 +1,247 @@
+"""Conditions for ending a simulation early
+
+Searches often only need to know whether a ball dropped, or which ball the cue ball hit
+first, and most of a shot's events happen after that is known. A :class:`StopCondition`
+passed to :func:`pooltool.evolution.event_based.simulate.simulate` (or to the batched,
+parallel, and compiled engines) is checked after each event, and the simulation ends
+as soon as it's met.
+
+Conditions are built from :class:`EventCount` (met once a number of matching events
+have happened), and :class:`Predicate` (met once an arbitrary function of the system
+and event returns True), and combined with ``|`` (either) and ``&`` (both):
+
+    >>> from pooltool.evolution.event_based import stop
+    >>> condition = stop.ball_pocketed("1") | stop.ball_pocketed("cue")
+    >>> condition = stop.first_ball_contact() & stop.cushion_contacts("cue", 3)
+
+Every part of a condition is latching: ``a & b`` is met once both ``a`` and ``b`` have
+been met, not necessarily by the same event. Conditions that contain no
+:class:`Predicate` can be evaluated by the compiled engine, without calling back into
+Python (see :meth:`StopCondition.compile`).
+"""
+
+from __future__ import annotations
+
+from abc import ABC, abstractmethod
+from itertools import product
+from typing import Callable, FrozenSet, List, Optional, Sequence, Tuple
+
+import attrs
+import numpy as np
+from numpy.typing import NDArray
+
+import pooltool.evolution.event_based.packed as packed
+from pooltool.events import AgentType, Event, EventType
+from pooltool.system.datatypes import System
+
+
+# The array representation of a stop condition (see StopCondition.compile)
+CompiledStopCondition = Tuple[
+    NDArray[np.bool_], NDArray[np.int64], NDArray[np.int64], NDArray[np.int64]
+]
+
+
+class StopCondition(ABC):
+    """Base class of all stop conditions"""
+
+    def __or__(self, other: StopCondition) -> StopCondition:
+        return AnyOf((self, other))
+
+    def __and__(self, other: StopCondition) -> StopCondition:
+        return AllOf((self, other))
+
+    @abstractmethod
+    def groups(self) -> List[Tuple[_Primitive, ...]]:
+        """The condition in disjunctive normal form
+
+        Returns:
+            groups:
+                The condition is met once every primitive of any one group has been met.
+        """
+
+    def watcher(self) -> StopWatcher:
+        """Create a watcher, which tracks the condition over the course of one shot"""
+        return StopWatcher(self.groups())
+
+    def compile(self, ball_ids: Sequence[str]) -> CompiledStopCondition:
+        """Get an array representation of the condition for compiled engines
+
+        Args:
+            ball_ids:
+                The ball IDs, in packed order.
+
+        Returns:
+            (types, balls, counts, groups):
+                For each primitive, ``types`` is a boolean mask over event type codes
+                (see :data:`pooltool.evolution.event_based.packed.EVENT_TYPE_TO_CODE`),
+                ``balls`` is the packed index of the ball that must be involved (-1 for
+                any), ``counts`` is the number of matching events needed, and ``groups``
+                is the index of the primitive's group.
+
+        Raises:
+            ValueError:
+                If the condition contains a :class:`Predicate`, or refers to a ball
+                that doesn't exist.
+        """
+        index_of_ball = {ball_id: i for i, ball_id in enumerate(ball_ids)}
+        num_codes = len(packed.CODE_TO_EVENT_TYPE)
+
+        types, balls, counts, groups = [], [], [], []
+        for group, primitives in enumerate(self.groups()):
+            for primitive in primitives:
+                if not isinstance(primitive, EventCount):
+                    raise ValueError(
+                        f"'{type(primitive).__name__}' can't be evaluated by a "
+                        f"compiled engine. Only EventCount conditions can."
+                    )
+
+                ball_id = primitive.ball_id
+                if ball_id is not None and ball_id not in index_of_ball:
+                    raise ValueError(f"Unknown ball ID '{ball_id}'")
+
+                mask = np.zeros(num_codes, dtype=np.bool_)
+                for event_type in primitive.event_types:
+                    mask[packed.EVENT_TYPE_TO_CODE[event_type]] = True
+
+                types.append(mask)
+                balls.append(-1 if ball_id is None else index_of_ball[ball_id])
+                counts.append(primitive.count)
+                groups.append(group)
+
+        return (
+            np.array(types, dtype=np.bool_).reshape((-1, num_codes)),
+            np.array(balls, dtype=np.int64),
+            np.array(counts, dtype=np.int64),
+            np.array(groups, dtype=np.int64),
+        )
+
+
+class _Primitive(StopCondition):
+    """A condition that is met once it has matched `count` events"""
+
+    count: int
+
+    @abstractmethod
+    def matches(self, shot: System, event: Event) -> bool:
+        pass
+
+    def groups(self) -> List[Tuple[_Primitive, ...]]:
+        return [(self,)]
+
+
+@attrs.define(frozen=True)
+class EventCount(_Primitive):
+    """Met once a number of events of given types (involving a given ball) happened
+
+    Attributes:
+        event_types:
+            The event types that match.
+        ball_id:
+            If set, only events that this ball is an agent of match.
+        count:
+            The number of matching events needed.
+    """
+
+    event_types: FrozenSet[EventType] = attrs.field(converter=frozenset)
+    ball_id: Optional[str] = attrs.field(default=None)
+    count: int = attrs.field(default=1)
+
+    def matches(self, shot: System, event: Event) -> bool:
+        if event.event_type not in self.event_types:
+            return False
+
+        if self.ball_id is None:
+            return True
+
+        return any(
+            agent.agent_type == AgentType.BALL and agent.id == self.ball_id
+            for agent in event.agents
+        )
+
+
+@attrs.define(frozen=True)
+class Predicate(_Primitive):
+    """Met once a function of the system and the latest event returns True
+
+    Predicates can't be evaluated by the compiled engine, and must be picklable to be
+    used with process pools.
+    """
+
+    func: Callable[[System, Event], bool]
+    count: int = attrs.field(default=1)
+
+    def matches(self, shot: System, event: Event) -> bool:
+        return self.func(shot, event)
+
+
+@attrs.define(frozen=True)
+class AnyOf(StopCondition):
+    """Met once any of its conditions is met"""
+
+    conditions: Tuple[StopCondition, ...] = attrs.field(converter=tuple)
+
+    def groups(self) -> List[Tuple[_Primitive, ...]]:
+        return [group for condition in self.conditions for group in condition.groups()]
+
+
+@attrs.define(frozen=True)
+class AllOf(StopCondition):
+    """Met once all of its conditions are met"""
+
+    conditions: Tuple[StopCondition, ...] = attrs.field(converter=tuple)
+
+    def groups(self) -> List[Tuple[_Primitive, ...]]:
+        choices = product(*(condition.groups() for condition in self.conditions))
+        return [
+            tuple(primitive for group in groups for primitive in group)
+            for groups in choices
+        ]
+
+
+class StopWatcher:
+    """Tracks a stop condition over the course of one shot"""
+
+    def __init__(self, groups: List[Tuple[_Primitive, ...]]):
+        self.groups = groups
+        self.counts = [[0] * len(group) for group in groups]
+
+    def update(self, shot: System, event: Event) -> bool:
+        """Account for an event, and return whether the condition is met"""
+        met = False
+        for group, counts in zip(self.groups, self.counts):
+            group_met = True
+            for p, primitive in enumerate(group):
+                if counts[p] < primitive.count and primitive.matches(shot, event):
+                    counts[p] += 1
+                group_met &= counts[p] >= primitive.count
+            met |= group_met
+
+        return met
+
+
+_CUSHION_TYPES = frozenset(
+    {EventType.BALL_LINEAR_CUSHION, EventType.BALL_CIRCULAR_CUSHION}
+)
+
+
+def first_ball_contact(ball_id: Optional[str] = None) -> EventCount:
+    """Met at the first ball-ball collision (involving `ball_id`, if given)"""
+    return EventCount({EventType.BALL_BALL}, ball_id=ball_id)
+
+
+def ball_pocketed(ball_id: Optional[str] = None) -> EventCount:
+    """Met once `ball_id` (or if not given, any ball) is pocketed"""
+    return EventCount({EventType.BALL_POCKET}, ball_id=ball_id)
+
+
+def cushion_contacts(ball_id: str, count: int = 1) -> EventCount:
+    """Met once `ball_id` has contacted cushions `count` times
+
+    For example, in three cushion billiards, ``cushion_contacts("white", 3)``.
+    """
+    return EventCount(_CUSHION_TYPES, ball_id=ball_id, count=count)
+
+
+def ball_contacts(ball_id: str, count: int = 1) -> EventCount:
+    """Met once `ball_id` has collided with other balls `count` times"""
+    return EventCount({EventType.BALL_BALL}, ball_id=ball_id, count=count)
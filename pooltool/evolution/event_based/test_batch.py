@@ -0,0 +1,88 @@
+import pytest
+
+from pooltool.evolution.event_based import stop
+from pooltool.evolution.event_based.batch import simulate_batch
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.evolution.event_based.test_data import (
+    assert_same_simulation,
+    phi_sweep,
+)
+from pooltool.objects import Ball
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.physics.resolve.ball_cushion import (
+    BallLCushionModel,
+    get_ball_lin_cushion_model,
+)
+from pooltool.physics.resolve.resolver import Resolver
+from pooltool.ptmath.roots import quartic
+
+
+@pytest.mark.parametrize(
+    "solver", [quartic.QuarticSolver.NUMERIC, quartic.QuarticSolver.HYBRID]
+)
+def test_simulate_batch_matches_simulate(solver: quartic.QuarticSolver):
+    shots = phi_sweep(12)
+
+    batched = simulate_batch(shots, quartic_solver=solver)
+    serial = [simulate(shot, quartic_solver=solver) for shot in shots]
+
+    for batched_shot, serial_shot in zip(batched, serial):
+        assert_same_simulation(batched_shot, serial_shot)
+
+
+def test_simulate_batch_custom_model():
+    # Ball-linear cushion collisions are resolved one at a time, without an array
+    # entrypoint
+    resolver = Resolver.default()
+    resolver.ball_linear_cushion = get_ball_lin_cushion_model(
+        BallLCushionModel.UNREALISTIC
+    )
+    engine = PhysicsEngine(resolver=resolver)
+
+    shots = phi_sweep(6)
+    batched = simulate_batch(shots, engine=engine)
+    serial = [simulate(shot, engine=engine) for shot in shots]
+
+    for batched_shot, serial_shot in zip(batched, serial):
+        assert_same_simulation(batched_shot, serial_shot)
+
+
+def test_simulate_batch_limits():
+    shots = phi_sweep(4)
+
+    batched = simulate_batch(shots, t_final=0.5)
+    serial = [simulate(shot, t_final=0.5) for shot in shots]
+    for batched_shot, serial_shot in zip(batched, serial):
+        assert_same_simulation(batched_shot, serial_shot)
+
+    batched = simulate_batch(shots, max_events=3)
+    serial = [simulate(shot, max_events=3) for shot in shots]
+    for batched_shot, serial_shot in zip(batched, serial):
+        assert_same_simulation(batched_shot, serial_shot)
+
+
+def test_simulate_batch_inplace():
+    shots = phi_sweep(3)
+
+    simulated = simulate_batch(shots, inplace=False)
+    assert all(not shot.simulated for shot in shots)
+    assert all(shot.simulated for shot in simulated)
+
+    simulated = simulate_batch(shots, inplace=True)
+    assert all(shot.simulated for shot in shots)
+    assert all(a is b for a, b in zip(shots, simulated))
+
+
+def test_simulate_batch_incompatible():
+    shots = phi_sweep(2)
+    shots[1].balls["2"] = Ball.create("2", xy=(0.5, 0.5))
+
+    with pytest.raises(ValueError):
+        simulate_batch(shots)
+
+
+def test_simulate_batch_stop():
+    condition = stop.first_ball_contact() | stop.cushion_contacts("cue", 3)
+    shots = phi_sweep(8)
+    for batched, shot in zip(simulate_batch(shots, stop=condition), shots):
+        assert_same_simulation(batched, simulate(shot, stop=condition))
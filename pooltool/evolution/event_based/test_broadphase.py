@@ -0,0 +1,92 @@
+from itertools import combinations
+
+import numpy as np
+import pytest
+
+import pooltool.constants as const
+from pooltool.evolution.event_based.broadphase import (
+    BallBounds,
+    BroadPhase,
+    SweepAndPrune,
+    sweep_and_prune,
+)
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.system import System
+
+
+def test_sweep_and_prune():
+    rng = np.random.default_rng(42)
+
+    for _ in range(20):
+        lo = rng.uniform(0, 1, size=(30, 2))
+        boxes = np.hstack((lo, lo + rng.uniform(0, 0.2, size=(30, 2))))
+
+        overlaps = sweep_and_prune(boxes)
+
+        for i, j in combinations(range(len(boxes)), 2):
+            expected = (
+                boxes[i, 0] <= boxes[j, 2]
+                and boxes[j, 0] <= boxes[i, 2]
+                and boxes[i, 1] <= boxes[j, 3]
+                and boxes[j, 1] <= boxes[i, 3]
+            )
+            assert overlaps[i, j] == expected
+            assert not overlaps[j, i]
+
+
+def _moving_cue_ball_system() -> System:
+    system = System.example()
+    cue_ball = system.balls["cue"]
+    cue_ball.state.rvw[1] = np.array([0.0, 1.0, 0.0])
+    cue_ball.state.s = const.sliding
+    return system
+
+
+def test_ball_bounds():
+    bounds = BallBounds.from_system(_moving_cue_ball_system())
+
+    # An infinite horizon doesn't bound moving balls
+    boxes = bounds.boxes(np.inf)
+    for i in range(len(bounds.balls)):
+        assert np.isinf(boxes[i]).all() == (bounds.speed[i] > 0)
+
+    # A zero horizon bounds the balls by their radius
+    boxes = bounds.boxes(0.0)
+    assert np.allclose(boxes[:, 2] - boxes[:, 0], 2 * bounds.R, atol=1e-5)
+
+    # The bounds grow with the horizon
+    assert (bounds.boxes(0.2)[:, 2] >= bounds.boxes(0.1)[:, 2]).all()
+
+
+def test_candidates():
+    system = _moving_cue_ball_system()
+    candidates = SweepAndPrune.from_table(system.table).candidates(system)
+
+    # With no horizon, nothing is culled by the bounding boxes
+    assert len(candidates.ball_ball(np.inf)) == 1
+    assert len(candidates.ball_pocket(np.inf)) == len(system.table.pockets)
+
+    # With a zero horizon, the cue ball can't reach anything
+    assert len(candidates.ball_ball(0.0)) == 0
+    assert len(candidates.ball_pocket(0.0)) == 0
+
+
+@pytest.mark.parametrize("cache_collisions", [False, True])
+def test_sweep_and_prune_matches_exhaustive(cache_collisions: bool):
+    template = System.example()
+    for phi in np.linspace(0, 360, 12, endpoint=False):
+        system = template.copy()
+        system.cue.set_state(phi=phi)
+
+        exhaustive = simulate(system, broadphase=BroadPhase.EXHAUSTIVE)
+        culled = simulate(
+            system,
+            broadphase=BroadPhase.SWEEP_AND_PRUNE,
+            cache_collisions=cache_collisions,
+        )
+
+        assert len(exhaustive.events) == len(culled.events)
+        for event, other in zip(exhaustive.events, culled.events):
+            assert event.event_type == other.event_type
+            assert event.ids == other.ids
+            assert event.time == pytest.approx(other.time, abs=1e-9)
@@ -0,0 +1,84 @@
+import pytest
+
+from pooltool.evolution.event_based import stop
+from pooltool.evolution.event_based.compiled import simulate_compiled
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.evolution.event_based.test_data import (
+    assert_same_simulation,
+    nine_ball_break,
+    phi_sweep,
+)
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.physics.resolve.ball_cushion import (
+    BallLCushionModel,
+    get_ball_lin_cushion_model,
+)
+from pooltool.physics.resolve.resolver import Resolver
+from pooltool.ptmath.roots import quartic
+from pooltool.system import System
+
+
+@pytest.mark.parametrize("solver", list(quartic.QuarticSolver))
+def test_simulate_compiled_matches_simulate(solver: quartic.QuarticSolver):
+    for shot in phi_sweep(12) + [nine_ball_break()]:
+        assert_same_simulation(
+            simulate_compiled(shot, quartic_solver=solver),
+            simulate(shot, quartic_solver=solver),
+            agents=True,
+        )
+
+
+def test_simulate_compiled_limits():
+    for shot in phi_sweep(4):
+        assert_same_simulation(
+            simulate_compiled(shot, t_final=0.5),
+            simulate(shot, t_final=0.5),
+            agents=True,
+        )
+        assert_same_simulation(
+            simulate_compiled(shot, max_events=3),
+            simulate(shot, max_events=3),
+            agents=True,
+        )
+
+
+def test_simulate_compiled_inplace():
+    shot = phi_sweep(1)[0]
+
+    simulated = simulate_compiled(shot, inplace=False)
+    assert not shot.simulated
+    assert simulated.simulated
+
+    simulated = simulate_compiled(shot, inplace=True)
+    assert shot.simulated
+    assert simulated is shot
+
+
+def test_simulate_compiled_unsupported_resolver():
+    resolver = Resolver.default()
+    resolver.ball_linear_cushion = get_ball_lin_cushion_model(
+        BallLCushionModel.UNREALISTIC
+    )
+
+    with pytest.raises(ValueError):
+        simulate_compiled(System.example(), engine=PhysicsEngine(resolver=resolver))
+
+
+def test_simulate_compiled_stop():
+    conditions = [
+        stop.first_ball_contact(),
+        stop.ball_pocketed("1"),
+        stop.cushion_contacts("cue", 2) & stop.ball_contacts("1"),
+    ]
+    for condition in conditions:
+        for shot in phi_sweep(4):
+            assert_same_simulation(
+                simulate_compiled(shot, stop=condition),
+                simulate(shot, stop=condition),
+                agents=True,
+            )
+
+    with pytest.raises(ValueError):
+        simulate_compiled(
+            System.example(), stop=stop.Predicate(lambda system, event: True)
+        )
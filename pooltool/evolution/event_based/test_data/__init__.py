@@ -1,3 +1,102 @@
+"""Shots and comparisons shared by the tests of the simulation engines
+
+Besides the regression test shots saved in this directory, this holds the shots the
+engines are exercised with, and the comparison of two simulations of the same shot.
+"""
+
 from pathlib import Path
+from typing import List
+
+import numpy as np
+
+import pooltool.ai.aim as aim
+from pooltool.game.datatypes import GameType
+from pooltool.layouts import get_rack
+from pooltool.objects import Ball, Cue, Table
+from pooltool.system.datatypes import System
 
 TEST_DIR = Path(__file__).parent
+
+
+def phi_sweep(num_shots: int) -> List[System]:
+    """The example system, struck at evenly spaced cue angles (unsimulated)"""
+    template = System.example()
+    shots = []
+    for phi in np.linspace(0, 360, num_shots, endpoint=False):
+        shot = template.copy()
+        shot.cue.set_state(phi=phi)
+        shots.append(shot)
+
+    return shots
+
+
+def nine_ball_break() -> System:
+    """A nine-ball break on the default table (unsimulated)"""
+    table = Table.default()
+    shot = System(
+        cue=Cue(cue_ball_id="cue"),
+        table=table,
+        balls=get_rack(GameType.NINEBALL, table=table),
+    )
+    shot.strike(V0=8, phi=aim.at_ball(shot, "1"))
+    return shot
+
+
+def _close(a: float, b: float) -> bool:
+    # The tolerances of pytest.approx
+    return bool(np.isclose(a, b, rtol=1e-6, atol=1e-12))
+
+
+def assert_same_simulation(
+    system: System, expected: System, agents: bool = False, history: bool = True
+) -> None:
+    """Assert that two simulations of a shot agree, up to round-off
+
+    The events (their types, agents, and times), the final ball states, and the pocket
+    contents are always compared.
+
+    Args:
+        agents:
+            If True, the initial and final states of the event agents are compared.
+        history:
+            If True, the ball histories are compared.
+    """
+    assert len(system.events) == len(expected.events)
+
+    for event, other in zip(system.events, expected.events):
+        assert event.event_type == other.event_type
+        assert event.ids == other.ids
+        assert _close(event.time, other.time)
+
+        if not agents:
+            continue
+
+        for agent, other_agent in zip(event.agents, other.agents):
+            for obj, other_obj in (
+                (agent.initial, other_agent.initial),
+                (agent.final, other_agent.final),
+            ):
+                if isinstance(other_obj, Ball):
+                    assert isinstance(obj, Ball)
+                    assert obj.state.s == other_obj.state.s
+                    assert _close(obj.state.t, other_obj.state.t)
+                    assert np.allclose(obj.state.rvw, other_obj.state.rvw)
+                else:
+                    assert obj == other_obj
+
+    for ball_id, ball in system.balls.items():
+        other_ball = expected.balls[ball_id]
+        assert ball.state.s == other_ball.state.s
+        assert np.allclose(ball.state.rvw, other_ball.state.rvw)
+
+        if not history:
+            continue
+
+        assert len(ball.history) == len(other_ball.history)
+        for state, other_state in zip(ball.history, other_ball.history):
+            assert state.s == other_state.s
+            assert _close(state.t, other_state.t)
+            assert np.allclose(state.rvw, other_state.rvw)
+
+    for pocket_id, pocket in system.table.pockets.items():
+        assert pocket.contains == expected.table.pockets[pocket_id].contains
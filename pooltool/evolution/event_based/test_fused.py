@@ -0,0 +1,98 @@
+from concurrent.futures import ThreadPoolExecutor
+from typing import List
+
+import numpy as np
+import pytest
+
+from pooltool.events import Event
+from pooltool.evolution.event_based import fused
+from pooltool.evolution.event_based.fused import FusedDetector
+from pooltool.evolution.event_based.simulate import (
+    get_next_ball_ball_collision,
+    get_next_ball_circular_cushion_event,
+    get_next_ball_linear_cushion_collision,
+    get_next_ball_pocket_collision,
+    simulate,
+)
+from pooltool.evolution.event_based.test_data import nine_ball_break
+from pooltool.objects import Table
+from pooltool.ptmath.roots.quartic import QuarticSolver
+from pooltool.system import System
+
+
+def _systems() -> List[System]:
+    """Systems just after being struck, and partway through their shots"""
+    shots = []
+    for phi in np.linspace(0, 360, 6, endpoint=False):
+        shot = System.example()
+        shot.strike(phi=phi)
+        shots.append(shot)
+    shots.append(nine_ball_break())
+
+    systems = []
+    for shot in shots:
+        for t_final in (0.0, 0.3, 1.5):
+            system = simulate(shot, t_final=t_final)
+            system.reset_history()
+            systems.append(system)
+
+    return systems
+
+
+def _expected(shot: System, solver: QuarticSolver) -> List[Event]:
+    events = [
+        get_next_ball_ball_collision(shot, solver=solver),
+        get_next_ball_linear_cushion_collision(shot),
+        get_next_ball_circular_cushion_event(shot, solver=solver),
+        get_next_ball_pocket_collision(shot, solver=solver),
+    ]
+    return [event for event in events if event.time < np.inf]
+
+
+@pytest.mark.parametrize("parallel", [False, True])
+@pytest.mark.parametrize("solver", list(QuarticSolver))
+def test_next_collisions(solver: QuarticSolver, parallel: bool):
+    for shot in _systems():
+        detector = FusedDetector.from_table(shot.table, parallel=parallel)
+        events, quartics, fallbacks = detector.next_collisions(shot, solver)
+        expected = _expected(shot, solver)
+
+        assert len(events) == len(expected)
+        for event, other in zip(events, expected):
+            assert event.event_type == other.event_type
+            assert event.ids == other.ids
+            assert event.time == pytest.approx(other.time, abs=1e-12)
+
+        assert 0 <= fallbacks <= quartics
+
+
+def test_parallel_threshold(monkeypatch):
+    shot = nine_ball_break()
+    serial = simulate(shot)
+
+    monkeypatch.setattr(fused, "parallel_threshold", 0)
+    parallel = simulate(shot)
+
+    assert len(parallel.events) == len(serial.events)
+    for event, other in zip(parallel.events, serial.events):
+        assert event.event_type == other.event_type
+        assert event.ids == other.ids
+        assert event.time == other.time
+
+
+def test_parallel_off_main_thread(monkeypatch):
+    monkeypatch.setattr(fused, "parallel_threshold", 0)
+    detector = FusedDetector.from_table(Table.default())
+    assert detector.use_parallel(2)
+
+    with ThreadPoolExecutor(max_workers=1) as pool:
+        # Concurrent launches abort the process with the workqueue layer
+        monkeypatch.setattr(fused, "threading_layer", lambda: "workqueue")
+        assert not pool.submit(detector.use_parallel, 2).result()
+
+        monkeypatch.setattr(fused, "threading_layer", lambda: "tbb")
+        assert pool.submit(detector.use_parallel, 2).result()
+
+        # An explicit choice is kept
+        serial = FusedDetector.from_table(Table.default(), parallel=False)
+        assert not pool.submit(serial.use_parallel, 2).result()
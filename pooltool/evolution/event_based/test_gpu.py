@@ -0,0 +1,156 @@
+from typing import List
+
+import attrs
+import numpy as np
+import pytest
+from numba import config, cuda
+
+import pooltool.evolution.event_based.packed as packed
+from pooltool.evolution.event_based import compiled, gpu
+from pooltool.evolution.event_based.compiled import simulate_compiled
+from pooltool.evolution.event_based.config import INCLUDED_EVENTS
+from pooltool.evolution.event_based.gpu import (
+    STOP_FALLBACK,
+    GPUEventLog,
+    simulate_gpu,
+)
+from pooltool.evolution.event_based.simulate import DEFAULT_ENGINE
+from pooltool.evolution.event_based.test_data import (
+    assert_same_simulation,
+    nine_ball_break,
+    phi_sweep,
+)
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.physics.resolve.ball_cushion import (
+    BallLCushionModel,
+    get_ball_lin_cushion_model,
+)
+from pooltool.physics.resolve.resolver import Resolver
+from pooltool.ptmath.roots.quartic import QuarticSolver
+from pooltool.system import System
+
+# Run with NUMBA_ENABLE_CUDASIM=1 to test the kernels on the host, with numba's CUDA
+# simulator
+requires_cuda = pytest.mark.skipif(
+    not cuda.is_available(), reason="requires a CUDA device"
+)
+
+# The simulator runs device code in Python, so it's given fewer shots
+NUM_SHOTS = 4 if config.ENABLE_CUDASIM else 16
+
+
+def _host_log(shots: List[System], max_events: int = 1000) -> GPUEventLog:
+    """The event log the device writes, made by the compiled event loop instead"""
+    shots, ball_ids, table, rvw, s, params, _ = gpu._prepare(shots, DEFAULT_ENGINE)
+    resolve = np.array(
+        [event_type in INCLUDED_EVENTS for event_type in packed.CODE_TO_EVENT_TYPE],
+        dtype=np.bool_,
+    )
+
+    num_shots, capacity = len(shots), max_events + 2
+    num_events = np.zeros(num_shots, dtype=np.int64)
+    stops = np.zeros(num_shots, dtype=np.int64)
+    codes = np.zeros((num_shots, capacity), dtype=np.int8)
+    times = np.zeros((num_shots, capacity), dtype=np.float64)
+    first = np.zeros((num_shots, capacity), dtype=np.int32)
+    second = np.zeros((num_shots, capacity), dtype=np.int32)
+
+    for n, shot in enumerate(shots):
+        log = gpu._simulate_on_host(
+            shot, rvw[n], s[n], params[n], table, resolve, np.inf, max_events
+        )
+        num, stops[n] = log[0], log[1]
+        num_events[n] = num
+        codes[n, :num], times[n, :num] = log[2][:num], log[3][:num]
+        first[n, :num], second[n, :num] = log[5][:num], log[6][:num]
+
+    return GPUEventLog(
+        shots=shots,
+        ball_ids=ball_ids,
+        table=table,
+        resolve=resolve,
+        t_final=np.inf,
+        max_events=max_events,
+        num_events=num_events,
+        stops=stops,
+        codes=codes,
+        times=times,
+        first=first,
+        second=second,
+    )
+
+
+@requires_cuda
+def test_simulate_gpu_matches_compiled():
+    for shots in (phi_sweep(NUM_SHOTS), [nine_ball_break()]):
+        log = simulate_gpu(shots)
+        assert len(log) == len(shots)
+
+        for n, shot in enumerate(shots):
+            expected = simulate_compiled(shot, quartic_solver=QuarticSolver.BRACKETED)
+            assert_same_simulation(log[n], expected, history=False)
+
+            # The passed systems are left untouched
+            assert not len(shot.events)
+
+
+@requires_cuda
+def test_simulate_gpu_max_events():
+    (shot,) = shots = [nine_ball_break()]
+    log = simulate_gpu(shots, max_events=5)
+    assert log.stops[0] in (compiled.STOP_MAX_EVENTS, STOP_FALLBACK)
+
+    expected = simulate_compiled(
+        shot, quartic_solver=QuarticSolver.BRACKETED, max_events=5
+    )
+    assert_same_simulation(log[0], expected, history=False)
+    assert all(ball.state.s == 0 for ball in log[0].balls.values())
+
+
+def test_decode():
+    for shots in (phi_sweep(4), [nine_ball_break()]):
+        log = _host_log(shots)
+        assert len(log) == len(shots)
+
+        for n, shot in enumerate(shots):
+            expected = simulate_compiled(shot, quartic_solver=QuarticSolver.BRACKETED)
+            assert_same_simulation(log[n], expected, history=False)
+
+        # Decoding builds a new system each time
+        assert log[0] is not log[0]
+        assert log[0] == log[0]
+
+
+def test_decode_stops():
+    shot = nine_ball_break()
+
+    # Stopped simulations are finished like the compiled event loop finishes them
+    log = _host_log([shot], max_events=5)
+    assert log.stops[0] == compiled.STOP_MAX_EVENTS
+    expected = simulate_compiled(
+        shot, quartic_solver=QuarticSolver.BRACKETED, max_events=5
+    )
+    assert_same_simulation(log[0], expected, history=False)
+
+    # Systems the device gave up on are simulated on the host
+    log = _host_log([shot])
+    fallback = attrs.evolve(log, stops=np.full(1, STOP_FALLBACK))
+    assert_same_simulation(fallback[0], log[0], history=False)
+
+
+def test_simulate_gpu_validation():
+    shots = phi_sweep(2)
+
+    with pytest.raises(ValueError):
+        simulate_gpu(shots, max_events=0)
+
+    with pytest.raises(ValueError):
+        simulate_gpu([])
+
+    resolver = Resolver.default()
+    resolver.ball_linear_cushion = get_ball_lin_cushion_model(
+        BallLCushionModel.UNREALISTIC
+    )
+
+    with pytest.raises(ValueError):
+        simulate_gpu(shots, engine=PhysicsEngine(resolver=resolver))
@@ -0,0 +1,112 @@
+from pathlib import Path
+
+import attrs
+import pytest
+
+from pooltool.evolution.event_based.memo import SimulationCache, Tolerances
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.instrumentation import instrument
+from pooltool.physics.resolve.ball_cushion import BallLCushionModel
+from pooltool.physics.resolve.resolver import ResolverConfig
+from pooltool.system import System
+
+
+def _shot(phi: float = 90.0) -> System:
+    shot = System.example()
+    shot.cue.set_state(phi=phi)
+    return shot
+
+
+def test_simulation_cache():
+    cache = SimulationCache()
+
+    shot = _shot()
+    result = cache.simulate(shot, copy=False)
+    assert not shot.simulated
+    assert result.simulated
+    assert result == simulate(shot)
+
+    # Matching shots share the result
+    assert cache.simulate(shot, copy=False) is result
+    assert cache.simulate(_shot(90 + 1e-9), copy=False) is result
+    assert (cache.hits, cache.misses) == (2, 1)
+
+    # By default, copies are returned, so modifying them doesn't modify the result
+    copied = cache.simulate(shot)
+    assert copied is not result
+    assert copied == result
+    ball = copied.balls["cue"]
+    ball.state.rvw[0] = 0
+    ball.history[0] = ball.state
+    copied.events.clear()
+    assert cache.simulate(shot) == simulate(shot)
+
+    # Shots that differ by more than the tolerances are simulated
+    assert cache.simulate(_shot(90 + 1e-3), copy=False) is not result
+
+    moved = _shot()
+    moved.balls["1"].state.rvw[0, 0] += 1e-3
+    assert cache.simulate(moved, copy=False) is not result
+
+    assert cache.simulate(shot, t_final=0.5, copy=False) is not result
+    assert (cache.hits, cache.misses) == (4, 4)
+
+
+def test_simulation_cache_config():
+    cache = SimulationCache()
+    shot = _shot()
+    result = cache.simulate(shot, copy=False)
+
+    config = attrs.evolve(
+        ResolverConfig.default(), ball_linear_cushion=BallLCushionModel.UNREALISTIC
+    )
+    assert cache.simulate(shot, config=config, copy=False) is not result
+    assert cache.simulate(shot, config=ResolverConfig.default(), copy=False) is result
+
+
+def test_simulation_cache_tolerances():
+    exact = SimulationCache(tolerances=Tolerances(angle=0))
+    coarse = SimulationCache(tolerances=Tolerances(angle=1))
+
+    for cache in (exact, coarse):
+        cache.simulate(_shot())
+        cache.simulate(_shot(90 + 1e-9))
+
+    assert exact.misses == 2
+    assert coarse.misses == 1
+
+
+def test_simulation_cache_lru():
+    cache = SimulationCache(maxsize=2)
+
+    for phi in (0, 90, 180):
+        cache.simulate(_shot(phi))
+    assert len(cache) == 2
+
+    # The least recently used result was dropped
+    cache.simulate(_shot(180))
+    cache.simulate(_shot(0))
+    assert (cache.hits, cache.misses) == (1, 4)
+
+
+def test_simulation_cache_directory(tmp_path: Path):
+    result = SimulationCache(directory=tmp_path).simulate(_shot())
+    assert len(list(tmp_path.iterdir())) == 1
+
+    # Another cache finds the saved result
+    cache = SimulationCache(directory=tmp_path)
+    assert cache.simulate(_shot()) == result
+    assert (cache.hits, cache.misses) == (1, 0)
+
+
+@pytest.mark.parametrize("copy", [True, False])
+def test_simulation_cache_instrumented(copy: bool):
+    cache = SimulationCache()
+
+    with instrument() as stats:
+        for _ in range(3):
+            cache.simulate(_shot(), copy=copy)
+
+    assert (stats.cache_hits, stats.cache_misses) == (2, 1)
+    assert stats.shots == 1
+    assert "cache: 2 hits, 1 misses" in stats.summary()
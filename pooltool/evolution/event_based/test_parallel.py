@@ -0,0 +1,32 @@
+import pytest
+
+from pooltool.evolution.event_based.parallel import PoolType, simulate_many
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.evolution.event_based.test_data import phi_sweep
+
+
+@pytest.mark.parametrize("pool", [PoolType.PROCESS, PoolType.THREAD])
+def test_simulate_many(pool: PoolType):
+    shots = phi_sweep(8)
+
+    results = list(simulate_many(shots, workers=2, pool=pool, chunksize=3))
+    assert len(results) == len(shots)
+
+    for shot, result in zip(shots, results):
+        # The passed systems are untouched
+        assert not shot.simulated
+
+        # Results arrive in submission order, and match a serial simulation
+        expected = simulate(shot)
+        assert result.cue.phi == shot.cue.phi
+        assert [event.event_type for event in result.events] == [
+            event.event_type for event in expected.events
+        ]
+        assert result.t == pytest.approx(expected.t)
+
+        for pocket_id, pocket in result.table.pockets.items():
+            assert pocket.contains == expected.table.pockets[pocket_id].contains
+
+
+def test_simulate_many_empty():
+    assert list(simulate_many([], workers=2)) == []
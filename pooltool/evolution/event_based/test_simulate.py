@@ -2,17 +2,33 @@ import numpy as np
 import pytest
 from numpy.typing import NDArray
 
+import pooltool.ai.aim as aim
 import pooltool.constants as const
 import pooltool.ptmath as ptmath
 from pooltool.events import EventType, ball_ball_collision, ball_pocket_collision
 from pooltool.evolution.event_based.simulate import (
+    TrajectoryCache,
     get_next_ball_ball_collision,
     get_next_event,
+    resimulate,
     simulate,
+    simulate_iter,
+)
+from pooltool.evolution.event_based.solve import (
+    ball_ball_collision_coeffs,
+    ball_transition_time,
 )
-from pooltool.evolution.event_based.solve import ball_ball_collision_coeffs
 from pooltool.evolution.event_based.test_data import TEST_DIR
+from pooltool.game.datatypes import GameType
+from pooltool.layouts import get_rack
 from pooltool.objects import Ball, BilliardTableSpecs, Cue, Table
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.physics.evolve import evolve_ball_motion
+from pooltool.physics.resolve.ball_cushion import (
+    BallLCushionModel,
+    get_ball_lin_cushion_model,
+)
+from pooltool.physics.resolve.resolver import Resolver
 from pooltool.ptmath.roots import quadratic, quartic
 from pooltool.system import System
 
@@ -479,3 +495,244 @@ def test_no_ball_ball_collisions_for_intersecting_balls(solver: quartic.QuarticS
         get_next_event(system, quartic_solver=solver).event_type != EventType.BALL_BALL
     )
     assert get_next_ball_ball_collision(system, solver=solver).time == np.inf
+
+
+def _assert_same_events(system: System, other: System, num_events: int) -> None:
+    for event, other_event in zip(
+        system.events[:num_events], other.events[:num_events]
+    ):
+        assert event.event_type == other_event.event_type
+        assert event.ids == other_event.ids
+        assert event.time == pytest.approx(other_event.time, abs=1e-9)
+
+
+@pytest.mark.parametrize(
+    "solver", [quartic.QuarticSolver.NUMERIC, quartic.QuarticSolver.HYBRID]
+)
+def test_cache_collisions(solver: quartic.QuarticSolver):
+    """Cached collision predictions are equivalent to the exhaustive search"""
+    template = System.example()
+    for phi in np.linspace(0, 360, 12, endpoint=False):
+        system = template.copy()
+        system.cue.set_state(phi=phi)
+
+        exhaustive = simulate(system, quartic_solver=solver)
+        cached = simulate(system, quartic_solver=solver, cache_collisions=True)
+
+        assert len(exhaustive.events) == len(cached.events)
+        _assert_same_events(exhaustive, cached, len(exhaustive.events))
+
+    # A break is chaotic, so only the early events are compared
+    np.random.seed(42)
+    system = System(
+        cue=Cue(cue_ball_id="cue"),
+        table=(table := Table.default()),
+        balls=get_rack(GameType.NINEBALL, table, spacing_factor=1e-2),
+    )
+    system.strike(V0=8, phi=aim.at_ball(system, "1"))
+
+    exhaustive = simulate(system, quartic_solver=solver)
+    cached = simulate(system, quartic_solver=solver, cache_collisions=True)
+    _assert_same_events(exhaustive, cached, 10)
+
+
+def test_resimulate():
+    system = simulate(System.example())
+    num_events = len(system.events)
+    pocketed = {k: set(v.contains) for k, v in system.table.pockets.items()}
+
+    # With the same engine, re-simulating reproduces the shot
+    for event_index in (0, 1, num_events // 2, num_events - 2):
+        resimulated = resimulate(system, event_index)
+        assert len(resimulated.events) == num_events
+        _assert_same_events(system, resimulated, num_events)
+
+        for ball_id, ball in resimulated.balls.items():
+            other = system.balls[ball_id]
+            assert np.allclose(ball.state.rvw, other.state.rvw)
+            assert ball.state.s == other.state.s
+
+        for pocket_id, pocket in resimulated.table.pockets.items():
+            assert pocket.contains == pocketed[pocket_id]
+
+    # The prefix is shared, and the original is untouched
+    assert len(system.events) == num_events
+    assert resimulated.events[1] is system.events[1]
+    history = resimulated.balls["cue"].history
+    state = history[0]
+    state.rvw[0] = 0
+    history[0] = state
+    assert np.all(system.balls["cue"].history[0].rvw[0] != 0)
+
+    with pytest.raises(IndexError):
+        resimulate(system, num_events)
+
+    with pytest.raises(ValueError):
+        resimulate(System.example(), 0)
+
+
+def test_resimulate_with_engine():
+    system = simulate(System.example())
+    cushion_index = next(
+        i
+        for i, event in enumerate(system.events)
+        if event.event_type == EventType.BALL_LINEAR_CUSHION
+    )
+
+    resolver = Resolver.default()
+    resolver.ball_linear_cushion = get_ball_lin_cushion_model(
+        BallLCushionModel.UNREALISTIC
+    )
+    engine = PhysicsEngine(resolver=resolver)
+
+    # Resuming just before the first cushion contact diverges from there, and matches
+    # simulating the whole shot with the new engine, whose earlier events are the same
+    resimulated = resimulate(system, cushion_index - 1, engine=engine)
+    simulated = simulate(System.example(), engine=engine)
+
+    _assert_same_events(system, resimulated, cushion_index)
+    assert len(resimulated.events) == len(simulated.events)
+    _assert_same_events(simulated, resimulated, len(simulated.events))
+
+
+def test_simulate_iter():
+    system = System.example()
+    simulated = simulate(system)
+
+    steps = simulate_iter(system)
+    first = next(steps)
+
+    # Nothing is simulated until the steps are consumed
+    assert first.event.event_type == EventType.NONE
+    assert len(first.system.events) == 1
+    assert not len(system.events)
+
+    steps = [first, *steps]
+    assert [step.final for step in steps] == [False] * (len(steps) - 1) + [True]
+    assert all(step.samples is None for step in steps)
+
+    shot = steps[-1].system
+    assert [step.event for step in steps] == shot.events
+    _assert_same_events(simulated, shot, len(simulated.events))
+
+    for n, step in enumerate(steps):
+        for ball_id, state in step.states.items():
+            assert state == shot.balls[ball_id].history[n]
+
+
+@pytest.mark.parametrize("dt", [0.01, 0.1])
+def test_simulate_iter_continuous(dt: float):
+    simulated = simulate(System.example(), continuous=True, dt=dt)
+    steps = list(simulate_iter(System.example(), continuous=True, dt=dt))
+    shot = steps[-1].system
+
+    for ball_id, ball in simulated.balls.items():
+        # Steps without new timepoints have empty samples
+        samples = [
+            (step, step.samples[ball_id].vectorize())  # type: ignore
+            for step in steps
+            if len(step.samples[ball_id])  # type: ignore
+        ]
+        times = np.concatenate([vectorization[2] for _, vectorization in samples])
+
+        # A step's samples became final with its event, so they don't follow it
+        for step, (_, _, step_times) in samples:
+            assert (step_times <= step.event.time).all()
+
+        # The samples make up the continuized history, which matches continuize's
+        rvws, _, ts = shot.balls[ball_id].history_cts.vectorize()
+        expected_rvws, _, expected_ts = ball.history_cts.vectorize()
+        assert np.array_equal(ts, times)
+        assert np.allclose(ts, expected_ts)
+        assert np.allclose(rvws, expected_rvws)
+
+
+@pytest.mark.parametrize(
+    "state, rvw",
+    [
+        (const.sliding, [[0.5, 0.5, 0.0285], [1.0, 0.3, 0.0], [5.0, -20.0, 30.0]]),
+        (const.sliding, [[0.5, 0.5, 0.0285], [0.0, 0.0, 0.0], [40.0, 10.0, -1.0]]),
+        (const.rolling, [[0.5, 0.5, 0.0285], [0.8, -0.6, 0.0], [21.0, 28.0, 2.0]]),
+        (const.rolling, [[0.5, 0.5, 0.0285], [0.8, -0.6, 0.0], [21.0, 28.0, 80.0]]),
+        (const.spinning, [[0.5, 0.5, 0.0285], [0.0, 0.0, 0.0], [0.0, 0.0, 10.0]]),
+        (const.stationary, [[0.5, 0.5, 0.0285], [0.0, 0.0, 0.0], [0.0, 0.0, 0.0]]),
+    ],
+)
+def test_trajectory_cache(state: int, rvw: list):
+    """Trajectory segments evolve balls identically to evolve_ball_motion"""
+    ball = Ball.create("cue", xy=(0.5, 0.5))
+    ball.state.rvw = np.array(rvw, dtype=np.float64)
+    ball.state.s = state
+
+    if state == const.rolling:
+        # Lock the angular velocity to the velocity
+        ball.state.rvw[2, :2] = ptmath.coordinate_rotation(
+            ball.state.rvw[1] / ball.params.R, np.pi / 2
+        )[:2]
+
+    system = System(
+        cue=Cue(cue_ball_id="cue"), table=Table.default(), balls={"cue": ball}
+    )
+    start = ball.state.copy()
+
+    cache = TrajectoryCache.create(system)
+    duration, _ = ball_transition_time(
+        start.rvw,
+        start.s,
+        ball.params.R,
+        ball.params.u_s,
+        ball.params.u_sp,
+        ball.params.u_r,
+        ball.params.g,
+    )
+
+    for t in np.linspace(0, min(duration, 2.0), 10):
+        cache.evolve(system, t)
+        cache.sync(system)
+        expected, _ = evolve_ball_motion(
+            start.s,
+            start.rvw,
+            ball.params.R,
+            ball.params.m,
+            ball.params.u_s,
+            ball.params.u_sp,
+            ball.params.u_r,
+            ball.params.g,
+            t,
+        )
+
+        assert ball.state.s == start.s
+        assert ball.state.t == t
+        assert np.allclose(ball.state.rvw, expected, atol=1e-12)
+
+
+def test_trajectory_cache_lazy():
+    """Only the balls that are synced are evaluated, and stationary balls never are"""
+    moving = Ball.create("cue", xy=(0.5, 0.5))
+    moving.state.rvw[1] = [1.0, 0.3, 0.0]
+    moving.state.s = const.sliding
+    resting = Ball.create("1", xy=(0.5, 1.5))
+    system = System(
+        cue=Cue(cue_ball_id="cue"),
+        table=Table.default(),
+        balls={"cue": moving, "1": resting},
+    )
+    start, resting_state = moving.state.copy(), resting.state
+
+    cache = TrajectoryCache.create(system)
+    cache.evolve(system, 0.1)
+    assert moving.state == start
+
+    cache.sync(system, ["1"])
+    assert moving.state == start
+    assert resting.state is resting_state
+    assert resting.state.t == 0.1
+
+    cache.sync(system)
+    assert moving.state.t == 0.1
+    assert not np.allclose(moving.state.rvw[0], start.rvw[0])
+
+    # Balls that are already synced aren't evaluated again
+    synced = moving.state
+    cache.sync(system, ["cue"])
+    assert moving.state is synced
@@ -0,0 +1,79 @@
+import pytest
+
+from pooltool.events import EventType, filter_type
+from pooltool.evolution.event_based import stop
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.system import System
+
+
+def test_groups():
+    a = stop.ball_pocketed("1")
+    b = stop.first_ball_contact()
+    c = stop.cushion_contacts("cue", 2)
+
+    assert (a | b).groups() == [(a,), (b,)]
+    assert (a & b).groups() == [(a, b)]
+    assert ((a | b) & c).groups() == [(a, c), (b, c)]
+
+
+def test_watcher_latches():
+    system = simulate(System.example())
+    cushion_events = filter_type(
+        system.events, [EventType.BALL_LINEAR_CUSHION, EventType.BALL_CIRCULAR_CUSHION]
+    )
+    assert len(cushion_events) >= 2
+
+    # Met by two separate events, neither of which meets both parts
+    condition = stop.first_ball_contact() & stop.EventCount(
+        {EventType.BALL_LINEAR_CUSHION, EventType.BALL_CIRCULAR_CUSHION}
+    )
+    watcher = condition.watcher()
+    met = [watcher.update(system, event) for event in system.events]
+
+    first = met.index(True)
+    assert all(met[first:])
+    assert not any(met[:first])
+
+
+def test_simulate_stops_at_pocket():
+    system = System.example()
+    full = simulate(system)
+    pocket_event = filter_type(full.events, EventType.BALL_POCKET)[0]
+
+    stopped = simulate(system, stop=stop.ball_pocketed("1"))
+
+    # The pocketing is the last event, before the null event that ends the shot
+    assert stopped.events[-2].event_type == EventType.BALL_POCKET
+    assert stopped.events[-2].time == pytest.approx(pocket_event.time)
+    assert stopped.events[-1].event_type == EventType.NONE
+    assert len(stopped.events) < len(full.events)
+
+
+def test_ball_id_is_not_cushion_id():
+    system = simulate(System.example())
+    condition = stop.cushion_contacts("1")
+
+    # Cushion segments are also numbered, so a cushion with ID "1" mustn't count as
+    # an event involving ball "1"
+    for event in system.events:
+        if event.event_type in condition.event_types:
+            ball_id = event.agents[0].id
+            assert condition.matches(system, event) == (ball_id == "1")
+
+
+def test_compile():
+    condition = (stop.ball_pocketed("1") & stop.cushion_contacts("cue", 3)) | (
+        stop.first_ball_contact()
+    )
+    types, balls, counts, groups = condition.compile(["cue", "1"])
+
+    assert types.shape[0] == balls.shape[0] == counts.shape[0] == groups.shape[0] == 3
+    assert balls.tolist() == [1, 0, -1]
+    assert counts.tolist() == [1, 3, 1]
+    assert groups.tolist() == [0, 0, 1]
+
+    with pytest.raises(ValueError):
+        stop.ball_pocketed("2").compile(["cue", "1"])
+
+    with pytest.raises(ValueError):
+        stop.Predicate(lambda system, event: True).compile(["cue", "1"])
@@ -0,0 +1,261 @@
+"""Compile the just-in-time kernels ahead of the first shot
+
+Every numerical kernel in pooltool is compiled by numba the first time it's called, so
+a fresh process pays seconds of compile time before its first simulation. Compiled
+kernels are cached to disk (see :data:`pooltool.constants.use_numba_cache`), but only
+once they've been called, and only if numba's cache directory is writable.
+
+:func:`precompile` compiles every kernel up front by simulating representative shots
+with each engine and quartic solver. Calling the kernels, rather than compiling them
+against hand-written type signatures, guarantees that the cached signatures are exactly
+the ones simulations use. Run it when building an image or installing, pointing
+``cache_dir`` at a directory that will be readable at runtime, and then set the
+``NUMBA_CACHE_DIR`` environment variable to that directory in runtime processes:
+
+.. code-block:: bash
+
+    python -m pooltool warmup --cache-dir /opt/pooltool-cache
+    NUMBA_CACHE_DIR=/opt/pooltool-cache python my_batch_job.py
+
+Passing ``--benchmark`` to ``warmup`` reports the time-to-first-shot of a fresh process
+with a cold cache, and with a precompiled one (see :func:`benchmark`).
+"""
+
+from __future__ import annotations
+
+import os
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+from typing import Dict, List, Optional
+
+import attrs
+import numba
+import numpy as np
+from numba.core.dispatcher import Dispatcher
+
+import pooltool.constants as const
+from pooltool.evolution.continuize import continuize
+from pooltool.evolution.event_based import stop
+from pooltool.evolution.event_based.batch import simulate_batch
+from pooltool.evolution.event_based.broadphase import BroadPhase
+from pooltool.evolution.event_based.compiled import simulate_compiled
+from pooltool.evolution.event_based.fused import FusedDetector
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.evolution.event_based.test_data import nine_ball_break
+from pooltool.ptmath.roots.quartic import QuarticSolver, minimum_quartic_roots
+from pooltool.serialize.serializers import Pathish
+from pooltool.system.datatypes import System
+
+
+@attrs.define(frozen=True)
+class PrecompileReport:
+    """The outcome of :func:`precompile`
+
+    Attributes:
+        cache_dir:
+            The directory the compiled kernels were cached to, or None if numba's
+            default location was used.
+        kernels:
+            The number of just-in-time compiled kernels.
+        signatures:
+            The number of compiled type signatures, summed over kernels.
+        seconds:
+            The time taken.
+    """
+
+    cache_dir: Optional[Path]
+    kernels: int
+    signatures: int
+    seconds: float
+
+
+def precompile(cache_dir: Optional[Pathish] = None) -> PrecompileReport:
+    """Compile (and cache) every just-in-time kernel used by simulations
+
+    Args:
+        cache_dir:
+            If passed, compiled kernels are cached to this directory, and so are any
+            compiled later in this process (``NUMBA_CACHE_DIR`` is set for
+            subprocesses, too). Kernels that were already compiled are recompiled, so
+            they're cached too. Otherwise, numba's cache directory is used.
+
+    Returns:
+        PrecompileReport: What was compiled, and how long it took.
+
+    Raises:
+        ValueError:
+            If ``cache_dir`` is passed while caching is disabled (see
+            :data:`pooltool.constants.use_numba_cache`).
+
+    Example:
+
+        Warm a worker before it takes its first job:
+
+        >>> import pooltool as pt
+        >>> report = pt.precompile()
+        >>> print(f"{report.signatures} signatures compiled in {report.seconds:.1f}s")
+    """
+    start = time.perf_counter()
+
+    path = None if cache_dir is None else Path(cache_dir)
+    if path is not None:
+        _require_caching()
+        path.mkdir(parents=True, exist_ok=True)
+        _redirect_cache(path)
+
+    _exercise()
+
+    dispatchers = _dispatchers()
+    return PrecompileReport(
+        cache_dir=path,
+        kernels=len(dispatchers),
+        signatures=sum(len(dispatcher.signatures) for dispatcher in dispatchers),
+        seconds=time.perf_counter() - start,
+    )
+
+
+# Run by a fresh interpreter to time its first simulation, including imports
+_FIRST_SHOT = """
+import time
+start = time.perf_counter()
+import pooltool as pt
+pt.simulate(pt.System.example())
+print(time.perf_counter() - start)
+"""
+
+
+def time_to_first_shot(cache_dir: Optional[Pathish] = None) -> float:
+    """Time a fresh process from importing pooltool to finishing its first simulation
+
+    Args:
+        cache_dir:
+            The numba cache directory of the process. If None, it inherits this
+            process's environment.
+
+    Returns:
+        float: The time in seconds.
+    """
+    env = dict(os.environ)
+    if cache_dir is not None:
+        env["NUMBA_CACHE_DIR"] = str(cache_dir)
+
+    result = subprocess.run(
+        [sys.executable, "-c", _FIRST_SHOT],
+        env=env,
+        check=True,
+        capture_output=True,
+        text=True,
+    )
+    return float(result.stdout.split()[-1])
+
+
+def benchmark(cache_dir: Optional[Pathish] = None) -> Dict[str, float]:
+    """Compare the time-to-first-shot of fresh processes with and without precompiling
+
+    The cold time is measured with an empty cache. Then the cache is precompiled (in a
+    separate process), and the warm time is measured.
+
+    Args:
+        cache_dir:
+            The cache directory to precompile to. It should be empty. By default, a
+            temporary directory is used.
+
+    Returns:
+        Dict[str, float]:
+            The ``"cold"`` and ``"warm"`` times-to-first-shot, and the time taken to
+            ``"precompile"``, in seconds.
+
+    Raises:
+        ValueError:
+            If caching is disabled (see :data:`pooltool.constants.use_numba_cache`),
+            since there's no cache to precompile.
+    """
+    _require_caching()
+
+    if cache_dir is None:
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            return benchmark(tmp_dir)
+
+    cold = time_to_first_shot(cache_dir)
+
+    start = time.perf_counter()
+    subprocess.run(
+        [sys.executable, "-m", "pooltool", "warmup", "--cache-dir", str(cache_dir)],
+        check=True,
+        capture_output=True,
+    )
+    seconds = time.perf_counter() - start
+
+    return {
+        "cold": cold,
+        "precompile": seconds,
+        "warm": time_to_first_shot(cache_dir),
+    }
+
+
+def _require_caching() -> None:
+    """Raise if compiled kernels aren't cached to disk"""
+    if not const.use_numba_cache:
+        raise ValueError(
+            "Compiled kernels aren't cached, because "
+            "pooltool.constants.use_numba_cache is False"
+        )
+
+
+def _redirect_cache(cache_dir: Path) -> None:
+    """Cache compiled kernels to a directory from now on"""
+    os.environ["NUMBA_CACHE_DIR"] = str(cache_dir)
+    numba.config.CACHE_DIR = str(cache_dir)
+
+    # Each kernel chose its cache location when it was decorated
+    for dispatcher in _dispatchers():
+        dispatcher.enable_caching()
+        if dispatcher.signatures:
+            dispatcher.recompile()
+
+
+def _dispatchers() -> List[Dispatcher]:
+    """The just-in-time compiled kernels of all imported pooltool modules"""
+    dispatchers: Dict[int, Dispatcher] = {}
+    for name, module in list(sys.modules.items()):
+        if module is None or name.split(".")[0] != "pooltool":
+            continue
+
+        for obj in list(vars(module).values()):
+            if isinstance(obj, Dispatcher):
+                dispatchers[id(obj)] = obj
+
+    return list(dispatchers.values())
+
+
+def _exercise() -> None:
+    """Call every kernel with the argument types simulations call them with"""
+    # The example shot has pocket and linear cushion events, and the break has circular
+    # cushion and many ball-ball events
+    shots = [System.example(), nine_ball_break()]
+    condition = stop.ball_pocketed() | stop.cushion_contacts("cue", 2)
+
+    for solver in QuarticSolver:
+        minimum_quartic_roots(np.random.default_rng(42).random((8, 5)), solver)
+
+        for shot in shots:
+            simulate(shot, quartic_solver=solver)
+            simulate(shot, quartic_solver=solver, cache_collisions=True)
+            simulate(shot, quartic_solver=solver, stop=condition)
+            simulate_compiled(shot, quartic_solver=solver)
+            simulate_compiled(shot, quartic_solver=solver, stop=condition)
+
+            # Tables this size are detected serially, so the parallel kernel is
+            # exercised directly
+            FusedDetector.from_table(shot.table, parallel=True).next_collisions(
+                shot, solver
+            )
+
+        simulate(shots[1], quartic_solver=solver, broadphase=BroadPhase.SWEEP_AND_PRUNE)
+        simulate_batch(shots, quartic_solver=solver)
+
+    continuize(simulate(shots[0]))
+
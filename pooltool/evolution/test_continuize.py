@@ -1,5 +1,11 @@
+from bisect import bisect_right
+
+import numpy as np
+import pytest
+
 from pooltool.evolution.continuize import continuize
 from pooltool.evolution.event_based.simulate import simulate
+from pooltool.physics.evolve import evolve_ball_motion
 from pooltool.system import System
 
 
@@ -30,3 +36,39 @@ def test_continuize_inplace():
 
     # They are the same object
     assert continuized_system is system
+
+
+@pytest.mark.parametrize("dt", [0.01, 1 / 240])
+def test_continuize_matches_evolution(dt: float):
+    for phi in np.linspace(0, 360, 6, endpoint=False):
+        system = System.example()
+        system.cue.set_state(phi=phi)
+        simulate(system, inplace=True)
+        continuize(system, dt=dt, inplace=True)
+
+        num_timestamps = int(system.events[-1].time // dt) + 1
+
+        for ball in system.balls.values():
+            history = ball.history_cts
+            assert len(history) == num_timestamps + 1
+            assert history[0] == ball.history[0]
+            assert history[-1] == ball.history[-1]
+
+            # Each timepoint can be recovered by evolving the ball from the preceding
+            # event-based state
+            times = [state.t for state in ball.history]
+            for state in history.states[1:-1]:
+                previous = ball.history[bisect_right(times, state.t) - 1]
+                rvw, s = evolve_ball_motion(
+                    previous.s,
+                    previous.rvw,
+                    ball.params.R,
+                    ball.params.m,
+                    ball.params.u_s,
+                    ball.params.u_sp,
+                    ball.params.u_r,
+                    ball.params.g,
+                    state.t - previous.t,
+                )
+                assert state.s == s
+                assert np.allclose(state.rvw, rvw, atol=1e-9)
@@ -0,0 +1,29 @@
+import pytest
+
+import pooltool.constants as const
+from pooltool.evolution.event_based import solve
+from pooltool.evolution.precompile import _dispatchers, benchmark, precompile
+
+
+def test_precompile():
+    report = precompile()
+
+    assert report.cache_dir is None
+    assert report.kernels == len(_dispatchers())
+    assert report.kernels > 0
+    assert report.signatures > 0
+
+    # The kernels simulations use have been compiled
+    assert solve.ball_transition_time.signatures
+    assert solve.ball_ball_collision_coeffs.signatures
+
+
+def test_precompile_caching_disabled(monkeypatch, tmp_path):
+    monkeypatch.setattr(const, "use_numba_cache", False)
+
+    # There's no cache to precompile to, or to benchmark
+    with pytest.raises(ValueError):
+        precompile(tmp_path / "cache")
+    with pytest.raises(ValueError):
+        benchmark(tmp_path / "cache")
+    assert not (tmp_path / "cache").exists()
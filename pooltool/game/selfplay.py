@@ -0,0 +1,423 @@
+"""Headless self-play of complete games
+
+:func:`play_games` plays many complete games between AI players (see
+:class:`pooltool.ruleset.datatypes.AIPlayer`) without a GUI, for example to generate
+training data for agents.
+
+Games are played in lockstep: every game in progress takes its next shot, the shots are
+simulated together with :func:`pooltool.evolution.event_based.batch.simulate_batch`,
+and then each game's ruleset processes its shot and advances. Each game holds a single
+system, whose history is reset before each shot, so only the ball states and pocket
+contents that rulesets need carry over between shots, and memory doesn't grow with the
+length of a game. Recording every shot (to the columnar format, see
+:mod:`pooltool.system.columnar`) is opt-in.
+
+With more than one worker, games are split between worker processes, each of which
+plays its games in lockstep. Since whole games are sent to workers, rather than shots,
+nothing but the results are sent between processes.
+"""
+
+from __future__ import annotations
+
+import os
+import time
+from collections import deque
+from concurrent.futures import ProcessPoolExecutor
+from functools import partial
+from pathlib import Path
+from typing import Callable, Deque, Dict, Iterable, List, Optional, Sequence
+
+import attrs
+import numpy as np
+
+import pooltool.ai.aim as aim
+import pooltool.constants as const
+from pooltool.ai.action import Action
+from pooltool.ai.pot import calc_potting_angle, pick_easiest_pot
+from pooltool.evolution.event_based.batch import simulate_batch
+from pooltool.game.datatypes import GameType
+from pooltool.layouts import get_rack
+from pooltool.objects import Cue, Table
+from pooltool.physics.engine import PhysicsEngine
+from pooltool.ptmath.roots.quartic import QuarticSolver
+from pooltool.ruleset import Player, Ruleset, get_ruleset
+from pooltool.serialize.serializers import Pathish
+from pooltool.system.datatypes import MultiSystem, System
+
+# A game's players, given the game's index
+PlayersFactory = Callable[[int], Sequence[Player]]
+
+
+class PottingAI:
+    """A baseline AI that pots the easiest ball it's allowed to hit
+
+    Among the hittable balls, it picks one at random that can be potted (see
+    :func:`pooltool.ai.pot.pick_easiest_pot`), and aims to pot it with a random speed.
+    If none can be potted, it hits a random hittable ball with a random cut. If the
+    ruleset requires shots to be called, the ball and pocket are called. Ball-in-hand
+    isn't taken advantage of: the cue ball is left where the ruleset spots it.
+
+    Args:
+        seed:
+            Seeds the random choices.
+        noise:
+            The standard deviation of the error added to the cue angle phi, in degrees.
+    """
+
+    def __init__(self, seed: Optional[Sequence[int]] = None, noise: float = 0.5):
+        self.rng = np.random.default_rng(seed)
+        self.noise = noise
+
+    def decide(
+        self,
+        system: System,
+        game: Ruleset,
+        callback: Optional[Callable[[Action], None]] = None,
+    ) -> Action:
+        constraints = game.shot_constraints
+        cue_ball_id = system.cue.cue_ball_id
+        cue_ball = system.balls[cue_ball_id]
+
+        targets = _on_table(system, constraints.hittable, cue_ball_id)
+        if not len(targets):
+            targets = _on_table(system, system.balls.keys(), cue_ball_id)
+
+        pocket = None
+        for i in self.rng.permutation(len(targets)):
+            ball = system.balls[targets[i]]
+            if (pocket := pick_easiest_pot(system, ball)) is not None:
+                phi = calc_potting_angle(cue_ball, ball, system.table, pocket)
+                break
+        else:
+            ball = system.balls[targets[self.rng.integers(len(targets))]]
+            phi = aim.at_ball(system, ball.id, cut=self.rng.uniform(-45, 45))
+
+        if constraints.call_shot:
+            constraints.ball_call = ball.id
+            if pocket is None and len(system.table.pockets):
+                pocket = list(system.table.pockets.values())[0]
+            constraints.pocket_call = None if pocket is None else pocket.id
+
+        action = Action(
+            V0=self.rng.uniform(1.5, 4),
+            phi=(phi + self.rng.normal(0, self.noise)) % 360,
+            theta=0.0,
+            a=0.0,
+            b=0.0,
+        )
+
+        if callback is not None:
+            callback(action)
+
+        return action
+
+    def apply(self, system: System, action: Action) -> None:
+        action.apply(system.cue)
+
+
+def _on_table(system: System, ball_ids: Iterable[str], cue_ball_id: str) -> List[str]:
+    return [
+        ball_id
+        for ball_id in ball_ids
+        if ball_id != cue_ball_id
+        and ball_id in system.balls
+        and system.balls[ball_id].state.s != const.pocketed
+    ]
+
+
+def potting_players(index: int, seed: Optional[int] = None) -> List[Player]:
+    """Two :class:`PottingAI` players, seeded by `seed` and the game's index"""
+    return [
+        Player(
+            f"Player {i + 1}",
+            ai=PottingAI(seed=None if seed is None else (seed, index, i)),
+        )
+        for i in range(2)
+    ]
+
+
+@attrs.define(frozen=True)
+class GameResult:
+    """The outcome of a game
+
+    Attributes:
+        index:
+            The game's index.
+        winner:
+            The winner's name, or None if the game was tied or unfinished.
+        score:
+            The final score (see :attr:`pooltool.ruleset.datatypes.ShotInfo.score`).
+        shots:
+            The number of shots played.
+        finished:
+            False if the game was cut short after ``max_shots`` shots.
+        path:
+            If shots were recorded, the file they were saved to.
+    """
+
+    index: int
+    winner: Optional[str]
+    score: Dict[str, int]
+    shots: int
+    finished: bool
+    path: Optional[Path] = None
+
+
+@attrs.define(frozen=True)
+class SelfPlayReport:
+    """The outcome of :func:`play_games`
+
+    Attributes:
+        results:
+            The result of each game, in order of index.
+        seconds:
+            The wall time taken.
+        workers:
+            The number of worker processes.
+    """
+
+    results: List[GameResult]
+    seconds: float
+    workers: int
+
+    @property
+    def shots(self) -> int:
+        return sum(result.shots for result in self.results)
+
+    @property
+    def games_per_second(self) -> float:
+        return len(self.results) / self.seconds
+
+    @property
+    def games_per_second_per_core(self) -> float:
+        return self.games_per_second / self.workers
+
+
+@attrs.define
+class _Game:
+    """A game in progress"""
+
+    index: int
+    ruleset: Ruleset
+    system: System
+    recorded: Optional[MultiSystem]
+    shots: int = 0
+
+    @classmethod
+    def create(
+        cls,
+        game_type: GameType,
+        index: int,
+        players: Sequence[Player],
+        record: bool,
+        seed: Optional[int],
+    ) -> _Game:
+        for player in players:
+            if not player.is_ai:
+                raise ValueError(f"Player '{player.name}' isn't an AI player")
+
+        if seed is not None:
+            # Racks are randomly spaced
+            np.random.seed((seed + index) % 2**32)
+
+        ruleset = get_ruleset(game_type)(players=list(players))
+        table = Table.from_game_type(game_type)
+        rack = get_rack(game_type, table=table)
+
+        # Batched shots must share ball IDs in the same order, but racks are ordered
+        # randomly
+        balls = {ball_id: rack[ball_id] for ball_id in sorted(rack)}
+        cue = Cue(cue_ball_id=ruleset.shot_constraints.cueball(balls))
+
+        return cls(
+            index=index,
+            ruleset=ruleset,
+            system=System(cue=cue, table=table, balls=balls),
+            recorded=MultiSystem() if record else None,
+        )
+
+    def aim(self) -> System:
+        """Have the active player set up the next shot"""
+        # The previous shot was processed, so its history is no longer needed
+        self.system.reset_history()
+
+        ai = self.ruleset.active_player.ai
+        assert ai is not None
+        ai.apply(self.system, ai.decide(self.system, self.ruleset))
+
+        return self.system
+
+    def advance(self) -> None:
+        """Process the simulated shot"""
+        if self.recorded is not None:
+            # Rulesets respot balls in place, so the shot is recorded beforehand
+            self.recorded.append(self.system.copy())
+
+        self.ruleset.process_and_advance(self.system)
+        self.shots += 1
+
+    def result(self, finished: bool, record_dir: Optional[Path]) -> GameResult:
+        path = None
+        if self.recorded is not None:
+            assert record_dir is not None
+            path = record_dir / f"game_{self.index:08d}.columnar"
+            self.recorded.save(path)
+
+        winner = self.ruleset.shot_info.winner if finished else None
+        return GameResult(
+            index=self.index,
+            winner=None if winner is None else winner.name,
+            score=dict(self.ruleset.score),
+            shots=self.shots,
+            finished=finished,
+            path=path,
+        )
+
+
+def _play(
+    game_type: GameType,
+    indices: Sequence[int],
+    players: PlayersFactory,
+    concurrency: int,
+    max_shots: int,
+    record: Optional[Path],
+    seed: Optional[int],
+    engine: Optional[PhysicsEngine],
+    quartic_solver: QuarticSolver,
+    max_events: int,
+) -> List[GameResult]:
+    """Play games in lockstep, `concurrency` at a time"""
+    pending: Deque[int] = deque(indices)
+    active: List[_Game] = []
+    results: List[GameResult] = []
+
+    while len(pending) or len(active):
+        while len(pending) and len(active) < concurrency:
+            index = pending.popleft()
+            active.append(
+                _Game.create(game_type, index, players(index), record is not None, seed)
+            )
+
+        simulate_batch(
+            [game.aim() for game in active],
+            engine=engine,
+            inplace=True,
+            quartic_solver=quartic_solver,
+            max_events=max_events,
+        )
+
+        unfinished = []
+        for game in active:
+            game.advance()
+            if game.ruleset.shot_info.game_over:
+                results.append(game.result(True, record))
+            elif game.shots >= max_shots:
+                results.append(game.result(False, record))
+            else:
+                unfinished.append(game)
+        active = unfinished
+
+    return sorted(results, key=lambda result: result.index)
+
+
+def play_games(
+    game_type: GameType,
+    num_games: int,
+    players: Optional[PlayersFactory] = None,
+    workers: Optional[int] = 1,
+    concurrency: int = 64,
+    max_shots: int = 500,
+    record: Optional[Pathish] = None,
+    seed: Optional[int] = None,
+    engine: Optional[PhysicsEngine] = None,
+    quartic_solver: QuarticSolver = QuarticSolver.HYBRID,
+    max_events: int = 10_000,
+) -> SelfPlayReport:
+    """Play complete games between AI players
+
+    Args:
+        game_type:
+            The game to play.
+        num_games:
+            The number of games.
+        players:
+            Creates the players of a game, given the game's index. Every player must
+            have an AI. With more than one worker, this must be picklable. By default,
+            two :class:`PottingAI` players play (see :func:`potting_players`).
+        workers:
+            The number of worker processes. Pass None to use every CPU.
+        concurrency:
+            The number of games each worker plays in lockstep. Larger values amortize
+            the overhead of batched simulation over more shots.
+        max_shots:
+            Games are cut short (and marked unfinished) after this many shots.
+        record:
+            If passed, the shots of each game are saved to a columnar file in this
+            directory (see :attr:`GameResult.path`).
+        seed:
+            If passed, the racks and default players are seeded, so that the games are
+            reproducible.
+        engine:
+            See :func:`pooltool.evolution.event_based.simulate.simulate`.
+        quartic_solver:
+            See :func:`pooltool.evolution.event_based.simulate.simulate`.
+        max_events:
+            Each shot's simulation is cut short after this many events (see
+            :func:`pooltool.evolution.event_based.simulate.simulate`), so that rare
+            near-infinite event loops don't stall the run. Pass 0 for no limit.
+
+    Returns:
+        SelfPlayReport: The result of each game, and the throughput.
+
+    Example:
+
+        Play 9-ball on every core, and report the throughput:
+
+        >>> import pooltool as pt
+        >>> report = pt.play_games(pt.GameType.NINEBALL, 1000, workers=None, seed=42)
+        >>> print(f"{report.games_per_second_per_core:.1f} games/s/core")
+    """
+    if players is None:
+        players = partial(potting_players, seed=seed)
+
+    if workers is None:
+        workers = os.cpu_count() or 1
+    workers = max(1, min(workers, num_games))
+
+    record_dir = None
+    if record is not None:
+        record_dir = Path(record)
+        record_dir.mkdir(parents=True, exist_ok=True)
+
+    play = partial(
+        _play,
+        game_type,
+        players=players,
+        concurrency=concurrency,
+        max_shots=max_shots,
+        record=record_dir,
+        seed=seed,
+        engine=engine,
+        quartic_solver=quartic_solver,
+        max_events=max_events,
+    )
+
+    start = time.perf_counter()
+
+    if workers == 1:
+        results = play(range(num_games))
+    else:
+        chunks = [
+            [int(index) for index in chunk]
+            for chunk in np.array_split(np.arange(num_games), workers)
+        ]
+        with ProcessPoolExecutor(max_workers=workers) as executor:
+            results = [
+                result for chunk in executor.map(play, chunks) for result in chunk
+            ]
+
+    return SelfPlayReport(
+        results=results,
+        seconds=time.perf_counter() - start,
+        workers=workers,
+    )
@@ -0,0 +1,51 @@
+from pathlib import Path
+
+import pytest
+
+from pooltool.game.datatypes import GameType
+from pooltool.game.selfplay import play_games
+from pooltool.ruleset import Player
+from pooltool.system.datatypes import MultiSystem
+
+
+def test_play_games():
+    report = play_games(GameType.NINEBALL, 4, max_shots=10, seed=42)
+
+    assert [result.index for result in report.results] == [0, 1, 2, 3]
+    assert report.shots == sum(result.shots for result in report.results)
+    assert report.games_per_second > 0
+
+    for result in report.results:
+        assert 0 < result.shots <= 10
+        if not result.finished:
+            assert result.shots == 10
+            assert result.winner is None
+
+
+def test_play_games_reproducible():
+    # Playing in lockstep doesn't change the outcome of each game
+    lockstep = play_games(GameType.NINEBALL, 3, max_shots=5, seed=0, concurrency=3)
+    one_by_one = play_games(GameType.NINEBALL, 3, max_shots=5, seed=0, concurrency=1)
+
+    assert lockstep.results == one_by_one.results
+
+
+def test_play_games_record(tmp_path: Path):
+    report = play_games(GameType.EIGHTBALL, 2, max_shots=3, seed=42, record=tmp_path)
+
+    for result in report.results:
+        assert result.path is not None
+        assert len(MultiSystem.load(result.path)) == result.shots
+
+
+def test_play_games_workers():
+    serial = play_games(GameType.NINEBALL, 2, max_shots=3, seed=42)
+    parallel = play_games(GameType.NINEBALL, 2, max_shots=3, seed=42, workers=2)
+
+    assert parallel.workers == 2
+    assert parallel.results == serial.results
+
+
+def test_play_games_requires_ai():
+    with pytest.raises(ValueError):
+        play_games(GameType.NINEBALL, 1, players=lambda index: [Player("Human")])
@@ -0,0 +1,242 @@
+"""Opt-in instrumentation of simulations
+
+Pass a block of code to :func:`instrument` to find out where its simulation time goes:
+
+    >>> import pooltool as pt
+    >>> with pt.instrument() as stats:
+    >>>     pt.simulate(pt.System.example())
+    >>> print(stats.summary())
+
+:func:`pooltool.evolution.event_based.simulate.simulate` records the time spent in each
+phase of its event loop (see :class:`Phase`) and the collision candidates it considers.
+:meth:`pooltool.physics.resolve.resolver.Resolver.resolve` records the number of events
+of each type it resolves, and their cumulative resolution time. The quartic solvers
+(see :mod:`pooltool.ptmath.roots.quartic`) record how many polynomials they solved, and
+how many fell back to the numerical solver. Simulation caches (see
+:class:`pooltool.evolution.event_based.memo.SimulationCache`) record their hits and
+misses.
+
+Each instrumented site checks :data:`active` once and does nothing else unless
+instrumentation is on, so it costs close to nothing when it's off. The engines whose
+event loops are compiled (see
+:func:`pooltool.evolution.event_based.compiled.simulate_compiled`) aren't instrumented.
+
+This module imports nothing from pooltool but :mod:`pooltool.utils.strenum`, so any
+module can be instrumented without import cycles.
+"""
+
+from __future__ import annotations
+
+import time
+import tracemalloc
+from collections import defaultdict
+from contextlib import contextmanager
+from typing import DefaultDict, Iterator, List, Optional, Sized
+
+import attrs
+
+from pooltool.utils.strenum import StrEnum, auto
+
+
+class Phase(StrEnum):
+    """The phases of each step of the event loop
+
+    Attributes:
+        DETECT:
+            Finding the next event (see
+            :func:`pooltool.evolution.event_based.simulate.get_next_event`).
+        EVOLVE:
+            Evolving the balls to the time of the event.
+        RESOLVE:
+            Resolving the event, and updating the transition and trajectory caches.
+        RECORD:
+            Recording the event into the system's history, updating the collision
+            cache, and checking whether the shot is over.
+    """
+
+    DETECT = auto()
+    EVOLVE = auto()
+    RESOLVE = auto()
+    RECORD = auto()
+
+
+def _tally() -> DefaultDict[str, int]:
+    return defaultdict(int)
+
+
+def _timer() -> DefaultDict[str, float]:
+    return defaultdict(float)
+
+
+@attrs.define
+class SimulationStats:
+    """Instrumentation counters collected by :func:`instrument`
+
+    Keys of the per-event-type counters are
+    :class:`pooltool.events.datatypes.EventType` values, and keys of the per-phase
+    timers are :class:`Phase` values. All times are wall times, in seconds.
+
+    Attributes:
+        shots:
+            The number of shots simulated.
+        events:
+            The number of events resolved, per event type.
+        event_time:
+            The cumulative time spent resolving events, per event type.
+        phase_time:
+            The cumulative time spent in each phase of the event loop.
+        quartics:
+            The number of quartic polynomials solved.
+        quartic_fallbacks:
+            How many of them were solved with the numerical solver, because the
+            requested solver couldn't solve them reliably.
+        candidates:
+            The number of collision candidates (*e.g.* ball pairs) there were to
+            consider, per collision event type.
+        culled_candidates:
+            The number left after broad phase culling (see
+            :class:`pooltool.evolution.event_based.broadphase.BroadPhase`), per
+            collision event type. Without culling, these are equal to ``candidates``.
+        cache_hits:
+            The number of shots found in a simulation cache.
+        cache_misses:
+            The number of shots a simulation cache had to simulate.
+        allocated:
+            If allocations are traced, the net number of bytes allocated.
+        peak_allocated:
+            If allocations are traced, the peak number of bytes allocated.
+    """
+
+    shots: int = attrs.field(default=0)
+    events: DefaultDict[str, int] = attrs.field(factory=_tally)
+    event_time: DefaultDict[str, float] = attrs.field(factory=_timer)
+    phase_time: DefaultDict[str, float] = attrs.field(factory=_timer)
+    quartics: int = attrs.field(default=0)
+    quartic_fallbacks: int = attrs.field(default=0)
+    candidates: DefaultDict[str, int] = attrs.field(factory=_tally)
+    culled_candidates: DefaultDict[str, int] = attrs.field(factory=_tally)
+    cache_hits: int = attrs.field(default=0)
+    cache_misses: int = attrs.field(default=0)
+    allocated: Optional[int] = attrs.field(default=None)
+    peak_allocated: Optional[int] = attrs.field(default=None)
+
+    _lap: float = attrs.field(default=0.0, init=False, repr=False, eq=False)
+
+    def lap(self, phase: Optional[Phase] = None) -> None:
+        """Attribute the time since the previous lap to a phase
+
+        If ``phase`` is None, the time since the previous lap is discarded.
+        """
+        now = time.perf_counter()
+        if phase is not None:
+            self.phase_time[phase] += now - self._lap
+        self._lap = now
+
+    def record_event(self, event_type: str, seconds: float) -> None:
+        self.events[event_type] += 1
+        self.event_time[event_type] += seconds
+
+    def record_quartics(self, num: int, fallbacks: int) -> None:
+        self.quartics += num
+        self.quartic_fallbacks += fallbacks
+
+    def record_candidates(
+        self, event_type: str, num: int, culled: Optional[Sized]
+    ) -> None:
+        """Record collision candidates
+
+        Args:
+            event_type:
+                The type of collision.
+            num:
+                The number of candidates before culling.
+            culled:
+                The candidates left after culling, or None if there was no culling.
+        """
+        self.candidates[event_type] += num
+        self.culled_candidates[event_type] += num if culled is None else len(culled)
+
+    def record_cache(self, hit: bool) -> None:
+        if hit:
+            self.cache_hits += 1
+        else:
+            self.cache_misses += 1
+
+    def summary(self) -> str:
+        """A human-readable summary of the counters"""
+        lines: List[str] = [f"shots: {self.shots}"]
+
+        lines.append("events (count, seconds):")
+        for event_type, count in sorted(self.events.items()):
+            seconds = self.event_time[event_type]
+            lines.append(f"    {event_type}: {count}, {seconds:.6f}")
+
+        lines.append("phases (seconds):")
+        for phase in Phase:
+            lines.append(f"    {phase}: {self.phase_time[phase]:.6f}")
+
+        lines.append(f"quartics: {self.quartics} ({self.quartic_fallbacks} fallbacks)")
+
+        lines.append("candidates (before culling, after culling):")
+        for event_type, count in sorted(self.candidates.items()):
+            culled = self.culled_candidates[event_type]
+            lines.append(f"    {event_type}: {count}, {culled}")
+
+        if self.cache_hits or self.cache_misses:
+            lines.append(f"cache: {self.cache_hits} hits, {self.cache_misses} misses")
+
+        if self.allocated is not None:
+            lines.append(f"allocated: {self.allocated} bytes")
+            lines.append(f"peak allocated: {self.peak_allocated} bytes")
+
+        return "\n".join(lines)
+
+
+# The stats being collected, or None if instrumentation is off. Instrumented sites read
+# this once, and skip all instrumentation if it's None
+active: Optional[SimulationStats] = None
+
+
+@contextmanager
+def instrument(trace_allocations: bool = False) -> Iterator[SimulationStats]:
+    """Collect simulation statistics within a block
+
+    Instrumentation is process-wide and not thread-safe: simulations run on other
+    threads during the block are instrumented too, and their counts may race.
+    Simulations run in other processes aren't instrumented. Nested blocks collect
+    statistics only into the innermost block.
+
+    Args:
+        trace_allocations:
+            If True, memory allocations are traced with :mod:`tracemalloc`, which
+            slows down everything within the block considerably.
+
+    Yields:
+        SimulationStats: The statistics, which are populated as the block runs.
+    """
+    global active
+
+    previous = active
+    stats = SimulationStats()
+
+    tracing = trace_allocations and not tracemalloc.is_tracing()
+    if tracing:
+        tracemalloc.start()
+    if trace_allocations:
+        # Python < 3.9 can't reset the peak of an ongoing trace
+        if hasattr(tracemalloc, "reset_peak"):
+            tracemalloc.reset_peak()
+        baseline = tracemalloc.get_traced_memory()[0]
+
+    active = stats
+    try:
+        yield stats
+    finally:
+        active = previous
+
+        if trace_allocations:
+            current, peak = tracemalloc.get_traced_memory()
+            stats.allocated = current - baseline
+            stats.peak_allocated = peak - baseline
+        if tracing:
+            tracemalloc.stop()
@@ -7,11 +7,13 @@ from typing import Any, Dict, List, Optional, Protocol, Set, Tuple, Union
 
 import attrs
 import numpy as np
+from numpy.typing import NDArray
 
 from pooltool.game.datatypes import GameType
 from pooltool.objects.ball.datatypes import Ball, BallParams
 from pooltool.objects.ball.sets import BallSet, get_ballset
 from pooltool.objects.table.datatypes import Table
+from pooltool.ptmath.placement import place_layouts
 from pooltool.utils import classproperty
 from pooltool.utils.strenum import StrEnum, auto
 
@@ -271,6 +273,66 @@ def _wiggle(x: float, y: float, spacer: float) -> Tuple[float, float]:
     return x + rad * np.cos(ang), y + rad * np.sin(ang)
 
 
+def random_layouts(
+    num_layouts: int,
+    num_balls: int,
+    table: Table,
+    ball_params: Optional[BallParams] = None,
+    niter: int = 100,
+    seed: Optional[int] = None,
+) -> NDArray[np.float64]:
+    """Generate random non-overlapping ball layouts, as arrays
+
+    Layouts are generated in bulk by a single just-in-time compiled call (see
+    :func:`pooltool.ptmath.placement.place_layouts`), so this is suited to generating
+    many starting positions, `e.g.` for training data.
+
+    Args:
+        num_layouts:
+            The number of layouts.
+        num_balls:
+            The number of balls in each layout.
+        table:
+            The table the balls are placed on.
+        ball_params:
+            The ball parameters, which set the ball radius. Defaults to
+            :meth:`BallParams.default`.
+        niter:
+            The number of draws of each ball, and the number of restarts of each
+            layout, before giving up.
+        seed:
+            Set a seed for reproducibility.
+
+    Returns:
+        NDArray[np.float64]:
+            The planar ball positions of each layout, with shape ``(num_layouts,
+            num_balls, 2)``.
+
+    Raises:
+        ValueError:
+            If a layout couldn't be placed, which happens when the balls don't fit
+            comfortably on the table.
+    """
+    if ball_params is None:
+        ball_params = BallParams.default()
+
+    if seed is None:
+        seed = np.random.randint(2**31)
+
+    if not num_balls:
+        return np.zeros((num_layouts, 0, 2))
+
+    R = np.full(num_balls, ball_params.R, dtype=np.float64)
+    xy, placed = place_layouts(num_layouts, R, table.w, table.l, niter, seed)
+
+    if not placed.all():
+        raise ValueError(
+            f"Couldn't place {num_balls} balls on the table in {niter} attempts"
+        )
+
+    return xy
+
+
 def _get_nine_ball_rack(
     table: Table,
     ballset: Optional[BallSet] = None,
@@ -538,5 +600,6 @@ __all__ = [
     "BallPos",
     "ball_cluster_blueprint",
     "generate_layout",
+    "random_layouts",
     "get_rack",
 ]
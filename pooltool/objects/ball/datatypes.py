@@ -2,7 +2,8 @@
 
 from __future__ import annotations
 
-from typing import Iterator, List, Optional, Sequence, Tuple
+import operator
+from typing import Iterable, Iterator, List, Optional, Sequence, Tuple
 
 import numpy as np
 from attrs import define, evolve, field, validate
@@ -62,6 +63,10 @@ class BallOrientation:
         return self
 
 
+# The number of states a BallHistory has room for upon its first addition
+_INITIAL_CAPACITY = 16
+
+
 def _null_rvw() -> NDArray[np.float64]:
     return np.array([[np.nan, np.nan, np.nan], [0, 0, 0], [0, 0, 0]], dtype=np.float64)
 
@@ -138,69 +143,244 @@ class BallState:
         )
 
 
-@define
 class BallHistory:
     """A container of BallState objects
 
-    Attributes:
+    The states are stored column-wise, in contiguous arrays of kinematic states
+    (:attr:`BallState.rvw`), motion states (:attr:`BallState.s`), and timestamps
+    (:attr:`BallState.t`). The arrays are over-allocated and grow geometrically, so
+    adding a state takes amortized constant time.
+
+    Indexing and iterating produce copies of the states, so modifying them doesn't
+    modify the history. Use :meth:`__setitem__` (*e.g.* ``history[0] = state``),
+    :meth:`add`, or :meth:`vectorize` to modify it.
+
+    Copies (see :meth:`copy` and :meth:`truncated`) share storage with the original
+    until either is accessed in a way that could modify it (adding, setting, or
+    vectorizing), at which point it moves to storage of its own. Reading states doesn't
+    copy the storage.
+
+    Args:
         states:
-            A list of time-increasing BallState objects (*default* = ``[]``).
+            Time-increasing BallState objects to initialize the history with (*default*
+            = ``()``).
     """
 
-    states: List[BallState] = field(factory=list)
-    """A list of time-increasing BallState objects (*default* = ``[]``)"""
+    __slots__ = ("_rvws", "_ss", "_ts", "_length", "_shares")
+
+    def __init__(self, states: Iterable[BallState] = ()) -> None:
+        self._rvws: NDArray[np.float64] = np.empty((0, 3, 3), dtype=np.float64)
+        self._ss: NDArray[np.float64] = np.empty(0, dtype=np.float64)
+        self._ts: NDArray[np.float64] = np.empty(0, dtype=np.float64)
+        self._length = 0
+
+        # The number of histories sharing this storage. The list is shared between them
+        self._shares = [1]
+
+        for state in states:
+            self.add(state)
 
     def __getitem__(self, idx: int) -> BallState:
-        return self.states[idx]
+        idx = self._index(idx)
+        return BallState(self._rvws[idx].copy(), self._ss[idx], self._ts[idx])
+
+    def __setitem__(self, idx: int, state: BallState) -> None:
+        idx = self._index(idx)
+        self._own()
+        self._rvws[idx] = state.rvw
+        self._ss[idx] = state.s
+        self._ts[idx] = state.t
 
     def __len__(self) -> int:
-        return len(self.states)
+        return self._length
 
     def __iter__(self) -> Iterator[BallState]:
-        for state in self.states:
-            yield state
+        rvws, ss, ts = self._columns()
+        for rvw, s, t in zip(rvws.copy(), ss, ts):
+            yield BallState(rvw, s, t)
+
+    def __eq__(self, other) -> bool:
+        if not isinstance(other, BallHistory):
+            return NotImplemented
+
+        if len(self) != len(other):
+            return False
+
+        return all(
+            np.array_equal(a, b, equal_nan=True)
+            for a, b in zip(self._columns(), other._columns())
+        )
+
+    def __repr__(self) -> str:
+        return f"BallHistory(states={self.states!r})"
+
+    def __reduce__(self):
+        # Spare capacity isn't pickled
+        columns = self._columns() if self._length else None
+        return BallHistory.from_vectorization, (columns,)
+
+    @property
+    def states(self) -> List[BallState]:
+        """A list of time-increasing BallState objects
+
+        Note:
+            - The list is created upon access, so appending to it doesn't modify the
+              history. Use :meth:`add` instead.
+        """
+        return list(self)
 
     @property
     def empty(self) -> bool:
         """Returns whether or not the ball history is empty
 
         Returns:
-            bool: True if :attr:`states` has no length else False
+            bool: True if the history has no length else False
         """
-        return not bool(len(self.states))
+        return not bool(self._length)
 
     def add(self, state: BallState) -> None:
         """Append a state to the history
 
         Raises:
-            AssertionError: If ``state.t < self.states[-1]``
+            AssertionError: If ``state.t < self[-1].t``
 
         Notes:
-            - This appends ``state`` to :attr:`states`
-            - ``state`` is not copied before appending to the history, so they
-              share the same memory address.
+            - The values of ``state`` are copied into the history, so modifying
+              ``state`` afterwards doesn't modify the history.
+        """
+        if not self.empty:
+            assert state.t >= self._ts[self._length - 1]
+
+        self._own()
+        if self._length == len(self._ts):
+            self._reserve(max(_INITIAL_CAPACITY, 2 * self._length))
+
+        self._rvws[self._length] = state.rvw
+        self._ss[self._length] = state.s
+        self._ts[self._length] = state.t
+        self._length += 1
+
+    def add_vectorization(
+        self,
+        vectorization: Tuple[
+            NDArray[np.float64], NDArray[np.float64], NDArray[np.float64]
+        ],
+    ) -> None:
+        """Append many states, given as arrays
+
+        This is like calling :meth:`add` for each state, but the states are copied into
+        the history at once.
+
+        Args:
+            vectorization:
+                The rvw, s, and t arrays of the states (see :meth:`vectorize`).
+
+        Raises:
+            AssertionError: If the states aren't ordered in time, or are earlier than
+                ``self[-1].t``
         """
+        rvws, ss, ts = vectorization
+        num = len(ts)
+        assert len(rvws) == len(ss) == num
+
+        if not num:
+            return
+
+        assert (np.diff(ts) >= 0).all()
         if not self.empty:
-            assert state.t >= self.states[-1].t
+            assert ts[0] >= self._ts[self._length - 1]
+
+        self._own()
+        end = self._length + num
+        if end > len(self._ts):
+            self._reserve(max(_INITIAL_CAPACITY, 2 * self._length, end))
 
-        self.states.append(state)
+        self._rvws[self._length : end] = rvws
+        self._ss[self._length : end] = ss
+        self._ts[self._length : end] = ts
+        self._length = end
 
     def copy(self) -> BallHistory:
-        """Create a copy"""
+        """Create a copy
+
+        This takes constant time, since the copy shares storage with ``self`` until
+        either is modified.
+        """
+        return self.truncated(self._length)
+
+    def truncated(self, length: int) -> BallHistory:
+        """Create a history of the first ``length`` states
+
+        Like :meth:`copy`, this takes constant time, since the truncated history shares
+        storage with ``self`` until either is modified.
+
+        Raises:
+            IndexError: If ``length`` is negative or greater than ``len(self)``
+        """
+        if not 0 <= length <= self._length:
+            raise IndexError("BallHistory truncation length out of range")
+
         history = BallHistory()
-        for state in self.states:
-            history.add(state.copy())
+        if not length:
+            return history
 
+        history._rvws, history._ss, history._ts = self._rvws, self._ss, self._ts
+        history._length = length
+        history._shares = self._shares
+        self._shares[0] += 1
         return history
 
+    def _index(self, idx: int) -> int:
+        idx = operator.index(idx)
+        if idx < 0:
+            idx += self._length
+        if not 0 <= idx < self._length:
+            raise IndexError("BallHistory index out of range")
+        return idx
+
+    def _columns(
+        self,
+    ) -> Tuple[NDArray[np.float64], NDArray[np.float64], NDArray[np.float64]]:
+        return (
+            self._rvws[: self._length],
+            self._ss[: self._length],
+            self._ts[: self._length],
+        )
+
+    def _own(self) -> None:
+        """Move to storage of its own, if the storage is shared or read-only"""
+        if self._shares[0] == 1 and self._rvws.flags.writeable:
+            if self._ss.flags.writeable and self._ts.flags.writeable:
+                return
+
+        self._shares[0] -= 1
+        self._shares = [1]
+        self._reserve(self._length)
+
+    def _reserve(self, capacity: int) -> None:
+        rvws = np.empty((capacity, 3, 3), dtype=np.float64)
+        ss = np.empty(capacity, dtype=np.float64)
+        ts = np.empty(capacity, dtype=np.float64)
+
+        rvws[: self._length], ss[: self._length], ts[: self._length] = self._columns()
+        self._rvws, self._ss, self._ts = rvws, ss, ts
+
     def vectorize(
         self,
     ) -> Optional[Tuple[NDArray[np.float64], NDArray[np.float64], NDArray[np.float64]]]:
-        """Compile the attribute from each ball state into arrays
+        """Get the attribute of each ball state as arrays
 
-        This method unzips each :class:`BallState` in :attr:`states`, resulting in an
-        array of :attr:`BallState.rvw` values, an array of :attr:`BallState.s` values,
-        and an array of :attr:`BallState.t` values.
+        This method returns an array of :attr:`BallState.rvw` values, an array of
+        :attr:`BallState.s` values, and an array of :attr:`BallState.t` values.
+
+        No data is copied: the arrays are views into the history's storage, so
+        modifying them modifies the history. If the storage was shared with a copy, the
+        history first moves to storage of its own.
+
+        Note:
+            - The views stay views into this history's current storage, which a later
+              :meth:`copy` shares. Vectorize again after copying, rather than holding
+              on to the views.
 
         The vectors have the following properties:
 
@@ -242,18 +422,8 @@ class BallHistory:
         if self.empty:
             return None
 
-        num_states = len(self.states)
-
-        rvws = np.empty((num_states, 3, 3), dtype=np.float64)
-        ss = np.empty(num_states, dtype=np.float64)
-        ts = np.empty(num_states, dtype=np.float64)
-
-        for idx, state in enumerate(self.states):
-            rvws[idx] = state.rvw
-            ss[idx] = state.s
-            ts[idx] = state.t
-
-        return rvws, ss, ts
+        self._own()
+        return self._columns()
 
     @staticmethod
     def from_vectorization(
@@ -265,6 +435,13 @@ class BallHistory:
 
         An inverse method of :meth:`vectorize`.
 
+        No data is copied: the history adopts the passed arrays as its storage (unless
+        they need to be converted to contiguous ``float64`` arrays). Read-only arrays
+        are adopted too, and are copied when the history is first modified.
+
+        Raises:
+            AssertionError: If the timestamps aren't time-increasing.
+
         Returns:
             BallHistory: A BallHistory constructed from the input vectors.
 
@@ -291,8 +468,14 @@ class BallHistory:
         if vectorization is None:
             return history
 
-        for args in zip(*vectorization):
-            history.add(BallState(*args))
+        rvws, ss, ts = (
+            np.ascontiguousarray(column, dtype=np.float64) for column in vectorization
+        )
+        assert len(rvws) == len(ss) == len(ts)
+        assert (np.diff(ts) >= 0).all()
+
+        history._rvws, history._ss, history._ts = rvws, ss, ts
+        history._length = len(ts)
 
         return history
 
@@ -302,7 +485,9 @@ class BallHistory:
 
 
 conversion.register_unstructure_hook(
-    BallHistory, lambda v: v.vectorize(), which=(SerializeFormat.MSGPACK,)
+    BallHistory,
+    lambda v: v._columns() if v._length else None,
+    which=(SerializeFormat.MSGPACK,),
 )
 conversion.register_structure_hook(
     BallHistory,
@@ -311,6 +496,26 @@ conversion.register_structure_hook(
 )
 
 
+def _register_state_list_hooks(fmt: SerializeFormat) -> None:
+    """Serialize a BallHistory as a list of states (as for an attrs class)"""
+    converter = conversion[fmt]
+
+    conversion.register_unstructure_hook(
+        BallHistory,
+        lambda v: {"states": converter.unstructure(v.states, List[BallState])},
+        which=(fmt,),
+    )
+    conversion.register_structure_hook(
+        BallHistory,
+        lambda v, _: BallHistory(converter.structure(v["states"], List[BallState])),
+        which=(fmt,),
+    )
+
+
+_register_state_list_hooks(SerializeFormat.JSON)
+_register_state_list_hooks(SerializeFormat.YAML)
+
+
 @define
 class Ball:
     """A billiards ball
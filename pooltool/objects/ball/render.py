@@ -9,6 +9,7 @@ from direct.interval.IntervalGlobal import (
     Parallel,
     Sequence,
 )
+from numpy.typing import NDArray
 from panda3d.core import (
     CollisionCapsule,
     CollisionNode,
@@ -203,6 +204,31 @@ class BallRender(Render):
         ws = rvws[:, 2, :]
         self.quats = autils.as_quaternion(ws, ts)
 
+    def get_playback_arrays(
+        self,
+    ) -> Tuple[NDArray[np.float64], NDArray[np.float64], NDArray[np.float64]]:
+        """Return the ball's continuized trajectory as arrays
+
+        This is the array-based alternative to :meth:`get_playback_sequence` (see
+        :class:`pooltool.system.render.ArrayPlayback`). As a side effect, self.quats is
+        set.
+
+        Returns:
+            (ts, xyzs, quats):
+                The timestamps (shape (T,)), positions (shape (T, 3)), and quaternions
+                (shape (T, 4), ordered m, x, y, z) of the continuized history.
+        """
+        vectors = self._ball.history_cts.vectorize()
+        if vectors is None:
+            self.quats = []
+            return np.empty(0), np.empty((0, 3)), np.empty((0, 4))
+
+        rvws, _, ts = vectors
+        self.quats = autils.as_quaternion(rvws[:, 2, :], ts)
+        quats = np.array([tuple(quat) for quat in self.quats], dtype=np.float64)
+
+        return ts.copy(), rvws[:, 0, :].copy(), quats
+
     def get_playback_sequence(self, playback_speed=1) -> MetaInterval:
         """Creates the motion sequences of the ball for a given playback speed"""
         vectors = self._ball.history_cts.vectorize()
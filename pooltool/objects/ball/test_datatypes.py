@@ -12,6 +12,7 @@ from pooltool.objects.ball.datatypes import (
     _null_rvw,
 )
 from pooltool.objects.ball.sets import get_ballset
+from pooltool.serialize import SerializeFormat, conversion
 
 
 def test__null_rvw():
@@ -141,13 +142,11 @@ def test_ball_history_add():
     history.add(state)
     assert not history.empty
 
-    # `add` appends the state directly, just list how lists append. So verify they are
-    # the same objects
-    assert history[0] is state
-
-    # Therefore modifying the state modifies the history
-    state.t = 2
+    # `add` copies the values of the state into the history. So modifying the state
+    # doesn't modify the history
     assert history[0] == state
+    state.rvw[0] = [1, 1, 1]
+    assert history[0] != state
 
     # You can't add a state with a time less than the last entry
     with pytest.raises(AssertionError):
@@ -161,6 +160,134 @@ def test_ball_history_add():
     assert len(history) == 2
 
 
+def test_ball_history_add_vectorization():
+    states = [
+        BallState(np.full((3, 3), i, dtype=np.float64), i % 5, i) for i in range(40)
+    ]
+    history = BallHistory()
+    history.add(states[0])
+    copy = history.copy()
+
+    # Adding arrays of states is like adding the states one by one
+    rvws = np.array([state.rvw for state in states[1:]])
+    ss = np.array([state.s for state in states[1:]], dtype=np.float64)
+    ts = np.array([state.t for state in states[1:]], dtype=np.float64)
+    history.add_vectorization((rvws, ss, ts))
+    assert list(history) == states
+
+    # The values are copied, and copies aren't modified
+    rvws[0] = 42
+    assert history[1] == states[1]
+    assert len(copy) == 1
+
+    # States can't be added out of order
+    with pytest.raises(AssertionError):
+        history.add_vectorization((rvws[:1], ss[:1], ts[:1]))
+    with pytest.raises(AssertionError):
+        history.add_vectorization((rvws[::-1], ss[::-1], ts[::-1] + 100))
+    assert len(history) == 40
+
+
+def test_ball_history_columnar():
+    history = BallHistory()
+    states = []
+    for i in range(100):
+        state = BallState(np.full((3, 3), i, dtype=np.float64), i % 5, i)
+        states.append(state)
+        history.add(state)
+
+    # Storage grows to accommodate the states
+    assert len(history) == 100
+    assert list(history) == states
+    assert history[-1] == states[-1]
+    with pytest.raises(IndexError):
+        history[100]
+
+    # Vectorizing doesn't copy, so modifying the vectors modifies the history
+    assert (vectorize := history.vectorize()) is not None
+    rvws, _, _ = vectorize
+    rvws[0] = 42
+    assert np.all(history[0].rvw == 42)
+
+    # States are copies, so modifying them doesn't modify the history
+    history[1].rvw[0] = [0, 0, 0]
+    assert np.all(rvws[1, 0] == 1)
+
+    # States can be overwritten
+    stopped = BallState(np.zeros((3, 3), dtype=np.float64), stationary, 99)
+    history[-1] = stopped
+    assert history[-1] == stopped
+
+
+def test_ball_history_truncated():
+    history = BallHistory()
+    for i in range(10):
+        history.add(BallState(np.full((3, 3), i, dtype=np.float64), i % 5, i))
+
+    truncated = history.truncated(4)
+    assert len(truncated) == 4
+    assert list(truncated) == list(history)[:4]
+
+    # Neither history modifies the other
+    state = BallState(np.full((3, 3), 42, dtype=np.float64), 0, 5)
+    truncated.add(state)
+    truncated[0] = state
+    assert truncated[-1] == state
+    assert history[4] != state
+    assert history[0] != state
+    assert len(history) == 10
+
+    assert history.truncated(0).empty
+    with pytest.raises(IndexError):
+        history.truncated(11)
+
+
+def test_ball_history_copy_on_write():
+    history = BallHistory()
+    for i in range(10):
+        history.add(BallState(np.full((3, 3), i, dtype=np.float64), i % 5, i))
+
+    # Copies share storage until they're written to. Reading doesn't copy the storage
+    copies = [history.copy() for _ in range(3)]
+    assert list(copies[0]) == list(history)
+    assert copies[0][-1] == history[-1]
+    assert all(copy._rvws is history._rvws for copy in copies)
+
+    # Writing to one copy doesn't modify the others
+    state = BallState(np.full((3, 3), 42, dtype=np.float64), 0, 0)
+    copies[0][0] = state
+    assert copies[0]._rvws is not history._rvws
+    assert copies[0][0] == state
+    assert np.all(copies[1][0].rvw[0] == 0)
+    assert np.all(history[0].rvw[0] == 0)
+
+    # Nor does writing through the original's vectors
+    assert (vectorize := history.vectorize()) is not None
+    vectorize[0][1] = 42
+    assert np.all(copies[2][1].rvw[0] == 1)
+
+    # States read before copying aren't views, so writing to them modifies nothing
+    state = history[2]
+    copy = history.copy()
+    state.rvw[0] = 42
+    assert np.all(copy[2].rvw[0] == 2)
+    assert np.all(history[2].rvw[0] == 2)
+
+    # Equality doesn't require owning the storage
+    assert history.copy() == history
+
+
+@pytest.mark.parametrize("fmt", [SerializeFormat.JSON, SerializeFormat.MSGPACK])
+def test_ball_history_serialize(tmp_path, fmt: SerializeFormat):
+    history = BallHistory()
+    for i in range(3):
+        history.add(BallState(np.full((3, 3), i, dtype=np.float64), i, i))
+
+    path = tmp_path / f"history.{fmt.ext}"
+    conversion.unstructure_to(history, path)
+    assert conversion.structure_from(path, BallHistory) == history
+
+
 # ------ BallParams
 
 
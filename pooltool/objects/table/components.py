@@ -7,7 +7,7 @@ from functools import cached_property
 from typing import Dict, Union
 
 import numpy as np
-from attrs import define, evolve, field
+from attrs import define, field
 from numpy.typing import NDArray
 
 import pooltool.ptmath as ptmath
@@ -316,15 +316,10 @@ class CushionSegments:
 
     def copy(self) -> CushionSegments:
         """Create a copy"""
-        # Delegates the deep-ish copying of LinearCushionSegment and
-        # CircularCushionSegment elements to their respective copy() methods. Uses
-        # dictionary comprehensions to construct equal but different `linear` and
-        # `circular` attributes.
-        return evolve(
-            self,
-            linear={k: v.copy() for k, v in self.linear.items()},
-            circular={k: v.copy() for k, v in self.circular.items()},
-        )
+        # LinearCushionSegment and CircularCushionSegment copies are the segments
+        # themselves (see their copy() methods), so shallow copies of the dictionaries
+        # construct equal but different `linear` and `circular` attributes.
+        return CushionSegments(linear=dict(self.linear), circular=dict(self.circular))
 
 
 @define(eq=False, frozen=True, slots=False)
@@ -393,8 +388,11 @@ class Pocket:
         # Pocket is a frozen instance, and except for `contains`, its attributes are
         # either (a) immutable, or (b) have read-only flags set. Therefore, only a copy
         # of `contains` needs to be made. Since it's members are strs (immutable), a
-        # shallow copy suffices.
-        return evolve(self, contains=copy.copy(self.contains))
+        # shallow copy suffices. Copying the instance rather than evolving it skips
+        # validation, and keeps the cached properties.
+        pocket = copy.copy(self)
+        object.__setattr__(pocket, "contains", copy.copy(self.contains))
+        return pocket
 
     @staticmethod
     def dummy() -> Pocket:
@@ -17,7 +17,7 @@ import pooltool.constants as const
 import pooltool.ptmath as ptmath
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def evolve_ball_motion(state, rvw, R, m, u_s, u_sp, u_r, g, t):
     if state == const.stationary or state == const.pocketed:
         return rvw, state
@@ -56,7 +56,7 @@ def evolve_ball_motion(state, rvw, R, m, u_s, u_sp, u_r, g, t):
     raise ValueError
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def evolve_slide_state(rvw, R, m, u_s, u_sp, g, t):
     if t == 0:
         return rvw
@@ -95,7 +95,7 @@ def evolve_slide_state(rvw, R, m, u_s, u_sp, g, t):
     return rvw_T
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def evolve_roll_state(rvw, R, u_r, u_sp, g, t):
     if t == 0:
         return rvw
@@ -121,7 +121,7 @@ def evolve_roll_state(rvw, R, u_r, u_sp, g, t):
     return new_rvw
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def evolve_perpendicular_spin_component(wz, R, u_sp, g, t):
     if t == 0:
         return wz
@@ -142,7 +142,7 @@ def evolve_perpendicular_spin_component(wz, R, u_sp, g, t):
     return wz_final
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def evolve_perpendicular_spin_state(rvw, R, u_sp, g, t):
     # Otherwise ball.state.rvw will be modified and corresponding entry in self.history
     # FIXME framework has changed, this may not be true. EDIT This is still true.
@@ -150,3 +150,117 @@ def evolve_perpendicular_spin_state(rvw, R, u_sp, g, t):
 
     rvw[2, 2] = evolve_perpendicular_spin_component(rvw[2, 2], R, u_sp, g, t)
     return rvw
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def trajectory_coeffs(rvw, state, R, u_s, u_sp, u_r, g):
+    """Get the closed-form coefficients of a ball's motion
+
+    Until the ball's next motion transition, its kinematic state ``tau`` seconds from
+    now is
+
+    .. math::
+
+        rvw(\\tau) = C_0 + C_1 \\tau + C_2 \\tau^2
+
+    with the exception of the z-component of angular velocity, which decays until
+    ``tau = spin_time`` and remains constant thereafter.
+
+    (just-in-time compiled)
+
+    Returns:
+        (coeffs, spin_time):
+            ``coeffs`` is a (3, 3, 3) array, where ``coeffs[k]`` is the coefficient of
+            :math:`\\tau^k`. ``spin_time`` is the time it takes for the perpendicular
+            spin to decay (``np.inf`` if it doesn't).
+    """
+    coeffs = np.zeros((3, 3, 3), dtype=np.float64)
+    coeffs[0] = rvw
+    spin_time = np.inf
+
+    if state == const.stationary or state == const.pocketed:
+        return coeffs, spin_time
+
+    # The perpendicular spin decays independently (see
+    # evolve_perpendicular_spin_component)
+    wz = rvw[2, 2]
+    if np.abs(wz) >= const.EPS:
+        alpha = 5 * u_sp * g / (2 * R)
+        spin_time = np.abs(wz) / alpha
+        coeffs[1, 2, 2] = -alpha if wz > 0 else alpha
+
+    if state == const.sliding:
+        # See evolve_slide_state. The ball decelerates along its relative velocity,
+        # and stays at its initial height
+        u = ptmath.unit_vector(ptmath.rel_velocity(rvw, R))
+        a = u_s * g
+
+        coeffs[1, 0, :2] = rvw[1, :2]
+        coeffs[2, 0, :2] = -0.5 * a * u[:2]
+        coeffs[1, 1] = -a * u
+        coeffs[1, 2, 0] = -5 / 2 / R * a * u[1]
+        coeffs[1, 2, 1] = 5 / 2 / R * a * u[0]
+
+    elif state == const.rolling:
+        # See evolve_roll_state. The ball decelerates along its velocity, and its
+        # angular velocity is locked to its velocity
+        v_hat = ptmath.unit_vector(rvw[1])
+        a = u_r * g
+
+        coeffs[1, 0] = rvw[1]
+        coeffs[2, 0] = -0.5 * a * v_hat
+        coeffs[1, 1] = -a * v_hat
+        coeffs[0, 2, 0] = -rvw[1, 1] / R
+        coeffs[0, 2, 1] = rvw[1, 0] / R
+        coeffs[1, 2, 0] = a * v_hat[1] / R
+        coeffs[1, 2, 1] = -a * v_hat[0] / R
+
+    return coeffs, spin_time
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def evaluate_trajectory(rvw, coeffs, spin_time, tau):
+    """Evaluate a ball's kinematic state from its trajectory coefficients
+
+    Args:
+        rvw:
+            The kinematic state at ``tau = 0``.
+        coeffs:
+            See :func:`trajectory_coeffs`.
+        spin_time:
+            See :func:`trajectory_coeffs`.
+        tau:
+            The time since ``rvw``. This shouldn't exceed the time until the ball's next
+            motion transition.
+
+    (just-in-time compiled)
+    """
+    if tau == 0:
+        return rvw.copy()
+
+    rvw_tau = coeffs[0] + coeffs[1] * tau + coeffs[2] * tau**2
+    rvw_tau[2, 2] = coeffs[0, 2, 2] + coeffs[1, 2, 2] * min(tau, spin_time)
+
+    return rvw_tau
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def evaluate_trajectories(rvw, coeffs, spin_time, tau):
+    """Evaluate the kinematic states of many balls from their trajectory coefficients
+
+    This is the vectorized analog of :func:`evaluate_trajectory`, where each argument
+    has an additional leading axis of length N (the number of balls).
+
+    (just-in-time compiled)
+
+    Returns:
+        rvw_tau:
+            A (N, 3, 3) array of kinematic states.
+    """
+    num_balls = len(tau)
+    rvw_tau = np.empty((num_balls, 3, 3), dtype=np.float64)
+
+    for i in range(num_balls):
+        rvw_tau[i] = evaluate_trajectory(rvw[i], coeffs[i], spin_time[i], tau[i])
+
+    return rvw_tau
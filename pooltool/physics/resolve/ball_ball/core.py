@@ -1,6 +1,10 @@
 from abc import ABC, abstractmethod
 from typing import Protocol, Tuple
 
+import numpy as np
+from numba import jit
+from numpy.typing import NDArray
+
 import pooltool.constants as const
 import pooltool.ptmath as ptmath
 from pooltool.objects.ball.datatypes import Ball
@@ -22,6 +26,40 @@ class BallBallCollisionStrategy(_BaseStrategy, Protocol):
         ...
 
 
+class BallBallArrayStrategy(Protocol):
+    """Ball-ball collision models may also satisfy this protocol
+
+    Models that do resolve many collisions with one call, from packed arrays rather
+    than ball objects (see
+    :meth:`pooltool.physics.resolve.resolver.Resolver.array_entrypoint`). Models that
+    don't are resolved one collision at a time.
+    """
+
+    def resolve_many(
+        self,
+        rvw1: NDArray[np.float64],
+        rvw2: NDArray[np.float64],
+        R: NDArray[np.float64],
+    ) -> Tuple[NDArray[np.int64], NDArray[np.int64]]:
+        """Resolve K ball-ball collisions (in place)
+
+        Like :meth:`_BaseStrategy.resolve`, the balls are made to kiss before the
+        collisions are solved.
+
+        Args:
+            rvw1:
+                The kinematic states of the first balls, with shape (K, 3, 3).
+            rvw2:
+                The kinematic states of the second balls, with shape (K, 3, 3).
+            R:
+                The radii of the first balls, with shape (K,).
+
+        Returns:
+            (s1, s2): The motion states of the first and second balls, with shape (K,).
+        """
+        ...
+
+
 class CoreBallBallCollision(ABC):
     """Operations used by every ball-ball collision resolver"""
 
@@ -34,12 +72,7 @@ class CoreBallBallCollision(ABC):
         distance (constants.EPS_SPACE) is put between them, ensuring the balls are
         non-intersecting.
         """
-        r1, r2 = ball1.state.rvw[0], ball2.state.rvw[0]
-        n = ptmath.unit_vector(r2 - r1)
-
-        correction = 2 * ball1.params.R - ptmath.norm3d(r2 - r1) + const.EPS_SPACE
-        ball2.state.rvw[0] += correction / 2 * n
-        ball1.state.rvw[0] -= correction / 2 * n
+        ball_ball_kiss(ball1.state.rvw, ball2.state.rvw, ball1.params.R)
 
         return ball1, ball2
 
@@ -57,3 +90,19 @@ class CoreBallBallCollision(ABC):
     @abstractmethod
     def solve(self, ball1: Ball, ball2: Ball) -> Tuple[Ball, Ball]:
         pass
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def ball_ball_kiss(rvw1, rvw2, R):
+    """Translate two balls so they are (almost) touching (in place)
+
+    See :meth:`CoreBallBallCollision.make_kiss`.
+
+    (just-in-time compiled)
+    """
+    r1, r2 = rvw1[0], rvw2[0]
+    n = ptmath.unit_vector(r2 - r1)
+
+    correction = 2 * R - ptmath.norm3d(r2 - r1) + const.EPS_SPACE
+    rvw2[0] += correction / 2 * n
+    rvw1[0] -= correction / 2 * n
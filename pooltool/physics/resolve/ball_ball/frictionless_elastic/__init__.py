@@ -1,15 +1,24 @@
 from typing import Tuple
 
 import numpy as np
+from numba import jit
+from numpy.typing import NDArray
 
 import pooltool.constants as const
 import pooltool.ptmath as ptmath
 from pooltool.objects.ball.datatypes import Ball, BallState
-from pooltool.physics.resolve.ball_ball.core import CoreBallBallCollision
+from pooltool.physics.resolve.ball_ball.core import (
+    CoreBallBallCollision,
+    ball_ball_kiss,
+)
 
 
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def _resolve_ball_ball(rvw1, rvw2, R):
-    """Frictionless, instantaneous, elastic, equal mass collision"""
+    """Frictionless, instantaneous, elastic, equal mass collision
+
+    (just-in-time compiled)
+    """
 
     r1, r2 = rvw1[0], rvw2[0]
     v1, v2 = rvw1[1], rvw2[1]
@@ -28,6 +37,19 @@ def _resolve_ball_ball(rvw1, rvw2, R):
     return rvw1, rvw2
 
 
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _resolve_ball_balls(rvw1, rvw2, R):
+    """Make many pairs of balls kiss, then collide them (in place)
+
+    (just-in-time compiled)
+    """
+    for k in range(len(R)):
+        ball_ball_kiss(rvw1[k], rvw2[k], R[k])
+        rvw1_k, rvw2_k = _resolve_ball_ball(rvw1[k].copy(), rvw2[k].copy(), R[k])
+        rvw1[k] = rvw1_k
+        rvw2[k] = rvw2_k
+
+
 class FrictionlessElastic(CoreBallBallCollision):
     def solve(self, ball1: Ball, ball2: Ball) -> Tuple[Ball, Ball]:
         rvw1, rvw2 = _resolve_ball_ball(
@@ -40,3 +62,18 @@ class FrictionlessElastic(CoreBallBallCollision):
         ball2.state = BallState(rvw2, const.sliding)
 
         return ball1, ball2
+
+    def resolve_many(
+        self,
+        rvw1: NDArray[np.float64],
+        rvw2: NDArray[np.float64],
+        R: NDArray[np.float64],
+    ) -> Tuple[NDArray[np.int64], NDArray[np.int64]]:
+        """Resolve K ball-ball collisions (in place)
+
+        See :class:`pooltool.physics.resolve.ball_ball.core.BallBallArrayStrategy`.
+        """
+        _resolve_ball_balls(rvw1, rvw2, R)
+
+        s = np.full(len(R), const.sliding, dtype=np.int64)
+        return s, s.copy()
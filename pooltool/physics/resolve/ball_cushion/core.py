@@ -2,6 +2,8 @@ from abc import ABC, abstractmethod
 from typing import Protocol, Tuple
 
 import numpy as np
+from numba import jit
+from numpy.typing import NDArray
 
 import pooltool.constants as const
 import pooltool.ptmath as ptmath
@@ -48,6 +50,94 @@ class BallCCushionCollisionStrategy(_BaseCircularStrategy, Protocol):
         ...
 
 
+class BallLCushionArrayStrategy(Protocol):
+    """Ball-linear cushion collision models may also satisfy this protocol
+
+    Models that do resolve many collisions with one call, from packed arrays rather
+    than ball and cushion objects (see
+    :meth:`pooltool.physics.resolve.resolver.Resolver.array_entrypoint`). Models that
+    don't are resolved one collision at a time.
+    """
+
+    def resolve_many(
+        self,
+        rvw: NDArray[np.float64],
+        R: NDArray[np.float64],
+        m: NDArray[np.float64],
+        e_c: NDArray[np.float64],
+        f_c: NDArray[np.float64],
+        p1: NDArray[np.float64],
+        p2: NDArray[np.float64],
+        normals: NDArray[np.float64],
+        heights: NDArray[np.float64],
+    ) -> NDArray[np.int64]:
+        """Resolve K ball-linear cushion collisions (in place)
+
+        Like :meth:`_BaseLinearStrategy.resolve`, the balls are made to kiss the
+        cushions before the collisions are solved.
+
+        Args:
+            rvw:
+                The kinematic states of the balls, with shape (K, 3, 3).
+            R:
+                The ball radii, with shape (K,). ``m``, ``e_c``, and ``f_c`` are the
+                other ball parameters (see
+                :class:`pooltool.objects.ball.params.BallParams`).
+            p1:
+                The first endpoints of the cushions, with shape (K, 3). ``p2`` are the
+                second endpoints.
+            normals:
+                The cushion normals (see :attr:`LinearCushionSegment.normal`), with
+                shape (K, 3).
+            heights:
+                The cushion heights, with shape (K,).
+
+        Returns:
+            NDArray[np.int64]: The motion states of the balls, with shape (K,).
+        """
+        ...
+
+
+class BallCCushionArrayStrategy(Protocol):
+    """Ball-circular cushion collision models may also satisfy this protocol
+
+    See :class:`BallLCushionArrayStrategy`.
+    """
+
+    def resolve_many(
+        self,
+        rvw: NDArray[np.float64],
+        R: NDArray[np.float64],
+        m: NDArray[np.float64],
+        e_c: NDArray[np.float64],
+        f_c: NDArray[np.float64],
+        centers: NDArray[np.float64],
+        radii: NDArray[np.float64],
+        heights: NDArray[np.float64],
+    ) -> NDArray[np.int64]:
+        """Resolve K ball-circular cushion collisions (in place)
+
+        Like :meth:`_BaseCircularStrategy.resolve`, the balls are made to kiss the
+        cushions before the collisions are solved.
+
+        Args:
+            rvw:
+                See :meth:`BallLCushionArrayStrategy.resolve_many`.
+            R:
+                See :meth:`BallLCushionArrayStrategy.resolve_many`.
+            centers:
+                The cushion centers, with shape (K, 3).
+            radii:
+                The cushion radii, with shape (K,).
+            heights:
+                The cushion heights, with shape (K,).
+
+        Returns:
+            NDArray[np.int64]: The motion states of the balls, with shape (K,).
+        """
+        ...
+
+
 class CoreBallLCushionCollision(ABC):
     """Operations used by every ball-linear cushion collision resolver"""
 
@@ -60,23 +150,13 @@ class CoreBallLCushionCollision(ABC):
         (constants.EPS_SPACE) is put between them, ensuring the cushion and ball are
         separated post-resolution.
         """
-        normal = cushion.get_normal(ball.state.rvw)
-
-        # orient the normal so it points away from playing surface
-        normal = normal if np.dot(normal, ball.state.rvw[1]) > 0 else -normal
-
-        # Calculate the point on cushion line where contact should be made, then set the
-        # z-component to match the ball's height
-        c = ptmath.point_on_line_closest_to_point(
-            cushion.p1, cushion.p2, ball.state.rvw[0]
-        )
-        c[2] = ball.state.rvw[0, 2]
-
-        # Move the ball to exactly meet the cushion
-        correction = (
-            ball.params.R - ptmath.norm3d(ball.state.rvw[0] - c) + const.EPS_SPACE
+        ball_linear_cushion_kiss(
+            ball.state.rvw,
+            cushion.p1,
+            cushion.p2,
+            cushion.get_normal(ball.state.rvw),
+            ball.params.R,
         )
-        ball.state.rvw[0] -= correction * normal
 
         return ball
 
@@ -110,21 +190,14 @@ class CoreBallCCushionCollision(ABC):
         (constants.EPS_SPACE) is put between them, ensuring the cushion and ball are
         separated post-resolution.
         """
-        normal = cushion.get_normal(ball.state.rvw)
-
-        # orient the normal so it points away from playing surface
-        normal = normal if np.dot(normal, ball.state.rvw[1]) > 0 else -normal
-
-        c = np.array([cushion.center[0], cushion.center[1], ball.state.rvw[0, 2]])
-        correction = (
-            ball.params.R
-            + cushion.radius
-            - ptmath.norm3d(ball.state.rvw[0] - c)
-            - const.EPS_SPACE
+        ball_circular_cushion_kiss(
+            ball.state.rvw,
+            cushion.center,
+            cushion.radius,
+            cushion.get_normal(ball.state.rvw),
+            ball.params.R,
         )
 
-        ball.state.rvw[0] += correction * normal
-
         return ball
 
     def resolve(
@@ -137,3 +210,52 @@ class CoreBallCCushionCollision(ABC):
         ball = self.make_kiss(ball, cushion)
 
         return self.solve(ball, cushion)  # type: ignore
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def ball_linear_cushion_kiss(rvw, p1, p2, normal, R):
+    """Translate a ball so it (almost) touches a linear cushion segment (in place)
+
+    See :meth:`CoreBallLCushionCollision.make_kiss`.
+
+    (just-in-time compiled)
+    """
+    # orient the normal so it points away from playing surface
+    normal = normal if np.dot(normal, rvw[1]) > 0 else -normal
+
+    # Calculate the point on cushion line where contact should be made, then set the
+    # z-component to match the ball's height
+    c = ptmath.point_on_line_closest_to_point(p1, p2, rvw[0])
+    c[2] = rvw[0, 2]
+
+    # Move the ball to exactly meet the cushion
+    correction = R - ptmath.norm3d(rvw[0] - c) + const.EPS_SPACE
+    rvw[0] -= correction * normal
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def ball_circular_cushion_kiss(rvw, center, radius, normal, R):
+    """Translate a ball so it (almost) touches a circular cushion segment (in place)
+
+    See :meth:`CoreBallCCushionCollision.make_kiss`.
+
+    (just-in-time compiled)
+    """
+    # orient the normal so it points away from playing surface
+    normal = normal if np.dot(normal, rvw[1]) > 0 else -normal
+
+    c = np.array([center[0], center[1], rvw[0, 2]])
+    correction = R + radius - ptmath.norm3d(rvw[0] - c) - const.EPS_SPACE
+
+    rvw[0] += correction * normal
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def circular_cushion_normal(rvw, center):
+    """See :meth:`CircularCushionSegment.get_normal`
+
+    (just-in-time compiled)
+    """
+    normal = rvw[0, :] - center
+    normal[2] = 0  # remove z-component
+    return ptmath.unit_vector(normal)
@@ -1,6 +1,8 @@
 from typing import Tuple, TypeVar
 
 import numpy as np
+from numba import jit
+from numpy.typing import NDArray
 
 import pooltool.constants as const
 import pooltool.ptmath as ptmath
@@ -12,6 +14,9 @@ from pooltool.objects.table.components import (
 from pooltool.physics.resolve.ball_cushion.core import (
     CoreBallCCushionCollision,
     CoreBallLCushionCollision,
+    ball_circular_cushion_kiss,
+    ball_linear_cushion_kiss,
+    circular_cushion_normal,
 )
 from pooltool.physics.resolve.ball_cushion.han_2005.properties import (
     get_ball_cushion_friction,
@@ -19,8 +24,12 @@ from pooltool.physics.resolve.ball_cushion.han_2005.properties import (
 )
 
 
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def han2005(rvw, normal, R, m, h, e_c, f_c):
-    """Inhwan Han (2005) 'Dynamics in Carom and Three Cushion Billiards'"""
+    """Inhwan Han (2005) 'Dynamics in Carom and Three Cushion Billiards'
+
+    (just-in-time compiled)
+    """
     # orient the normal so it points away from playing surface
     normal = normal if np.dot(normal, rvw[1]) > 0 else -normal
 
@@ -88,6 +97,32 @@ def han2005(rvw, normal, R, m, h, e_c, f_c):
     return rvw
 
 
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _han2005_linear_many(rvw, R, m, e_c, f_c, p1, p2, normals, heights):
+    """Make many balls kiss linear cushions, then collide them (in place)
+
+    (just-in-time compiled)
+    """
+    for k in range(len(R)):
+        ball_linear_cushion_kiss(rvw[k], p1[k], p2[k], normals[k], R[k])
+        rvw[k] = han2005(rvw[k], normals[k], R[k], m[k], heights[k], e_c[k], f_c[k])
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _han2005_circular_many(rvw, R, m, e_c, f_c, centers, radii, heights):
+    """Make many balls kiss circular cushions, then collide them (in place)
+
+    (just-in-time compiled)
+    """
+    for k in range(len(R)):
+        normal = circular_cushion_normal(rvw[k], centers[k])
+        ball_circular_cushion_kiss(rvw[k], centers[k], radii[k], normal, R[k])
+
+        # The normal is recalculated, since the ball moved
+        normal = circular_cushion_normal(rvw[k], centers[k])
+        rvw[k] = han2005(rvw[k], normal, R[k], m[k], heights[k], e_c[k], f_c[k])
+
+
 Cushion = TypeVar("Cushion", LinearCushionSegment, CircularCushionSegment)
 
 
@@ -113,9 +148,48 @@ class Han2005Linear(CoreBallLCushionCollision):
     ) -> Tuple[Ball, LinearCushionSegment]:
         return _solve(ball, cushion)
 
+    def resolve_many(
+        self,
+        rvw: NDArray[np.float64],
+        R: NDArray[np.float64],
+        m: NDArray[np.float64],
+        e_c: NDArray[np.float64],
+        f_c: NDArray[np.float64],
+        p1: NDArray[np.float64],
+        p2: NDArray[np.float64],
+        normals: NDArray[np.float64],
+        heights: NDArray[np.float64],
+    ) -> NDArray[np.int64]:
+        """Resolve K ball-linear cushion collisions (in place)
+
+        See
+        :class:`pooltool.physics.resolve.ball_cushion.core.BallLCushionArrayStrategy`.
+        """
+        _han2005_linear_many(rvw, R, m, e_c, f_c, p1, p2, normals, heights)
+        return np.full(len(R), const.sliding, dtype=np.int64)
+
 
 class Han2005Circular(CoreBallCCushionCollision):
     def solve(
         self, ball: Ball, cushion: CircularCushionSegment
     ) -> Tuple[Ball, CircularCushionSegment]:
         return _solve(ball, cushion)
+
+    def resolve_many(
+        self,
+        rvw: NDArray[np.float64],
+        R: NDArray[np.float64],
+        m: NDArray[np.float64],
+        e_c: NDArray[np.float64],
+        f_c: NDArray[np.float64],
+        centers: NDArray[np.float64],
+        radii: NDArray[np.float64],
+        heights: NDArray[np.float64],
+    ) -> NDArray[np.int64]:
+        """Resolve K ball-circular cushion collisions (in place)
+
+        See
+        :class:`pooltool.physics.resolve.ball_cushion.core.BallCCushionArrayStrategy`.
+        """
+        _han2005_circular_many(rvw, R, m, e_c, f_c, centers, radii, heights)
+        return np.full(len(R), const.sliding, dtype=np.int64)
@@ -1,8 +1,11 @@
 import numpy as np
+from numba import jit
 
+import pooltool.constants as const
 import pooltool.ptmath as ptmath
 
 
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def get_ball_cushion_restitution(rvw, e_c):
     """Get restitution coefficient dependent on ball state
 
@@ -22,6 +25,7 @@ def get_ball_cushion_restitution(rvw, e_c):
     return max([0.40, 0.50 + 0.257 * rvw[1, 0] - 0.044 * rvw[1, 0] ** 2])
 
 
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def get_ball_cushion_friction(rvw, f_c):
     """Get friction coeffecient depend on ball state
 
@@ -2,10 +2,13 @@
 
 from __future__ import annotations
 
+import time
 from pathlib import Path
+from typing import Any, Callable, Optional
 
 import attrs
 
+import pooltool.instrumentation as instrumentation
 import pooltool.user_config
 from pooltool.events.datatypes import AgentType, Event, EventType
 from pooltool.physics.resolve.ball_ball import (
@@ -117,7 +120,49 @@ class Resolver:
     transition: BallTransitionStrategy
 
     def resolve(self, shot: System, event: Event) -> None:
-        """Resolve an event for a system"""
+        """Resolve an event for a system
+
+        While instrumenting (see :func:`pooltool.instrumentation.instrument`), the
+        event's type and resolution time are recorded.
+        """
+        stats = instrumentation.active
+        if stats is None:
+            self._resolve(shot, event)
+            return
+
+        start = time.perf_counter()
+        self._resolve(shot, event)
+        stats.record_event(event.event_type, time.perf_counter() - start)
+
+    def array_entrypoint(self, event_type: EventType) -> Optional[Callable]:
+        """The array entrypoint of the model for an event type
+
+        Models with an array entrypoint resolve many events with one call, on packed
+        arrays rather than ball objects (see, e.g.,
+        :class:`pooltool.physics.resolve.ball_ball.core.BallBallArrayStrategy`). This
+        is what :func:`pooltool.evolution.event_based.batch.simulate_batch` resolves
+        events with.
+
+        Returns:
+            Optional[Callable]:
+                The model's ``resolve_many`` method, or None if the model doesn't have
+                one. Ball-pocket and stick-ball models never do.
+        """
+        strategy: Any
+        if event_type.is_transition():
+            strategy = self.transition
+        elif event_type == EventType.BALL_BALL:
+            strategy = self.ball_ball
+        elif event_type == EventType.BALL_LINEAR_CUSHION:
+            strategy = self.ball_linear_cushion
+        elif event_type == EventType.BALL_CIRCULAR_CUSHION:
+            strategy = self.ball_circular_cushion
+        else:
+            return None
+
+        return getattr(strategy, "resolve_many", None)
+
+    def _resolve(self, shot: System, event: Event) -> None:
         _snapshot_initial(shot, event)
 
         ids = event.ids
@@ -0,0 +1,150 @@
+from typing import List, Tuple
+
+import numpy as np
+import pytest
+from numpy.typing import NDArray
+
+import pooltool.evolution.event_based.packed as packed
+from pooltool.events import Agent, AgentType, Event, EventType, filter_type
+from pooltool.evolution.event_based import batch
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.physics.resolve.ball_cushion import (
+    BallLCushionModel,
+    get_ball_lin_cushion_model,
+)
+from pooltool.physics.resolve.resolver import Resolver
+from pooltool.system import System
+
+
+def _unresolved(event: Event) -> Event:
+    """A copy of an event, without the states of its agents"""
+    return Event(
+        event_type=event.event_type,
+        agents=tuple(
+            Agent(id=agent.id, agent_type=agent.agent_type) for agent in event.agents
+        ),
+        time=event.time,
+    )
+
+
+def _setups(event_type: EventType) -> List[Tuple[System, Event]]:
+    """Systems set up just before each of their events of a type, with the events"""
+    setups = []
+    for phi in np.linspace(0, 360, 12, endpoint=False):
+        shot = System.example()
+        shot.cue.set_state(phi=phi)
+        simulate(shot, inplace=True)
+
+        for event in filter_type(shot.events, event_type):
+            setup = shot.copy()
+            for agent in event.agents:
+                if agent.agent_type == AgentType.BALL:
+                    setup.balls[agent.id].state = agent.initial.state.copy()
+
+            setups.append((setup, _unresolved(event)))
+
+    return setups
+
+
+def _resolve_packed(
+    resolver: Resolver, setups: List[Tuple[System, Event]]
+) -> Tuple[List[Tuple[System, Event]], NDArray[np.float64], NDArray[np.int64]]:
+    """Resolve the events on packed states, the way simulate_batch does"""
+    setups = [(shot.copy(), _unresolved(event)) for shot, event in setups]
+    shots = [shot for shot, _ in setups]
+    events = [event for _, event in setups]
+    event_type = events[0].event_type
+
+    ball_ids, table = batch._validate_batch(shots)
+    states = [packed.pack_ball_states(list(shot.balls.values())) for shot in shots]
+    rvw = np.array([shot_rvw for shot_rvw, _ in states])
+    s = np.array([shot_s for _, shot_s in states])
+    params = np.array(
+        [packed.pack_ball_params(list(shot.balls.values())) for shot in shots]
+    )
+
+    if event_type == EventType.BALL_BALL:
+        others = ball_ids
+    elif event_type == EventType.BALL_LINEAR_CUSHION:
+        others = table.linear_ids
+    elif event_type == EventType.BALL_CIRCULAR_CUSHION:
+        others = table.circular_ids
+    else:
+        others = ()
+
+    first = np.array([ball_ids.index(event.ids[0]) for event in events])
+    second = np.array(
+        [others.index(event.ids[1]) if others else -1 for event in events]
+    )
+    t_evolved = np.array([shot.balls[event.ids[0]].state.t for shot, event in setups])
+
+    resolve_many = resolver.array_entrypoint(event_type)
+    assert resolve_many is not None
+    batch._resolve_packed(
+        resolve_many,
+        shots,
+        events,
+        np.arange(len(setups)),
+        first,
+        second,
+        rvw,
+        s,
+        params,
+        t_evolved,
+        np.empty(s.shape, dtype=np.float64),
+        np.empty(s.shape, dtype=np.int64),
+        table,
+    )
+
+    return setups, rvw, s
+
+
+@pytest.mark.parametrize(
+    "event_type",
+    [
+        EventType.BALL_BALL,
+        EventType.BALL_LINEAR_CUSHION,
+        EventType.BALL_CIRCULAR_CUSHION,
+        EventType.SLIDING_ROLLING,
+    ],
+)
+def test_array_entrypoint(event_type: EventType):
+    """Resolving on packed states matches resolving on the balls"""
+    resolver = Resolver.default()
+    setups = _setups(event_type)
+    assert len(setups)
+
+    resolved, rvw, s = _resolve_packed(resolver, setups)
+
+    for k, ((shot, event), (_, packed_event)) in enumerate(zip(setups, resolved)):
+        resolver.resolve(shot, event)
+        ball_ids = list(shot.balls)
+
+        for agent, packed_agent in zip(event.agents, packed_event.agents):
+            if agent.agent_type != AgentType.BALL:
+                continue
+
+            for obj, packed_obj in (
+                (agent.initial, packed_agent.initial),
+                (agent.final, packed_agent.final),
+            ):
+                assert obj.state.s == packed_obj.state.s
+                assert obj.state.t == packed_obj.state.t
+                assert np.allclose(obj.state.rvw, packed_obj.state.rvw)
+
+            i = ball_ids.index(agent.id)
+            assert shot.balls[agent.id].state.s == s[k, i]
+            assert np.allclose(shot.balls[agent.id].state.rvw, rvw[k, i])
+
+
+def test_array_entrypoint_missing():
+    resolver = Resolver.default()
+    for event_type in (EventType.BALL_POCKET, EventType.STICK_BALL, EventType.NONE):
+        assert resolver.array_entrypoint(event_type) is None
+
+    # Models without one are resolved on the balls by simulate_batch
+    resolver.ball_linear_cushion = get_ball_lin_cushion_model(
+        BallLCushionModel.UNREALISTIC
+    )
+    assert not hasattr(resolver.ball_linear_cushion, "resolve_many")
+    assert resolver.array_entrypoint(EventType.BALL_LINEAR_CUSHION) is None
@@ -9,6 +9,7 @@ Note:
 from typing import Dict, Optional, Protocol, Tuple, Type
 
 import numpy as np
+from numpy.typing import NDArray
 
 import pooltool.constants as const
 from pooltool.events.datatypes import EventType
@@ -25,6 +26,34 @@ class BallTransitionStrategy(Protocol):
         ...
 
 
+class BallTransitionArrayStrategy(Protocol):
+    """Ball transition models may also satisfy this protocol
+
+    Models that do resolve many transitions with one call, from packed arrays rather
+    than ball objects (see
+    :meth:`pooltool.physics.resolve.resolver.Resolver.array_entrypoint`). Models that
+    don't are resolved one transition at a time.
+    """
+
+    def resolve_many(
+        self, rvw: NDArray[np.float64], s: NDArray[np.int64], transition: EventType
+    ) -> NDArray[np.int64]:
+        """Resolve K ball transitions of the same type (in place)
+
+        Args:
+            rvw:
+                The kinematic states of the balls, with shape (K, 3, 3).
+            s:
+                The motion states of the balls, with shape (K,).
+            transition:
+                The type of the transitions.
+
+        Returns:
+            NDArray[np.int64]: The motion states of the balls, with shape (K,).
+        """
+        ...
+
+
 class CanonicalTransition:
     def resolve(self, ball: Ball, transition: EventType, inplace: bool = False) -> Ball:
         if not inplace:
@@ -62,6 +91,32 @@ class CanonicalTransition:
 
         return ball
 
+    def resolve_many(
+        self, rvw: NDArray[np.float64], s: NDArray[np.int64], transition: EventType
+    ) -> NDArray[np.int64]:
+        """Resolve K ball transitions of the same type (in place)
+
+        See :class:`BallTransitionArrayStrategy`.
+        """
+        assert transition.is_transition()
+        start, end = _ball_transition_motion_states(transition)
+
+        assert (s == start).all(), f"Start states weren't all {start}"
+
+        if end == const.spinning:
+            assert (np.abs(rvw[:, 1]) < const.EPS_SPACE).all()
+            assert (np.abs(rvw[:, 2, :2]) < const.EPS_SPACE).all()
+
+            rvw[:, 1, :] = 0.0
+            rvw[:, 2, :2] = 0.0
+
+        if end == const.stationary:
+            assert (np.abs(rvw[:, 1:]) < const.EPS_SPACE).all()
+
+            rvw[:, 1:, :] = 0.0
+
+        return np.full(len(s), end, dtype=np.int64)
+
 
 def _ball_transition_motion_states(event_type: EventType) -> Tuple[int, int]:
     """Return the ball motion states before and after a transition"""
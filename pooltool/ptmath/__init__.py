@@ -1,5 +1,6 @@
 """Math functions"""
 
+import pooltool.ptmath.placement as placement
 import pooltool.ptmath.roots as roots
 from pooltool.ptmath.utils import (
     angle,
@@ -27,6 +28,7 @@ from pooltool.ptmath.utils import (
 )
 
 __all__ = [
+    "placement",
     "roots",
     "angle",
     "orientation",
@@ -0,0 +1,252 @@
+"""Overlap checks and random placement of balls
+
+Ball positions are passed as arrays, so that whole layouts are checked and placed by a
+single just-in-time compiled call rather than a Python loop over ball pairs.
+
+Random placement is rejection sampling on a uniform grid: each ball is drawn uniformly
+on the table until it doesn't overlap any ball already placed, and only the balls in
+the neighboring grid cells of the draw are checked. This re-draws only the ball that
+conflicts, rather than the whole layout, so layouts are sampled sequentially (each ball
+is uniform given the balls placed before it), rather than uniformly over all
+non-overlapping layouts.
+"""
+
+from typing import Tuple
+
+import numpy as np
+from numba import jit
+from numpy.typing import NDArray
+
+import pooltool.constants as const
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def overlapping(xyz: NDArray[np.float64], R: NDArray[np.float64]) -> NDArray[np.bool_]:
+    """Which balls overlap another ball (just-in-time compiled)
+
+    Args:
+        xyz:
+            The ball positions, with shape (n, 3) (or (n, 2) for planar positions).
+        R:
+            The ball radii, with shape (n,).
+
+    Returns:
+        NDArray[np.bool_]: True for each ball that overlaps any other ball.
+    """
+    n = len(R)
+    mask = np.zeros(n, dtype=np.bool_)
+    for i in range(n):
+        for j in range(i + 1, n):
+            if _is_overlapping(xyz, R, i, j):
+                mask[i] = True
+                mask[j] = True
+    return mask
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def any_overlapping(xyz: NDArray[np.float64], R: NDArray[np.float64]) -> bool:
+    """Whether any two balls overlap (just-in-time compiled)
+
+    See :func:`overlapping` for the arguments.
+    """
+    n = len(R)
+    for i in range(n):
+        for j in range(i + 1, n):
+            if _is_overlapping(xyz, R, i, j):
+                return True
+    return False
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _is_overlapping(
+    xyz: NDArray[np.float64], R: NDArray[np.float64], i: int, j: int
+) -> bool:
+    dist_sq = 0.0
+    for k in range(xyz.shape[1]):
+        d = xyz[i, k] - xyz[j, k]
+        dist_sq += d * d
+    return dist_sq < (R[i] + R[j]) ** 2
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _cell(x: float, size: float, num: int) -> int:
+    """The grid cell of a coordinate, clamped to the grid"""
+    return min(max(int(x // size), 0), num - 1)
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _conflicts(
+    xy: NDArray[np.float64],
+    R: NDArray[np.float64],
+    i: int,
+    heads: NDArray[np.int64],
+    nexts: NDArray[np.int64],
+    size: float,
+) -> bool:
+    """Whether ball i overlaps any ball in the grid
+
+    Cells are at least a ball diameter wide, so only the neighboring cells are checked.
+    Clamping cells to the grid only brings positions closer, so balls off the grid are
+    still found.
+    """
+    nx, ny = heads.shape
+    cx = _cell(xy[i, 0], size, nx)
+    cy = _cell(xy[i, 1], size, ny)
+
+    for gx in range(max(cx - 1, 0), min(cx + 2, nx)):
+        for gy in range(max(cy - 1, 0), min(cy + 2, ny)):
+            j = heads[gx, gy]
+            while j >= 0:
+                if _is_overlapping(xy, R, i, j):
+                    return True
+                j = nexts[j]
+
+    return False
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _insert(
+    xy: NDArray[np.float64],
+    i: int,
+    heads: NDArray[np.int64],
+    nexts: NDArray[np.int64],
+    size: float,
+) -> None:
+    nx, ny = heads.shape
+    cx = _cell(xy[i, 0], size, nx)
+    cy = _cell(xy[i, 1], size, ny)
+    nexts[i] = heads[cx, cy]
+    heads[cx, cy] = i
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _place(
+    xy: NDArray[np.float64],
+    R: NDArray[np.float64],
+    movable: NDArray[np.bool_],
+    w: float,
+    l: float,
+    niter: int,
+) -> bool:
+    """Place the movable balls, drawing from numba's random state"""
+    n = len(R)
+    size = 2 * R.max()
+    heads = np.full((int(w // size) + 1, int(l // size) + 1), -1, dtype=np.int64)
+    nexts = np.full(n, -1, dtype=np.int64)
+
+    # Balls that stay put are placed first, and must not overlap each other
+    for i in range(n):
+        if not movable[i]:
+            if _conflicts(xy, R, i, heads, nexts, size):
+                return False
+            _insert(xy, i, heads, nexts, size)
+
+    for i in range(n):
+        if not movable[i]:
+            continue
+
+        placed = False
+        for _ in range(niter):
+            xy[i, 0] = np.random.uniform(R[i], w - R[i])
+            xy[i, 1] = np.random.uniform(R[i], l - R[i])
+            if not _conflicts(xy, R, i, heads, nexts, size):
+                placed = True
+                break
+
+        if not placed:
+            return False
+
+        _insert(xy, i, heads, nexts, size)
+
+    return True
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def place_balls(
+    xy: NDArray[np.float64],
+    R: NDArray[np.float64],
+    movable: NDArray[np.bool_],
+    w: float,
+    l: float,
+    niter: int,
+    seed: int,
+) -> bool:
+    """Place balls randomly on a table, without overlap (just-in-time compiled)
+
+    Movable balls are placed in order, each drawn uniformly within the table's playing
+    surface until it doesn't overlap the balls placed before it (see the module
+    docstring).
+
+    Args:
+        xy:
+            The planar ball positions, with shape (n, 2). The positions of movable balls
+            are overwritten (in place).
+        R:
+            The ball radii, with shape (n,).
+        movable:
+            Which balls are placed, with shape (n,). The others stay put.
+        w:
+            The width of the table.
+        l:
+            The length of the table.
+        niter:
+            The number of draws of each ball before giving up.
+        seed:
+            Seeds the draws.
+
+    Returns:
+        bool:
+            True if every movable ball was placed. False if a ball couldn't be placed
+            within ``niter`` draws, or if the balls that stay put overlap.
+    """
+    np.random.seed(seed)
+    return _place(xy, R, movable, w, l, niter)
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def place_layouts(
+    num_layouts: int,
+    R: NDArray[np.float64],
+    w: float,
+    l: float,
+    niter: int,
+    seed: int,
+) -> Tuple[NDArray[np.float64], NDArray[np.bool_]]:
+    """Generate random layouts of balls on a table (just-in-time compiled)
+
+    Each layout is placed like :func:`place_balls` places balls, and layouts that fail
+    are restarted, up to ``niter`` times.
+
+    Args:
+        num_layouts:
+            The number of layouts.
+        R:
+            The ball radii, with shape (n,).
+        w:
+            See :func:`place_balls`.
+        l:
+            See :func:`place_balls`.
+        niter:
+            See :func:`place_balls`.
+        seed:
+            See :func:`place_balls`.
+
+    Returns:
+        (xy, placed):
+            The planar ball positions of each layout, with shape (num_layouts, n, 2),
+            and whether each layout was placed, with shape (num_layouts,).
+    """
+    np.random.seed(seed)
+
+    n = len(R)
+    xy = np.zeros((num_layouts, n, 2))
+    placed = np.zeros(num_layouts, dtype=np.bool_)
+    movable = np.ones(n, dtype=np.bool_)
+
+    for m in range(num_layouts):
+        for _ in range(niter):
+            if _place(xy[m], R, movable, w, l, niter):
+                placed[m] = True
+                break
+
+    return xy, placed
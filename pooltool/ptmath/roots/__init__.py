@@ -1,11 +1,12 @@
 import pooltool.ptmath.roots.quadratic as quadratic
 import pooltool.ptmath.roots.quartic as quartic
 from pooltool.ptmath.roots.core import min_real_root
-from pooltool.ptmath.roots.quartic import minimum_quartic_root
+from pooltool.ptmath.roots.quartic import minimum_quartic_root, minimum_quartic_roots
 
 __all__ = [
     "quadratic",
     "quartic",
     "min_real_root",
     "minimum_quartic_root",
+    "minimum_quartic_roots",
 ]
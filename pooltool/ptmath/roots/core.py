@@ -64,7 +64,51 @@ def min_real_root(
     return candidates[candidates.real.argmin()]
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def min_real_root_rows(
+    roots: NDArray[np.complex128],
+    abs_or_rel_cutoff: float = 1e-3,
+    rtol: float = 1e-3,
+    atol: float = 1e-9,
+) -> NDArray[np.float64]:
+    """Find the minimum, real, positive root of each row in a 2D array of roots
+
+    This is the row-wise analog of :func:`min_real_root`, and it uses the same criteria
+    for deciding whether a root is real. Unlike :func:`min_real_root`, only the real
+    component of each minimum root is returned.
+
+    (just-in-time compiled)
+
+    Returns:
+        roots:
+            An array with length equal to the number of rows of ``roots``. Rows without
+            a real, positive root are assigned ``np.inf``.
+    """
+    num_rows, num_cols = roots.shape
+    minimums = np.full(num_rows, np.inf, dtype=np.float64)
+
+    for i in range(num_rows):
+        for j in range(num_cols):
+            real = roots[i, j].real
+            if not real >= 0.0:
+                continue
+
+            imag_mag = abs(roots[i, j].imag)
+
+            if real > abs_or_rel_cutoff:
+                keep = imag_mag < atol
+            elif real > 0.0:
+                keep = (imag_mag / real) < rtol
+            else:
+                keep = imag_mag == 0.0
+
+            if keep and real < minimums[i]:
+                minimums[i] = real
+
+    return minimums
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def find_first_row_with_value(arr, X) -> int:
     """Find the index of the first row in a 2D array that contains a specific value."""
     for i in range(arr.shape[0]):
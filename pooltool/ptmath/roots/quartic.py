@@ -1,17 +1,43 @@
-from typing import Callable, Dict, Tuple
+import time
+from functools import lru_cache
+from typing import Any, Callable, Dict, Optional, Tuple
 
 import numpy as np
 from numba import jit
 from numpy.typing import NDArray
 
 import pooltool.constants as const
-from pooltool.ptmath.roots.core import find_first_row_with_value, min_real_root
+import pooltool.instrumentation as instrumentation
+from pooltool.ptmath.roots.core import (
+    find_first_row_with_value,
+    min_real_root,
+    min_real_root_rows,
+)
 from pooltool.utils.strenum import StrEnum, auto
 
 
 class QuarticSolver(StrEnum):
+    """Methods for finding the roots of quartic polynomials
+
+    Attributes:
+        HYBRID:
+            Roots are calculated with the closed-form solution, with a fallback to
+            companion matrix eigenvalues for polynomials whose analytic roots don't
+            satisfy the polynomial (see :func:`solve_many`).
+        NUMERIC:
+            Roots are the eigenvalues of companion matrices (see
+            :func:`solve_many_numerical`).
+        BRACKETED:
+            Only the smallest real, positive root is found, in real arithmetic. The
+            root is bracketed between the polynomial's critical points and refined with
+            safeguarded Newton iterations. Rows that are degenerate, or that come close
+            to a root without crossing zero, fall back to companion matrix eigenvalues
+            (see :func:`smallest_positive_root`).
+    """
+
     HYBRID = auto()
     NUMERIC = auto()
+    BRACKETED = auto()
 
 
 def minimum_quartic_root(
@@ -34,8 +60,16 @@ def minimum_quartic_root(
             specifies the index of the responsible polynomial. i.e. the polynomial with
             the root real_root is ps[index, :]
     """
-    # Get the roots for the polynomials
     assert QuarticSolver(solver)
+
+    if instrumentation.active is not None:
+        _record(instrumentation.active, ps, solver)
+
+    if solver == QuarticSolver.BRACKETED:
+        root, index = min_root_bracketed(ps)
+        return (np.inf, 0) if index < 0 else (float(root), int(index))
+
+    # Get the roots for the polynomials
     roots = _quartic_routine[solver](ps)
 
     best_root = min_real_root(roots.flatten())
@@ -49,6 +83,66 @@ def minimum_quartic_root(
     return float(best_root.real), index
 
 
+def minimum_quartic_roots(
+    ps: NDArray[np.float64], solver: QuarticSolver = QuarticSolver.HYBRID
+) -> NDArray[np.float64]:
+    """Solves an array of quartic coefficients, returns the smallest root of each
+
+    This is the row-wise analog of :func:`minimum_quartic_root`. It's useful when the
+    polynomials belong to independent groups (*e.g.* many systems being simulated at
+    once), where the minimum of each group is needed, rather than the global minimum.
+
+    Args:
+        ps:
+            A mx5 array of polynomial coefficients, where m is the number of equations.
+            The columns are in the order a, b, c, d, e, where these coefficients make up
+            the quartic polynomial equation at^4 + bt^3 + ct^2 + dt + e = 0.
+        solver:
+            The method used to calculate the roots. See
+            pooltool.ptmath.roots.quartic.QuarticSolver.
+
+    Returns:
+        real_roots:
+            A length m array, where ``real_roots[i]`` is the smallest real, positive
+            root of ``ps[i, :]`` (``np.inf`` if there is none).
+    """
+    assert QuarticSolver(solver)
+
+    if not len(ps):
+        return np.empty(0, dtype=np.float64)
+
+    if instrumentation.active is not None:
+        _record(instrumentation.active, ps, solver)
+
+    if solver == QuarticSolver.BRACKETED:
+        return min_roots_bracketed(ps)
+
+    # NUMERIC may return a real-valued array if all roots happen to be real
+    roots = _quartic_routine[solver](ps).astype(np.complex128)
+    return min_real_root_rows(roots)
+
+
+def _record(
+    stats: instrumentation.SimulationStats,
+    ps: NDArray[np.float64],
+    solver: QuarticSolver,
+) -> None:
+    """Record the number of polynomials, and how many need the numerical solver
+
+    Telling which polynomials fall back means solving them again, which is why this is
+    only done when instrumenting.
+    """
+    if solver == QuarticSolver.HYBRID:
+        _, indicators = _solve_many(ps.astype(np.complex128))
+        fallbacks = int((indicators == _NUMERIC_FALLBACK).sum())
+    elif solver == QuarticSolver.BRACKETED:
+        fallbacks = int(count_bracketed_fallbacks(ps))
+    else:
+        fallbacks = 0
+
+    stats.record_quartics(len(ps), fallbacks)
+
+
 def solve_many_numerical(p):
     """Solve multiple polynomial equations using companion matrix eigenvalues
 
@@ -109,12 +203,16 @@ def solve_many(ps: NDArray[np.float64]) -> NDArray[np.complex128]:
     return roots
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+# The indicator _solve returns when it resorts to companion matrix eigenvalues
+_NUMERIC_FALLBACK = 3
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def solve(a, b, c, d, e) -> NDArray[np.complex128]:
     return _solve(np.array([a, b, c, d, e], dtype=np.complex128))[0]
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def _solve_many(
     ps: NDArray[np.complex128],
 ) -> Tuple[NDArray[np.complex128], NDArray[np.uint8]]:
@@ -129,7 +227,7 @@ def _solve_many(
     return all_roots, indicators
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def _solve(
     p: NDArray[np.complex128], ftol: float = 1e-5
 ) -> Tuple[NDArray[np.complex128], int]:
@@ -195,12 +293,12 @@ def _solve(
     return numeric(p), 3
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def evaluate(p: NDArray[np.complex128], val: complex) -> complex:
     return p[0] * val**4 + p[1] * val**3 + p[2] * val**2 + p[3] * val + p[4]
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def instability(p: NDArray[np.complex128]) -> float:
     """Range is from [0, inf], 0 is most stable"""
     a, b = p[:2]
@@ -212,12 +310,12 @@ def instability(p: NDArray[np.complex128]) -> float:
     return t + 1 / t
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def numeric(p: NDArray[np.complex128]) -> NDArray[np.complex128]:
     return np.roots(p).astype(np.complex128)
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def analytic(p: NDArray[np.complex128]) -> NDArray[np.complex128]:
     """Calculate a quartic's roots using the closed-form solution
 
@@ -327,17 +425,364 @@ def analytic(p: NDArray[np.complex128]) -> NDArray[np.complex128]:
     return np.array(roots, dtype=np.complex128)
 
 
-def _truth(a_val, b_val, c_val, d_val, e_val, digits=50):
+MAX_ITERATIONS: int = 100
+"""The maximum number of iterations spent refining a bracketed root
+
+This, :data:`XTOL`, and :data:`GRAZE_TOL` define the bracketing solver (see
+:func:`smallest_positive_root`). Ports of the solver to other devices should use them,
+so that they find the same roots.
+"""
+
+XTOL: float = float(4 * np.finfo(np.float64).eps)
+"""Refinement stops when the root moves by less than this fraction of itself"""
+
+GRAZE_TOL: float = 1e-6
+"""The tolerance for a (near) double root
+
+A polynomial that comes within this fraction of its magnitude to zero at a critical
+point, without crossing zero, is considered to have a (near) double root there.
+"""
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _horner(q, x):
+    """Evaluate a polynomial and its derivative with Horner's method
+
+    (just-in-time compiled)
+    """
+    f = q[0]
+    df = 0.0
+    for k in range(1, len(q)):
+        df = df * x + f
+        f = f * x + q[k]
+    return f, df
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _monotone_root(q, lo, hi, f_lo):
+    """Find the root of a polynomial that is monotone and changes sign in (lo, hi)
+
+    Newton steps that leave the bracket are replaced by bisection steps.
+
+    (just-in-time compiled)
+    """
+    x = 0.5 * (lo + hi)
+
+    for _ in range(MAX_ITERATIONS):
+        f, df = _horner(q, x)
+        if f == 0.0:
+            return x
+
+        if (f < 0.0) == (f_lo < 0.0):
+            lo = x
+        else:
+            hi = x
+
+        if df != 0.0 and lo < x - f / df < hi:
+            x_new = x - f / df
+        else:
+            x_new = 0.5 * (lo + hi)
+
+        if abs(x_new - x) <= XTOL * abs(x_new) or hi - lo <= XTOL * hi:
+            return x_new
+
+        x = x_new
+
+    return x
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _interval_roots(q, knots, num_knots, roots):
+    """Find the roots of a polynomial that is monotone between consecutive knots
+
+    The roots are written to ``roots`` in increasing order.
+
+    (just-in-time compiled)
+
+    Returns:
+        num_roots: The number of roots found.
+    """
+    num_roots = 0
+
+    for k in range(num_knots - 1):
+        lo, hi = knots[k], knots[k + 1]
+        f_lo, _ = _horner(q, lo)
+        f_hi, _ = _horner(q, hi)
+
+        if f_hi == 0.0:
+            roots[num_roots] = hi
+            num_roots += 1
+        elif f_lo != 0.0 and (f_lo < 0.0) != (f_hi < 0.0):
+            roots[num_roots] = _monotone_root(q, lo, hi, f_lo)
+            num_roots += 1
+
+    return num_roots
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def smallest_positive_root(p):
+    """Find the smallest real, positive root of a quartic in real arithmetic
+
+    The quartic is monotone between its critical points (the roots of its cubic
+    derivative), and the cubic derivative is monotone between its own critical points
+    (the roots of the quadratic second derivative). So the critical points are
+    bracketed using the roots of the second derivative, and the smallest root is the
+    first bracket in which the quartic changes sign. All roots are bounded by the
+    Cauchy bound.
+
+    (just-in-time compiled)
+
+    Args:
+        p:
+            A length 5 array of polynomial coefficients a, b, c, d, e, of the quartic
+            polynomial equation at^4 + bt^3 + ct^2 + dt + e = 0.
+
+    Returns:
+        (root, flagged):
+            ``root`` is the smallest real, positive root (``np.inf`` if there is none).
+            ``flagged`` is True if no root could be trusted, because the quartic is
+            degenerate (``a == 0``) or it has a critical point where it touches zero.
+            In that case, the root should be calculated another way (see
+            :func:`min_roots_bracketed`).
+    """
+    a, b, c, d, e = p[0], p[1], p[2], p[3], p[4]
+
+    # This means t=0 is a root
+    if e == 0.0:
+        return 0.0, False
+
+    if a == 0.0 or not np.isfinite(p).all():
+        return np.inf, True
+
+    upper = 1.0 + max(abs(b / a), abs(c / a), abs(d / a), abs(e / a))
+
+    # The cubic derivative is monotone between the roots of the second derivative
+    knots = np.empty(4, dtype=np.float64)
+    knots[0] = 0.0
+    num_knots = 1
+
+    A, B, C = 12.0 * a, 6.0 * b, 2.0 * c
+    discriminant = B * B - 4.0 * A * C
+    if discriminant >= 0.0:
+        # Numerically stable form of the quadratic formula
+        q = -0.5 * (B + np.copysign(np.sqrt(discriminant), B))
+        r1 = q / A
+        r2 = C / q if q != 0.0 else r1
+        for r in (min(r1, r2), max(r1, r2)):
+            if 0.0 < r < upper and r > knots[num_knots - 1]:
+                knots[num_knots] = r
+                num_knots += 1
+
+    knots[num_knots] = upper
+    num_knots += 1
+
+    # The quartic is monotone between the roots of the cubic derivative
+    derivative = np.array([4.0 * a, 3.0 * b, 2.0 * c, d])
+    critical = np.empty(5, dtype=np.float64)
+    critical[0] = 0.0
+    num_critical = 1 + _interval_roots(derivative, knots, num_knots, critical[1:])
+    critical[num_critical] = upper
+    num_critical += 1
+
+    for k in range(num_critical - 1):
+        lo, hi = critical[k], critical[k + 1]
+        f_lo, _ = _horner(p, lo)
+        f_hi, _ = _horner(p, hi)
+
+        if f_hi == 0.0:
+            return hi, False
+
+        if (f_lo < 0.0) != (f_hi < 0.0):
+            return _monotone_root(p, lo, hi, f_lo), False
+
+        if k < num_critical - 2:
+            # The quartic doesn't cross zero, but it may have a (near) double root at
+            # the critical point
+            magnitude = abs(a) * hi**4 + abs(b) * hi**3 + abs(c) * hi**2
+            magnitude += abs(d) * hi + abs(e)
+            if abs(f_hi) <= GRAZE_TOL * magnitude:
+                return np.inf, True
+
+    return np.inf, False
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def _fallback_root(p):
+    """The smallest real, positive root of a quartic, from companion matrix eigenvalues
+
+    (just-in-time compiled)
+    """
+    roots = numeric(p.astype(np.complex128))
+    return min_real_root_rows(roots.reshape((1, -1)))[0]
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def min_roots_bracketed(ps):
+    """Find the smallest real, positive root of each quartic
+
+    Roots are found with :func:`smallest_positive_root`, and flagged rows fall back to
+    companion matrix eigenvalues.
+
+    (just-in-time compiled)
+
+    Args:
+        ps:
+            A mx5 array of polynomial coefficients.
+
+    Returns:
+        real_roots:
+            A length m array, where ``real_roots[i]`` is the smallest real, positive
+            root of ``ps[i, :]`` (``np.inf`` if there is none).
+    """
+    num_rows = len(ps)
+    minimums = np.empty(num_rows, dtype=np.float64)
+
+    for i in range(num_rows):
+        root, flagged = smallest_positive_root(ps[i])
+        minimums[i] = _fallback_root(ps[i]) if flagged else root
+
+    return minimums
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def count_bracketed_fallbacks(ps):
+    """Count the quartics :func:`smallest_positive_root` flags for the fallback
+
+    (just-in-time compiled)
+    """
+    count = 0
+    for i in range(len(ps)):
+        _, flagged = smallest_positive_root(ps[i])
+        count += flagged
+
+    return count
+
+
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
+def min_root_bracketed(ps):
+    """Find the smallest real, positive root amongst many quartics
+
+    This is a single pass analog of :func:`min_roots_bracketed` that also tracks which
+    row the smallest root belongs to.
+
+    (just-in-time compiled)
+
+    Returns:
+        (root, index):
+            ``root`` is the smallest real, positive root, and ``index`` is the first row
+            that has it. If no quartic has a real, positive root, ``(np.inf, -1)`` is
+            returned.
+    """
+    best = np.inf
+    index = -1
+
+    for i in range(len(ps)):
+        root, flagged = smallest_positive_root(ps[i])
+        if flagged:
+            root = _fallback_root(ps[i])
+
+        if root < best:
+            best = root
+            index = i
+
+    return best, index
+
+
+@lru_cache(maxsize=None)
+def _general_solution():
     import sympy  # type: ignore
 
     x, a, b, c, d, e = sympy.symbols("x a b c d e")
-    general_solution = sympy.solve(a * x**4 + b * x**3 + c * x**2 + d * x + e, x)
+    return (a, b, c, d, e), sympy.solve(a * x**4 + b * x**3 + c * x**2 + d * x + e, x)
+
+
+def _truth(a_val, b_val, c_val, d_val, e_val, digits=50):
+    (a, b, c, d, e), general_solution = _general_solution()
     return [
         sol.evalf(digits, subs={a: a_val, b: b_val, c: c_val, d: d_val, e: e_val})
         for sol in general_solution
     ]
 
 
+def benchmark(
+    ps: Optional[NDArray[np.float64]] = None,
+    num_truth: int = 200,
+    repeats: int = 5,
+    seed: int = 42,
+) -> Dict[QuarticSolver, Dict[str, Any]]:
+    """Benchmark the accuracy and throughput of each solver
+
+    Accuracy is measured against :func:`_truth` (which requires ``sympy``), by
+    comparing the smallest real, positive root of each polynomial. Throughput is
+    measured with :func:`minimum_quartic_roots`.
+
+    Args:
+        ps:
+            A mx5 array of polynomial coefficients. By default, 10,000 polynomials with
+            coefficients of random sign and log-uniformly distributed magnitudes are
+            used.
+        num_truth:
+            The number of polynomials (the first ``num_truth`` rows of ``ps``) that
+            accuracy is measured on. Calculating the true roots is slow.
+        repeats:
+            Throughput is taken from the fastest of this many runs.
+        seed:
+            The random seed used to generate the default polynomials.
+
+    Returns:
+        results:
+            For each solver, a dictionary with the keys ``"polys_per_second"``,
+            ``"max_rel_error"`` (the maximum relative error of roots that both the
+            solver and the truth agree exist), and ``"mismatches"`` (the number of
+            polynomials for which exactly one of the solver and the truth finds a
+            root).
+
+    Example:
+
+        >>> from pooltool.ptmath.roots import quartic
+        >>> for solver, result in quartic.benchmark().items():
+        >>>     print(solver, result)
+    """
+    if ps is None:
+        rng = np.random.default_rng(seed)
+        magnitudes = 10 ** rng.uniform(-4, 3, size=(10_000, 5))
+        ps = magnitudes * rng.choice([-1.0, 1.0], size=(10_000, 5))
+
+    truth = np.array(
+        [
+            min_real_root(np.array(_truth(*p), dtype=np.complex128)).real
+            for p in ps[:num_truth]
+        ]
+    )
+
+    results: Dict[QuarticSolver, Dict[str, Any]] = {}
+    for solver in QuarticSolver:
+        # Warm up, so that compilation isn't timed
+        roots = minimum_quartic_roots(ps, solver)
+
+        elapsed = np.inf
+        for _ in range(repeats):
+            start = time.perf_counter()
+            minimum_quartic_roots(ps, solver)
+            elapsed = min(elapsed, time.perf_counter() - start)
+
+        found = np.isfinite(roots[:num_truth])
+        expected = np.isfinite(truth)
+        both = found & expected
+
+        results[solver] = dict(
+            polys_per_second=len(ps) / elapsed,
+            max_rel_error=float(
+                np.max(np.abs(roots[:num_truth][both] - truth[both]) / truth[both])
+                if both.any()
+                else 0.0
+            ),
+            mismatches=int((found != expected).sum()),
+        )
+
+    return results
+
+
 _quartic_routine: Dict[QuarticSolver, Callable] = {
     QuarticSolver.NUMERIC: solve_many_numerical,
     QuarticSolver.HYBRID: solve_many,
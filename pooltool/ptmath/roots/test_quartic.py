@@ -4,9 +4,7 @@ import pytest
 from pooltool.ptmath.roots import quartic
 
 
-@pytest.mark.parametrize(
-    "solver", [quartic.QuarticSolver.NUMERIC, quartic.QuarticSolver.HYBRID]
-)
+@pytest.mark.parametrize("solver", list(quartic.QuarticSolver))
 def test_case1(solver: quartic.QuarticSolver):
     coeffs = (
         0.9604000000000001,
@@ -34,3 +32,52 @@ def test_e_equals_0():
 
     expected = np.zeros(4, dtype=np.complex128)
     assert (expected == quartic.solve(*coeffs)).all()
+
+
+def test_bracketed_matches_numeric():
+    rng = np.random.default_rng(42)
+
+    # Quartics with known real roots, some of them negative, and a complex pair
+    real = rng.uniform(-1, 2, size=(500, 2))
+    pair = rng.uniform(-1, 2, size=500) + 1j * rng.uniform(0.1, 1, size=500)
+    ps = np.array(
+        [np.poly([r1, r2, z, np.conj(z)]).real for (r1, r2), z in zip(real, pair)]
+    )
+    ps *= rng.uniform(0.1, 10, size=(500, 1))
+
+    bracketed = quartic.minimum_quartic_roots(ps, quartic.QuarticSolver.BRACKETED)
+    numeric = quartic.minimum_quartic_roots(ps, quartic.QuarticSolver.NUMERIC)
+
+    expected = np.where(real > 0, real, np.inf).min(axis=1)
+    assert np.allclose(bracketed, expected, rtol=1e-9)
+    assert np.allclose(bracketed, numeric, rtol=1e-6)
+
+    root, index = quartic.minimum_quartic_root(ps, quartic.QuarticSolver.BRACKETED)
+    assert root == pytest.approx(expected.min(), rel=1e-9)
+    assert index == np.argmin(expected)
+
+
+def test_bracketed_fallback():
+    # A degenerate quartic (a cubic), a near double root, and no real roots
+    ps = np.array(
+        [
+            [0.0, 1.0, -3.0, 2.0, -0.5],
+            np.polymul([1.0, -1.0, 0.25 + 1e-12], [1.0, 3.0, 2.0]),
+            [1.0, 0.0, 1.0, 0.0, 1.0],
+        ]
+    )
+
+    _, flagged = quartic.smallest_positive_root(ps[0])
+    assert flagged
+    _, flagged = quartic.smallest_positive_root(ps[1])
+    assert flagged
+    root, flagged = quartic.smallest_positive_root(ps[2])
+    assert not flagged and root == np.inf
+
+    roots = quartic.minimum_quartic_roots(ps, quartic.QuarticSolver.BRACKETED)
+
+    cubic = np.roots(ps[0, 1:])
+    assert roots[0] == pytest.approx(min(r.real for r in cubic if r.imag == 0))
+    assert np.allclose(
+        roots[1:], quartic.minimum_quartic_roots(ps[1:], quartic.QuarticSolver.NUMERIC)
+    )
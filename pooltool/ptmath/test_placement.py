@@ -0,0 +1,69 @@
+from itertools import combinations
+
+import numpy as np
+
+from pooltool.ptmath.placement import (
+    any_overlapping,
+    overlapping,
+    place_balls,
+    place_layouts,
+)
+
+
+def _brute_force(xyz, R):
+    mask = np.zeros(len(R), dtype=bool)
+    for i, j in combinations(range(len(R)), 2):
+        if np.linalg.norm(xyz[i] - xyz[j]) < R[i] + R[j]:
+            mask[i] = mask[j] = True
+    return mask
+
+
+def test_overlapping():
+    rng = np.random.default_rng(42)
+    for _ in range(20):
+        xyz = rng.uniform(0, 0.5, (16, 3))
+        R = rng.uniform(0.02, 0.04, 16)
+
+        expected = _brute_force(xyz, R)
+        assert np.array_equal(overlapping(xyz, R), expected)
+        assert any_overlapping(xyz, R) == expected.any()
+
+
+def test_place_balls():
+    w, l = 1.0, 2.0
+    R = np.full(15, 0.03)
+
+    # The first three balls stay put, and one of them is off the table
+    xy = np.zeros((15, 2))
+    xy[:3] = [(0.5, 1.0), (0.2, 0.2), (-1.0, 5.0)]
+    movable = np.ones(15, dtype=bool)
+    movable[:3] = False
+    fixed = xy[:3].copy()
+
+    assert place_balls(xy, R, movable, w, l, 100, 42)
+    assert np.array_equal(xy[:3], fixed)
+    assert not any_overlapping(xy, R)
+    assert np.all((xy[3:] >= R[3:, None]) & (xy[3:] <= [w, l] - R[3:, None]))
+
+    # Seeded
+    other = np.zeros((15, 2))
+    other[:3] = fixed
+    place_balls(other, R, movable, w, l, 100, 42)
+    assert np.array_equal(xy, other)
+
+    # Balls that stay put overlap
+    xy[1] = xy[0]
+    assert not place_balls(xy, R, movable, w, l, 100, 42)
+
+    # Too many balls to fit
+    R = np.full(100, 0.1)
+    assert not place_balls(np.zeros((100, 2)), R, np.ones(100, bool), w, l, 100, 42)
+
+
+def test_place_layouts():
+    R = np.full(16, 0.028575)
+    xy, placed = place_layouts(50, R, 1.0, 2.0, 100, 42)
+
+    assert xy.shape == (50, 16, 2)
+    assert placed.all()
+    assert not any(any_overlapping(layout, R) for layout in xy)
@@ -50,7 +50,7 @@ def solve_transcendental(f, a, b, tol=1e-5, max_iter=100) -> float:
     return c
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def orientation(p, q, r):
     """Find the orientation of an ordered triplet (p, q, r)
 
@@ -146,7 +146,7 @@ def find_intersection_2D(
     return x, y
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def cross(u, v):
     """Compute cross product u x v, where u and v are 3-dimensional vectors
 
@@ -183,7 +183,7 @@ def unit_vector_slow(vector, handle_zero=False):
         return vector / norm
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def unit_vector(vector, handle_zero=False):
     """Returns the unit vector of the vector (just-in-time compiled)
 
@@ -202,7 +202,7 @@ def unit_vector(vector, handle_zero=False):
     return vector / norm
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def angle(v2, v1=(1, 0)):
     """Returns counter-clockwise angle of projections of v1 and v2 onto the x-y plane
 
@@ -216,7 +216,7 @@ def angle(v2, v1=(1, 0)):
     return ang
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def coordinate_rotation(v, phi):
     """Rotate vector/matrix from one frame of reference to another (3D FIXME)
 
@@ -234,7 +234,7 @@ def coordinate_rotation(v, phi):
     return np.dot(rotation, v)
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def point_on_line_closest_to_point(p1, p2, p0):
     """Returns point on line defined by points p1 and p2 closest to the point p0
 
@@ -245,7 +245,7 @@ def point_on_line_closest_to_point(p1, p2, p0):
     return p1 + diff * t
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def norm3d(vec):
     """Calculate the norm of a 3D vector
 
@@ -263,7 +263,7 @@ def norm3d(vec):
     return sqrt(vec[0] ** 2 + vec[1] ** 2 + vec[2] ** 2)
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def norm2d(vec):
     """Calculate the norm of a 2D vector
 
@@ -272,7 +272,7 @@ def norm2d(vec):
     return sqrt(vec[0] ** 2 + vec[1] ** 2)
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def rel_velocity(rvw, R):
     """Compute velocity of cloth with respect to ball's point of contact
 
@@ -282,7 +282,7 @@ def rel_velocity(rvw, R):
     return v + R * cross(np.array([0.0, 0.0, 1.0], dtype=np.float64), w)
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def get_u_vec(rvw, phi, R, s):
     if s == const.rolling:
         return np.array([1.0, 0.0, 0.0])
@@ -295,7 +295,7 @@ def get_u_vec(rvw, phi, R, s):
     return coordinate_rotation(unit_vector(rel_vel), -phi)
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def get_slide_time(rvw, R, u_s, g):
     if u_s == 0.0:
         return np.inf
@@ -303,7 +303,7 @@ def get_slide_time(rvw, R, u_s, g):
     return 2 * norm3d(rel_velocity(rvw, R)) / (7 * u_s * g)
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def get_roll_time(rvw, u_r, g):
     if u_r == 0.0:
         return np.inf
@@ -312,7 +312,7 @@ def get_roll_time(rvw, u_r, g):
     return norm3d(v) / (u_r * g)
 
 
-@jit(nopython=True, cache=const.use_numba_cache)
+@jit(nopython=True, nogil=True, cache=const.use_numba_cache)
 def get_spin_time(rvw, R, u_sp, g):
     if u_sp == 0.0:
         return np.inf
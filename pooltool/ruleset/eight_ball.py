@@ -5,7 +5,6 @@ from __future__ import annotations
 from typing import Counter, Dict, Optional, Tuple
 
 from pooltool.events.datatypes import EventType
-from pooltool.events.filter import by_ball, by_time, by_type, filter_events
 from pooltool.ruleset.datatypes import (
     BallInHandOptions,
     Player,
@@ -43,24 +42,18 @@ def _is_legal_break(shot: System) -> Tuple[bool, str]:
 
 
 def _is_cushion_hit_after_first_contact(shot: System) -> bool:
-    first_contact_event = filter_events(
-        shot.events,
-        by_ball("cue"),
-        by_type(EventType.BALL_BALL),
-    )
+    index = shot.event_index
+    first_contact_event = index.first("cue", EventType.BALL_BALL)
 
-    if not len(first_contact_event):
+    if first_contact_event is None:
         return False
 
-    first_contact_event = first_contact_event[0]
-
-    post_first_contact_cushion_hits = filter_events(
-        shot.events,
-        by_time(first_contact_event.time),
-        by_type([EventType.BALL_LINEAR_CUSHION, EventType.BALL_CIRCULAR_CUSHION]),
+    post_first_contact_cushion_hit = index.first(
+        types=[EventType.BALL_LINEAR_CUSHION, EventType.BALL_CIRCULAR_CUSHION],
+        after=first_contact_event.time,
     )
 
-    return bool(len(post_first_contact_cushion_hits))
+    return post_first_contact_cushion_hit is not None
 
 
 def _is_8_ball_pocketed_incorrectly(shot: System, constraints: ShotConstraints) -> bool:
@@ -72,11 +65,7 @@ def _is_8_ball_pocketed_incorrectly(shot: System, constraints: ShotConstraints)
         # Pocketed out-of-turn
         return True
 
-    ball_id, pocket_id = filter_events(
-        shot.events,
-        by_type(EventType.BALL_POCKET),
-        by_ball("8"),
-    )[0].ids
+    ball_id, pocket_id = shot.event_index.query("8", EventType.BALL_POCKET)[0].ids
 
     assert ball_id == "8"
 
@@ -9,7 +9,6 @@ from typing import Tuple
 import attrs
 
 from pooltool.events.datatypes import EventType
-from pooltool.events.filter import by_ball, by_time, by_type, filter_events
 from pooltool.ruleset.datatypes import (
     BallInHandOptions,
     Ruleset,
@@ -46,24 +45,18 @@ def _is_legal_break(shot: System) -> Tuple[bool, str]:
 
 
 def _is_cushion_hit_after_first_contact(shot: System) -> bool:
-    first_contact_event = filter_events(
-        shot.events,
-        by_ball("cue"),
-        by_type(EventType.BALL_BALL),
-    )
+    index = shot.event_index
+    first_contact_event = index.first("cue", EventType.BALL_BALL)
 
-    if not len(first_contact_event):
+    if first_contact_event is None:
         return False
 
-    first_contact_event = first_contact_event[0]
-
-    post_first_contact_cushion_hits = filter_events(
-        shot.events,
-        by_time(first_contact_event.time),
-        by_type([EventType.BALL_LINEAR_CUSHION, EventType.BALL_CIRCULAR_CUSHION]),
+    post_first_contact_cushion_hit = index.first(
+        types=[EventType.BALL_LINEAR_CUSHION, EventType.BALL_CIRCULAR_CUSHION],
+        after=first_contact_event.time,
     )
 
-    return bool(len(post_first_contact_cushion_hits))
+    return post_first_contact_cushion_hit is not None
 
 
 def is_legal(shot: System, break_shot: bool) -> Tuple[bool, str]:
@@ -5,7 +5,6 @@ from __future__ import annotations
 from typing import Counter
 
 from pooltool.events.datatypes import EventType
-from pooltool.events.filter import by_ball, by_type, filter_events, filter_type
 from pooltool.ruleset.datatypes import (
     BallInHandOptions,
     Player,
@@ -18,23 +17,15 @@ from pooltool.system.datatypes import System
 
 def is_turn_over(shot: System) -> bool:
     # See whether cue contacted object ball
-    ball_hits = filter_type(shot.events, EventType.BALL_BALL)
-    if not len(ball_hits):
+    index = shot.event_index
+    if index.first(types=EventType.BALL_BALL) is None:
         return True
 
     # Count rails that cue ball hits
-    cue_cushion_hits = filter_events(
-        shot.events,
-        by_type(EventType.BALL_LINEAR_CUSHION),
-        by_ball("cue"),
-    )
+    cue_cushion_hits = index.query("cue", EventType.BALL_LINEAR_CUSHION)
 
     # Count rails that object ball hits
-    object_cushion_hits = filter_events(
-        shot.events,
-        by_type(EventType.BALL_LINEAR_CUSHION),
-        by_ball("object"),
-    )
+    object_cushion_hits = index.query("object", EventType.BALL_LINEAR_CUSHION)
 
     return len(cue_cushion_hits) + len(object_cushion_hits) != 3
 
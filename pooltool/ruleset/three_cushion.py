@@ -5,7 +5,6 @@ from __future__ import annotations
 from typing import Counter
 
 from pooltool.events.datatypes import Event, EventType
-from pooltool.events.filter import by_ball, by_time, by_type, filter_events
 from pooltool.ruleset.datatypes import (
     BallInHandOptions,
     Player,
@@ -30,11 +29,7 @@ def is_turn_over(shot: System, constraints: ShotConstraints) -> bool:
 
     # Find when the second ball is first hit by the cue-ball
 
-    ball_hits = filter_events(
-        shot.events,
-        by_type(EventType.BALL_BALL),
-        by_ball(cue),
-    )
+    ball_hits = shot.event_index.query(cue, EventType.BALL_BALL)
 
     hits = set()
     for event in ball_hits:
@@ -46,11 +41,8 @@ def is_turn_over(shot: System, constraints: ShotConstraints) -> bool:
 
     # Now calculate all cue-ball cushion hits before that event
 
-    cushion_hits = filter_events(
-        shot.events,
-        by_type(EventType.BALL_LINEAR_CUSHION),
-        by_ball(cue),
-        by_time(event.time, after=False),
+    cushion_hits = shot.event_index.query(
+        cue, EventType.BALL_LINEAR_CUSHION, before=event.time
     )
 
     return len(cushion_hits) < 3
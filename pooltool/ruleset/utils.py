@@ -2,7 +2,6 @@ from typing import List, Optional, Set, Tuple
 
 import pooltool.constants as const
 from pooltool.events.datatypes import EventType
-from pooltool.events.filter import by_ball, by_type, filter_events, filter_type
 from pooltool.objects.ball.datatypes import Ball, BallState
 from pooltool.ruleset.datatypes import ShotConstraints
 from pooltool.system.datatypes import System
@@ -21,7 +20,7 @@ def get_pocketed_ball_ids_during_shot(
 
     return [
         event.agents[0].id
-        for event in filter_type(shot.events, EventType.BALL_POCKET)
+        for event in shot.event_index.query(types=EventType.BALL_POCKET)
         if event.agents[0].id not in exclude
     ]
 
@@ -35,28 +34,24 @@ def get_pocketed_ball_ids(shot: System) -> List[str]:
 
 
 def get_id_of_first_ball_hit(shot: System, cue: str = "cue") -> Optional[str]:
-    cue_collisions = filter_events(
-        shot.events,
-        by_ball(cue),
-        by_type(EventType.BALL_BALL),
-    )
+    first_collision = shot.event_index.first(cue, EventType.BALL_BALL)
 
-    if not len(cue_collisions):
+    if first_collision is None:
         return None
 
-    id1, id2 = cue_collisions[0].ids
+    id1, id2 = first_collision.ids
     return id1 if id1 != cue else id2
 
 
 def is_ball_pocketed(shot: System, ball_id: str) -> bool:
     return any(
         ball_id in event.agents[0].id
-        for event in filter_type(shot.events, EventType.BALL_POCKET)
+        for event in shot.event_index.query(types=EventType.BALL_POCKET)
     )
 
 
 def is_ball_pocketed_in_pocket(shot: System, ball_id: str, pocket_id: str) -> bool:
-    for event in filter_type(shot.events, EventType.BALL_POCKET):
+    for event in shot.event_index.query(ball_id, EventType.BALL_POCKET):
         agent1, agent2 = event.ids
         if ball_id == agent1 and pocket_id == agent2:
             return True
@@ -195,17 +190,16 @@ def balls_that_hit_cushion(
         ball.id for ball in shot.balls.values() if ball.id not in exclude
     ]
 
-    cushion_events = filter_events(
-        shot.events,
-        by_type([EventType.BALL_LINEAR_CUSHION, EventType.BALL_CIRCULAR_CUSHION]),
-        by_ball(numbered_ball_ids),
+    cushion_events = shot.event_index.query(
+        numbered_ball_ids,
+        [EventType.BALL_LINEAR_CUSHION, EventType.BALL_CIRCULAR_CUSHION],
     )
 
     return set(event.agents[0].id for event in cushion_events)
 
 
 def is_ball_hit(shot: System) -> bool:
-    return bool(len(filter_events(shot.events, by_type(EventType.BALL_BALL))))
+    return shot.event_index.first(types=EventType.BALL_BALL) is not None
 
 
 def is_numbered_ball_pocketed(shot: System) -> bool:
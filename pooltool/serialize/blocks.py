@@ -0,0 +1,166 @@
+"""A binary container of named, fixed-layout array blocks
+
+The file layout is:
+
+(1) An 8-byte magic string.
+(2) A little-endian ``uint32`` format version and a ``uint32`` that is reserved.
+(3) A little-endian ``uint64`` holding the byte length of the header.
+(4) The header, a UTF-8 encoded JSON object.
+(5) The blocks, each aligned to :data:`ALIGNMENT` bytes.
+
+The header holds arbitrary metadata under ``"meta"``, and the dtype, shape, and byte
+offset (relative to the start of the first block) of each block under ``"blocks"``.
+Since each block is a contiguous, aligned run of bytes, blocks can be read without any
+parsing, or memory-mapped.
+"""
+
+from __future__ import annotations
+
+import json
+import struct
+from typing import Any, BinaryIO, Dict, Tuple
+
+import numpy as np
+from numpy.typing import NDArray
+
+from pooltool.serialize.serializers import Pathish
+
+MAGIC = b"PTBLOCKS"
+VERSION = 1
+
+# Blocks start at multiples of this many bytes, which is at least the alignment of any
+# dtype
+ALIGNMENT = 64
+
+_PREAMBLE = struct.Struct("<8sIIQ")
+
+
+def _padding(nbytes: int) -> int:
+    return -nbytes % ALIGNMENT
+
+
+def write_blocks(path: Pathish, meta: Any, blocks: Dict[str, NDArray[Any]]) -> None:
+    """Write a block file
+
+    Args:
+        path:
+            The file path.
+        meta:
+            JSON-serializable metadata.
+        blocks:
+            The arrays, keyed by name. They are stored in C order with little-endian
+            dtypes.
+    """
+    with open(path, "wb") as fp:
+        dump_blocks(fp, meta, blocks)
+
+
+def dump_blocks(fp: BinaryIO, meta: Any, blocks: Dict[str, NDArray[Any]]) -> int:
+    """Write a block file to an open binary file, at its current position
+
+    Blocks are aligned relative to the current position, so the position should be a
+    multiple of :data:`ALIGNMENT` for them to be aligned in the file.
+
+    See :func:`write_blocks` for the arguments.
+
+    Returns:
+        int: The number of bytes written, which is a multiple of :data:`ALIGNMENT`.
+    """
+    arrays = {
+        name: np.ascontiguousarray(array, dtype=array.dtype.newbyteorder("<"))
+        for name, array in blocks.items()
+    }
+
+    layout = {}
+    offset = 0
+    for name, array in arrays.items():
+        layout[name] = dict(dtype=array.dtype.str, shape=array.shape, offset=offset)
+        offset += array.nbytes + _padding(array.nbytes)
+
+    header = json.dumps(dict(meta=meta, blocks=layout)).encode("utf-8")
+
+    fp.write(_PREAMBLE.pack(MAGIC, VERSION, 0, len(header)))
+    fp.write(header)
+    fp.write(b"\0" * _padding(_PREAMBLE.size + len(header)))
+
+    for array in arrays.values():
+        fp.write(array.tobytes())
+        fp.write(b"\0" * _padding(array.nbytes))
+
+    start = _PREAMBLE.size + len(header)
+    return start + _padding(start) + offset
+
+
+def read_blocks(
+    path: Pathish, mmap: bool = False
+) -> Tuple[Any, Dict[str, NDArray[Any]]]:
+    """Read a block file
+
+    Args:
+        path:
+            The file path.
+        mmap:
+            If True, the file is memory-mapped (copy-on-write) rather than read, and the
+            blocks are views into the mapping. Pages are read from disk only when the
+            corresponding arrays are accessed, and modifying the arrays never modifies
+            the file.
+
+    Returns:
+        (meta, blocks):
+            The metadata and the arrays, keyed by name.
+
+    Raises:
+        ValueError: If the file isn't a block file of a supported version.
+    """
+    if mmap:
+        buffer = np.memmap(path, dtype=np.uint8, mode="c")
+    else:
+        buffer = np.fromfile(path, dtype=np.uint8)
+
+    return parse_blocks(buffer, name=str(path))
+
+
+def parse_blocks(
+    buffer: NDArray[np.uint8], name: str = "buffer"
+) -> Tuple[Any, Dict[str, NDArray[Any]]]:
+    """Parse a block file held in a byte buffer
+
+    The blocks are views into the buffer, so no data is copied.
+
+    Args:
+        buffer:
+            The bytes of the block file, e.g. a slice of a memory-map.
+        name:
+            What the buffer holds, for error messages.
+
+    Returns:
+        (meta, blocks):
+            The metadata and the arrays, keyed by name.
+
+    Raises:
+        ValueError: If the buffer doesn't hold a block file of a supported version.
+    """
+    if len(buffer) < _PREAMBLE.size:
+        raise ValueError(f"'{name}' is not a block file")
+
+    magic, version, _, header_size = _PREAMBLE.unpack(
+        buffer[: _PREAMBLE.size].tobytes()
+    )
+    if magic != MAGIC:
+        raise ValueError(f"'{name}' is not a block file")
+    if version != VERSION:
+        raise ValueError(f"'{name}' has unsupported block file version {version}")
+
+    start = _PREAMBLE.size + header_size
+    header = json.loads(buffer[_PREAMBLE.size : start].tobytes().decode("utf-8"))
+    start += _padding(start)
+
+    blocks = {}
+    for block, spec in header["blocks"].items():
+        dtype = np.dtype(spec["dtype"])
+        shape = tuple(spec["shape"])
+        offset = start + spec["offset"]
+        nbytes = dtype.itemsize * int(np.prod(shape, dtype=np.int64))
+        blocks[block] = buffer[offset : offset + nbytes].view(dtype).reshape(shape)
+
+    return header["meta"], blocks
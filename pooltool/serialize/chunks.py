@@ -0,0 +1,217 @@
+"""An appendable binary container of block file chunks, with an offset index
+
+The file layout is:
+
+(1) An 8-byte magic string.
+(2) A little-endian ``uint32`` format version and a ``uint32`` number of chunks.
+(3) A little-endian ``uint64`` holding the byte offset of the index.
+(4) The chunks, each a block file (see :mod:`pooltool.serialize.blocks`) aligned to
+    :data:`pooltool.serialize.blocks.ALIGNMENT` bytes.
+(5) The index, a little-endian ``int64`` array with one row per chunk and a closing
+    row. Each row holds the byte offset at which a chunk starts (the closing row holds
+    the offset of the index), and the number of items held by the chunks before it.
+
+What an item is is up to the caller, e.g. a shot. The index lets a single chunk, or
+the chunk holding a given item, be read without reading (or parsing) anything else.
+
+Chunks are appended after the index, followed by a new index, and the preamble is
+updated to point to the new index last. The existing chunks and the previous index are
+never rewritten, so an interrupted append leaves the file as it was before the append.
+The previous index is left in place, as padding after the chunk preceding it.
+"""
+
+from __future__ import annotations
+
+import os
+import struct
+from pathlib import Path
+from typing import Any, BinaryIO, Dict, Iterable, Tuple
+
+import numpy as np
+from attrs import define
+from numpy.typing import NDArray
+
+from pooltool.serialize.blocks import ALIGNMENT, dump_blocks, parse_blocks
+from pooltool.serialize.serializers import Pathish
+
+MAGIC = b"PTCHUNKS"
+VERSION = 1
+
+_PREAMBLE = struct.Struct("<8sIIQ")
+_START = _PREAMBLE.size + -_PREAMBLE.size % ALIGNMENT
+
+
+@define
+class Chunk:
+    """A chunk of a chunk file
+
+    Attributes:
+        meta:
+            JSON-serializable metadata.
+        blocks:
+            The arrays, keyed by name.
+        count:
+            The number of items held by the chunk.
+    """
+
+    meta: Any
+    blocks: Dict[str, NDArray[Any]]
+    count: int
+
+
+def write_chunks(path: Pathish, chunks: Iterable[Chunk]) -> None:
+    """Write a chunk file
+
+    Args:
+        path:
+            The file path.
+        chunks:
+            The chunks, in order. There may be none.
+    """
+    with open(path, "wb") as fp:
+        fp.write(b"\0" * _START)
+        _append(fp, np.array([[_START, 0]], dtype=np.int64), _START, chunks)
+
+
+def append_chunks(path: Pathish, chunks: Iterable[Chunk]) -> None:
+    """Append chunks to a chunk file, creating it if it doesn't exist
+
+    Nothing is rewritten except the preamble, which is updated last. If appending is
+    interrupted, the file is left as it was.
+
+    Args:
+        path:
+            The file path.
+        chunks:
+            The chunks, in order.
+
+    Raises:
+        ValueError: If the file isn't a chunk file of a supported version.
+    """
+    if not Path(path).exists():
+        write_chunks(path, chunks)
+        return
+
+    with open(path, "r+b") as fp:
+        index = _read_index(fp, path)
+        _append(fp, index, int(index[-1, 0]) + index.nbytes, chunks)
+
+
+class ChunkReader:
+    """Reads individual chunks of a chunk file
+
+    The file is read as it was when the reader was made, so chunks appended afterwards
+    aren't seen.
+
+    Args:
+        path:
+            The file path.
+        mmap:
+            If True, the file is memory-mapped (copy-on-write), and the blocks of read
+            chunks are views into the mapping (see
+            :func:`pooltool.serialize.blocks.read_blocks`). Otherwise, each chunk is
+            read from the file when asked for.
+
+    Attributes:
+        offsets:
+            The byte offset of each chunk, along with the offset of the index.
+        counts:
+            The number of items held by the chunks before each chunk, along with the
+            total.
+
+    Raises:
+        ValueError: If the file isn't a chunk file of a supported version.
+    """
+
+    def __init__(self, path: Pathish, mmap: bool = False) -> None:
+        self.path = path
+
+        with open(path, "rb") as fp:
+            index = _read_index(fp, path)
+
+        self.offsets: NDArray[np.int64] = index[:, 0]
+        self.counts: NDArray[np.int64] = index[:, 1]
+        self._buffer = np.memmap(path, dtype=np.uint8, mode="c") if mmap else None
+
+    def __len__(self) -> int:
+        return len(self.offsets) - 1
+
+    @property
+    def num_items(self) -> int:
+        return int(self.counts[-1])
+
+    def locate(self, item: int) -> Tuple[int, int]:
+        """The chunk holding an item, and the item's index within the chunk"""
+        if not 0 <= item < self.num_items:
+            raise IndexError(f"Item {item} is out of range")
+
+        k = int(np.searchsorted(self.counts, item, "right")) - 1
+        return k, item - int(self.counts[k])
+
+    def read(self, k: int) -> Tuple[Any, Dict[str, NDArray[Any]]]:
+        """Read a chunk
+
+        Returns:
+            (meta, blocks):
+                The metadata and the arrays of the chunk, keyed by name.
+        """
+        start, stop = int(self.offsets[k]), int(self.offsets[k + 1])
+
+        if self._buffer is not None:
+            buffer = self._buffer[start:stop]
+        else:
+            with open(self.path, "rb") as fp:
+                fp.seek(start)
+                buffer = np.fromfile(fp, dtype=np.uint8, count=stop - start)
+
+        return parse_blocks(buffer, name=f"{self.path}, chunk {k}")
+
+
+def _read_index(fp: BinaryIO, path: Pathish) -> NDArray[np.int64]:
+    preamble = fp.read(_PREAMBLE.size)
+    if len(preamble) < _PREAMBLE.size:
+        raise ValueError(f"'{path}' is not a chunk file")
+
+    magic, version, num_chunks, index_offset = _PREAMBLE.unpack(preamble)
+    if magic != MAGIC:
+        raise ValueError(f"'{path}' is not a chunk file")
+    if version != VERSION:
+        raise ValueError(f"'{path}' has unsupported chunk file version {version}")
+
+    # Anything after the index is left over from an interrupted append
+    fp.seek(index_offset)
+    index = np.frombuffer(fp.read(16 * (num_chunks + 1)), dtype="<i8")
+    return index.reshape(-1, 2).astype(np.int64)
+
+
+def _append(
+    fp: BinaryIO, index: NDArray[np.int64], end: int, chunks: Iterable[Chunk]
+) -> None:
+    """Write chunks after the index, followed by the updated index
+
+    ``end`` is where the index ends. Anything after it is left over from an interrupted
+    append, and is dropped.
+    """
+    fp.seek(end)
+    fp.truncate()
+
+    offset = end + -end % ALIGNMENT
+    fp.write(b"\0" * (offset - end))
+
+    # The closing row is replaced, so the previous index pads the last chunk before it
+    count = int(index[-1, 1])
+    rows = [index[:-1]]
+    for chunk in chunks:
+        rows.append(np.array([[offset, count]], dtype=np.int64))
+        offset += dump_blocks(fp, chunk.meta, chunk.blocks)
+        count += chunk.count
+
+    rows.append(np.array([[offset, count]], dtype=np.int64))
+    updated = np.concatenate(rows)
+    fp.write(updated.astype("<i8").tobytes())
+
+    # The preamble points to the previous index until everything else is on disk
+    fp.flush()
+    os.fsync(fp.fileno())
+    fp.seek(0)
+    fp.write(_PREAMBLE.pack(MAGIC, VERSION, len(updated) - 1, offset))
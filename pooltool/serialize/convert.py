@@ -25,36 +25,36 @@ class Convert:
         self,
         cl: Any,
         func: Callable[[Any, Type[T]], T],
-        which: Iterable[SerializeFormat] = SerializeFormat,
+        which: Optional[Iterable[SerializeFormat]] = None,
     ) -> None:
-        for fmt in which:
+        for fmt in self._formats(which):
             self.converters[fmt].register_structure_hook(cl, func)
 
     def register_structure_hook_func(
         self,
         check_func: Callable[[Type[T]], bool],
         func: Callable[[Any, Type[T]], T],
-        which: Iterable[SerializeFormat] = SerializeFormat,
+        which: Optional[Iterable[SerializeFormat]] = None,
     ) -> None:
-        for fmt in which:
+        for fmt in self._formats(which):
             self.converters[fmt].register_structure_hook_func(check_func, func)
 
     def register_unstructure_hook(
         self,
         cls: Any,
         func: Callable[[Any], Any],
-        which: Iterable[SerializeFormat] = SerializeFormat,
+        which: Optional[Iterable[SerializeFormat]] = None,
     ) -> None:
-        for fmt in which:
+        for fmt in self._formats(which):
             self.converters[fmt].register_unstructure_hook(cls, func)
 
     def register_unstructure_hook_func(
         self,
         check_func: Callable[[Any], bool],
         func: Callable[[Any], Any],
-        which: Iterable[SerializeFormat] = SerializeFormat,
+        which: Optional[Iterable[SerializeFormat]] = None,
     ) -> None:
-        for fmt in which:
+        for fmt in self._formats(which):
             self.converters[fmt].register_unstructure_hook_func(check_func, func)
 
     def unstructure_to(
@@ -70,6 +70,12 @@ class Convert:
         fmt = SerializeFormat(fmt) if fmt is not None else self._infer_ext(path)
         return self.converters[fmt].structure(deserializers[fmt](path), cl)
 
+    def _formats(
+        self, which: Optional[Iterable[SerializeFormat]]
+    ) -> Iterable[SerializeFormat]:
+        """The passed formats, or by default, all formats that have a converter"""
+        return self.converters.keys() if which is None else which
+
     def _infer_ext(self, path: Pathish) -> SerializeFormat:
         inferred = Path(path).suffix.lstrip(".")
         for fmt in self.converters:
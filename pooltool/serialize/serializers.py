@@ -12,9 +12,30 @@ Pathish = Union[str, Path]
 
 
 class SerializeFormat(StrEnum):
+    """Serialization formats
+
+    Attributes:
+        JSON:
+            Human-readable JSON.
+        MSGPACK:
+            Binary msgpack.
+        YAML:
+            Human-readable YAML.
+        COLUMNAR:
+            Fixed-layout columnar blocks (see :mod:`pooltool.serialize.blocks`). This
+            format holds systems (see :mod:`pooltool.system.columnar`) rather than
+            arbitrary objects, so no converter exists for it.
+        ARCHIVE:
+            Chunks of columnar blocks with an offset index (see
+            :mod:`pooltool.serialize.chunks`). Like :attr:`COLUMNAR`, this format holds
+            systems, and no converter exists for it.
+    """
+
     JSON = auto()
     MSGPACK = auto()
     YAML = auto()
+    COLUMNAR = auto()
+    ARCHIVE = auto()
 
     @property
     def ext(self):
@@ -0,0 +1,41 @@
+import numpy as np
+import pytest
+
+from pooltool.serialize.blocks import read_blocks, write_blocks
+
+
+@pytest.mark.parametrize("mmap", [False, True])
+def test_blocks_round_trip(tmp_path, mmap: bool):
+    path = tmp_path / "blocks.bin"
+    meta = {"name": "foo", "values": [1, 2, 3]}
+    blocks = {
+        "float64": np.arange(27, dtype=np.float64).reshape((3, 3, 3)),
+        "int8": np.arange(5, dtype=np.int8),
+        "empty": np.empty((0, 3, 3), dtype=np.float64),
+        "big_endian": np.arange(4, dtype=">i4"),
+    }
+
+    write_blocks(path, meta, blocks)
+    loaded_meta, loaded = read_blocks(path, mmap=mmap)
+
+    assert loaded_meta == meta
+    assert loaded.keys() == blocks.keys()
+    for name, array in blocks.items():
+        assert loaded[name].shape == array.shape
+        assert np.array_equal(loaded[name], array)
+
+        # Blocks are aligned
+        assert loaded[name].flags.aligned
+
+    # Blocks can be modified without modifying the file
+    loaded["float64"][0] = 42
+    _, reloaded = read_blocks(path, mmap=mmap)
+    assert np.array_equal(reloaded["float64"], blocks["float64"])
+
+
+def test_not_blocks(tmp_path):
+    path = tmp_path / "not_blocks.bin"
+    path.write_bytes(b"\0" * 64)
+
+    with pytest.raises(ValueError):
+        read_blocks(path)
@@ -0,0 +1,108 @@
+import numpy as np
+import pytest
+
+from pooltool.serialize.blocks import write_blocks
+from pooltool.serialize.chunks import Chunk, ChunkReader, append_chunks, write_chunks
+
+
+def _chunk(k: int) -> Chunk:
+    return Chunk(
+        meta={"chunk": k},
+        blocks={
+            "float64": np.full((k + 1, 3), k, dtype=np.float64),
+            "int8": np.arange(k, dtype=np.int8),
+        },
+        count=k,
+    )
+
+
+def _assert_chunk(reader: ChunkReader, k: int) -> None:
+    meta, blocks = reader.read(k)
+    expected = _chunk(k)
+
+    assert meta == expected.meta
+    for name, array in expected.blocks.items():
+        assert np.array_equal(blocks[name], array)
+        assert blocks[name].flags.aligned
+
+
+@pytest.mark.parametrize("mmap", [False, True])
+def test_chunks_round_trip(tmp_path, mmap: bool):
+    path = tmp_path / "chunks.bin"
+
+    write_chunks(path, [])
+    reader = ChunkReader(path, mmap=mmap)
+    assert len(reader) == 0
+    assert reader.num_items == 0
+
+    write_chunks(path, [_chunk(k) for k in range(3)])
+    reader = ChunkReader(path, mmap=mmap)
+    assert len(reader) == 3
+    assert reader.num_items == 0 + 1 + 2
+
+    for k in range(3):
+        _assert_chunk(reader, k)
+
+    assert reader.locate(0) == (1, 0)
+    assert reader.locate(2) == (2, 1)
+    with pytest.raises(IndexError):
+        reader.locate(3)
+
+
+def test_append_chunks(tmp_path):
+    path = tmp_path / "chunks.bin"
+
+    append_chunks(path, [_chunk(0), _chunk(1)])
+    before = path.read_bytes()
+    reader = ChunkReader(path)
+
+    append_chunks(path, [_chunk(2)])
+    append_chunks(path, [_chunk(3)])
+
+    # Existing chunks aren't rewritten
+    assert path.read_bytes()[: reader.offsets[-1]] == before[: reader.offsets[-1]]
+
+    # A reader sees the file as it was when it was made
+    assert len(reader) == 2
+
+    reader = ChunkReader(path)
+    assert len(reader) == 4
+    assert reader.num_items == 6
+    for k in range(4):
+        _assert_chunk(reader, k)
+
+
+def test_append_chunks_interrupted(tmp_path):
+    path = tmp_path / "chunks.bin"
+    write_chunks(path, [_chunk(0), _chunk(1)])
+
+    def interrupted():
+        yield _chunk(2)
+        raise KeyboardInterrupt
+
+    with pytest.raises(KeyboardInterrupt):
+        append_chunks(path, interrupted())
+
+    # The file reads as it did before the append
+    reader = ChunkReader(path)
+    assert len(reader) == 2
+    for k in range(2):
+        _assert_chunk(reader, k)
+
+    # What the append left behind is dropped by the next one
+    append_chunks(path, [_chunk(2)])
+    reader = ChunkReader(path)
+    assert len(reader) == 3
+    for k in range(3):
+        _assert_chunk(reader, k)
+
+
+def test_not_chunks(tmp_path):
+    path = tmp_path / "blocks.bin"
+    write_blocks(path, {}, {})
+
+    with pytest.raises(ValueError):
+        ChunkReader(path)
+
+    with pytest.raises(ValueError):
+        append_chunks(path, [_chunk(0)])
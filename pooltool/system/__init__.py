@@ -1,11 +1,12 @@
 """The system container and its associated objects"""
 
-from pooltool.system.datatypes import MultiSystem, System, multisystem
+from pooltool.system.datatypes import LazyMultiSystem, MultiSystem, System, multisystem
 from pooltool.system.render import SystemController, SystemRender, visual
 
 __all__ = [
     "System",
     "MultiSystem",
+    "LazyMultiSystem",
     "multisystem",
     "SystemRender",
     "SystemController",
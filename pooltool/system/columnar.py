@@ -0,0 +1,705 @@
+"""Columnar binary storage of systems
+
+Systems are stored in the :attr:`pooltool.serialize.SerializeFormat.COLUMNAR` format, a
+block file (see :mod:`pooltool.serialize.blocks`) holding one or more systems.
+
+The bulk of a simulated system is its ball histories and its events. These are stored
+as fixed-layout columns that are shared by all of the systems in the file:
+
+(1) Ball columns hold each ball's ID, parameters, ballset, orientation, and state.
+(2) History columns hold the concatenated :class:`BallHistory` vectorizations (see
+    :meth:`BallHistory.vectorize`) of every ball, for both ``history`` and
+    ``history_cts``. Offset columns mark where each ball's history starts.
+(3) Event columns hold each event's type and time, and offsets into the agent columns.
+(4) Agent columns hold each agent's ID and type, and the states of ball agents before
+    and after the event.
+
+Rows of each system are marked by offset columns too. What's left (the cue, the pocket
+contents, and table geometry) is small, and is stored in the header. Tables, ball
+parameters, ballsets, and IDs are stored once no matter how many systems share them.
+
+When loaded, histories are built directly on the loaded (or memory-mapped) columns, so
+no data is copied. The columns are made read-only, so a history moves to storage of its
+own when it's first modified, and systems built on the same columns (such as those of
+an archive chunk that's read more than once) never write into each other.
+
+Large or growing collections of systems can instead be stored in the
+:attr:`pooltool.serialize.SerializeFormat.ARCHIVE` format, a chunk file (see
+:mod:`pooltool.serialize.chunks`) whose chunks each hold the columns of a few systems.
+Systems of an archive are loaded one chunk at a time (see :class:`ShotArchive`), and
+systems are appended without rewriting the file (see :func:`append_archive`).
+"""
+
+from __future__ import annotations
+
+import json
+from typing import (
+    Any,
+    Dict,
+    Iterable,
+    Iterator,
+    List,
+    Optional,
+    Sequence,
+    Tuple,
+    Type,
+    Union,
+)
+
+import numpy as np
+from attrs import define, evolve
+from numpy.typing import NDArray
+
+from pooltool.events import Agent, AgentType, Event, EventType
+from pooltool.objects.ball.datatypes import (
+    Ball,
+    BallHistory,
+    BallOrientation,
+    BallState,
+)
+from pooltool.objects.ball.params import BallParams
+from pooltool.objects.ball.sets import BallSet
+from pooltool.objects.cue.datatypes import Cue
+from pooltool.objects.table.components import (
+    CircularCushionSegment,
+    LinearCushionSegment,
+    Pocket,
+)
+from pooltool.objects.table.datatypes import Table
+from pooltool.serialize import SerializeFormat, conversion
+from pooltool.serialize.blocks import read_blocks, write_blocks
+from pooltool.serialize.chunks import Chunk, ChunkReader, append_chunks, write_chunks
+from pooltool.serialize.serializers import Pathish
+
+_EVENT_TYPES = tuple(EventType)
+_AGENT_TYPES = tuple(AgentType)
+
+_AGENT_CLASSES: Dict[AgentType, Type[Any]] = {
+    AgentType.CUE: Cue,
+    AgentType.BALL: Ball,
+    AgentType.POCKET: Pocket,
+    AgentType.LINEAR_CUSHION_SEGMENT: LinearCushionSegment,
+    AgentType.CIRCULAR_CUSHION_SEGMENT: CircularCushionSegment,
+}
+
+# References of agent states. Non-negative references index the agent objects in the
+# header
+_NO_STATE = -2
+_BALL_STATE = -1
+
+_HISTORIES = ("history", "history_cts")
+
+# The dtype and row shape of each column
+_COLUMNS: Dict[str, Tuple[Type[np.generic], Tuple[int, ...]]] = {
+    "system_t": (np.float64, ()),
+    "system_table": (np.int64, ()),
+    "system_balls": (np.int64, ()),
+    "system_events": (np.int64, ()),
+    "ball_id": (np.int64, ()),
+    "ball_params": (np.int64, ()),
+    "ball_ballset": (np.int64, ()),
+    "ball_orientation": (np.float64, (2, 4)),
+    "ball_rvw": (np.float64, (3, 3)),
+    "ball_s": (np.float64, ()),
+    "ball_t": (np.float64, ()),
+    "event_type": (np.int8, ()),
+    "event_time": (np.float64, ()),
+    "event_agents": (np.int64, ()),
+    "agent_id": (np.int64, ()),
+    "agent_type": (np.int8, ()),
+    **{
+        f"agent_{name}{suffix}": spec
+        for name in ("initial", "final")
+        for suffix, spec in (
+            ("", (np.int64, ())),
+            ("_rvw", (np.float64, (3, 3))),
+            ("_s", (np.float64, ())),
+            ("_t", (np.float64, ())),
+        )
+    },
+    **{
+        f"{name}_{suffix}": spec
+        for name in _HISTORIES
+        for suffix, spec in (
+            ("offsets", (np.int64, ())),
+            ("rvw", (np.float64, (3, 3))),
+            ("s", (np.float64, ())),
+            ("t", (np.float64, ())),
+        )
+    },
+}
+
+_converter = conversion[SerializeFormat.JSON]
+
+
+@define
+class ShotRecord:
+    """The stored parts of a system
+
+    Attributes:
+        cue:
+            See :attr:`pooltool.system.datatypes.System.cue`.
+        table:
+            See :attr:`pooltool.system.datatypes.System.table`.
+        balls:
+            See :attr:`pooltool.system.datatypes.System.balls`.
+        t:
+            See :attr:`pooltool.system.datatypes.System.t`.
+        events:
+            See :attr:`pooltool.system.datatypes.System.events`.
+    """
+
+    cue: Cue
+    table: Table
+    balls: Dict[str, Ball]
+    t: float
+    events: List[Event]
+
+
+def save_shots(shots: Sequence[ShotRecord], path: Pathish) -> None:
+    """Save shots to a columnar file"""
+    packer = _Packer()
+    for shot in shots:
+        packer.add(shot)
+
+    write_blocks(path, packer.meta(), packer.blocks())
+
+
+def load_shots(path: Pathish, mmap: bool = False) -> List[ShotRecord]:
+    """Load shots from a columnar file
+
+    Args:
+        path:
+            The file path.
+        mmap:
+            If True, the file is memory-mapped rather than read (see
+            :func:`pooltool.serialize.blocks.read_blocks`).
+    """
+    meta, blocks = read_blocks(path, mmap=mmap)
+    return _Unpacker(meta, blocks).shots()
+
+
+def save_archive(
+    shots: Sequence[ShotRecord], path: Pathish, chunk_size: int = 64
+) -> None:
+    """Save shots to an archive
+
+    Args:
+        shots:
+            The shots.
+        path:
+            The file path.
+        chunk_size:
+            The number of shots stored in each chunk.
+    """
+    write_chunks(path, _chunks(shots, chunk_size))
+
+
+def append_archive(
+    shots: Sequence[ShotRecord], path: Pathish, chunk_size: int = 64
+) -> None:
+    """Append shots to an archive, creating it if it doesn't exist
+
+    The shots are stored in new chunks, so the existing shots are never rewritten. See
+    :func:`save_archive` for the arguments.
+    """
+    append_chunks(path, _chunks(shots, chunk_size))
+
+
+def _chunks(shots: Sequence[ShotRecord], chunk_size: int) -> Iterator[Chunk]:
+    if chunk_size < 1:
+        raise ValueError(f"chunk_size must be positive, got {chunk_size}")
+
+    # Shots are packed as chunks are written, so the columns of only one chunk are held
+    # at a time
+    return (
+        _chunk(shots[start : start + chunk_size])
+        for start in range(0, len(shots), chunk_size)
+    )
+
+
+def _chunk(shots: Sequence[ShotRecord]) -> Chunk:
+    packer = _Packer()
+    for shot in shots:
+        packer.add(shot)
+
+    return Chunk(packer.meta(), packer.blocks(), len(shots))
+
+
+class _Interner:
+    """Assigns an index to each distinct JSON-serializable value"""
+
+    def __init__(self) -> None:
+        self.values: List[Any] = []
+        self._indices: Dict[str, int] = {}
+
+    def __call__(self, value: Any) -> int:
+        key = json.dumps(value, sort_keys=True)
+        if key not in self._indices:
+            self._indices[key] = len(self.values)
+            self.values.append(value)
+        return self._indices[key]
+
+
+class _Packer:
+    """Accumulates the columns of shots"""
+
+    def __init__(self) -> None:
+        self.strings = _Interner()
+        self.tables = _Interner()
+        self.params = _Interner()
+        self.ballsets = _Interner()
+        self.objects = _Interner()
+
+        self.systems: List[Dict[str, Any]] = []
+        self.columns: Dict[str, List[Any]] = {name: [] for name in _COLUMNS}
+
+        self.num_balls = 0
+        self.num_events = 0
+        self.num_agents = 0
+        self.num_states = dict.fromkeys(_HISTORIES, 0)
+
+    def add(self, shot: ShotRecord) -> None:
+        columns = self.columns
+
+        # The pocket contents are stored separately, so that systems with the same table
+        # geometry share a table
+        table = shot.table.copy()
+        for pocket in table.pockets.values():
+            pocket.contains.clear()
+
+        self.systems.append(
+            dict(
+                cue=_converter.unstructure(shot.cue),
+                contains={
+                    pocket_id: sorted(pocket.contains)
+                    for pocket_id, pocket in shot.table.pockets.items()
+                },
+            )
+        )
+        columns["system_t"].append(shot.t)
+        columns["system_table"].append(self.tables(_converter.unstructure(table)))
+        columns["system_balls"].append(self.num_balls)
+        columns["system_events"].append(self.num_events)
+
+        for ball in shot.balls.values():
+            self._add_ball(ball)
+
+        for event in shot.events:
+            self._add_event(event, shot.balls)
+
+    def _add_ball(self, ball: Ball) -> None:
+        columns = self.columns
+
+        columns["ball_id"].append(self.strings(ball.id))
+        columns["ball_params"].append(self.params(_converter.unstructure(ball.params)))
+        columns["ball_ballset"].append(
+            -1
+            if ball.ballset is None
+            else self.ballsets(_converter.unstructure(ball.ballset))
+        )
+        columns["ball_orientation"].append(
+            (ball.initial_orientation.pos, ball.initial_orientation.sphere)
+        )
+        columns["ball_rvw"].append(ball.state.rvw)
+        columns["ball_s"].append(ball.state.s)
+        columns["ball_t"].append(ball.state.t)
+
+        for name in _HISTORIES:
+            columns[f"{name}_offsets"].append(self.num_states[name])
+
+            vectorization = getattr(ball, name).vectorize()
+            if vectorization is None:
+                continue
+
+            for suffix, column in zip(("rvw", "s", "t"), vectorization):
+                columns[f"{name}_{suffix}"].append(column)
+            self.num_states[name] += len(vectorization[2])
+
+        self.num_balls += 1
+
+    def _add_event(self, event: Event, balls: Dict[str, Ball]) -> None:
+        columns = self.columns
+
+        columns["event_type"].append(_EVENT_TYPES.index(event.event_type))
+        columns["event_time"].append(event.time)
+        columns["event_agents"].append(self.num_agents)
+
+        for agent in event.agents:
+            columns["agent_id"].append(self.strings(agent.id))
+            columns["agent_type"].append(_AGENT_TYPES.index(agent.agent_type))
+
+            for name, obj in (("initial", agent.initial), ("final", agent.final)):
+                state = None
+
+                if obj is None:
+                    ref = _NO_STATE
+                elif _is_ball_snapshot(obj, balls.get(agent.id)):
+                    ref = _BALL_STATE
+                    state = obj.state
+                else:
+                    ref = self.objects(
+                        dict(
+                            agent_type=agent.agent_type.value,
+                            value=_converter.unstructure(obj),
+                        )
+                    )
+
+                columns[f"agent_{name}"].append(ref)
+                columns[f"agent_{name}_rvw"].append(
+                    np.zeros((3, 3)) if state is None else state.rvw
+                )
+                columns[f"agent_{name}_s"].append(0 if state is None else state.s)
+                columns[f"agent_{name}_t"].append(0.0 if state is None else state.t)
+
+            self.num_agents += 1
+
+        self.num_events += 1
+
+    def meta(self) -> Dict[str, Any]:
+        return dict(
+            systems=self.systems,
+            strings=self.strings.values,
+            tables=self.tables.values,
+            params=self.params.values,
+            ballsets=self.ballsets.values,
+            objects=self.objects.values,
+        )
+
+    def blocks(self) -> Dict[str, NDArray[Any]]:
+        columns = self.columns
+
+        # Close the offsets
+        columns["system_balls"].append(self.num_balls)
+        columns["system_events"].append(self.num_events)
+        columns["event_agents"].append(self.num_agents)
+        for name in _HISTORIES:
+            columns[f"{name}_offsets"].append(self.num_states[name])
+
+        blocks = {}
+        for name, (dtype, shape) in _COLUMNS.items():
+            column = columns[name]
+            if name.startswith(_HISTORIES) and not name.endswith("_offsets"):
+                # History columns are built from vectorizations rather than rows
+                blocks[name] = (
+                    np.concatenate(column).astype(dtype, copy=False)
+                    if len(column)
+                    else np.empty((0, *shape), dtype=dtype)
+                )
+            else:
+                blocks[name] = np.array(column, dtype=dtype).reshape(-1, *shape)
+
+        return blocks
+
+
+def _is_ball_snapshot(obj: Any, ball: Optional[Ball]) -> bool:
+    """Whether an agent state is a history-less copy of a ball in a different state
+
+    If so, only the state needs to be stored.
+    """
+    return (
+        isinstance(obj, Ball)
+        and ball is not None
+        and obj.id == ball.id
+        and obj.params == ball.params
+        and obj.ballset == ball.ballset
+        and obj.initial_orientation == ball.initial_orientation
+        and obj.history.empty
+        and obj.history_cts.empty
+    )
+
+
+class _Unpacker:
+    """Builds shots from columns"""
+
+    def __init__(self, meta: Dict[str, Any], blocks: Dict[str, NDArray[Any]]) -> None:
+        self.meta = meta
+        self.blocks = blocks
+
+        # Histories built on the columns copy them when they're first modified
+        for array in blocks.values():
+            array.flags.writeable = False
+
+        self.tables = [_converter.structure(table, Table) for table in meta["tables"]]
+        self.params = [
+            _converter.structure(params, BallParams) for params in meta["params"]
+        ]
+        self.ballsets = [
+            _converter.structure(ballset, BallSet) for ballset in meta["ballsets"]
+        ]
+        self._objects: Dict[int, Any] = {}
+
+    def shots(self) -> List[ShotRecord]:
+        return [self._shot(k) for k in range(len(self.meta["systems"]))]
+
+    def _shot(self, k: int) -> ShotRecord:
+        blocks = self.blocks
+        system = self.meta["systems"][k]
+
+        table = self.tables[blocks["system_table"][k]].copy()
+        for pocket_id, contains in system["contains"].items():
+            table.pockets[pocket_id].contains.update(contains)
+
+        balls = {}
+        for b in range(blocks["system_balls"][k], blocks["system_balls"][k + 1]):
+            ball = self._ball(b)
+            balls[ball.id] = ball
+
+        events = [
+            self._event(e, balls)
+            for e in range(blocks["system_events"][k], blocks["system_events"][k + 1])
+        ]
+
+        return ShotRecord(
+            cue=_converter.structure(system["cue"], Cue),
+            table=table,
+            balls=balls,
+            t=float(blocks["system_t"][k]),
+            events=events,
+        )
+
+    def _ball(self, b: int) -> Ball:
+        blocks = self.blocks
+        strings = self.meta["strings"]
+
+        histories = {}
+        for name in _HISTORIES:
+            start, stop = blocks[f"{name}_offsets"][b : b + 2]
+            histories[name] = BallHistory.from_vectorization(
+                (
+                    blocks[f"{name}_rvw"][start:stop],
+                    blocks[f"{name}_s"][start:stop],
+                    blocks[f"{name}_t"][start:stop],
+                )
+            )
+
+        ballset = blocks["ball_ballset"][b]
+        orientation = blocks["ball_orientation"][b]
+
+        return Ball(
+            id=strings[blocks["ball_id"][b]],
+            state=BallState(
+                blocks["ball_rvw"][b].copy(), blocks["ball_s"][b], blocks["ball_t"][b]
+            ),
+            params=self.params[blocks["ball_params"][b]],
+            ballset=None if ballset < 0 else self.ballsets[ballset],
+            initial_orientation=BallOrientation(
+                pos=tuple(orientation[0].tolist()),  # type: ignore
+                sphere=tuple(orientation[1].tolist()),  # type: ignore
+            ),
+            history=histories["history"],
+            history_cts=histories["history_cts"],
+        )
+
+    def _event(self, e: int, balls: Dict[str, Ball]) -> Event:
+        blocks = self.blocks
+        strings = self.meta["strings"]
+
+        agents = []
+        for a in range(blocks["event_agents"][e], blocks["event_agents"][e + 1]):
+            agent = Agent(
+                id=strings[blocks["agent_id"][a]],
+                agent_type=_AGENT_TYPES[blocks["agent_type"][a]],
+            )
+            agent.initial = self._agent_state(a, "initial", balls.get(agent.id))
+            agent.final = self._agent_state(a, "final", balls.get(agent.id))
+            agents.append(agent)
+
+        return Event(
+            event_type=_EVENT_TYPES[blocks["event_type"][e]],
+            agents=tuple(agents),
+            time=float(blocks["event_time"][e]),
+        )
+
+    def _agent_state(self, a: int, name: str, ball: Optional[Ball]) -> Any:
+        blocks = self.blocks
+        ref = blocks[f"agent_{name}"][a]
+
+        if ref == _NO_STATE:
+            return None
+
+        if ref == _BALL_STATE:
+            assert ball is not None
+            return evolve(
+                ball,
+                state=BallState(
+                    blocks[f"agent_{name}_rvw"][a].copy(),
+                    blocks[f"agent_{name}_s"][a],
+                    blocks[f"agent_{name}_t"][a],
+                ),
+                history=BallHistory(),
+                history_cts=BallHistory(),
+            )
+
+        if ref not in self._objects:
+            obj = self.meta["objects"][ref]
+            self._objects[ref] = _converter.structure(
+                obj["value"], _AGENT_CLASSES[AgentType(obj["agent_type"])]
+            )
+
+        return self._objects[ref].copy()
+
+
+class ColumnarEvents:
+    """Queries over the events of a columnar file, without loading them
+
+    Queries are evaluated on the event and agent columns, so only those columns are
+    read (with ``mmap=True``, only their pages are), and only the events that are
+    asked for are built (see :meth:`events`). Events are identified by their row, which
+    counts events across every system in the file.
+
+    Args:
+        path:
+            The file path.
+        mmap:
+            If True, the file is memory-mapped rather than read (see
+            :func:`pooltool.serialize.blocks.read_blocks`).
+
+    Example:
+
+        Find the shots of an archive in which the 8-ball was pocketed:
+
+        >>> events = ColumnarEvents("shots.columnar")
+        >>> rows = events.query("8", pt.EventType.BALL_POCKET)
+        >>> shots = np.unique(events.shot_of(rows))
+
+    See Also:
+        - :class:`pooltool.events.index.EventIndex`, for queries over a system's
+          events.
+    """
+
+    def __init__(self, path: Pathish, mmap: bool = True) -> None:
+        meta, blocks = read_blocks(path, mmap=mmap)
+        self._unpacker = _Unpacker(meta, blocks)
+        self._strings = {string: i for i, string in enumerate(meta["strings"])}
+        self._balls: Dict[int, Dict[str, Ball]] = {}
+
+        self.num_shots = len(meta["systems"])
+
+    def __len__(self) -> int:
+        return len(self._unpacker.blocks["event_type"])
+
+    def query(
+        self,
+        ball_ids: Optional[Union[str, Iterable[str]]] = None,
+        types: Optional[Union[EventType, Iterable[EventType]]] = None,
+        after: Optional[float] = None,
+        before: Optional[float] = None,
+        keep_nonevent: bool = False,
+        shots: Optional[Iterable[int]] = None,
+    ) -> NDArray[np.int64]:
+        """Query the events
+
+        The criteria match like those of
+        :meth:`pooltool.events.index.EventIndex.query`, with times relative to the
+        start of each shot.
+
+        Args:
+            shots:
+                If passed, only the events of these shots (by index) are matched.
+
+        Returns:
+            NDArray[np.int64]: The rows of the matching events, in ascending order.
+        """
+        blocks = self._unpacker.blocks
+        event_type = blocks["event_type"]
+        mask = np.ones(len(event_type), dtype=bool)
+
+        if types is not None:
+            types = [types] if isinstance(types, str) else list(types)
+            codes = [_EVENT_TYPES.index(EventType(t)) for t in types]
+            mask &= np.isin(event_type, codes)
+
+        if after is not None or before is not None:
+            event_time = blocks["event_time"]
+            if after is not None:
+                mask &= event_time > after
+            if before is not None:
+                mask &= event_time < before
+
+        if ball_ids is not None:
+            ball_ids = [ball_ids] if isinstance(ball_ids, str) else list(ball_ids)
+            codes = [self._strings[i] for i in ball_ids if i in self._strings]
+
+            agents = np.flatnonzero(
+                (blocks["agent_type"] == _AGENT_TYPES.index(AgentType.BALL))
+                & np.isin(blocks["agent_id"], codes)
+            )
+
+            # An agent belongs to the last event whose agents start at or before it
+            events = np.searchsorted(blocks["event_agents"], agents, "right") - 1
+            involved = np.zeros(len(event_type), dtype=bool)
+            involved[events] = True
+            if keep_nonevent:
+                involved |= event_type == _EVENT_TYPES.index(EventType.NONE)
+            mask &= involved
+
+        if shots is not None:
+            offsets = blocks["system_events"]
+            in_shots = np.zeros(len(event_type), dtype=bool)
+            for k in shots:
+                in_shots[offsets[k] : offsets[k + 1]] = True
+            mask &= in_shots
+
+        return np.flatnonzero(mask)
+
+    def shot_of(self, rows: NDArray[np.int64]) -> NDArray[np.int64]:
+        """The index of the shot each event belongs to"""
+        return (
+            np.searchsorted(self._unpacker.blocks["system_events"], rows, "right") - 1
+        )
+
+    def events(self, rows: Iterable[int]) -> List[Event]:
+        """Build the events of the given rows
+
+        Events hold copies of the balls they involve, so the balls of each shot that's
+        referenced are built (on the loaded columns) too.
+        """
+        rows = np.asarray(rows, dtype=np.int64)
+        return [
+            self._unpacker._event(int(e), self._shot_balls(int(k)))
+            for e, k in zip(rows, self.shot_of(rows))
+        ]
+
+    def _shot_balls(self, k: int) -> Dict[str, Ball]:
+        if k not in self._balls:
+            offsets = self._unpacker.blocks["system_balls"]
+            balls = [self._unpacker._ball(b) for b in range(offsets[k], offsets[k + 1])]
+            self._balls[k] = {ball.id: ball for ball in balls}
+        return self._balls[k]
+
+
+class ShotArchive:
+    """Loads individual shots of an archive
+
+    Loading a shot reads (and parses the header of) the chunk that holds it, which is
+    kept until a shot of another chunk is loaded. Shots are built on the chunk's
+    columns, like those loaded by :func:`load_shots`.
+
+    Args:
+        path:
+            The file path.
+        mmap:
+            If True, the file is memory-mapped rather than read chunk by chunk (see
+            :class:`pooltool.serialize.chunks.ChunkReader`).
+    """
+
+    def __init__(self, path: Pathish, mmap: bool = False) -> None:
+        self._chunks = ChunkReader(path, mmap=mmap)
+        self._chunk: Optional[Tuple[int, _Unpacker]] = None
+
+    def __len__(self) -> int:
+        return self._chunks.num_items
+
+    def shot(self, k: int) -> ShotRecord:
+        """Load the shot with index k
+
+        Raises:
+            IndexError: If there's no such shot.
+        """
+        chunk, j = self._chunks.locate(k)
+
+        if self._chunk is None or self._chunk[0] != chunk:
+            self._chunk = chunk, _Unpacker(*self._chunks.read(chunk))
+
+        return self._chunk[1]._shot(j)
@@ -2,20 +2,25 @@
 
 from __future__ import annotations
 
-from typing import Dict, Iterator, List, Optional
+from pathlib import Path
+from typing import Dict, Iterator, List, Literal, Optional, Sequence, Union, overload
 
 import numpy as np
-from attrs import define, field
+from attrs import define, evolve, field
+from cattrs.gen import make_dict_unstructure_fn, override
 
 import pooltool.constants as const
 import pooltool.ptmath as ptmath
+import pooltool.ptmath.placement as placement
 from pooltool.events import Event
+from pooltool.events.index import EventIndex
 from pooltool.objects.ball.datatypes import Ball, BallHistory
 from pooltool.objects.ball.sets import BallSet
 from pooltool.objects.cue.datatypes import Cue
 from pooltool.objects.table.datatypes import Table
-from pooltool.serialize import conversion
+from pooltool.serialize import SerializeFormat, conversion
 from pooltool.serialize.serializers import Pathish
+from pooltool.system import columnar
 
 
 @define
@@ -100,6 +105,10 @@ class System:
     t: float = field(default=0.0)
     events: List[Event] = field(factory=list)
 
+    _event_index: Optional[EventIndex] = field(
+        default=None, init=False, repr=False, eq=False
+    )
+
     @balls.validator  # type: ignore
     def _validate_balls(self, _, value) -> None:
         first_ball_m = None
@@ -148,6 +157,35 @@ class System:
         """
         return bool(len(self.events))
 
+    @property
+    def event_index(self) -> EventIndex:
+        """An index over :attr:`events`, for fast queries
+
+        The index is built the first time it's accessed, and is kept up to date as
+        events are appended, or as :attr:`events` is replaced. Events replaced in place
+        (`e.g.` ``system.events[3] = event``) aren't picked up.
+
+        Example:
+
+            This finds the first ball-ball collision of the cue ball, and the cushions
+            it hit afterwards:
+
+            >>> import pooltool as pt
+            >>> system = pt.simulate(pt.System.example())
+            >>> first = system.event_index.first("cue", pt.EventType.BALL_BALL)
+            >>> system.event_index.query(
+            >>>     "cue", pt.EventType.BALL_LINEAR_CUSHION, after=first.time
+            >>> )
+
+        See Also:
+            - :class:`pooltool.events.index.EventIndex`
+        """
+        if self._event_index is None:
+            self._event_index = EventIndex(self.events)
+        else:
+            self._event_index = self._event_index.sync(self.events)
+        return self._event_index
+
     def set_ballset(self, ballset: BallSet) -> None:
         """Sets the ballset for each ball in the system.
 
@@ -305,15 +343,15 @@ class System:
     ) -> bool:
         """Randomize ball positions on the table--ensure no overlap
 
-        This "algorithm" initializes a random state, and checks that all the balls are
-        non-overlapping. If any are, a new state is initialized and the process is
-        repeated. This is an inefficient algorithm, in case that needs to be said.
+        Balls are placed one at a time, each drawn uniformly on the table until it
+        doesn't overlap any other ball, so only balls that conflict are re-drawn (see
+        :mod:`pooltool.ptmath.placement`).
 
         Args:
             ball_ids:
-                Only these balls will be randomized.
+                Only these balls will be randomized. The others stay put.
             niter:
-                The number of iterations tried until the algorithm gives up.
+                The number of draws of each ball until the algorithm gives up.
 
         Returns:
             bool: True if all balls are non-overlapping. Returns False otherwise.
@@ -322,20 +360,23 @@ class System:
         if ball_ids is None:
             ball_ids = list(self.balls.keys())
 
-        for _ in range(niter):
-            for ball_id in ball_ids:
-                ball = self.balls[ball_id]
-                R = ball.params.R
-                ball.state.rvw[0] = [
-                    np.random.uniform(R, self.table.w - R),
-                    np.random.uniform(R, self.table.l - R),
-                    R,
-                ]
+        balls = list(self.balls.values())
+        if not len(balls):
+            return True
 
-            if not self.is_balls_overlapping():
-                return True
+        xy = np.array([ball.state.rvw[0, :2] for ball in balls], dtype=np.float64)
+        R = np.array([ball.params.R for ball in balls], dtype=np.float64)
+        movable = np.array([ball.id in ball_ids for ball in balls], dtype=np.bool_)
 
-        return False
+        placed = placement.place_balls(
+            xy, R, movable, self.table.w, self.table.l, niter, np.random.randint(2**31)
+        )
+
+        for i, ball in enumerate(balls):
+            if movable[i]:
+                ball.state.rvw[0] = [xy[i, 0], xy[i, 1], R[i]]
+
+        return placed
 
     def is_balls_overlapping(self) -> bool:
         """Determines if any balls are overlapping.
@@ -343,21 +384,10 @@ class System:
         Returns:
             bool: True if any balls overlap, False otherwise.
         """
-        for ball1 in self.balls.values():
-            for ball2 in self.balls.values():
-                if ball1 is ball2:
-                    continue
-
-                assert (
-                    ball1.params.R == ball2.params.R
-                ), "Balls are assumed to be equal radii"
-
-                if ptmath.is_overlapping(
-                    ball1.state.rvw, ball2.state.rvw, ball1.params.R, ball2.params.R
-                ):
-                    return True
-
-        return False
+        balls = self.balls.values()
+        xyz = np.array([ball.state.rvw[0] for ball in balls], dtype=np.float64)
+        R = np.array([ball.params.R for ball in balls], dtype=np.float64)
+        return placement.any_overlapping(xyz.reshape(-1, 3), R)
 
     def copy(self) -> System:
         """Creates a deep-`ish` copy of the system.
@@ -371,9 +401,16 @@ class System:
         TLDR For all intents and purposes, mutating the system copy will not impact the
         original system, and vice versa.
 
+        Copying is cheap even for simulated systems. Ball histories are shared
+        copy-on-write (see :meth:`pooltool.objects.ball.datatypes.BallHistory.copy`),
+        and events, which aren't modified once recorded, are shared too.
+
         Returns:
             System: A deepcopy of the system.
 
+        See Also:
+            - :meth:`fork` shares the table geometry too.
+
         Example:
             >>> import pooltool as pt
             >>> system = pt.System.example()
@@ -389,7 +426,43 @@ class System:
             table=self.table.copy(),
             balls={k: v.copy() for k, v in self.balls.items()},
             t=self.t,
-            events=[event.copy() for event in self.events],
+            events=list(self.events),
+        )
+
+    def fork(self) -> System:
+        """Creates a lightweight, mutable overlay of the system.
+
+        The fork owns everything that simulating or striking it modifies: the cue, the
+        ball states, the pocket contents, the time, and the list of events. Everything
+        else is shared with ``self``, including the ball parameters, the ball histories
+        (copy-on-write), the recorded events, and the table's cushion segments.
+
+        This makes forking the cheapest way to try many shots from one pre-shot state.
+        Unlike with :meth:`copy`, though, adding or removing cushion segments of the
+        fork's table modifies the original's table.
+
+        Returns:
+            System: The fork.
+
+        Example:
+            >>> import pooltool as pt
+            >>> system = pt.System.example()
+            >>> for phi in range(0, 360, 10):
+            >>>     fork = system.fork()
+            >>>     fork.cue.set_state(phi=phi)
+            >>>     pt.simulate(fork, inplace=True)
+            >>> system.simulated
+            False
+        """
+        return System(
+            cue=self.cue.copy(),
+            table=evolve(
+                self.table,
+                pockets={k: v.copy() for k, v in self.table.pockets.items()},
+            ),
+            balls={k: v.copy() for k, v in self.balls.items()},
+            t=self.t,
+            events=list(self.events),
         )
 
     def save(self, path: Pathish, drop_continuized_history: bool = False) -> None:
@@ -399,6 +472,9 @@ class System:
 
         (1) ``.json``
         (2) ``.msgpack``
+        (3) ``.columnar`` (see :mod:`pooltool.system.columnar`)
+        (4) ``.archive`` (see :mod:`pooltool.system.columnar`), which more systems
+            can be appended to (see :class:`LazyMultiSystem`)
 
         Args:
             path:
@@ -487,42 +563,75 @@ class System:
             >>> pt.continuize(loaded_system, inplace=True)
             >>> assert loaded_system == system
 
+        Example:
+
+            The columnar format stores ball histories and events as fixed-layout
+            arrays, so saving and loading involve no per-state parsing. It can also be
+            memory-mapped, in which case the ball histories are views into the mapped
+            file (see :meth:`load`):
+
+            >>> import pooltool as pt
+            >>> system = pt.System.example()
+            >>> pt.simulate(system, continuous=True, inplace=True)
+            >>> system.save("shot.columnar")
+            >>> loaded_system = pt.System.load("shot.columnar", mmap=True)
+            >>> assert loaded_system == system
+
         See Also:
             Load systems with :meth:`load`.
         """
+        system = self
+
         if drop_continuized_history:
             # We're dropping the continuized histories. To avoid losing them in `self`,
             # we make a copy.
-            copy = self.copy()
+            system = self.copy()
 
-            for ball in copy.balls.values():
+            for ball in system.balls.values():
                 ball.history_cts = BallHistory()
 
-            conversion.unstructure_to(copy, path)
+        if _is_columnar(path):
+            columnar.save_shots([_to_record(system)], path)
             return
 
-        conversion.unstructure_to(self, path)
+        if _is_archive(path):
+            columnar.save_archive([_to_record(system)], path)
+            return
+
+        conversion.unstructure_to(system, path)
 
     @classmethod
-    def load(cls, path: Pathish) -> System:
+    def load(cls, path: Pathish, mmap: bool = False) -> System:
         """Load a System from a file in a serialized format.
 
         Supported file extensions:
 
         (1) ``.json``
         (2) ``.msgpack``
+        (3) ``.columnar`` (see :mod:`pooltool.system.columnar`)
+        (4) ``.archive`` (see :mod:`pooltool.system.columnar`)
 
         Args:
             path:
                 Either a ``pathlib.Path`` object or a string representing the file path. The
                 extension should match the supported filetypes mentioned above.
+            mmap:
+                If True, the file is memory-mapped rather than read, and the ball
+                histories are built directly on the mapping. Pages are read from disk
+                only as the histories are accessed. Modifying the loaded system never
+                modifies the file. Only supported for ``.columnar`` and ``.archive``
+                files.
 
         Returns:
             System: The deserialized System object loaded from the file.
 
         Raises:
             AssertionError: If the file specified by `path` does not exist.
-            ValueError: If the file extension is not supported.
+            ValueError:
+                If the file extension is not supported, if ``mmap`` is True for a
+                format other than ``.columnar`` or ``.archive``, or if a ``.columnar``
+                or ``.archive`` file doesn't hold exactly one system (see
+                :meth:`MultiSystem.load`).
 
         Examples:
 
@@ -531,6 +640,27 @@ class System:
         See Also:
             Save systems with :meth:`save`.
         """
+        if _is_columnar(path):
+            records = columnar.load_shots(path, mmap=mmap)
+            if len(records) != 1:
+                raise ValueError(
+                    f"'{path}' holds {len(records)} systems. Load it with "
+                    "MultiSystem.load"
+                )
+            return _from_record(records[0])
+
+        if _is_archive(path):
+            archive = columnar.ShotArchive(path, mmap=mmap)
+            if len(archive) != 1:
+                raise ValueError(
+                    f"'{path}' holds {len(archive)} systems. Load it with "
+                    "MultiSystem.load"
+                )
+            return _from_record(archive.shot(0))
+
+        if mmap:
+            raise ValueError("mmap is only supported for the columnar formats")
+
         return conversion.structure_from(path, cls)
 
     @classmethod
@@ -694,47 +824,228 @@ class MultiSystem:
 
         self.active_index = i
 
-    def save(self, path: Pathish) -> None:
+    def save(self, path: Pathish, chunk_size: int = 64) -> None:
         """Save the multisystem to file in a serialized format.
 
         Supported file extensions:
 
         (1) ``.json``
         (2) ``.msgpack``
+        (3) ``.columnar`` (see :mod:`pooltool.system.columnar`). All systems are
+            stored in shared columns, so this scales to large collections of shots.
+        (4) ``.archive`` (see :mod:`pooltool.system.columnar`). Systems are stored in
+            chunks of columns, so that they can be loaded a few at a time (see
+            :meth:`load`), and appended to the file (see
+            :meth:`LazyMultiSystem.append`).
 
         Args:
             path:
                 Either a ``pathlib.Path`` object or a string. The extension should match the
                 supported filetypes mentioned above.
+            chunk_size:
+                The number of systems stored in each chunk of an ``.archive`` file.
 
         See Also:
             - To load a multisystem, see :meth:`load`.
             - To save/load single systems, see :meth:`System.save` and :meth:`System.load`
         """
+        if _is_columnar(path):
+            columnar.save_shots([_to_record(system) for system in self], path)
+            return
+
+        if _is_archive(path):
+            records = [_to_record(system) for system in self]
+            columnar.save_archive(records, path, chunk_size=chunk_size)
+            return
+
         conversion.unstructure_to(self, path)
 
+    @overload
+    @classmethod
+    def load(
+        cls, path: Pathish, mmap: bool = False, lazy: Literal[False] = False
+    ) -> MultiSystem: ...
+
+    @overload
+    @classmethod
+    def load(
+        cls, path: Pathish, mmap: bool = False, *, lazy: Literal[True]
+    ) -> LazyMultiSystem: ...
+
     @classmethod
-    def load(cls, path: Pathish) -> MultiSystem:
+    def load(
+        cls, path: Pathish, mmap: bool = False, lazy: bool = False
+    ) -> Union[MultiSystem, LazyMultiSystem]:
         """Load a multisystem from a file in a serialized format.
 
         Supported file extensions:
 
         (1) ``.json``
         (2) ``.msgpack``
+        (3) ``.columnar`` (see :mod:`pooltool.system.columnar`)
+        (4) ``.archive`` (see :mod:`pooltool.system.columnar`)
 
         Args:
             path:
                 Either a pathlib.Path object or a string representing the file path. The
                 extension should match the supported filetypes mentioned above.
+            mmap:
+                See :meth:`System.load`. Also supported for ``.archive`` files.
+            lazy:
+                If True, a :class:`LazyMultiSystem` is returned, which loads systems
+                only as they're accessed. Only supported for ``.archive`` files.
 
         Returns:
             MultiSystem: The deserialized MultiSystem object loaded from the file.
 
+        Example:
+
+            Record shots as they're taken, then look at one of them:
+
+            >>> pt.MultiSystem().save("session.archive")
+            >>> session = pt.MultiSystem.load("session.archive", lazy=True)
+            >>> for phi in range(0, 360, 10):
+            >>>     shot = pt.System.example()
+            >>>     shot.strike(phi=phi)
+            >>>     session.append(pt.simulate(shot))
+            >>> shot = session[7]
+
         See Also:
             - To save a multisystem, see :meth:`save`.
             - To save/load single systems, see :meth:`System.save` and :meth:`System.load`
         """
+        if lazy:
+            if not _is_archive(path):
+                raise ValueError("lazy is only supported for the archive format")
+            return LazyMultiSystem(path, mmap=mmap)
+
+        if _is_columnar(path):
+            multisystem = cls()
+            multisystem.extend(
+                [_from_record(record) for record in columnar.load_shots(path, mmap)]
+            )
+            return multisystem
+
+        if _is_archive(path):
+            multisystem = cls()
+            multisystem.extend(list(LazyMultiSystem(path, mmap=mmap)))
+            return multisystem
+
+        if mmap:
+            raise ValueError("mmap is only supported for the columnar formats")
+
         return conversion.structure_from(path, cls)
 
 
+class LazyMultiSystem:
+    """A collection of systems stored in an archive, loaded as they're accessed
+
+    Like :class:`MultiSystem`, this can be indexed and iterated through. Each access
+    builds the system from the file (see :class:`pooltool.system.columnar.ShotArchive`),
+    so loaded systems are never shared, and modifying one never modifies the file.
+    Systems can be appended to the file, but not changed or removed.
+
+    Args:
+        path:
+            The path of an ``.archive`` file.
+        mmap:
+            If True, the file is memory-mapped rather than read chunk by chunk.
+
+    See Also:
+        - To make one, see :meth:`MultiSystem.load`.
+    """
+
+    def __init__(self, path: Pathish, mmap: bool = False) -> None:
+        self.path = path
+        self.mmap = mmap
+        self._archive = columnar.ShotArchive(path, mmap=mmap)
+
+    def __len__(self) -> int:
+        return len(self._archive)
+
+    def __getitem__(self, idx: int) -> System:
+        if idx < 0:
+            idx += len(self)
+        return _from_record(self._archive.shot(idx))
+
+    def __iter__(self) -> Iterator[System]:
+        for idx in range(len(self)):
+            yield self[idx]
+
+    @property
+    def empty(self) -> bool:
+        return not bool(len(self))
+
+    def append(self, system: System) -> None:
+        """Append a system to the file
+
+        The system is stored in a chunk of its own, and the file's existing chunks are
+        left untouched.
+
+        Note:
+            - Each chunk stores its own copy of the tables, ball parameters, and
+              ballsets its systems use, along with its own header and index entry. When
+              recording many systems, buffer them and append them in batches with
+              :meth:`extend`, rather than appending them one at a time.
+        """
+        self.extend([system])
+
+    def extend(self, systems: Sequence[System], chunk_size: int = 64) -> None:
+        """Append systems to the file
+
+        Args:
+            systems:
+                The systems.
+            chunk_size:
+                The number of systems stored in each new chunk.
+        """
+        records = [_to_record(system) for system in systems]
+        columnar.append_archive(records, self.path, chunk_size=chunk_size)
+        self._archive = columnar.ShotArchive(self.path, mmap=self.mmap)
+
+
+def _register_system_hooks(fmt: SerializeFormat) -> None:
+    """Unstructure systems without their event index, which is derived from events"""
+    conversion.register_unstructure_hook(
+        System,
+        make_dict_unstructure_fn(
+            System, conversion[fmt], _event_index=override(omit=True)
+        ),
+        which=(fmt,),
+    )
+
+
+_register_system_hooks(SerializeFormat.JSON)
+_register_system_hooks(SerializeFormat.MSGPACK)
+_register_system_hooks(SerializeFormat.YAML)
+
+
+def _is_columnar(path: Pathish) -> bool:
+    return Path(path).suffix.lstrip(".") == SerializeFormat.COLUMNAR.ext
+
+
+def _is_archive(path: Pathish) -> bool:
+    return Path(path).suffix.lstrip(".") == SerializeFormat.ARCHIVE.ext
+
+
+def _to_record(system: System) -> columnar.ShotRecord:
+    return columnar.ShotRecord(
+        cue=system.cue,
+        table=system.table,
+        balls=system.balls,
+        t=system.t,
+        events=system.events,
+    )
+
+
+def _from_record(record: columnar.ShotRecord) -> System:
+    return System(
+        cue=record.cue,
+        table=record.table,
+        balls=record.balls,
+        t=record.t,
+        events=record.events,
+    )
+
+
 multisystem = MultiSystem()
@@ -2,10 +2,19 @@ from __future__ import annotations
 
 from typing import Dict, Optional
 
+import numpy as np
 from attrs import define
-from direct.interval.IntervalGlobal import Func, Parallel, Sequence, Wait
+from direct.interval.IntervalGlobal import (
+    Func,
+    LerpFunctionInterval,
+    Parallel,
+    Sequence,
+    Wait,
+)
+from panda3d.core import Quat
 from panda3d.direct import HideInterval, ShowInterval
 
+import pooltool.ani as ani
 from pooltool.ani.globals import Global
 from pooltool.evolution.continuize import continuize
 from pooltool.objects.ball.render import BallRender
@@ -40,6 +49,92 @@ class PlaybackMode(StrEnum):
     SINGLE = auto()
 
 
+class ArrayPlayback:
+    """Drives rendered balls from arrays of their continuized trajectories
+
+    Rather than building a chain of Lerp intervals for each ball (see
+    :meth:`pooltool.objects.ball.render.BallRender.get_playback_sequence`), each ball's
+    positions and quaternions are stored as arrays, and all balls are interpolated at a
+    given time in one vectorized pass (see :meth:`set_time`). Since the playback time is
+    all that's needed to place the balls, seeking, pausing, and changing the playback
+    speed don't require rebuilding anything.
+    """
+
+    def __init__(self, balls: Dict[str, BallRender]):
+        self.renders = []
+        ts, xyzs, quats = [], [], []
+
+        for ball in balls.values():
+            if not ball.rendered:
+                ball.render()
+
+            ball_ts, ball_xyzs, ball_quats = ball.get_playback_arrays()
+            if not len(ball_ts):
+                continue
+
+            self.renders.append(ball)
+            ts.append(ball_ts)
+            xyzs.append(ball_xyzs)
+            quats.append(ball_quats)
+
+        if not len(self.renders):
+            self.ts = np.zeros(1)
+            self.xyzs = np.zeros((0, 1, 3))
+            self.quats = np.zeros((0, 1, 4))
+            return
+
+        # Continuized histories share the same timestamps
+        assert all(np.array_equal(ts[0], other) for other in ts)
+
+        self.ts = ts[0]
+        self.xyzs = np.stack(xyzs)
+        self.quats = np.stack(quats)
+
+        # Flip quaternion signs so consecutive quaternions take the short way around
+        dots = (self.quats[:, 1:] * self.quats[:, :-1]).sum(axis=2)
+        signs = np.cumprod(np.where(dots < 0, -1.0, 1.0), axis=1)
+        self.quats[:, 1:] *= signs[..., None]
+
+    @property
+    def duration(self) -> float:
+        return float(self.ts[-1] - self.ts[0])
+
+    def set_time(self, t: float) -> None:
+        """Place each ball at its interpolated state at time t"""
+        if len(self.ts) == 1:
+            xyzs, quats = self.xyzs[:, 0], self.quats[:, 0]
+        else:
+            # The timestamps bracketing t
+            i = np.searchsorted(self.ts, t, side="right") - 1
+            i = min(max(i, 0), len(self.ts) - 2)
+
+            span = self.ts[i + 1] - self.ts[i]
+            frac = min(max((t - self.ts[i]) / span, 0.0), 1.0) if span > 0 else 1.0
+
+            xyzs = self.xyzs[:, i] + frac * (self.xyzs[:, i + 1] - self.xyzs[:, i])
+            quats = self.quats[:, i] + frac * (self.quats[:, i + 1] - self.quats[:, i])
+            quats /= np.linalg.norm(quats, axis=1, keepdims=True)
+
+        for ball, xyz, quat in zip(self.renders, xyzs, quats):
+            ball.set_render_state(xyz, Quat(*quat))
+
+    def interval(self, playback_speed: float = 1) -> LerpFunctionInterval:
+        """An interval that calls :meth:`set_time` with its playback time
+
+        Args:
+            playback_speed:
+                How many times faster than real time the shot is played. The
+                interval's duration is scaled, rather than its play rate, since the play
+                rate of an interval nested in a :class:`Sequence` is ignored.
+        """
+        return LerpFunctionInterval(
+            self.set_time,
+            duration=self.duration / playback_speed,
+            fromData=self.ts[0],
+            toData=self.ts[-1],
+        )
+
+
 class SystemController:
     def __init__(self) -> None:
         self.system: SystemRender
@@ -49,6 +144,7 @@ class SystemController:
         self.paused: bool = True
         self.playback_speed: float = 1
         self.playback_mode: PlaybackMode = PlaybackMode.SINGLE
+        self.array_playback: Optional[ArrayPlayback] = None
 
     @property
     def table(self):
@@ -68,6 +164,60 @@ class SystemController:
             self.teardown()
         self.system = SystemRender.from_system(system)
 
+    def can_rebind(self, system: System) -> bool:
+        """Returns whether the rendered nodes can be reused for a new system
+
+        This is the case when the new system has the same balls (by ID, ballset, and
+        radius) and the same table geometry as the attached system.
+        """
+        if not hasattr(self, "system"):
+            return False
+
+        if set(self.system.balls) != set(system.balls):
+            return False
+
+        for ball_id, ball in system.balls.items():
+            rendered = self.system.balls[ball_id]
+            if not rendered.rendered:
+                return False
+            if rendered._ball.ballset != ball.ballset:
+                return False
+            if rendered._ball.params.R != ball.params.R:
+                return False
+
+        table = self.system.table._table
+        return (
+            table.model_descr == system.table.model_descr
+            and table.table_type == system.table.table_type
+            and table.w == system.table.w
+            and table.l == system.table.l
+        )
+
+    def rebind(self, system: System) -> None:
+        """Attach a new system, reusing the rendered nodes of the attached system
+
+        Unlike :meth:`attach_system`, no nodes are torn down or rebuilt. Instead, the
+        existing renders are pointed at the new system's objects, and each ball's nodes
+        are moved to its initial state and orientation. The new system must be
+        compatible with the attached one (see :meth:`can_rebind`).
+        """
+        assert self.can_rebind(system), "System is incompatible with rendered nodes"
+
+        if system.simulated and not system.continuized:
+            continuize(system, inplace=True)
+
+        self.reset_animation()
+
+        for ball_id, ball in system.balls.items():
+            render = self.system.balls[ball_id]
+            render._ball = ball
+            render.quats = []
+            render.set_orientation(ball.initial_orientation)
+            render.set_render_state_as_object_state()
+
+        self.system.table._table = system.table
+        self.system.cue._cue = system.cue
+
     def reset_animation(self, reset_pause: bool = True) -> None:
         """Set objects to initial states, pause, and remove animations"""
         self.playback_mode = PlaybackMode.SINGLE
@@ -82,6 +232,7 @@ class SystemController:
         self.stroke_animation = Sequence()
         self.ball_animations = Parallel()
         self.shot_animation = Sequence()
+        self.array_playback = None
 
     @property
     def animation_finished(self):
@@ -164,6 +315,12 @@ class SystemController:
         self.change_speed(2.0)
 
     def change_speed(self, factor):
+        if self.array_playback is not None:
+            # Balls are interpolated at any playback time, so only the play rate changes
+            self.playback_speed *= factor
+            self.shot_animation.setPlayRate(factor * self.shot_animation.getPlayRate())
+            return
+
         curr_time = self.shot_animation.get_t()
 
         self.reset_animation(reset_pause=False)
@@ -210,17 +367,28 @@ class SystemController:
         trailing_buffer: float = 0,
         leading_buffer: float = 0,
     ) -> None:
-        """From the SystemRender, build the shot animation"""
-
-        # This takes ~90% of this method's execution time
-        self.ball_animations = Parallel()
-        for ball in self.system.balls.values():
-            if not ball.rendered:
-                ball.render()
+        """From the SystemRender, build the shot animation
 
-            self.ball_animations.append(
-                ball.get_playback_sequence(playback_speed=self.playback_speed)
+        If the ``array_playback`` graphics setting is on (the default), balls are
+        driven by an :class:`ArrayPlayback`. Otherwise, a sequence of Lerp intervals is
+        built for each ball.
+        """
+        if ani.settings["graphics"].get("array_playback", True):
+            self.array_playback = ArrayPlayback(self.system.balls)
+            self.ball_animations = Parallel(
+                self.array_playback.interval(playback_speed=self.playback_speed)
             )
+        else:
+            # This takes ~90% of this method's execution time
+            self.array_playback = None
+            self.ball_animations = Parallel()
+            for ball in self.system.balls.values():
+                if not ball.rendered:
+                    ball.render()
+
+                self.ball_animations.append(
+                    ball.get_playback_sequence(playback_speed=self.playback_speed)
+                )
 
         if not animate_stroke:
             # Early return, skipping stroke trajectory
@@ -0,0 +1,181 @@
+import numpy as np
+import pytest
+
+from pooltool.events import EventType
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.evolution.event_based.test_data import nine_ball_break, phi_sweep
+from pooltool.system import LazyMultiSystem, MultiSystem, System
+from pooltool.system.columnar import ColumnarEvents
+
+
+@pytest.mark.parametrize("mmap", [False, True])
+def test_columnar_round_trip(tmp_path, mmap: bool):
+    path = tmp_path / "shot.columnar"
+
+    # Unsimulated
+    system = System.example()
+    system.save(path)
+    assert System.load(path, mmap=mmap) == system
+
+    # Simulated and continuized, with balls pocketed
+    system = simulate(nine_ball_break(), continuous=True)
+    system.save(path)
+    loaded = System.load(path, mmap=mmap)
+    assert loaded == system
+
+    # Loaded systems can be modified without modifying the file
+    state = loaded.balls["cue"].history[0]
+    state.rvw[0] = [0, 0, 0]
+    loaded.balls["cue"].history[0] = state
+    simulate(loaded, inplace=True)
+    assert System.load(path, mmap=mmap) == system
+
+    # Continuized histories can be dropped
+    system.save(path, drop_continuized_history=True)
+    loaded = System.load(path, mmap=mmap)
+    assert all(ball.history_cts.empty for ball in loaded.balls.values())
+
+
+def test_columnar_multisystem(tmp_path):
+    path = tmp_path / "shots.columnar"
+
+    multisystem = MultiSystem()
+    template = System.example()
+    for phi in np.linspace(0, 360, 5, endpoint=False):
+        system = template.copy()
+        system.strike(phi=phi)
+        multisystem.append(simulate(system))
+    multisystem.append(simulate(nine_ball_break()))
+
+    multisystem.save(path)
+    loaded = MultiSystem.load(path, mmap=True)
+    assert len(loaded) == len(multisystem)
+    for system, other in zip(loaded, multisystem):
+        assert system == other
+
+    # Files holding many systems can't be loaded as a system
+    with pytest.raises(ValueError):
+        System.load(path)
+
+
+def test_mmap_unsupported(tmp_path):
+    path = tmp_path / "shot.msgpack"
+    System.example().save(path)
+
+    with pytest.raises(ValueError):
+        System.load(path, mmap=True)
+
+
+def test_columnar_events(tmp_path):
+    path = tmp_path / "shots.columnar"
+
+    multisystem = MultiSystem()
+    for phi in (0, 90, 180):
+        system = nine_ball_break()
+        system.strike(V0=8, phi=phi)
+        multisystem.append(simulate(system))
+    multisystem.save(path)
+
+    columnar_events = ColumnarEvents(path)
+    assert len(columnar_events) == sum(len(system.events) for system in multisystem)
+
+    queries = [
+        dict(ball_ids="cue", types=EventType.BALL_BALL),
+        dict(ball_ids=["1", "9"], after=0.5),
+        dict(types=[EventType.BALL_POCKET, EventType.NONE], before=2.0),
+        dict(ball_ids="2", keep_nonevent=True),
+    ]
+
+    for query in queries:
+        rows = columnar_events.query(**query)
+        shots = columnar_events.shot_of(rows)
+        events = columnar_events.events(rows)
+
+        expected = [
+            (k, event)
+            for k, system in enumerate(multisystem)
+            for event in system.event_index.query(**query)
+        ]
+        assert list(zip(shots.tolist(), events)) == expected
+
+        # Restricted to a shot
+        rows = columnar_events.query(**query, shots=[1])
+        assert columnar_events.events(rows) == multisystem[1].event_index.query(**query)
+
+
+def _simulated_sweep(num_shots: int) -> MultiSystem:
+    multisystem = MultiSystem()
+    for shot in phi_sweep(num_shots):
+        multisystem.append(simulate(shot))
+
+    return multisystem
+
+
+@pytest.mark.parametrize("mmap", [False, True])
+def test_archive_lazy(tmp_path, mmap: bool):
+    path = tmp_path / "shots.archive"
+
+    multisystem = _simulated_sweep(5)
+    multisystem.append(simulate(nine_ball_break()))
+    multisystem.save(path, chunk_size=4)
+
+    lazy = MultiSystem.load(path, mmap=mmap, lazy=True)
+    assert isinstance(lazy, LazyMultiSystem)
+    assert len(lazy) == len(multisystem)
+    assert lazy[-1] == multisystem[-1]
+    assert lazy[3] == multisystem[3]
+    for system, other in zip(lazy, multisystem):
+        assert system == other
+
+    # Loaded systems aren't shared, even though they're built on the same chunk
+    first, again, neighbor = lazy[0], lazy[0], lazy[1]
+    assert first is not again
+
+    ball = first.balls["cue"]
+    state = ball.history[0]
+    state.rvw[0] = 0
+    ball.history[0] = state
+    ball.state.rvw[0] = 0
+    simulate(first, inplace=True)
+    assert again == multisystem[0]
+    assert neighbor == multisystem[1]
+    assert lazy[0] == multisystem[0]
+
+    with pytest.raises(IndexError):
+        lazy[len(multisystem)]
+
+    loaded = MultiSystem.load(path, mmap=mmap)
+    assert isinstance(loaded, MultiSystem)
+    assert list(loaded) == list(multisystem)
+
+    # Files holding many systems can't be loaded as a system
+    with pytest.raises(ValueError):
+        System.load(path)
+
+    multisystem[0].save(path)
+    assert System.load(path, mmap=mmap) == multisystem[0]
+
+
+def test_archive_append(tmp_path):
+    path = tmp_path / "shots.archive"
+    multisystem = _simulated_sweep(3)
+
+    MultiSystem().save(path)
+    lazy = MultiSystem.load(path, lazy=True)
+    assert lazy.empty
+
+    lazy.append(multisystem[0])
+    lazy.extend(multisystem[1:])
+    assert len(lazy) == 3
+    assert list(lazy) == list(multisystem)
+
+    # Appended systems are seen when the file is loaded again
+    assert list(MultiSystem.load(path, lazy=True)) == list(multisystem)
+
+
+def test_lazy_unsupported(tmp_path):
+    for path in (tmp_path / "shots.columnar", tmp_path / "shots.msgpack"):
+        _simulated_sweep(1).save(path)
+
+        with pytest.raises(ValueError):
+            MultiSystem.load(path, lazy=True)
@@ -0,0 +1,56 @@
+import numpy as np
+
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.system.datatypes import System
+
+
+def test_system_copy():
+    system = simulate(System.example())
+    copy = system.copy()
+
+    assert copy == system
+
+    # Recorded events are shared, but the lists aren't
+    assert copy.events is not system.events
+    assert all(a is b for a, b in zip(copy.events, system.events))
+
+    # Histories are copy-on-write, so modifying one leaves the other untouched
+    state = copy.balls["cue"].history[0]
+    state.rvw[0] = 0
+    copy.balls["cue"].history[0] = state
+    assert not np.allclose(system.balls["cue"].history[0].rvw[0], 0)
+
+    copy.balls["cue"].state.rvw[0] = 0
+    assert not np.allclose(system.balls["cue"].state.rvw[0], 0)
+
+
+def test_system_fork():
+    system = System.example()
+    fork = system.fork()
+
+    assert fork == system
+    assert fork.table.cushion_segments is system.table.cushion_segments
+    assert fork.table.pockets is not system.table.pockets
+
+    # Simulating the fork leaves the original untouched
+    fork.cue.set_state(phi=fork.cue.phi + 1)
+    simulate(fork, inplace=True)
+    assert fork.simulated
+    assert not system.simulated
+    assert fork.cue != system.cue
+
+    for pocket_id, pocket in fork.table.pockets.items():
+        assert pocket.contains is not system.table.pockets[pocket_id].contains
+
+
+def test_system_randomize_positions():
+    system = System.example()
+    assert not system.is_balls_overlapping()
+
+    cue_xyz = system.balls["cue"].xyz.copy()
+    assert system.randomize_positions(ball_ids=["1"])
+    assert not system.is_balls_overlapping()
+    assert np.array_equal(system.balls["cue"].xyz, cue_xyz)
+
+    system.balls["1"].state.rvw[0] = system.balls["cue"].state.rvw[0]
+    assert system.is_balls_overlapping()
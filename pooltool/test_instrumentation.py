@@ -0,0 +1,58 @@
+import pooltool.instrumentation as instrumentation
+from pooltool.events import EventType
+from pooltool.evolution.event_based.broadphase import BroadPhase
+from pooltool.evolution.event_based.simulate import simulate
+from pooltool.instrumentation import Phase, instrument
+from pooltool.system import System
+
+
+def test_instrument_simulate():
+    with instrument() as stats:
+        shot = simulate(System.example())
+
+    assert instrumentation.active is None
+    assert stats.shots == 1
+
+    # Every recorded event but the null events that bookend the shot was resolved
+    resolved = [event for event in shot.events if event.event_type != EventType.NONE]
+    assert sum(stats.events.values()) == len(resolved)
+    assert stats.events[EventType.BALL_POCKET] == 1
+
+    assert all(stats.phase_time[phase] > 0 for phase in Phase)
+    assert stats.quartics > 0
+    assert 0 <= stats.quartic_fallbacks <= stats.quartics
+
+    # Without culling, every candidate is considered
+    assert stats.candidates[EventType.BALL_BALL] > 0
+    assert dict(stats.candidates) == dict(stats.culled_candidates)
+
+    assert stats.allocated is None
+    assert "shots: 1" in stats.summary()
+
+
+def test_instrument_culling():
+    with instrument() as stats:
+        simulate(System.example(), broadphase=BroadPhase.SWEEP_AND_PRUNE)
+
+    for event_type, num in stats.candidates.items():
+        assert stats.culled_candidates[event_type] <= num
+
+
+def test_instrument_nested():
+    with instrument() as outer:
+        simulate(System.example())
+        with instrument() as inner:
+            simulate(System.example())
+        assert instrumentation.active is outer
+
+    assert outer.shots == 1
+    assert inner.shots == 1
+
+
+def test_instrument_allocations():
+    with instrument(trace_allocations=True) as stats:
+        simulate(System.example())
+
+    assert stats.allocated is not None
+    assert stats.peak_allocated is not None
+    assert stats.peak_allocated >= stats.allocated
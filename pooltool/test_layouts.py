@@ -17,9 +17,11 @@ from pooltool.layouts import (
     _get_anchor_translation,
     _get_ball_ids,
     generate_layout,
+    random_layouts,
 )
 from pooltool.objects import BallParams, Table
 from pooltool.objects.ball.datatypes import Ball
+from pooltool.ptmath.placement import any_overlapping
 
 
 def test_get_ball_ids():
@@ -198,3 +200,18 @@ def test_seed():
     for result1, result2 in combinations(results_fixed_seed, 2):
         assert np.array_equal(result1.ball1_pos, result2.ball1_pos)
         assert np.array_equal(result1.ball2_pos, result2.ball2_pos)
+
+
+def test_random_layouts():
+    table = Table.default()
+    R = BallParams.default().R
+
+    layouts = random_layouts(20, 16, table, seed=42)
+    assert layouts.shape == (20, 16, 2)
+    for layout in layouts:
+        assert not any_overlapping(layout, np.full(16, R))
+
+    assert np.array_equal(layouts, random_layouts(20, 16, table, seed=42))
+
+    with pytest.raises(ValueError):
+        random_layouts(1, 1000, table, niter=5)